@@ -0,0 +1,11 @@
+/**
+* @file aabb.cpp
+* @author skwo
+* @brief Realization of axis aligned bounding box.
+*/
+
+#include "aabb.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "aabb.inl"
+#endif
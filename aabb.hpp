@@ -0,0 +1,139 @@
+/**
+* @file aabb.hpp
+* @author skwo
+* @brief Defenition of axis aligned bounding box.
+*
+* An AABB is the box between a min and a max corner. computeAABB builds the box of a point set,
+* from an array of vectors or a VectorBatch, as a SIMD min/max reduction split across threads.
+* transformAABB bounds a box after a rigid or affine transform with Arvo's method: the center
+* is transformed, and the half size is multiplied by the absolute values of the rotation part,
+* instead of transforming the eight corners. The result is the tightest axis aligned box of the
+* transformed box.
+*/
+
+#ifndef AABB_HPP_INCLUDED
+#define AABB_HPP_INCLUDED
+
+#include <cstddef>
+
+#include "config.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "quaternion.hpp"
+#include "vectorbatch.hpp"
+
+namespace skmath{
+
+  /** Axis aligned bounding box. A box with min greater than max along any axis is empty. */
+  struct AABB{
+    /** Constructor. Create empty box, min at +infinity and max at -infinity, so extending it
+    * by a point gives the box of that point.
+    */
+    AABB();
+
+    /** Constructor. Create box.
+    * @param minCorner Min corner.
+    * @param maxCorner Max corner.
+    */
+    AABB(const Vector& minCorner, const Vector& maxCorner);
+
+    /** Is empty.
+    * @return True if min is greater than max along any axis.
+    */
+    bool isEmpty() const;
+
+    /** Get center.
+    * @return Center of the box.
+    */
+    Vector center() const;
+
+    /** Get extent.
+    * @return Half size of the box along each axis.
+    */
+    Vector extent() const;
+
+    /** Extend box to contain point.
+    * @param point Point.
+    */
+    void extend(const Vector& point);
+
+    /** Extend box to contain box.
+    * @param box Box, may be empty.
+    */
+    void extend(const AABB& box);
+
+    /** Contains point.
+    * @param point Point.
+    * @return True if <c>point</c> is inside the box or on its boundary.
+    */
+    bool contains(const Vector& point) const;
+
+    /** Intersects box.
+    * @param box Box.
+    * @return True if the boxes overlap or touch.
+    */
+    bool intersects(const AABB& box) const;
+
+    Vector min; /**< Min corner. */
+    Vector max; /**< Max corner. */
+  };
+
+  static_assert(sizeof(AABB) == 6 * sizeof(float), "AABB must be packed, min then max");
+
+  /** Compute AABB. Bounding box of an array of points, reduced 8 (AVX) or 4 (SSE) points at a
+  * time; large arrays are split across threads.
+  * @param points Array of <c>size</c> points.
+  * @param size Number of points.
+  * @return Box of the points, empty if <c>size</c> is 0.
+  */
+  AABB computeAABB(const Vector* points, std::size_t size);
+
+  /** Compute AABB. Bounding box of a batch of points, as computeAABB of an array.
+  * @param points Batch of points.
+  * @return Box of the points, empty if the batch is empty.
+  */
+  AABB computeAABB(const VectorBatch& points);
+
+  /** Transform AABB. Box of <c>box</c> transformed by <c>m</c> as transformPoints does,
+  * translation included, with Arvo's method.
+  * @param m Affine transform.
+  * @param box Box to transform.
+  * @return Transformed box, empty if <c>box</c> is.
+  */
+  AABB transformAABB(const Matrix& m, const AABB& box);
+
+  /** Transform AABB. Box of <c>box</c> rotated as rotate(rotation, p), then translated.
+  * @param rotation Unit quaternion of the rotation.
+  * @param translation Translation.
+  * @param box Box to transform.
+  * @return Transformed box, empty if <c>box</c> is.
+  */
+  AABB transformAABB(const Quaternion& rotation, const Vector& translation, const AABB& box);
+
+  /** Transform AABB batch, <c>out[i]</c> as transformAABB(m[i], in[i]). Boxes and matrices are
+  * transposed into SIMD registers 8 (AVX) or 4 (SSE) at a time, and large inputs are split
+  * across threads.
+  * @param m Array of <c>size</c> affine transforms.
+  * @param in Array of <c>size</c> boxes.
+  * @param out Array of <c>size</c> boxes to store the result in, may be <c>in</c>.
+  * @param size Number of boxes.
+  */
+  void transformAABBBatch(const Matrix* m, const AABB* in, AABB* out, std::size_t size);
+
+  /** Transform AABB batch, <c>out[i]</c> as transformAABB(rotation[i], translation[i], in[i]).
+  * @param rotation Array of <c>size</c> unit quaternions.
+  * @param translation Array of <c>size</c> translations.
+  * @param in Array of <c>size</c> boxes.
+  * @param out Array of <c>size</c> boxes to store the result in, may be <c>in</c>.
+  * @param size Number of boxes.
+  */
+  void transformAABBBatch(const Quaternion* rotation, const Vector* translation, const AABB* in, AABB* out,
+                          std::size_t size);
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "aabb.inl"
+#endif
+
+#endif // AABB_HPP_INCLUDED
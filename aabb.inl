@@ -0,0 +1,368 @@
+/**
+* @file aabb.inl
+* @author skwo
+* @brief Realization of axis aligned bounding box.
+* @note Included by aabb.cpp, or by aabb.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#include "parallel.hpp"
+#include "profile.hpp"
+#include "simd.hpp"
+
+namespace skmath{
+
+  //Constructor
+  SKMATH_INLINE AABB::AABB()
+    : min(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()),
+      max(-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity())
+  {
+  }
+  SKMATH_INLINE AABB::AABB(const Vector& minCorner, const Vector& maxCorner)
+    : min(minCorner), max(maxCorner)
+  {
+  }
+
+  //Is empty
+  SKMATH_INLINE bool AABB::isEmpty() const
+  {
+    const float* lo = &min[0];
+    const float* hi = &max[0];
+    return hi[0] < lo[0] || hi[1] < lo[1] || hi[2] < lo[2];
+  }
+
+  //Get center
+  SKMATH_INLINE Vector AABB::center() const
+  {
+    return (min + max) * 0.5f;
+  }
+
+  //Get extent
+  SKMATH_INLINE Vector AABB::extent() const
+  {
+    return (max - min) * 0.5f;
+  }
+
+  //Extend
+  //Corners are read through float pointers, as Vector access is out of line in compiled builds
+  SKMATH_INLINE void AABB::extend(const Vector& point)
+  {
+    const float* p = &point[0];
+    float* lo = &min[0];
+    float* hi = &max[0];
+    for(int i = 0; i < 3; i++)
+    {
+      lo[i] = p[i] < lo[i] ? p[i] : lo[i];
+      hi[i] = p[i] > hi[i] ? p[i] : hi[i];
+    }
+  }
+  SKMATH_INLINE void AABB::extend(const AABB& box)
+  {
+    const float* boxLo = &box.min[0];
+    const float* boxHi = &box.max[0];
+    float* lo = &min[0];
+    float* hi = &max[0];
+    for(int i = 0; i < 3; i++)
+    {
+      lo[i] = boxLo[i] < lo[i] ? boxLo[i] : lo[i];
+      hi[i] = boxHi[i] > hi[i] ? boxHi[i] : hi[i];
+    }
+  }
+
+  //Contains
+  SKMATH_INLINE bool AABB::contains(const Vector& point) const
+  {
+    return point[0] >= min[0] && point[0] <= max[0] &&
+           point[1] >= min[1] && point[1] <= max[1] &&
+           point[2] >= min[2] && point[2] <= max[2];
+  }
+
+  //Intersects
+  SKMATH_INLINE bool AABB::intersects(const AABB& box) const
+  {
+    return box.min[0] <= max[0] && box.max[0] >= min[0] &&
+           box.min[1] <= max[1] && box.max[1] >= min[1] &&
+           box.min[2] <= max[2] && box.max[2] >= min[2];
+  }
+
+  namespace detail{
+
+    //Box of the cWidth lanes of min corners lo and max corners hi
+    SKMATH_INLINE AABB laneBounds(const simd::Float* lo, const simd::Float* hi)
+    {
+      alignas(simd::cAlignment) float l[3][simd::cWidth], h[3][simd::cWidth];
+      for(int i = 0; i < 3; i++)
+      {
+        simd::store(l[i], lo[i]);
+        simd::store(h[i], hi[i]);
+      }
+
+      AABB box;
+      for(std::size_t k = 0; k < simd::cWidth; k++)
+        box.extend(AABB(Vector(l[0][k], l[1][k], l[2][k]), Vector(h[0][k], h[1][k], h[2][k])));
+      return box;
+    }
+
+    //Box of points [begin, end) of an array
+    SKMATH_INLINE AABB boundsRange(const Vector* points, std::size_t begin, std::size_t end)
+    {
+      simd::Float lo[3], hi[3], x, y, z;
+      for(int i = 0; i < 3; i++)
+      {
+        lo[i] = simd::set1(std::numeric_limits<float>::infinity());
+        hi[i] = simd::set1(-std::numeric_limits<float>::infinity());
+      }
+
+      std::size_t i = begin;
+      for(; i + simd::cWidth <= end; i += simd::cWidth)
+      {
+        simd::loadVectors(&points[i][0], x, y, z);
+        lo[0] = simd::min(lo[0], x);
+        lo[1] = simd::min(lo[1], y);
+        lo[2] = simd::min(lo[2], z);
+        hi[0] = simd::max(hi[0], x);
+        hi[1] = simd::max(hi[1], y);
+        hi[2] = simd::max(hi[2], z);
+      }
+
+      AABB box = laneBounds(lo, hi);
+      for(; i < end; i++)
+        box.extend(points[i]);
+      return box;
+    }
+
+    //Box of points [begin, end) of a batch, begin a multiple of cWidth
+    SKMATH_INLINE AABB boundsRange(const VectorBatch& points, std::size_t begin, std::size_t end)
+    {
+      simd::Float lo[3], hi[3], x, y, z;
+      for(int i = 0; i < 3; i++)
+      {
+        lo[i] = simd::set1(std::numeric_limits<float>::infinity());
+        hi[i] = simd::set1(-std::numeric_limits<float>::infinity());
+      }
+
+      std::size_t i = begin;
+      for(; i + simd::cWidth <= end; i += simd::cWidth)
+      {
+        x = simd::load(points.x() + i);
+        y = simd::load(points.y() + i);
+        z = simd::load(points.z() + i);
+        lo[0] = simd::min(lo[0], x);
+        lo[1] = simd::min(lo[1], y);
+        lo[2] = simd::min(lo[2], z);
+        hi[0] = simd::max(hi[0], x);
+        hi[1] = simd::max(hi[1], y);
+        hi[2] = simd::max(hi[2], z);
+      }
+
+      AABB box = laneBounds(lo, hi);
+      for(; i < end; i++)
+        box.extend(points.get(i));
+      return box;
+    }
+
+    //Rows of the rotation matrices of rotate(q, p) of cWidth quaternions w, x, y, z, the
+    //transposes of quaternionToMatrix
+    SKMATH_INLINE void rotationRows(simd::Float w, simd::Float x, simd::Float y, simd::Float z, simd::Float r[3][3])
+    {
+      using simd::Float;
+      using simd::add;
+      using simd::sub;
+      using simd::mul;
+
+      //As quaternionToMatrix, 2 (a b) computed as a (2 b)
+      Float x2 = add(x, x), y2 = add(y, y), z2 = add(z, z);
+      Float xx = mul(x, x2), yy = mul(y, y2), zz = mul(z, z2);
+      Float xy = mul(x, y2), xz = mul(x, z2), yz = mul(y, z2);
+      Float wx = mul(w, x2), wy = mul(w, y2), wz = mul(w, z2);
+      Float one = simd::set1(1.0f);
+
+      r[0][0] = sub(one, add(yy, zz));
+      r[0][1] = sub(xy, wz);
+      r[0][2] = add(xz, wy);
+      r[1][0] = add(xy, wz);
+      r[1][1] = sub(one, add(xx, zz));
+      r[1][2] = sub(yz, wx);
+      r[2][0] = sub(xz, wy);
+      r[2][1] = add(yz, wx);
+      r[2][2] = sub(one, add(xx, yy));
+    }
+
+    //Arvo's transform of box by rows r and translation t: the center is transformed, the
+    //extent multiplied by the absolute values of r
+    SKMATH_INLINE AABB transformBox(const float r[3][3], const float* t, const AABB& box)
+    {
+      if(box.isEmpty())
+        return AABB();
+
+      const float* lo = &box.min[0];
+      const float* hi = &box.max[0];
+      const float c[3] = { (lo[0] + hi[0]) * 0.5f, (lo[1] + hi[1]) * 0.5f, (lo[2] + hi[2]) * 0.5f };
+      const float e[3] = { (hi[0] - lo[0]) * 0.5f, (hi[1] - lo[1]) * 0.5f, (hi[2] - lo[2]) * 0.5f };
+
+      AABB result;
+      float* outLo = &result.min[0];
+      float* outHi = &result.max[0];
+      for(int i = 0; i < 3; i++)
+      {
+        float center = r[i][0] * c[0] + r[i][1] * c[1] + r[i][2] * c[2] + t[i];
+        float extent = std::fabs(r[i][0]) * e[0] + std::fabs(r[i][1]) * e[1] + std::fabs(r[i][2]) * e[2];
+        outLo[i] = center - extent;
+        outHi[i] = center + extent;
+      }
+
+      return result;
+    }
+
+    //transformBox of cWidth packed boxes, 6 floats each, into out, which may be in
+    SKMATH_INLINE void transformBoxes(const simd::Float r[3][3], const simd::Float* t, const float* in, float* out)
+    {
+      using simd::Float;
+      using simd::add;
+      using simd::sub;
+      using simd::mul;
+      using simd::madd;
+      using simd::abs;
+      using simd::select;
+
+      //Boxes are 6 floats, so load them as records min x, y, z, max x and min z, max x, y, z
+      Float lx, ly, lz, hx, hy, hz, skipZ, skipX;
+      simd::loadRecords(in, 6, lx, ly, lz, hx);
+      simd::loadRecords(in + 2, 6, skipZ, skipX, hy, hz);
+
+      const Float half = simd::set1(0.5f);
+      const Float c[3] = { mul(add(lx, hx), half), mul(add(ly, hy), half), mul(add(lz, hz), half) };
+      const Float e[3] = { mul(sub(hx, lx), half), mul(sub(hy, ly), half), mul(sub(hz, lz), half) };
+      const Float empty = simd::cmplt(simd::min(simd::min(e[0], e[1]), e[2]), simd::zero());
+      const Float inf = simd::set1(std::numeric_limits<float>::infinity());
+
+      Float lo[3], hi[3];
+      for(int i = 0; i < 3; i++)
+      {
+        Float center = madd(r[i][0], c[0], madd(r[i][1], c[1], madd(r[i][2], c[2], t[i])));
+        Float extent = madd(abs(r[i][0]), e[0], madd(abs(r[i][1]), e[1], mul(abs(r[i][2]), e[2])));
+        lo[i] = select(empty, inf, sub(center, extent));
+        hi[i] = select(empty, simd::neg(inf), add(center, extent));
+      }
+
+      simd::storeRecords(out, 6, lo[0], lo[1], lo[2], hi[0]);
+      simd::storeRecords(out + 2, 6, lo[2], hi[0], hi[1], hi[2]);
+    }
+
+  };
+
+  //Compute AABB
+  SKMATH_INLINE AABB computeAABB(const Vector* points, std::size_t size)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileComputeAABB);
+    AABB box;
+    std::mutex mutex;
+
+    //A box per chunk, merged as the chunks finish
+    parallelFor(size, cParallelGrain, [&](std::size_t begin, std::size_t end) {
+      const AABB chunk = detail::boundsRange(points, begin, end);
+      std::lock_guard<std::mutex> lock(mutex);
+      box.extend(chunk);
+    });
+
+    return box;
+  }
+  SKMATH_INLINE AABB computeAABB(const VectorBatch& points)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileComputeAABB);
+    AABB box;
+    std::mutex mutex;
+
+    //Chunks start at multiples of 16, so the loads stay aligned
+    parallelFor(points.size(), cParallelGrain, [&](std::size_t begin, std::size_t end) {
+      const AABB chunk = detail::boundsRange(points, begin, end);
+      std::lock_guard<std::mutex> lock(mutex);
+      box.extend(chunk);
+    });
+
+    return box;
+  }
+
+  //Transform AABB
+  SKMATH_INLINE AABB transformAABB(const Matrix& m, const AABB& box)
+  {
+    //Column major, translation in the last column
+    const float* p = &m[0];
+    const float r[3][3] = {
+      { p[0], p[4], p[8] },
+      { p[1], p[5], p[9] },
+      { p[2], p[6], p[10] }
+    };
+
+    return detail::transformBox(r, p + 12, box);
+  }
+  SKMATH_INLINE AABB transformAABB(const Quaternion& rotation, const Vector& translation, const AABB& box)
+  {
+    //As detail::rotationRows, one quaternion w, x, y, z
+    const float* q = &rotation.w();
+    const float x2 = q[1] + q[1], y2 = q[2] + q[2], z2 = q[3] + q[3];
+    const float xx = q[1] * x2, yy = q[2] * y2, zz = q[3] * z2;
+    const float xy = q[1] * y2, xz = q[1] * z2, yz = q[2] * z2;
+    const float wx = q[0] * x2, wy = q[0] * y2, wz = q[0] * z2;
+    const float r[3][3] = {
+      { 1.0f - (yy + zz), xy - wz, xz + wy },
+      { xy + wz, 1.0f - (xx + zz), yz - wx },
+      { xz - wy, yz + wx, 1.0f - (xx + yy) }
+    };
+
+    return detail::transformBox(r, &translation[0], box);
+  }
+
+  //Transform AABB batch
+  SKMATH_INLINE void transformAABBBatch(const Matrix* m, const AABB* in, AABB* out, std::size_t size)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileTransformAABBBatch);
+    using simd::cWidth;
+
+    parallelFor(size, cParallelGrain / 8, [&](std::size_t begin, std::size_t end) {
+      simd::Float r[3][3], t[3], skip;
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        //Columns of cWidth matrices
+        simd::loadRecords(&m[i][0], 16, r[0][0], r[1][0], r[2][0], skip);
+        simd::loadRecords(&m[i][4], 16, r[0][1], r[1][1], r[2][1], skip);
+        simd::loadRecords(&m[i][8], 16, r[0][2], r[1][2], r[2][2], skip);
+        simd::loadRecords(&m[i][12], 16, t[0], t[1], t[2], skip);
+
+        detail::transformBoxes(r, t, &in[i].min[0], &out[i].min[0]);
+      }
+
+      for(; i < end; i++)
+        out[i] = transformAABB(m[i], in[i]);
+    });
+  }
+  SKMATH_INLINE void transformAABBBatch(const Quaternion* rotation, const Vector* translation, const AABB* in, AABB* out,
+                                        std::size_t size)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileTransformAABBBatch);
+    using simd::cWidth;
+
+    parallelFor(size, cParallelGrain / 8, [&](std::size_t begin, std::size_t end) {
+      simd::Float r[3][3], t[3], w, x, y, z;
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        simd::loadQuaternions(&rotation[i].w(), w, x, y, z);
+        simd::loadVectors(&translation[i][0], t[0], t[1], t[2]);
+        detail::rotationRows(w, x, y, z, r);
+
+        detail::transformBoxes(r, t, &in[i].min[0], &out[i].min[0]);
+      }
+
+      for(; i < end; i++)
+        out[i] = transformAABB(rotation[i], translation[i], in[i]);
+    });
+  }
+
+};
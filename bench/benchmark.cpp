@@ -0,0 +1,3368 @@
+/**
+* @file benchmark.cpp
+* @author skwo
+* @brief Benchmark of every public operation of Vector, Matrix and Quaternion, plus workloads.
+*
+* The float 3 component Vector, 4x4 Matrix and Quaternion are covered fully; the other shapes
+* (Vector4f/4d, Vector3d, Matrix3f, Matrix4d, Quaterniond) get a latency benchmark of their hot
+* operations.
+*
+* Every operation is measured in two modes:
+* - latency: one operation at a time, each using the result of the previous one. Operations that
+*   return a different type (e.g. Vector::dot) feed their result back with one multiply-add.
+* - throughput: independent operations over arrays of <c>--size</c> elements, large enough to
+*   leave the caches, so memory bandwidth is part of the result.
+*   Benchmarks of the compact formats also report MB/s, of the bytes read and written.
+*
+* On Linux every benchmark also reports the last level cache misses per operation of the
+* calling thread, where the kernel allows perf events.
+*
+* The accuracy mode measures the max error of the fast math approximations (fastmath.hpp),
+* conversions, dual quaternion skinning and compact formats (quantize.hpp) against double precision
+* references and checks it against the documented bounds; a failed check makes the benchmark exit with 1.
+*
+* The workload mode runs whole tasks: pose chains (skeleton world transforms), transform
+* hierarchy updates, point-cloud rotation, skinning a mesh of 1M vertices, saving and loading
+* a pose file and building and querying a k-d tree, reported per joint, node, point, vertex,
+* matrix or query.
+*
+* Built with <c>SKMATH_PROFILE</c>, the benchmark ends with the profile of its library calls
+* (profile.hpp) on standard error.
+*
+* Results are printed as a table, <c>--json=FILE</c> also writes them as JSON for tracking
+* regressions across compilers and flags (<c>--json=-</c> writes to standard output).
+* @code
+* cmake -S . -B build -DSKMATH_NATIVE=ON && cmake --build build
+* build/skmath_benchmark --mode=throughput --filter=Matrix --json=results.json
+* @endcode
+* Options: <c>--mode=latency|throughput|accuracy|workload|all</c>, <c>--filter=TEXT</c> (substring of
+* the name), <c>--size=N</c>, <c>--min-time=MS</c> (per sample), <c>--threads=N</c> (most
+* threads of the thread scaling benchmarks, default the hardware threads), <c>--list</c>.
+*
+* The thread scaling benchmarks run the parallel batch kernels on 1, 2, 4, ... threads and also
+* report the throughput per thread; with linear scaling it stays flat.
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#include "vector.hpp"
+#include "aabb.hpp"
+#include "dualquaternion.hpp"
+#include "frustum.hpp"
+#include "kdtree.hpp"
+#include "matrix.hpp"
+#include "memory.hpp"
+#include "parallel.hpp"
+#include "posefile.hpp"
+#include "quantize.hpp"
+#include "quaternion.hpp"
+#include "simd.hpp"
+#include "skinning.hpp"
+#include "transform.hpp"
+#include "vectorbatch.hpp"
+
+using namespace skmath;
+
+namespace{
+
+  const int cSamples = 5; /**< Samples per benchmark, the fastest is reported. */
+  const int cChain = 256; /**< Operations per latency chain. */
+  const int cJoints = 64; /**< Joints per skeleton in the pose chain workloads. */
+
+  typedef std::chrono::steady_clock Clock;
+
+  struct Options{
+    std::string mode;
+    std::string filter;
+    std::string json;
+    std::size_t size;
+    double minTime; /**< Seconds per sample. */
+    std::size_t threads; /**< Most threads of the thread scaling benchmarks. */
+    bool list;
+  };
+
+  struct Result{
+    std::string name;
+    std::string mode;
+    std::size_t ops;
+    std::size_t iterations;
+    double ns;
+    double checksum;
+    std::size_t threads; /**< Threads of a thread scaling benchmark, otherwise 0. */
+    std::size_t bytes; /**< Bytes read and written per operation of a bandwidth benchmark, otherwise 0. */
+    double misses; /**< Cache misses per operation, negative where not counted. */
+  };
+
+  struct Check{
+    std::string name;
+    std::string unit;
+    double error; /**< Max error measured. */
+    double bound; /**< Max error documented. */
+  };
+
+  struct Statistic{
+    std::string name;
+    std::string mode;
+    std::string unit;
+    double value;
+  };
+
+  /** Last level cache misses of the calling thread, from the Linux perf events; not available
+  * elsewhere, or where the kernel does not allow it.
+  */
+  class MissCounter{
+    public:
+      MissCounter()
+        : _fd(-1)
+      {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+      }
+
+      ~MissCounter()
+      {
+#ifdef __linux__
+        if(_fd >= 0)
+          ::close(_fd);
+#endif
+      }
+
+      //Misses so far, negative if not available
+      long long read() const
+      {
+        long long count = -1;
+#ifdef __linux__
+        if(_fd >= 0 && ::read(_fd, &count, sizeof(count)) != sizeof(count))
+          count = -1;
+#endif
+        return count;
+      }
+
+    private:
+      int _fd;
+  };
+
+  Options gOptions;
+  std::vector<Result> gResults;
+  std::vector<Check> gChecks;
+  std::vector<Statistic> gStatistics;
+  FILE* gOut = stdout; /**< Table output, standard error when JSON goes to standard output. */
+  float gZero; /**< Always 0, read at run time so the compiler can not fold it. */
+  volatile float gZeroSource = 0.0f;
+  volatile double gSink; /**< Results of timed runs end here, so they are not optimized away. */
+
+  //Fold r into x, so the next operation of a latency chain depends on r
+  Vector feed(const Vector& x, float r)
+  {
+    return Vector(x[0] + r * gZero, x[1], x[2]);
+  }
+  Matrix feed(const Matrix& x, float r)
+  {
+    Matrix m(x);
+    m[0] += r * gZero;
+    return m;
+  }
+  Quaternion feed(const Quaternion& x, float r)
+  {
+    Quaternion q(x);
+    q.w() += r * gZero;
+    return q;
+  }
+
+  //Checksums, keep results alive and let runs with different flags be compared
+  double checksum(float f) { return f; }
+  double checksum(const Vector& v) { return double(v[0]) + v[1] + v[2]; }
+  double checksum(const Quaternion& q) { return double(q.w()) + q[0] + q[1] + q[2]; }
+  double checksum(const Matrix& m)
+  {
+    double s = 0.0;
+    for(int i = 0; i < cMatrixSize; i++)
+      s += m[i];
+    return s;
+  }
+  template<typename T, int N>
+  double checksum(const BasicVector<T, N>& v)
+  {
+    double s = 0.0;
+    for(int i = 0; i < N; i++)
+      s += v[i];
+    return s;
+  }
+  template<typename T, int R, int C>
+  double checksum(const BasicMatrix<T, R, C>& m)
+  {
+    double s = 0.0;
+    for(int i = 0; i < R * C; i++)
+      s += m[i];
+    return s;
+  }
+  double checksum(const Quaterniond& q) { return q.w() + q[0] + q[1] + q[2]; }
+  double checksum(const DualQuaternion& q) { return checksum(q.real()) + checksum(q.dual()); }
+
+  //Is benchmark selected by the options
+  bool selected(const char* name, const char* mode)
+  {
+    if(gOptions.mode != "all" && gOptions.mode != mode)
+      return false;
+
+    return gOptions.filter.empty() || strstr(name, gOptions.filter.c_str()) != NULL;
+  }
+
+  //Time func, which does ops operations per call, and record the fastest sample
+  template<typename Func>
+  void measure(const char* name, const char* mode, std::size_t ops, Func func, std::size_t threads = 0, std::size_t bytes = 0)
+  {
+    if(!selected(name, mode))
+      return;
+
+    if(gOptions.list)
+    {
+      fprintf(gOut, "%-48s %s\n", name, mode);
+      return;
+    }
+
+    const double check = func(); //Also warms up caches and pages in the outputs
+    double sum = 0.0;
+
+    auto sample = [&](std::size_t iterations) {
+      Clock::time_point start = Clock::now();
+      for(std::size_t i = 0; i < iterations; i++)
+        sum += func();
+      return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    std::size_t iterations = 1;
+    while(sample(iterations) < gOptions.minTime && iterations < (std::size_t(1) << 30))
+      iterations *= 2;
+
+    static const MissCounter counter;
+    const long long missesBefore = counter.read();
+    double best = sample(iterations);
+    for(int s = 1; s < cSamples; s++)
+      best = std::min(best, sample(iterations));
+    const long long missesAfter = counter.read();
+
+    Result r;
+    r.name = name;
+    r.mode = mode;
+    r.ops = ops;
+    r.iterations = iterations;
+    r.ns = best * 1e9 / (double(iterations) * ops);
+    r.checksum = check;
+    r.threads = threads;
+    r.bytes = bytes;
+    r.misses = missesBefore < 0 || missesAfter < 0 ? -1.0 :
+      double(missesAfter - missesBefore) / (double(cSamples) * double(iterations) * double(ops));
+    gResults.push_back(r);
+    gSink = sum;
+
+    fprintf(gOut, "%-48s %-10s %10.3f ns/op %12.3f Mop/s", name, mode, r.ns, 1e3 / r.ns);
+    if(threads)
+      fprintf(gOut, " %12.3f Mop/s per thread", 1e3 / r.ns / threads);
+    if(bytes)
+      fprintf(gOut, " %12.1f MB/s", 1e3 * bytes / r.ns);
+    if(r.misses >= 0.0)
+      fprintf(gOut, " %10.3f misses/op", r.misses);
+    fprintf(gOut, "\n");
+    fflush(gOut);
+  }
+
+  //Latency. Time a chain of x = func(x), starting from seed
+  template<typename T, typename Func>
+  void latency(const char* name, const T& seed, Func func)
+  {
+    measure(name, "latency", cChain, [&]() {
+      T x = seed;
+      for(int i = 0; i < cChain; i++)
+        x = func(x);
+      return checksum(x);
+    });
+  }
+
+  //Throughput. Time func, which runs one operation over every element of the arrays
+  template<typename Func>
+  void throughput(const char* name, Func func)
+  {
+    measure(name, "throughput", gOptions.size, func);
+  }
+
+  //Bandwidth. Throughput of func, which reads and writes bytes per element of the arrays
+  template<typename Func>
+  void bandwidth(const char* name, std::size_t bytes, Func func)
+  {
+    measure(name, "throughput", gOptions.size, func, 0, bytes);
+  }
+
+  //Workload. Time func, which handles ops joints or points per call
+  template<typename Func>
+  void workload(const char* name, std::size_t ops, Func func)
+  {
+    measure(name, "workload", ops, func);
+  }
+
+  //Thread scaling. Time func, which runs one operation over every element of the arrays, on
+  //1, 2, 4, ... up to --threads threads
+  template<typename Func>
+  void scaling(const char* name, Func func)
+  {
+    for(std::size_t threads = 1; threads <= gOptions.threads; threads *= 2)
+    {
+      if(threads * 2 > gOptions.threads)
+        threads = gOptions.threads;
+
+      char label[64];
+      snprintf(label, sizeof(label), "%s (%zu threads)", name, threads);
+      setParallelThreads(threads);
+      measure(label, "throughput", gOptions.size, func, threads);
+    }
+
+    setParallelThreads(0);
+  }
+
+  //Accuracy. Record func(), the max error of an approximation, against its documented bound
+  template<typename Func>
+  void accuracy(const char* name, const char* unit, double bound, Func func)
+  {
+    if(!selected(name, "accuracy"))
+      return;
+
+    if(gOptions.list)
+    {
+      fprintf(gOut, "%-48s %s\n", name, "accuracy");
+      return;
+    }
+
+    Check c;
+    c.name = name;
+    c.unit = unit;
+    c.error = func();
+    c.bound = bound;
+    gChecks.push_back(c);
+
+    fprintf(gOut, "%-48s %-10s %10.3g %-9s bound %-9g %s\n", name, "accuracy", c.error, unit, bound,
+      c.error <= bound ? "ok" : "FAIL");
+    fflush(gOut);
+  }
+
+  //Statistic. Record value, a measurement other than time such as memory use, with a benchmark of mode
+  void statistic(const char* name, const char* mode, const char* unit, double value)
+  {
+    if(!selected(name, mode))
+      return;
+
+    if(gOptions.list)
+    {
+      fprintf(gOut, "%-48s %s\n", name, mode);
+      return;
+    }
+
+    Statistic s;
+    s.name = name;
+    s.mode = mode;
+    s.unit = unit;
+    s.value = value;
+    gStatistics.push_back(s);
+
+    fprintf(gOut, "%-48s %-10s %10.3f %s\n", name, mode, value, unit);
+    fflush(gOut);
+  }
+
+  //Ulp of the float nearest to x
+  double ulp(double x)
+  {
+    float r = std::fabs(float(x));
+    return double(std::nextafter(r, INFINITY)) - r;
+  }
+
+  //Error of x in ulp of ref
+  double ulps(double x, double ref)
+  {
+    return std::fabs(x - ref) / ulp(ref);
+  }
+
+  //Deterministic pseudo random numbers in [lo, hi)
+  float random(float lo, float hi)
+  {
+    static unsigned int state = 12345u;
+    state = state * 1664525u + 1013904223u;
+    return lo + (hi - lo) * float(state >> 8) / float(1u << 24);
+  }
+
+  Vector randomVector()
+  {
+    return Vector(random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f));
+  }
+
+  Quaternion randomRotation()
+  {
+    Quaternion q;
+    Vector axis = randomVector().normalize();
+    if(axis == Vector(0.0f, 0.0f, 0.0f))
+      axis = Vector(0.0f, 1.0f, 0.0f);
+    q.createRotation(axis, random(-180.0f, 180.0f));
+    return q;
+  }
+
+  //Rigid transform, rotation and translation
+  Matrix randomTransform()
+  {
+    Quaternion q = randomRotation();
+    Matrix m;
+    quaternionToMatrix(q, m);
+    m[12] = random(-10.0f, 10.0f);
+    m[13] = random(-10.0f, 10.0f);
+    m[14] = random(-10.0f, 10.0f);
+    return m;
+  }
+
+  /** Inputs and outputs shared by the throughput benchmarks. */
+  struct Data{
+    explicit Data(std::size_t size)
+      : va(size), vb(size), vout(size), ma(size), mb(size), mout(size),
+        qa(size), qb(size), qout(size), f(size), fout(size)
+    {
+      for(std::size_t i = 0; i < size; i++)
+      {
+        va[i] = randomVector();
+        vb[i] = randomVector();
+        ma[i] = randomTransform();
+        mb[i] = randomTransform();
+        qa[i] = randomRotation();
+        qb[i] = randomRotation();
+        f[i] = random(0.0f, 1.0f);
+      }
+    }
+
+    std::vector<Vector> va, vb, vout;
+    std::vector<Matrix> ma, mb, mout;
+    std::vector<Quaternion> qa, qb, qout;
+    std::vector<float> f, fout;
+  };
+
+  void benchVector(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const Vector a = d.va[0];
+    const Vector b = Vector(0.6f, 0.0f, 0.8f); //Unit, so cross product chains neither grow nor vanish
+    const float s = 1.0000001f;
+
+    latency("Vector::Vector(x, y, z)", a, [&](const Vector& v) { return Vector(v[1], v[2], v[0]); });
+    latency("Vector::norm", a, [&](const Vector& v) { return feed(v, v.norm()); });
+    latency("Vector::magnitude", a, [&](const Vector& v) { return feed(v, v.magnitude()); });
+    latency("Vector::normalize", a, [&](const Vector& v) { return v.normalize(); });
+    latency("Vector::inverse", a, [&](const Vector& v) { return v.inverse(); });
+    latency("Vector::dot", a, [&](const Vector& v) { return feed(v, v.dot(b)); });
+    latency("Vector::operator[]", a, [&](const Vector& v) { return feed(v, v[1]); });
+    latency("Vector::operator==", a, [&](const Vector& v) { return feed(v, float(v == b)); });
+    latency("Vector::operator!=", a, [&](const Vector& v) { return feed(v, float(v != b)); });
+    latency("Vector::operator+", a, [&](const Vector& v) { return v + b; });
+    latency("Vector::operator-", a, [&](const Vector& v) { return v - b; });
+    latency("Vector::operator* (cross)", a, [&](const Vector& v) { return v * b; });
+    latency("Vector::operator* (scalar)", a, [&](const Vector& v) { return v * s; });
+    latency("Vector::operator/", a, [&](const Vector& v) { return v / s; });
+    latency("Vector::operator+=", a, [&](Vector v) { return v += b; });
+    latency("Vector::operator-=", a, [&](Vector v) { return v -= b; });
+    latency("Vector::operator*= (cross)", a, [&](Vector v) { return v *= b; });
+    latency("Vector::operator*= (scalar)", a, [&](Vector v) { return v *= s; });
+    latency("Vector::operator/=", a, [&](Vector v) { return v /= s; });
+
+    throughput("Vector::Vector(x, y, z)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = Vector(d.f[i], d.f[i], d.f[i]);
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::norm", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.va[i].norm();
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Vector::magnitude", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.va[i].magnitude();
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Vector::normalize", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i].normalize();
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::inverse", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i].inverse();
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::dot", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.va[i].dot(d.vb[i]);
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Vector::operator[]", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.va[i][i % 3];
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Vector::operator==", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = float(d.va[i] == d.vb[i]);
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Vector::operator!=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = float(d.va[i] != d.vb[i]);
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Vector::operator+", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i] + d.vb[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::operator-", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i] - d.vb[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::operator* (cross)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i] * d.vb[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::operator* (scalar)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i] * d.f[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::operator/", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i] / s;
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::operator+=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] += d.va[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::operator-=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] -= d.va[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::operator*= (cross)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i];
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] *= d.vb[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::operator*= (scalar)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i];
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] *= d.f[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Vector::operator/=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i];
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] /= s;
+      return checksum(d.vout[n - 1]);
+    });
+  }
+
+  void benchMatrix(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const Matrix a = d.ma[0];
+    const Matrix b = d.mb[0];
+    const Vector v = d.va[0];
+    const float s = 1.0000001f;
+
+    latency("Matrix::Matrix(x, y, z)", a, [&](const Matrix& m) {
+      Vector x(m[5], m[6], m[4]), y(m[9], m[10], m[8]), z(m[1], m[2], m[0]);
+      return Matrix(x, y, z);
+    });
+    latency("Matrix::Matrix(float*)", a, [&](const Matrix& m) {
+      float f[cMatrixSize];
+      for(int i = 0; i < cMatrixSize; i++)
+        f[i] = m[(i + 1) % cMatrixSize];
+      return Matrix(f);
+    });
+    latency("Matrix::createIdentity", a, [&](const Matrix& m) {
+      Matrix r(m);
+      r.createIdentity();
+      return feed(r, m[0]);
+    });
+    latency("Matrix::create(x, y, z)", a, [&](const Matrix& m) {
+      Vector x(m[5], m[6], m[4]), y(m[9], m[10], m[8]), z(m[1], m[2], m[0]);
+      Matrix r;
+      r.create(x, y, z);
+      return r;
+    });
+    latency("Matrix::create(float*)", a, [&](const Matrix& m) {
+      float f[cMatrixSize];
+      for(int i = 0; i < cMatrixSize; i++)
+        f[i] = m[(i + 1) % cMatrixSize];
+      Matrix r;
+      r.create(f);
+      return r;
+    });
+    latency("Matrix::createRotationX", a, [&](const Matrix& m) {
+      Matrix r;
+      r.createRotationX(30.0f + m[0]);
+      return r;
+    });
+    latency("Matrix::createRotationY", a, [&](const Matrix& m) {
+      Matrix r;
+      r.createRotationY(30.0f + m[0]);
+      return r;
+    });
+    latency("Matrix::createRotationZ", a, [&](const Matrix& m) {
+      Matrix r;
+      r.createRotationZ(30.0f + m[0]);
+      return r;
+    });
+    latency("Matrix::get", a, [&](const Matrix& m) {
+      Matrix r(m);
+      float f[cMatrixSize];
+      r.get(f);
+      return feed(m, f[7]);
+    });
+    latency("Matrix::determinant", a, [&](const Matrix& m) { return feed(m, m.determinant()); });
+    latency("Matrix::transpose", a, [&](const Matrix& m) { return m.transpose(); });
+    latency("Matrix::inverse", a, [&](const Matrix& m) { return m.inverse(); });
+    latency("Matrix::inverseAffine", a, [&](const Matrix& m) { return m.inverseAffine(); });
+    latency("Matrix::inverseOrthonormal", a, [&](const Matrix& m) { return m.inverseOrthonormal(); });
+    latency("Matrix::operator[]", a, [&](const Matrix& m) { return feed(m, m[13]); });
+    latency("Matrix::operator==", a, [&](const Matrix& m) { return feed(m, float(m == b)); });
+    latency("Matrix::operator!=", a, [&](const Matrix& m) { return feed(m, float(m != b)); });
+    latency("Matrix::operator+", a, [&](const Matrix& m) { return m + b; });
+    latency("Matrix::operator-", a, [&](const Matrix& m) { return m - b; });
+    latency("Matrix::operator* (Matrix)", a, [&](const Matrix& m) { return m * b; });
+    latency("Matrix::operator* (Vector)", v, [&](const Vector& x) { return a * x; });
+    latency("Matrix::operator* (scalar)", a, [&](const Matrix& m) { return m * s; });
+    latency("Matrix::operator/", a, [&](const Matrix& m) { return m / s; });
+    latency("Matrix::operator+=", a, [&](Matrix m) { return m += b; });
+    latency("Matrix::operator-=", a, [&](Matrix m) { return m -= b; });
+    latency("Matrix::operator*= (Matrix)", a, [&](Matrix m) { return m *= b; });
+    latency("Matrix::operator*= (scalar)", a, [&](Matrix m) { return m *= s; });
+    latency("Matrix::operator/=", a, [&](Matrix m) { return m /= s; });
+    latency("matrixToQuaternion", a, [&](const Matrix& m) {
+      Matrix r(m);
+      Quaternion q;
+      matrixToQuaternion(r, q);
+      return feed(m, q.w());
+    });
+    latency("multiply", a, [&](const Matrix& m) {
+      Matrix r;
+      multiply(m, b, r);
+      return r;
+    });
+
+    throughput("Matrix::Matrix(x, y, z)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+      {
+        Vector x(d.va[i]), y(d.vb[i]), z(d.va[n - 1 - i]);
+        d.mout[i] = Matrix(x, y, z);
+      }
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::Matrix(float*)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+      {
+        float f[cMatrixSize];
+        d.ma[i].get(f);
+        d.mout[i] = Matrix(f);
+      }
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::createIdentity", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i].createIdentity();
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::create(x, y, z)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+      {
+        Vector x(d.va[i]), y(d.vb[i]), z(d.va[n - 1 - i]);
+        d.mout[i].create(x, y, z);
+      }
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::create(float*)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+      {
+        float f[cMatrixSize];
+        d.ma[i].get(f);
+        d.mout[i].create(f);
+      }
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::createRotationX", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i].createRotationX(360.0f * d.f[i]);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::createRotationY", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i].createRotationY(360.0f * d.f[i]);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::createRotationZ", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i].createRotationZ(360.0f * d.f[i]);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::get", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.ma[i].get(&d.mout[i][0]);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::determinant", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.ma[i].determinant();
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Matrix::transpose", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i].transpose();
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::inverse", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i].inverse();
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::inverseAffine", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i].inverseAffine();
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::inverseOrthonormal", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i].inverseOrthonormal();
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator[]", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.ma[i][int(i % cMatrixSize)];
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Matrix::operator==", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = float(d.ma[i] == d.mb[i]);
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Matrix::operator!=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = float(d.ma[i] != d.mb[i]);
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Matrix::operator+", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i] + d.mb[i];
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator-", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i] - d.mb[i];
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator* (Matrix)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i] * d.mb[i];
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator* (Vector)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.ma[i] * d.va[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Matrix::operator* (scalar)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i] * d.f[i];
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator/", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i] / s;
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator+=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] += d.ma[i];
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator-=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] -= d.ma[i];
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator*= (Matrix)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i];
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] *= d.mb[i];
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator*= (scalar)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i];
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] *= d.f[i];
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::operator/=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] = d.ma[i];
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i] /= s;
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("matrixToQuaternion", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        matrixToQuaternion(d.ma[i], d.qout[i]);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("matrixToQuaternionBatch", [&]() {
+      matrixToQuaternionBatch(d.ma.data(), d.qout.data(), n);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("multiply", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        multiply(d.ma[i], d.mb[i], d.mout[i]);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("transformPoints", [&]() {
+      transformPoints(a, d.va.data(), d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("transformPoints (non-temporal)", [&]() {
+      transformPoints(a, d.va.data(), d.vout.data(), n, true);
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("transformDirections", [&]() {
+      transformDirections(a, d.va.data(), d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("transformDirections (non-temporal)", [&]() {
+      transformDirections(a, d.va.data(), d.vout.data(), n, true);
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("determinantBatch", [&]() {
+      determinantBatch(d.ma.data(), d.fout.data(), n);
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("transposeBatch", [&]() {
+      transposeBatch(d.ma.data(), d.mout.data(), n);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("inverseBatch", [&]() {
+      inverseBatch(d.ma.data(), d.mout.data(), n);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("inverseAffineBatch", [&]() {
+      inverseAffineBatch(d.ma.data(), d.mout.data(), n);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("inverseOrthonormalBatch", [&]() {
+      inverseOrthonormalBatch(d.ma.data(), d.mout.data(), n);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("multiplyBatch (pairs)", [&]() {
+      multiplyBatch(d.ma.data(), d.mb.data(), d.mout.data(), n);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("multiplyBatch (one times N)", [&]() {
+      multiplyBatch(a, d.mb.data(), d.mout.data(), n);
+      return checksum(d.mout[n - 1]);
+    });
+  }
+
+  void benchFastMath(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const Vector av = d.va[0];
+    const Quaternion aq = d.qa[0];
+    const Matrix am = d.ma[0];
+    const Vector axis = Vector(0.6f, 0.0f, 0.8f);
+
+    latency("Vector::normalize (Fast)", av, [&](const Vector& v) { return v.normalize(Fast()); });
+    latency("Quaternion::normalize (Fast)", aq, [&](const Quaternion& q) { return q.normalize(Fast()); });
+    latency("Quaternion::createRotation (Fast)", aq, [&](const Quaternion& q) {
+      Quaternion r;
+      r.createRotation(axis, 30.0f + q.w(), Fast());
+      return r;
+    });
+    latency("Matrix::createRotationX (Fast)", am, [&](const Matrix& m) {
+      Matrix r;
+      r.createRotationX(30.0f + m[0], Fast());
+      return r;
+    });
+    latency("sincos (Exact)", 0.5f, [&](float a) {
+      float s, c;
+      sincos(a, s, c, Exact());
+      return s + c * gZero;
+    });
+    latency("sincos (Fast)", 0.5f, [&](float a) {
+      float s, c;
+      sincos(a, s, c, Fast());
+      return s + c * gZero;
+    });
+
+    throughput("Vector::normalize (Fast)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.va[i].normalize(Fast());
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Quaternion::normalize (Fast)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i].normalize(Fast());
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::createRotation (Fast)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i].createRotation(axis, 360.0f * d.f[i], Fast());
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Matrix::createRotationX (Fast)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i].createRotationX(360.0f * d.f[i], Fast());
+      return checksum(d.mout[n - 1]);
+    });
+
+    std::vector<float> s(n), c(n);
+    throughput("sincos (Exact)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        sincos(d.f[i], s[i], c[i], Exact());
+      return checksum(s[n - 1]) + c[n - 1];
+    });
+    throughput("sincosBatch (Fast)", [&]() {
+      sincosBatch(d.f.data(), s.data(), c.data(), n);
+      return checksum(s[n - 1]) + c[n - 1];
+    });
+
+    VectorBatch batch(d.va.data(), n);
+    VectorBatch out(n);
+    throughput("VectorBatch::normalize (Exact)", [&]() {
+      batch.normalize(out, Exact());
+      return checksum(out.get(n - 1));
+    });
+    throughput("VectorBatch::normalize (Fast)", [&]() {
+      batch.normalize(out, Fast());
+      return checksum(out.get(n - 1));
+    });
+
+    //Euler angles, against the product of three single axis rotations
+    std::vector<float> ex(n), ey(n), ez(n);
+    for(std::size_t i = 0; i < n; i++)
+    {
+      ex[i] = 360.0f * d.f[i];
+      ey[i] = 360.0f * d.f[(i + 1) % n];
+      ez[i] = 360.0f * d.f[(i + 2) % n];
+    }
+
+    latency("Matrix::createRotationX/Y/Z product", am, [&](const Matrix& m) {
+      Matrix x, y, z;
+      x.createRotationX(30.0f + m[0]);
+      y.createRotationY(20.0f);
+      z.createRotationZ(10.0f);
+      return z * y * x;
+    });
+    latency("Matrix::createFromEuler", am, [&](const Matrix& m) {
+      Matrix r;
+      r.createFromEuler(30.0f + m[0], 20.0f, 10.0f);
+      return r;
+    });
+    latency("Quaternion::createFromEuler", aq, [&](const Quaternion& q) {
+      Quaternion r;
+      r.createFromEuler(30.0f + q.w(), 20.0f, 10.0f);
+      return r;
+    });
+
+    throughput("Matrix::createRotationX/Y/Z product", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+      {
+        Matrix x, y, z;
+        x.createRotationX(ex[i]);
+        y.createRotationY(ey[i]);
+        z.createRotationZ(ez[i]);
+        d.mout[i] = z * y * x;
+      }
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::createFromEuler", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i].createFromEuler(ex[i], ey[i], ez[i]);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("fromEulerBatch (Matrix)", [&]() {
+      fromEulerBatch(ex.data(), ey.data(), ez.data(), d.mout.data(), n);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Quaternion::createFromEuler", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i].createFromEuler(ex[i], ey[i], ez[i]);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("fromEulerBatch (Quaternion)", [&]() {
+      fromEulerBatch(ex.data(), ey.data(), ez.data(), d.qout.data(), n);
+      return checksum(d.qout[n - 1]);
+    });
+  }
+
+  //Max error of fast normalized components, in ulp of the largest one
+  template<typename V>
+  double normalizeError(const V& v, const V& fast, int size)
+  {
+    double norm = 0.0, largest = 0.0, e = 0.0;
+    for(int k = 0; k < size; k++)
+      norm += double(v[k]) * v[k];
+    norm = std::sqrt(norm);
+
+    for(int k = 0; k < size; k++)
+      largest = std::max(largest, std::fabs(v[k] / norm));
+    for(int k = 0; k < size; k++)
+      e = std::max(e, std::fabs(fast[k] - v[k] / norm) / ulp(largest));
+
+    return e;
+  }
+
+  void checkFastMath()
+  {
+    const int cVectors = 1 << 20;
+    const int cAngles = 1 << 22;
+
+    //Vectors of every magnitude from 2^-40 to 2^40
+    std::vector<Vector> vectors(cVectors);
+    std::vector<Quaternion> quaternions(cVectors);
+    for(int i = 0; i < cVectors; i++)
+    {
+      float scale = std::ldexp(1.0f, int(random(-40.0f, 40.0f)));
+      vectors[i] = randomVector() * scale;
+      quaternions[i] = Quaternion(random(-1.0f, 1.0f) * scale, randomVector() * scale);
+    }
+
+    std::vector<float> small(cAngles), large(cAngles), s(cAngles), c(cAngles);
+    for(int i = 0; i < cAngles; i++)
+    {
+      small[i] = float(-M_PI + 2.0 * M_PI * i / cAngles);
+      large[i] = float(-8192.0 + 16384.0 * i / cAngles);
+    }
+
+    accuracy("rsqrt (Fast)", "ulp", cFastRsqrtUlp, [&]() {
+      //Every float in [1, 4), the estimate depends only on the mantissa and exponent parity
+      double e = 0.0;
+      for(float x = 1.0f; x < 4.0f; x = std::nextafter(x, 4.0f))
+        e = std::max(e, ulps(rsqrt(x, Fast()), 1.0 / std::sqrt(double(x))));
+      return e;
+    });
+    accuracy("simd::rsqrt (Fast)", "ulp", cFastRsqrtUlp, [&]() {
+      double e = 0.0;
+      float x = 1.0f;
+      while(x < 4.0f)
+      {
+        float in[simd::cWidth], out[simd::cWidth];
+        for(std::size_t k = 0; k < simd::cWidth; k++, x = std::nextafter(x, 4.0f))
+          in[k] = x;
+        simd::storeu(out, simd::rsqrt(simd::loadu(in), Fast()));
+        for(std::size_t k = 0; k < simd::cWidth; k++)
+          e = std::max(e, ulps(out[k], 1.0 / std::sqrt(double(in[k]))));
+      }
+      return e;
+    });
+    accuracy("sincos (Fast), |a| <= pi", "ulp", cFastSinCosUlp, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cAngles; i++)
+      {
+        float sa, ca;
+        sincos(small[i], sa, ca, Fast());
+        e = std::max(e, std::max(ulps(sa, std::sin(double(small[i]))), ulps(ca, std::cos(double(small[i])))));
+      }
+      return e;
+    });
+    accuracy("sincosBatch (Fast), |a| <= pi", "ulp", cFastSinCosUlp, [&]() {
+      double e = 0.0;
+      sincosBatch(small.data(), s.data(), c.data(), cAngles);
+      for(int i = 0; i < cAngles; i++)
+        e = std::max(e, std::max(ulps(s[i], std::sin(double(small[i]))), ulps(c[i], std::cos(double(small[i])))));
+      return e;
+    });
+    accuracy("sincos (Fast), |a| <= 8192", "absolute", cFastSinCosError, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cAngles; i++)
+      {
+        float sa, ca;
+        sincos(large[i], sa, ca, Fast());
+        e = std::max(e, std::max(std::fabs(sa - std::sin(double(large[i]))), std::fabs(ca - std::cos(double(large[i])))));
+      }
+      return e;
+    });
+    accuracy("sincosBatch (Fast), |a| <= 8192", "absolute", cFastSinCosError, [&]() {
+      double e = 0.0;
+      sincosBatch(large.data(), s.data(), c.data(), cAngles);
+      for(int i = 0; i < cAngles; i++)
+        e = std::max(e, std::max(std::fabs(s[i] - std::sin(double(large[i]))), std::fabs(c[i] - std::cos(double(large[i])))));
+      return e;
+    });
+    accuracy("Matrix::createRotationX (Fast)", "absolute", cFastSinCosError, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cVectors; i++)
+      {
+        float angle = random(-720.0f, 720.0f);
+        double a = double(angle * cAngToRad);
+        Matrix m;
+        m.createRotationX(angle, Fast());
+        e = std::max(e, std::max(std::fabs(m(2, 1) - std::sin(a)), std::fabs(m(1, 1) - std::cos(a))));
+      }
+      return e;
+    });
+    accuracy("Quaternion::createRotation (Fast)", "absolute", cFastSinCosError, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cVectors; i++)
+      {
+        Vector axis = randomVector().normalize();
+        float angle = random(-720.0f, 720.0f);
+        double a = double(angle * cAngToRad / 2.0f);
+        Quaternion q;
+        q.createRotation(axis, angle, Fast());
+        e = std::max(e, std::fabs(q.w() - std::cos(a)));
+        for(int k = 0; k < 3; k++)
+          e = std::max(e, std::fabs(q[k] - axis[k] * std::sin(a)));
+      }
+      return e;
+    });
+    accuracy("fromEulerBatch (Matrix), |a| <= 8192", "absolute", cFastEulerError, [&]() {
+      //Every order, against double precision createFromEuler
+      const EulerOrder orders[] = {cEulerXYZ, cEulerXZY, cEulerYXZ, cEulerYZX, cEulerZXY, cEulerZYX};
+      const int cRotations = 1 << 16;
+      std::vector<float> x(cRotations), y(cRotations), z(cRotations);
+      std::vector<Matrix> m(cRotations);
+      double e = 0.0;
+      for(EulerOrder order : orders)
+      {
+        for(int i = 0; i < cRotations; i++)
+        {
+          x[i] = random(-8192.0f, 8192.0f);
+          y[i] = random(-8192.0f, 8192.0f);
+          z[i] = random(-8192.0f, 8192.0f);
+        }
+        fromEulerBatch(x.data(), y.data(), z.data(), m.data(), cRotations, order, cRadians);
+        for(int i = 0; i < cRotations; i++)
+        {
+          Matrix3d r;
+          r.createFromEuler(x[i], y[i], z[i], order, cRadians);
+          for(int row = 0; row < 3; row++)
+            for(int col = 0; col < 3; col++)
+              e = std::max(e, std::fabs(m[i](row, col) - r(row, col)));
+        }
+      }
+      return e;
+    });
+    accuracy("fromEulerBatch (Quaternion), |a| <= 8192", "absolute", cFastEulerError, [&]() {
+      const EulerOrder orders[] = {cEulerXYZ, cEulerXZY, cEulerYXZ, cEulerYZX, cEulerZXY, cEulerZYX};
+      const int cRotations = 1 << 16;
+      std::vector<float> x(cRotations), y(cRotations), z(cRotations);
+      std::vector<Quaternion> q(cRotations);
+      double e = 0.0;
+      for(EulerOrder order : orders)
+      {
+        for(int i = 0; i < cRotations; i++)
+        {
+          x[i] = random(-8192.0f, 8192.0f);
+          y[i] = random(-8192.0f, 8192.0f);
+          z[i] = random(-8192.0f, 8192.0f);
+        }
+        fromEulerBatch(x.data(), y.data(), z.data(), q.data(), cRotations, order, cRadians);
+        for(int i = 0; i < cRotations; i++)
+        {
+          Quaterniond r;
+          r.createFromEuler(x[i], y[i], z[i], order, cRadians);
+          for(int k = 0; k < 4; k++)
+            e = std::max(e, std::fabs(q[i][k] - r[k]));
+        }
+      }
+      return e;
+    });
+    accuracy("Vector::normalize (Fast)", "ulp", cFastNormalizeUlp, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cVectors; i++)
+        e = std::max(e, normalizeError(vectors[i], vectors[i].normalize(Fast()), 3));
+      return e;
+    });
+    accuracy("VectorBatch::normalize (Fast)", "ulp", cFastNormalizeUlp, [&]() {
+      double e = 0.0;
+      VectorBatch batch(vectors.data(), cVectors);
+      batch.normalize(batch, Fast());
+      for(int i = 0; i < cVectors; i++)
+        e = std::max(e, normalizeError(vectors[i], batch.get(i), 3));
+      return e;
+    });
+    accuracy("Quaternion::normalize (Fast)", "ulp", cFastNormalizeUlp, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cVectors; i++)
+      {
+        const Quaternion& q = quaternions[i];
+        Quaternion f = q.normalize(Fast());
+        double v[4] = {q[0], q[1], q[2], q.w()}, r[4] = {f[0], f[1], f[2], f.w()};
+        e = std::max(e, normalizeError(v, r, 4));
+      }
+      return e;
+    });
+  }
+
+  //Error of q against ref, up to the sign of the whole quaternion
+  double quaternionError(const Quaternion& q, const Quaternion& ref)
+  {
+    double plus = 0.0, minus = 0.0;
+    for(int k = 0; k < 4; k++)
+    {
+      plus = std::max(plus, double(std::fabs(q[k] - ref[k])));
+      minus = std::max(minus, double(std::fabs(q[k] + ref[k])));
+    }
+    return std::min(plus, minus);
+  }
+
+  void checkConversions()
+  {
+    //Round trip quaternionToMatrix and back, 4 float roundings of unit values
+    const double cRoundTripError = 4.0 * FLT_EPSILON;
+    const int cRotations = 1 << 16;
+    const char* names[4][2] = {
+      {"matrixToQuaternion, x largest", "matrixToQuaternionBatch, x largest"},
+      {"matrixToQuaternion, y largest", "matrixToQuaternionBatch, y largest"},
+      {"matrixToQuaternion, z largest", "matrixToQuaternionBatch, z largest"},
+      {"matrixToQuaternion, w largest", "matrixToQuaternionBatch, w largest"}
+    };
+
+    std::vector<Quaternion> ref(cRotations), q(cRotations);
+    std::vector<Matrix> m(cRotations);
+
+    //One diagonal dominant case each: component k largest, the rest in (-1, 1). Every eighth
+    //rotation is about an axis, so the 180 degree ones with a trace of -1 are included.
+    for(int k = 0; k < 4; k++)
+    {
+      for(int i = 0; i < cRotations; i++)
+      {
+        float c[4];
+        for(int j = 0; j < 4; j++)
+          c[j] = i % 8 == 0 ? 0.0f : random(-1.0f, 1.0f);
+        c[k] = random(0.0f, 1.0f) < 0.5f ? -1.0f : 1.0f;
+        if(i % 16 == 8)
+          c[(k + 1) % 4] = c[k] * random(0.0f, 1.0f);
+
+        ref[i] = Quaternion(c[3], Vector(c[0], c[1], c[2])).normalize();
+        quaternionToMatrix(ref[i], m[i]);
+      }
+
+      accuracy(names[k][0], "absolute", cRoundTripError, [&]() {
+        double e = 0.0;
+        for(int i = 0; i < cRotations; i++)
+        {
+          Quaternion r;
+          matrixToQuaternion(m[i], r);
+          e = std::max(e, quaternionError(r, ref[i]));
+        }
+        return e;
+      });
+      accuracy(names[k][1], "absolute", cRoundTripError, [&]() {
+        double e = 0.0;
+        matrixToQuaternionBatch(m.data(), q.data(), cRotations);
+        for(int i = 0; i < cRotations; i++)
+          e = std::max(e, quaternionError(q[i], ref[i]));
+        return e;
+      });
+    }
+  }
+
+  //Compact formats against copies of the raw layouts, bytes read and written per element
+  void benchQuantize(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const Vector min(-1.0f, -1.0f, -1.0f), max(1.0f, 1.0f, 1.0f);
+
+    std::vector<PackedQuaternion32> q32(n);
+    std::vector<PackedQuaternion48> q48(n);
+    std::vector<HalfVector> half(n);
+    std::vector<FixedVector> fixed(n);
+    std::vector<OctNormal> oct(n);
+    std::vector<Vector> normals(n);
+    for(std::size_t i = 0; i < n; i++)
+      normals[i] = d.va[i].normalize();
+
+    encodeBatch(d.qa.data(), q32.data(), n);
+    encodeBatch(d.qa.data(), q48.data(), n);
+    encodeBatch(d.va.data(), half.data(), n);
+    encodeBatch(d.va.data(), min, max, fixed.data(), n);
+    encodeBatch(normals.data(), oct.data(), n);
+
+    bandwidth("Quaternion copy", 2 * sizeof(Quaternion), [&]() {
+      memcpy(d.qout.data(), d.qa.data(), n * sizeof(Quaternion));
+      return checksum(d.qout[n - 1]);
+    });
+    bandwidth("Vector copy", 2 * sizeof(Vector), [&]() {
+      memcpy(d.vout.data(), d.va.data(), n * sizeof(Vector));
+      return checksum(d.vout[n - 1]);
+    });
+    bandwidth("encode (PackedQuaternion32)", sizeof(Quaternion) + sizeof(PackedQuaternion32), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        encode(d.qa[i], q32[i]);
+      return double(q32[n - 1].bits);
+    });
+    bandwidth("encodeBatch (PackedQuaternion32)", sizeof(Quaternion) + sizeof(PackedQuaternion32), [&]() {
+      encodeBatch(d.qa.data(), q32.data(), n);
+      return double(q32[n - 1].bits);
+    });
+    bandwidth("decode (PackedQuaternion32)", sizeof(Quaternion) + sizeof(PackedQuaternion32), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        decode(q32[i], d.qout[i]);
+      return checksum(d.qout[n - 1]);
+    });
+    bandwidth("decodeBatch (PackedQuaternion32)", sizeof(Quaternion) + sizeof(PackedQuaternion32), [&]() {
+      decodeBatch(q32.data(), d.qout.data(), n);
+      return checksum(d.qout[n - 1]);
+    });
+    bandwidth("encode (PackedQuaternion48)", sizeof(Quaternion) + sizeof(PackedQuaternion48), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        encode(d.qa[i], q48[i]);
+      return double(q48[n - 1].bits[2]);
+    });
+    bandwidth("encodeBatch (PackedQuaternion48)", sizeof(Quaternion) + sizeof(PackedQuaternion48), [&]() {
+      encodeBatch(d.qa.data(), q48.data(), n);
+      return double(q48[n - 1].bits[2]);
+    });
+    bandwidth("decode (PackedQuaternion48)", sizeof(Quaternion) + sizeof(PackedQuaternion48), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        decode(q48[i], d.qout[i]);
+      return checksum(d.qout[n - 1]);
+    });
+    bandwidth("decodeBatch (PackedQuaternion48)", sizeof(Quaternion) + sizeof(PackedQuaternion48), [&]() {
+      decodeBatch(q48.data(), d.qout.data(), n);
+      return checksum(d.qout[n - 1]);
+    });
+    bandwidth("encode (HalfVector)", sizeof(Vector) + sizeof(HalfVector), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        encode(d.va[i], half[i]);
+      return double(half[n - 1].v[0]);
+    });
+    bandwidth("encodeBatch (HalfVector)", sizeof(Vector) + sizeof(HalfVector), [&]() {
+      encodeBatch(d.va.data(), half.data(), n);
+      return double(half[n - 1].v[0]);
+    });
+    bandwidth("decode (HalfVector)", sizeof(Vector) + sizeof(HalfVector), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        decode(half[i], d.vout[i]);
+      return checksum(d.vout[n - 1]);
+    });
+    bandwidth("decodeBatch (HalfVector)", sizeof(Vector) + sizeof(HalfVector), [&]() {
+      decodeBatch(half.data(), d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+    bandwidth("encode (FixedVector)", sizeof(Vector) + sizeof(FixedVector), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        encode(d.va[i], min, max, fixed[i]);
+      return double(fixed[n - 1].v[0]);
+    });
+    bandwidth("encodeBatch (FixedVector)", sizeof(Vector) + sizeof(FixedVector), [&]() {
+      encodeBatch(d.va.data(), min, max, fixed.data(), n);
+      return double(fixed[n - 1].v[0]);
+    });
+    bandwidth("decode (FixedVector)", sizeof(Vector) + sizeof(FixedVector), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        decode(fixed[i], min, max, d.vout[i]);
+      return checksum(d.vout[n - 1]);
+    });
+    bandwidth("decodeBatch (FixedVector)", sizeof(Vector) + sizeof(FixedVector), [&]() {
+      decodeBatch(fixed.data(), min, max, d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+    bandwidth("encode (OctNormal)", sizeof(Vector) + sizeof(OctNormal), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        encode(normals[i], oct[i]);
+      return double(oct[n - 1].v[0]);
+    });
+    bandwidth("encodeBatch (OctNormal)", sizeof(Vector) + sizeof(OctNormal), [&]() {
+      encodeBatch(normals.data(), oct.data(), n);
+      return double(oct[n - 1].v[0]);
+    });
+    bandwidth("decode (OctNormal)", sizeof(Vector) + sizeof(OctNormal), [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        decode(oct[i], d.vout[i]);
+      return checksum(d.vout[n - 1]);
+    });
+    bandwidth("decodeBatch (OctNormal)", sizeof(Vector) + sizeof(OctNormal), [&]() {
+      decodeBatch(oct.data(), d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+  }
+
+  //Angle between a and b in radians
+  double angle(const Vector& a, const Vector& b)
+  {
+    const double x[3] = {a[0], a[1], a[2]}, y[3] = {b[0], b[1], b[2]};
+    const double c[3] = {x[1] * y[2] - x[2] * y[1], x[2] * y[0] - x[0] * y[2], x[0] * y[1] - x[1] * y[0]};
+    return std::atan2(std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]), x[0] * y[0] + x[1] * y[1] + x[2] * y[2]);
+  }
+
+  void checkQuantize()
+  {
+    //Not a multiple of the SIMD width, so the batch tails are checked too
+    const int cElements = (1 << 16) + 3;
+
+    //Unit quaternions, every eighth with equal largest components or on an axis
+    std::vector<Quaternion> quaternions(cElements), q(cElements);
+    for(int i = 0; i < cElements; i++)
+    {
+      float c[4];
+      for(int j = 0; j < 4; j++)
+        c[j] = random(-1.0f, 1.0f);
+      if(i % 8 == 0)
+        c[i / 8 % 4] = c[(i / 8 + 1) % 4] = (i / 32 % 2 ? -0.5f : 0.5f);
+      if(i % 8 == 4)
+        c[0] = c[1] = c[2] = c[3] = 0.0f, c[i / 8 % 4] = i / 32 % 2 ? -1.0f : 1.0f;
+      quaternions[i] = Quaternion(c[3], Vector(c[0], c[1], c[2])).normalize();
+    }
+
+    std::vector<PackedQuaternion32> q32(cElements);
+    std::vector<PackedQuaternion48> q48(cElements);
+    accuracy("decode (PackedQuaternion32)", "absolute", cPackedQuaternion32Error, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+      {
+        encode(quaternions[i], q32[i]);
+        decode(q32[i], q[i]);
+        e = std::max(e, quaternionError(q[i], quaternions[i]));
+      }
+      return e;
+    });
+    accuracy("decodeBatch (PackedQuaternion32)", "absolute", cPackedQuaternion32Error, [&]() {
+      double e = 0.0;
+      encodeBatch(quaternions.data(), q32.data(), cElements);
+      decodeBatch(q32.data(), q.data(), cElements);
+      for(int i = 0; i < cElements; i++)
+        e = std::max(e, quaternionError(q[i], quaternions[i]));
+      return e;
+    });
+    accuracy("decode (PackedQuaternion48)", "absolute", cPackedQuaternion48Error, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+      {
+        encode(quaternions[i], q48[i]);
+        decode(q48[i], q[i]);
+        e = std::max(e, quaternionError(q[i], quaternions[i]));
+      }
+      return e;
+    });
+    accuracy("decodeBatch (PackedQuaternion48)", "absolute", cPackedQuaternion48Error, [&]() {
+      double e = 0.0;
+      encodeBatch(quaternions.data(), q48.data(), cElements);
+      decodeBatch(q48.data(), q.data(), cElements);
+      for(int i = 0; i < cElements; i++)
+        e = std::max(e, quaternionError(q[i], quaternions[i]));
+      return e;
+    });
+
+    //Magnitudes over the whole normal range of half floats
+    std::vector<Vector> vectors(cElements), v(cElements);
+    std::vector<HalfVector> half(cElements);
+    for(int i = 0; i < cElements; i++)
+    {
+      float c[3];
+      for(int k = 0; k < 3; k++)
+        c[k] = std::min(std::exp2(random(-14.0f, 16.0f)), 65504.0f) * (random(0.0f, 1.0f) < 0.5f ? -1.0f : 1.0f);
+      vectors[i] = Vector(c[0], c[1], c[2]);
+    }
+
+    auto relative = [&](const std::vector<Vector>& r) {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+        for(int k = 0; k < 3; k++)
+          e = std::max(e, std::fabs(double(r[i][k]) - vectors[i][k]) / std::fabs(vectors[i][k]));
+      return e;
+    };
+    accuracy("decode (HalfVector)", "relative", cHalfVectorError, [&]() {
+      for(int i = 0; i < cElements; i++)
+      {
+        encode(vectors[i], half[i]);
+        decode(half[i], v[i]);
+      }
+      return relative(v);
+    });
+    accuracy("decodeBatch (HalfVector)", "relative", cHalfVectorError, [&]() {
+      encodeBatch(vectors.data(), half.data(), cElements);
+      decodeBatch(half.data(), v.data(), cElements);
+      return relative(v);
+    });
+
+    //Points in a box of a different extent and offset along each axis
+    const Vector min(-10.0f, -2.0f, 0.0f), max(10.0f, 30.0f, 0.5f);
+    std::vector<FixedVector> fixed(cElements);
+    for(int i = 0; i < cElements; i++)
+      vectors[i] = Vector(random(min[0], max[0]), random(min[1], max[1]), random(min[2], max[2]));
+
+    auto extent = [&](const std::vector<Vector>& r) {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+        for(int k = 0; k < 3; k++)
+          e = std::max(e, std::fabs(double(r[i][k]) - vectors[i][k]) / (double(max[k]) - min[k]));
+      return e;
+    };
+    accuracy("decode (FixedVector)", "of extent", cFixedVectorError, [&]() {
+      for(int i = 0; i < cElements; i++)
+      {
+        encode(vectors[i], min, max, fixed[i]);
+        decode(fixed[i], min, max, v[i]);
+      }
+      return extent(v);
+    });
+    accuracy("decodeBatch (FixedVector)", "of extent", cFixedVectorError, [&]() {
+      encodeBatch(vectors.data(), min, max, fixed.data(), cElements);
+      decodeBatch(fixed.data(), min, max, v.data(), cElements);
+      return extent(v);
+    });
+
+    //Unit vectors, every eighth on an axis or a diagonal where the octahedron folds
+    std::vector<OctNormal> oct(cElements);
+    for(int i = 0; i < cElements; i++)
+    {
+      Vector r = randomVector();
+      if(i % 8 == 0)
+        r = Vector(float(i / 8 % 3 == 0), float(i / 8 % 3 == 1), i / 8 % 3 == 2 ? -1.0f : 0.0f);
+      if(i % 8 == 4)
+        r = Vector(r[0], r[0], -std::fabs(r[2]));
+      if(r == Vector(0.0f, 0.0f, 0.0f))
+        r = Vector(0.0f, 0.0f, 1.0f);
+      vectors[i] = r.normalize();
+    }
+
+    auto angles = [&](const std::vector<Vector>& r) {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+        e = std::max(e, angle(r[i], vectors[i]));
+      return e;
+    };
+    accuracy("decode (OctNormal)", "radians", cOctNormalError, [&]() {
+      for(int i = 0; i < cElements; i++)
+      {
+        encode(vectors[i], oct[i]);
+        decode(oct[i], v[i]);
+      }
+      return angles(v);
+    });
+    accuracy("decodeBatch (OctNormal)", "radians", cOctNormalError, [&]() {
+      encodeBatch(vectors.data(), oct.data(), cElements);
+      decodeBatch(oct.data(), v.data(), cElements);
+      return angles(v);
+    });
+  }
+
+  //Palette of cJoints bones, as dual quaternions and the same transforms as matrices, and
+  //influences per vertex, every fourth vertex with only two of them
+  struct SkinData{
+    SkinData(std::size_t size, int count = cSkinInfluences)
+      : bones(cJoints), palette(cJoints), indices(count * size), weights(count * size), influences(count)
+    {
+      for(int j = 0; j < cJoints; j++)
+      {
+        bones[j] = DualQuaternion(randomRotation(), randomVector() * 10.0f);
+        dualQuaternionToMatrix(bones[j], palette[j]);
+      }
+
+      for(std::size_t i = 0; i < size; i++)
+      {
+        float sum = 0.0f;
+        for(int k = 0; k < influences; k++)
+        {
+          indices[influences * i + k] = std::uint16_t(random(0.0f, float(cJoints)));
+          weights[influences * i + k] = i % 4 == 0 && k >= 2 ? 0.0f : random(0.05f, 1.0f);
+          sum += weights[influences * i + k];
+        }
+        for(int k = 0; k < influences; k++)
+          weights[influences * i + k] /= sum;
+      }
+    }
+
+    std::vector<DualQuaternion> bones;
+    std::vector<Matrix> palette;
+    std::vector<std::uint16_t> indices;
+    std::vector<float> weights;
+    int influences;
+  };
+
+  //Skin vertex i one dual quaternion operation at a time
+  void skinVertex(const SkinData& s, std::size_t i, const Vector& position, const Vector& normal,
+                  Vector& outPosition, Vector& outNormal)
+  {
+    const std::uint16_t* index = &s.indices[cSkinInfluences * i];
+    const float* weight = &s.weights[cSkinInfluences * i];
+    const DualQuaternion& first = s.bones[index[0]];
+
+    DualQuaternion b = first * weight[0];
+    for(int k = 1; k < cSkinInfluences; k++)
+    {
+      const DualQuaternion& bone = s.bones[index[k]];
+      b += bone * (bone.real().inner(first.real()) < 0.0f ? -weight[k] : weight[k]);
+    }
+
+    b = b.normalize();
+    outPosition = b.transformPoint(position);
+    outNormal = b.transformVector(normal);
+  }
+
+  //Dual quaternion of doubles from one of floats
+  DualQuaterniond toDouble(const DualQuaternion& q)
+  {
+    const Quaternion& r = q.real();
+    const Quaternion& d = q.dual();
+    return DualQuaterniond(Quaterniond(r.w(), Vector3d(r[0], r[1], r[2])), Quaterniond(d.w(), Vector3d(d[0], d[1], d[2])));
+  }
+
+  //Max absolute difference of a and ref
+  double vectorError(const Vector& a, const Vector3d& ref)
+  {
+    double e = 0.0;
+    for(int k = 0; k < 3; k++)
+      e = std::max(e, std::fabs(a[k] - ref[k]));
+    return e;
+  }
+
+  void checkDualQuaternion()
+  {
+    //Not a multiple of the SIMD width, so the batch tails are checked too. Translations and
+    //points up to 10 along each axis, so results are up to about 27 and a float rounding of them
+    //2 ^ -19; a handful of them.
+    const int cElements = (1 << 16) + 3;
+    const double cTransformError = 16.0 * std::ldexp(1.0, -19);
+
+    std::vector<DualQuaternion> dq(cElements);
+    std::vector<Vector> points(cElements), p(cElements), normals(cElements), n(cElements);
+    for(int i = 0; i < cElements; i++)
+    {
+      dq[i] = DualQuaternion(randomRotation(), randomVector() * 10.0f);
+      points[i] = randomVector() * 10.0f;
+      normals[i] = randomVector().normalize();
+    }
+
+    accuracy("DualQuaternion::transformPoint", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+      {
+        const Vector3d x(points[i][0], points[i][1], points[i][2]);
+        e = std::max(e, vectorError(dq[i].transformPoint(points[i]), toDouble(dq[i]).transformPoint(x)));
+      }
+      return e;
+    });
+    accuracy("DualQuaternion::inverse", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+      {
+        const Vector r = dq[i].inverse().transformPoint(dq[i].transformPoint(points[i]));
+        e = std::max(e, vectorError(r, Vector3d(points[i][0], points[i][1], points[i][2])));
+      }
+      return e;
+    });
+    accuracy("dualQuaternionToMatrix", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+      {
+        Matrix m;
+        Vector r;
+        dualQuaternionToMatrix(dq[i], m);
+        transformPoints(m, &points[i], &r, 1);
+        e = std::max(e, vectorError(r, toDouble(dq[i]).transformPoint(Vector3d(points[i][0], points[i][1], points[i][2]))));
+      }
+      return e;
+    });
+    accuracy("matrixToDualQuaternion", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+      {
+        const Matrix m = randomTransform();
+        DualQuaternion q;
+        Vector r;
+        matrixToDualQuaternion(m, q);
+        transformPoints(m, &points[i], &r, 1);
+        e = std::max(e, vectorError(q.transformPoint(points[i]), Vector3d(r[0], r[1], r[2])));
+      }
+      return e;
+    });
+    accuracy("dualQuaternionToMatrixBatch", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      std::vector<float> rows(12 * cElements), columns(12 * cElements);
+      dualQuaternionToMatrixBatch(dq.data(), rows.data(), cElements);
+      dualQuaternionToMatrixBatch(dq.data(), columns.data(), cElements, cColumnMajor);
+      for(int i = 0; i < cElements; i++)
+      {
+        Matrix m;
+        dualQuaternionToMatrix(dq[i], m);
+        for(int r = 0; r < 3; r++)
+          for(int c = 0; c < 4; c++)
+          {
+            e = std::max(e, std::fabs(double(rows[12 * i + 4 * r + c]) - m(r, c)));
+            e = std::max(e, std::fabs(double(columns[12 * i + 3 * c + r]) - m(r, c)));
+          }
+      }
+      return e;
+    });
+    accuracy("quaternionToMatrixBatch vs dual quaternions", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      std::vector<Quaternion> rotations(cElements);
+      std::vector<Vector> translations(cElements);
+      std::vector<float> a(12 * cElements), b(12 * cElements);
+      for(int i = 0; i < cElements; i++)
+      {
+        rotations[i] = dq[i].real();
+        translations[i] = dq[i].translation();
+      }
+      quaternionToMatrixBatch(rotations.data(), a.data(), cElements, cRowMajor, translations.data());
+      dualQuaternionToMatrixBatch(dq.data(), b.data(), cElements);
+      for(int i = 0; i < 12 * cElements; i++)
+        e = std::max(e, std::fabs(double(a[i]) - b[i]));
+      return e;
+    });
+
+    //Blends of the bones, against the blend in double precision
+    SkinData s(cElements);
+    accuracy("skinBatch (DualQuaternion)", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      skinBatch(s.bones.data(), s.indices.data(), s.weights.data(), points.data(), p.data(), cElements,
+                normals.data(), n.data());
+      for(int i = 0; i < cElements; i++)
+      {
+        const std::uint16_t* index = &s.indices[cSkinInfluences * i];
+        const float* weight = &s.weights[cSkinInfluences * i];
+        const DualQuaterniond first = toDouble(s.bones[index[0]]);
+        DualQuaterniond b = first * double(weight[0]);
+        for(int k = 1; k < cSkinInfluences; k++)
+        {
+          const DualQuaterniond bone = toDouble(s.bones[index[k]]);
+          b += bone * (bone.real().inner(first.real()) < 0.0 ? -weight[k] : weight[k]);
+        }
+        b = b.normalize();
+
+        e = std::max(e, vectorError(p[i], b.transformPoint(Vector3d(points[i][0], points[i][1], points[i][2]))));
+        e = std::max(e, vectorError(n[i], b.transformVector(Vector3d(normals[i][0], normals[i][1], normals[i][2]))));
+      }
+      return e;
+    });
+  }
+  //World matrices of a transform hierarchy against its local transforms applied one after
+  //another in double precision, rotate(q, s * p) + t from the node up to its root
+  void checkTransform()
+  {
+    //4 children per node, 6 levels below the root. Scales in [0.5, 1.5] and translations up to 1
+    //keep points within about 8, so a float rounding of them is 2 ^ -21; a few per level.
+    const std::size_t cNodes = 4096 + 3;
+    const double cTransformError = 64.0 * std::ldexp(1.0, -21);
+
+    std::vector<Transform> local(cNodes);
+    TransformHierarchy tree;
+    for(std::size_t i = 0; i < cNodes; i++)
+    {
+      local[i] = Transform(randomRotation(), randomVector(), Vector(random(0.5f, 1.5f), random(0.5f, 1.5f), random(0.5f, 1.5f)));
+      tree.add(local[i], i == 0 ? TransformHierarchy::cNoParent : (i - 1) / 4);
+    }
+    tree.update();
+
+    accuracy("quaternionToMatrixBatch (t and s)", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      std::vector<Quaternion> rotations(cNodes);
+      std::vector<Vector> translations(cNodes), scales(cNodes);
+      std::vector<float> rows(12 * cNodes), columns(12 * cNodes);
+      for(std::size_t i = 0; i < cNodes; i++)
+      {
+        rotations[i] = local[i].rotation;
+        translations[i] = local[i].translation;
+        scales[i] = local[i].scale;
+      }
+      quaternionToMatrixBatch(rotations.data(), rows.data(), cNodes, cRowMajor, translations.data(), scales.data());
+      quaternionToMatrixBatch(rotations.data(), columns.data(), cNodes, cColumnMajor, translations.data(), scales.data());
+      for(std::size_t i = 0; i < cNodes; i++)
+      {
+        Matrix m;
+        local[i].toMatrix(m);
+        for(int r = 0; r < 3; r++)
+          for(int c = 0; c < 4; c++)
+          {
+            e = std::max(e, std::fabs(double(rows[12 * i + 4 * r + c]) - m(r, c)));
+            e = std::max(e, std::fabs(double(columns[12 * i + 3 * c + r]) - m(r, c)));
+          }
+      }
+      return e;
+    });
+    accuracy("TransformHierarchy::world", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      for(std::size_t i = 0; i < cNodes; i++)
+      {
+        const Vector p = randomVector();
+        Vector r;
+        transformPoints(tree.world(i), &p, &r, 1);
+
+        Vector3d x(p[0], p[1], p[2]);
+        for(std::size_t j = i; ; j = (j - 1) / 4)
+        {
+          const Quaternion& q = local[j].rotation;
+          const Vector& t = local[j].translation;
+          const Vector& s = local[j].scale;
+          x = rotate(Quaterniond(q.w(), Vector3d(q[0], q[1], q[2])), Vector3d(x[0] * s[0], x[1] * s[1], x[2] * s[2])) +
+              Vector3d(t[0], t[1], t[2]);
+          if(j == 0)
+            break;
+        }
+        e = std::max(e, vectorError(r, x));
+      }
+      return e;
+    });
+  }
+
+  void checkSkinning()
+  {
+    //Not a multiple of the SIMD width, so the padding lanes are run too; points and
+    //translations up to 10 along each axis, as checkDualQuaternion
+    const int cElements = (1 << 16) + 3;
+    const double cTransformError = 16.0 * std::ldexp(1.0, -19);
+    const char* names[2] = {"skinBatch (Matrix, 4 bones)", "skinBatch (Matrix, 8 bones)"};
+
+    std::vector<Vector> points(cElements), normals(cElements);
+    for(int i = 0; i < cElements; i++)
+    {
+      points[i] = randomVector() * 10.0f;
+      normals[i] = randomVector().normalize();
+    }
+    VectorBatch p(points.data(), cElements), n(normals.data(), cElements), outP, outN;
+
+    for(int b = 0; b < 2; b++)
+    {
+      SkinData s(cElements, 4 * (b + 1));
+      accuracy(names[b], "absolute", cTransformError, [&]() {
+        double e = 0.0;
+        skinBatch(s.palette.data(), s.indices.data(), s.weights.data(), s.influences, p, n, outP, outN);
+        for(int i = 0; i < cElements; i++)
+        {
+          //Blended matrix times point, and normal normalized, in double
+          double m[16] = {0.0};
+          for(int k = 0; k < s.influences; k++)
+            for(int c = 0; c < 16; c++)
+              m[c] += double(s.weights[s.influences * i + k]) * s.palette[s.indices[s.influences * i + k]][c];
+
+          double q[3], r[3], length = 0.0;
+          for(int row = 0; row < 3; row++)
+          {
+            q[row] = m[row] * points[i][0] + m[4 + row] * points[i][1] + m[8 + row] * points[i][2] + m[12 + row];
+            r[row] = m[row] * normals[i][0] + m[4 + row] * normals[i][1] + m[8 + row] * normals[i][2];
+            length += r[row] * r[row];
+          }
+          length = std::sqrt(length);
+
+          e = std::max(e, vectorError(outP.get(i), Vector3d(q[0], q[1], q[2])));
+          e = std::max(e, vectorError(outN.get(i), Vector3d(r[0] / length, r[1] / length, r[2] / length)));
+        }
+        return e;
+      });
+    }
+  }
+  //Random box, every sixteenth empty
+  AABB randomBox(int i)
+  {
+    if(i % 16 == 15)
+      return AABB();
+
+    const Vector c = randomVector() * 10.0f;
+    const Vector e(random(0.0f, 5.0f), random(0.0f, 5.0f), random(0.0f, 5.0f));
+    return AABB(c - e, c + e);
+  }
+
+  //Error of box against the box of the corners of in transformed by func, in double precision;
+  //infinite if an empty box did not stay empty
+  template<typename Func>
+  double boxError(const AABB& box, const AABB& in, Func func)
+  {
+    if(in.isEmpty())
+      return box.isEmpty() ? 0.0 : INFINITY;
+
+    double lo[3] = {INFINITY, INFINITY, INFINITY}, hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for(int corner = 0; corner < 8; corner++)
+    {
+      const Vector3d p = func(Vector3d(corner & 1 ? in.max[0] : in.min[0], corner & 2 ? in.max[1] : in.min[1],
+                                       corner & 4 ? in.max[2] : in.min[2]));
+      for(int k = 0; k < 3; k++)
+      {
+        lo[k] = std::min(lo[k], p[k]);
+        hi[k] = std::max(hi[k], p[k]);
+      }
+    }
+
+    return std::max(vectorError(box.min, Vector3d(lo[0], lo[1], lo[2])), vectorError(box.max, Vector3d(hi[0], hi[1], hi[2])));
+  }
+
+  void checkAABB()
+  {
+    //Not a multiple of the SIMD width, and larger than a parallel grain. Box centers and
+    //translations up to 10, extents up to 5, so results are up to about 40 and a float
+    //rounding of them 2 ^ -18; a handful of them.
+    const int cElements = (1 << 16) + 3;
+    const double cTransformError = 16.0 * std::ldexp(1.0, -18);
+
+    std::vector<Vector> points(cElements);
+    for(int i = 0; i < cElements; i++)
+      points[i] = randomVector() * 10.0f;
+    const VectorBatch batch(points.data(), cElements);
+
+    AABB ref;
+    for(int i = 0; i < cElements; i++)
+      ref.extend(points[i]);
+
+    accuracy("computeAABB (Vector array)", "absolute", 0.0, [&]() {
+      const AABB box = computeAABB(points.data(), cElements);
+      return std::max(vectorError(box.min, Vector3d(ref.min[0], ref.min[1], ref.min[2])),
+                      vectorError(box.max, Vector3d(ref.max[0], ref.max[1], ref.max[2])));
+    });
+    accuracy("computeAABB (VectorBatch)", "absolute", 0.0, [&]() {
+      const AABB box = computeAABB(batch);
+      return std::max(vectorError(box.min, Vector3d(ref.min[0], ref.min[1], ref.min[2])),
+                      vectorError(box.max, Vector3d(ref.max[0], ref.max[1], ref.max[2])));
+    });
+
+    std::vector<AABB> boxes(cElements), out(cElements);
+    std::vector<Matrix> m(cElements);
+    std::vector<Quaternion> q(cElements);
+    std::vector<Vector> t(cElements);
+    for(int i = 0; i < cElements; i++)
+    {
+      boxes[i] = randomBox(i);
+      m[i] = randomTransform();
+      q[i] = randomRotation();
+      t[i] = randomVector() * 10.0f;
+    }
+
+    auto byMatrix = [&](int i) {
+      return [&, i](const Vector3d& p) {
+        Vector3d r;
+        for(int k = 0; k < 3; k++)
+          r[k] = m[i](k, 0) * p[0] + m[i](k, 1) * p[1] + m[i](k, 2) * p[2] + m[i](k, 3);
+        return r;
+      };
+    };
+    auto byQuaternion = [&](int i) {
+      return [&, i](const Vector3d& p) {
+        const Quaterniond r(q[i].w(), Vector3d(q[i][0], q[i][1], q[i][2]));
+        return rotate(r, p) + Vector3d(t[i][0], t[i][1], t[i][2]);
+      };
+    };
+
+    accuracy("transformAABB (Matrix)", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+        e = std::max(e, boxError(transformAABB(m[i], boxes[i]), boxes[i], byMatrix(i)));
+      return e;
+    });
+    accuracy("transformAABBBatch (Matrix)", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      transformAABBBatch(m.data(), boxes.data(), out.data(), cElements);
+      for(int i = 0; i < cElements; i++)
+        e = std::max(e, boxError(out[i], boxes[i], byMatrix(i)));
+      return e;
+    });
+    accuracy("transformAABB (Quaternion)", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      for(int i = 0; i < cElements; i++)
+        e = std::max(e, boxError(transformAABB(q[i], t[i], boxes[i]), boxes[i], byQuaternion(i)));
+      return e;
+    });
+    accuracy("transformAABBBatch (Quaternion)", "absolute", cTransformError, [&]() {
+      double e = 0.0;
+      transformAABBBatch(q.data(), t.data(), boxes.data(), out.data(), cElements);
+      for(int i = 0; i < cElements; i++)
+        e = std::max(e, boxError(out[i], boxes[i], byQuaternion(i)));
+      return e;
+    });
+  }
+  //Camera at eye looking at the origin, 60 degrees, 16:9, near 0.5, far 100
+  Matrix viewProjection(const Vector& eye)
+  {
+    Matrix projection, view;
+    projection.createPerspective(60.0f, 16.0f / 9.0f, 0.5f, 100.0f);
+    view.createLookAt(eye, Vector(0.0f, 0.0f, 0.0f), Vector(0.0f, 1.0f, 0.0f));
+    return projection * view;
+  }
+
+  //Normalized device coordinates of p by m, in double
+  Vector3d project(const Matrix& m, const Vector3d& p)
+  {
+    double clip[4];
+    for(int r = 0; r < 4; r++)
+      clip[r] = m(r, 0) * p[0] + m(r, 1) * p[1] + m(r, 2) * p[2] + m(r, 3);
+    return Vector3d(clip[0] / clip[3], clip[1] / clip[3], clip[2] / clip[3]);
+  }
+
+  void checkFrustum()
+  {
+    //Corners of the view volumes go to the corners of the -1 to 1 cube, within a few float
+    //roundings of the matrix entries
+    const double cCornerError = 16.0 * std::ldexp(1.0, -24);
+    const double fovY = 60.0, aspect = 16.0 / 9.0, zNear = 0.5, zFar = 100.0;
+
+    accuracy("Matrix::createPerspective", "absolute", cCornerError, [&]() {
+      Matrix m;
+      m.createPerspective(float(fovY), float(aspect), float(zNear), float(zFar));
+
+      double e = 0.0;
+      for(int corner = 0; corner < 8; corner++)
+      {
+        const double sx = corner & 1 ? 1.0 : -1.0, sy = corner & 2 ? 1.0 : -1.0, sz = corner & 4 ? 1.0 : -1.0;
+        const double z = sz < 0.0 ? zNear : zFar;
+        const double y = z * std::tan(fovY * 0.5 * 3.14159265358979323846 / 180.0);
+        const Vector3d ndc = project(m, Vector3d(sx * y * aspect, sy * y, -z));
+        e = std::max(e, std::max(std::fabs(ndc[0] - sx), std::max(std::fabs(ndc[1] - sy), std::fabs(ndc[2] - sz))));
+      }
+      return e;
+    });
+    accuracy("Matrix::createOrthographic", "absolute", cCornerError, [&]() {
+      const double l = -4.0, r = 6.0, b = -2.0, t = 3.0;
+      Matrix m;
+      m.createOrthographic(float(l), float(r), float(b), float(t), float(zNear), float(zFar));
+
+      double e = 0.0;
+      for(int corner = 0; corner < 8; corner++)
+      {
+        const double sx = corner & 1 ? 1.0 : -1.0, sy = corner & 2 ? 1.0 : -1.0, sz = corner & 4 ? 1.0 : -1.0;
+        const Vector3d ndc = project(m, Vector3d(sx < 0.0 ? l : r, sy < 0.0 ? b : t, sz < 0.0 ? -zNear : -zFar));
+        e = std::max(e, std::max(std::fabs(ndc[0] - sx), std::max(std::fabs(ndc[1] - sy), std::fabs(ndc[2] - sz))));
+      }
+      return e;
+    });
+
+    //Eye to the origin, target onto -z at its distance, with positions up to 10 and distances
+    //up to 35: a few float roundings of 32
+    accuracy("Matrix::createLookAt", "absolute", 16.0 * std::ldexp(1.0, -19), [&]() {
+      double e = 0.0;
+      for(int i = 0; i < 1000; i++)
+      {
+        const Vector eye = randomVector() * 10.0f, target = randomVector() * 10.0f;
+        Matrix m;
+        m.createLookAt(eye, target, randomVector());
+
+        const Vector3d d(target[0] - eye[0], target[1] - eye[1], target[2] - eye[2]);
+        const double distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        Vector a = eye, b = target;
+        transformPoints(m, &a, &a, 1);
+        transformPoints(m, &b, &b, 1);
+        e = std::max(e, std::max(vectorError(a, Vector3d(0.0, 0.0, 0.0)), vectorError(b, Vector3d(0.0, 0.0, -distance))));
+      }
+      return e;
+    });
+
+    //Points around the view volume inside the frustum exactly when their projection is inside
+    //the cube; points within 1e-3 of its faces are skipped. Error is the number of mismatches.
+    const Vector eye(5.0f, 10.0f, 60.0f);
+    const Matrix vp = viewProjection(eye);
+    const Frustum frustum(vp);
+    accuracy("Frustum::extract", "mismatches", 0.0, [&]() {
+      int mismatches = 0;
+      for(int i = 0; i < 100000; i++)
+      {
+        const Vector p = randomVector() * 120.0f;
+        const Vector3d ndc = project(vp, Vector3d(p[0], p[1], p[2]));
+        const bool front = vp(3, 0) * double(p[0]) + vp(3, 1) * double(p[1]) + vp(3, 2) * double(p[2]) + vp(3, 3) > 0.0;
+
+        const double outside = std::max(std::fabs(ndc[0]), std::max(std::fabs(ndc[1]), std::fabs(ndc[2])));
+        if(front && std::fabs(outside - 1.0) < 1e-3)
+          continue;
+        mismatches += frustum.intersects(p, 0.0f) != (front && outside <= 1.0);
+      }
+      return double(mismatches);
+    });
+
+    //Batches against the scalar tests, with a tail
+    const std::size_t cElements = 10003;
+    std::vector<Vector> centers(cElements), extents(cElements);
+    std::vector<float> radii(cElements);
+    for(std::size_t i = 0; i < cElements; i++)
+    {
+      centers[i] = randomVector() * 60.0f;
+      extents[i] = Vector(random(0.0f, 5.0f), random(0.0f, 5.0f), random(0.0f, 5.0f));
+      radii[i] = random(0.0f, 5.0f);
+    }
+    const VectorBatch centerBatch(centers.data(), cElements), extentBatch(extents.data(), cElements);
+    std::vector<std::uint32_t> visible(cElements);
+
+    accuracy("cullSpheres", "mismatches", 0.0, [&]() {
+      const std::size_t count = cullSpheres(frustum, centerBatch, radii.data(), visible.data());
+      std::size_t mismatches = 0, k = 0;
+      for(std::size_t i = 0; i < cElements; i++)
+        if(frustum.intersects(centers[i], radii[i]))
+          mismatches += (k >= count || visible[k++] != i);
+      return double(mismatches + (count - std::min(count, k)));
+    });
+    accuracy("cullAABBs", "mismatches", 0.0, [&]() {
+      const std::size_t count = cullAABBs(frustum, centerBatch, extentBatch, visible.data());
+      std::size_t mismatches = 0, k = 0;
+      for(std::size_t i = 0; i < cElements; i++)
+        if(frustum.intersects(AABB(centers[i] - extents[i], centers[i] + extents[i])))
+          mismatches += (k >= count || visible[k++] != i);
+      return double(mismatches + (count - std::min(count, k)));
+    });
+  }
+  void checkKdTree()
+  {
+    //Distances up to about 40, from single precision differences: a few roundings of 32
+    const double cDistanceError = 16.0 * std::ldexp(1.0, -19);
+    const std::size_t cPoints = 100003, cQueries = 500, cK = 8;
+    const float cRadius = 1.0f;
+
+    //Every hundredth point a duplicate, so ties are searched too
+    std::vector<Vector> points(cPoints), queries(cQueries);
+    for(std::size_t i = 0; i < cPoints; i++)
+      points[i] = i % 100 == 99 ? points[i - 1] : randomVector() * 10.0f;
+    for(std::size_t i = 0; i < cQueries; i++)
+      queries[i] = randomVector() * 12.0f;
+    const KdTree tree(points.data(), cPoints);
+
+    auto distance = [&](std::uint32_t i, const Vector& q) {
+      const double dx = double(points[i][0]) - q[0], dy = double(points[i][1]) - q[1], dz = double(points[i][2]) - q[2];
+      return std::sqrt(dx * dx + dy * dy + dz * dz);
+    };
+
+    //Distances against the sorted brute force ones, and against the distances of the indices
+    std::vector<std::uint32_t> indices(cQueries * cK);
+    std::vector<float> distances(cQueries * cK);
+    accuracy("KdTree::nearest", "absolute", cDistanceError, [&]() {
+      double e = 0.0;
+      std::vector<double> all(cPoints);
+      for(std::size_t q = 0; q < cQueries; q++)
+      {
+        for(std::size_t i = 0; i < cPoints; i++)
+          all[i] = distance(std::uint32_t(i), queries[q]);
+        std::partial_sort(all.begin(), all.begin() + cK, all.end());
+
+        std::uint32_t* index = &indices[q * cK];
+        float* d = &distances[q * cK];
+        if(tree.nearest(queries[q], cK, index, d) != cK)
+          return double(INFINITY);
+        for(std::size_t k = 0; k < cK; k++)
+          e = std::max(e, std::max(std::fabs(d[k] - all[k]), std::fabs(d[k] - distance(index[k], queries[q]))));
+      }
+      return e;
+    });
+
+    //Trees smaller than a leaf, a register and k, and empty
+    accuracy("KdTree::nearest (small trees)", "mismatches", 0.0, [&]() {
+      int mismatches = 0;
+      for(std::size_t size : { 0, 1, 3, 17, 40 })
+      {
+        const KdTree small(points.data(), size);
+        std::uint32_t index[32];
+        float d[32];
+        const std::size_t found = small.nearest(queries[0], 32, index, d);
+        mismatches += found != std::min<std::size_t>(size, 32);
+        for(std::size_t k = 0; k < 32; k++)
+        {
+          if(k < found)
+            mismatches += index[k] >= size || (k > 0 && d[k] < d[k - 1]);
+          else
+            mismatches += index[k] != KdTree::cNoPoint || !std::isinf(d[k]);
+        }
+      }
+      return double(mismatches);
+    });
+
+    //Points within 1e-4 of the radius may go either way and are skipped
+    std::vector<std::uint32_t> found;
+    accuracy("KdTree::radiusSearch", "mismatches", 0.0, [&]() {
+      int mismatches = 0;
+      std::vector<char> hit(cPoints);
+      for(std::size_t q = 0; q < cQueries; q++)
+      {
+        tree.radiusSearch(queries[q], cRadius, found);
+        std::fill(hit.begin(), hit.end(), 0);
+        for(std::uint32_t i : found)
+          mismatches += hit[i]++ != 0;
+        for(std::size_t i = 0; i < cPoints; i++)
+        {
+          const double d = distance(std::uint32_t(i), queries[q]);
+          if(std::fabs(d - cRadius) > 1e-4)
+            mismatches += (hit[i] != 0) != (d < cRadius);
+        }
+      }
+      return double(mismatches);
+    });
+
+    //Batches give the single query results, in the same order
+    accuracy("KdTree::nearestBatch", "mismatches", 0.0, [&]() {
+      std::vector<std::uint32_t> batchIndices(cQueries * cK);
+      std::vector<float> batchDistances(cQueries * cK);
+      tree.nearestBatch(queries.data(), cQueries, cK, batchIndices.data(), batchDistances.data());
+
+      int mismatches = 0;
+      for(std::size_t q = 0; q < cQueries; q++)
+      {
+        tree.nearest(queries[q], cK, &indices[q * cK], &distances[q * cK]);
+        for(std::size_t k = 0; k < cK; k++)
+          mismatches += batchIndices[q * cK + k] != indices[q * cK + k] || batchDistances[q * cK + k] != distances[q * cK + k];
+      }
+      return double(mismatches);
+    });
+    accuracy("KdTree::radiusSearchBatch", "mismatches", 0.0, [&]() {
+      std::vector<std::uint32_t> batch;
+      std::vector<std::size_t> offsets;
+      tree.radiusSearchBatch(queries.data(), cQueries, cRadius, batch, offsets);
+
+      std::size_t mismatches = 0;
+      for(std::size_t q = 0; q < cQueries; q++)
+      {
+        tree.radiusSearch(queries[q], cRadius, found);
+        mismatches += offsets[q + 1] - offsets[q] != found.size() ||
+                      !std::equal(found.begin(), found.end(), batch.begin() + offsets[q]);
+      }
+      return double(mismatches);
+    });
+  }
+
+
+
+
+
+  //Layouts of the same work: aligned and padded types against the plain ones, and arena
+  //temporaries against std::vector
+  void benchMemory(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const std::size_t cFrameChunk = 1024;
+    const Matrix a = d.ma[0];
+
+    //MissCounter counts the misses of the calling thread only, so the batches run on it alone
+    setParallelThreads(1);
+
+    //Matrices 32 bytes off a cache line, as std::vector<Matrix> may place them, so every one
+    //straddles two lines, against cache line aligned ones
+    char* offLine = static_cast<char*>(simd::alignedAlloc(3 * n * sizeof(Matrix) + 64));
+    Matrix* ma = reinterpret_cast<Matrix*>(offLine + 32);
+    Matrix* mb = ma + n;
+    Matrix* mout = mb + n;
+    AlignedArray<LineMatrix> la(n), lb(n), lout(n);
+    for(std::size_t i = 0; i < n; i++)
+    {
+      ma[i] = la[i] = d.ma[i];
+      mb[i] = lb[i] = d.mb[i];
+    }
+
+    throughput("multiplyBatch (pairs, 32 bytes off line)", [&]() {
+      multiplyBatch(ma, mb, mout, n);
+      return checksum(mout[n - 1]);
+    });
+    throughput("multiplyBatch (pairs, LineMatrix)", [&]() {
+      multiplyBatch(la.data(), lb.data(), lout.data(), n);
+      return checksum(lout[n - 1]);
+    });
+
+    //12-byte vectors against 16-byte ones, fewer bytes against aligned loads
+    AlignedArray<PaddedVector> pa(d.va.begin(), d.va.end()), pout(n);
+    throughput("Matrix::operator* (Vector, Vector array)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = a * d.va[i];
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Matrix::operator* (Vector, PaddedVector array)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        pout[i] = a * pa[i];
+      return checksum(pout[n - 1]);
+    });
+
+    //A frame of temporaries: every chunk of matrices gets a scratch array, freed with the frame
+    Arena arena;
+    throughput("frame temporaries (std::vector)", [&]() {
+      double sum = 0.0;
+      for(std::size_t i = 0; i < n; i += cFrameChunk)
+      {
+        const std::size_t count = std::min(cFrameChunk, n - i);
+        std::vector<Matrix> scratch(count);
+        for(std::size_t k = 0; k < count; k++)
+          scratch[k] = a * d.ma[i + k];
+        sum += checksum(scratch[count - 1]);
+      }
+      return sum;
+    });
+    throughput("frame temporaries (Arena)", [&]() {
+      double sum = 0.0;
+      for(std::size_t i = 0; i < n; i += cFrameChunk)
+      {
+        const std::size_t count = std::min(cFrameChunk, n - i);
+        Matrix* scratch = arena.allocate<Matrix>(count);
+        for(std::size_t k = 0; k < count; k++)
+          scratch[k] = a * d.ma[i + k];
+        sum += checksum(scratch[count - 1]);
+      }
+      arena.reset();
+      return sum;
+    });
+
+    simd::alignedFree(offLine);
+    setParallelThreads(0);
+  }
+
+  void benchThreads(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const Matrix a = d.ma[0];
+
+    //Cache line aligned output, so chunk boundaries are line boundaries
+    Matrix* out = static_cast<Matrix*>(simd::alignedAlloc(n * sizeof(Matrix)));
+
+    scaling("multiplyBatch (pairs)", [&]() {
+      multiplyBatch(d.ma.data(), d.mb.data(), out, n);
+      return checksum(out[n - 1]);
+    });
+    scaling("multiplyBatch (one times N)", [&]() {
+      multiplyBatch(a, d.mb.data(), out, n);
+      return checksum(out[n - 1]);
+    });
+    scaling("inverseBatch", [&]() {
+      inverseBatch(d.ma.data(), out, n);
+      return checksum(out[n - 1]);
+    });
+    scaling("transformPoints", [&]() {
+      transformPoints(a, d.va.data(), d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+
+    simd::alignedFree(out);
+  }
+
+  void benchQuaternion(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const Quaternion a = d.qa[0];
+    const Quaternion b = d.qb[0];
+    const Vector v = d.va[0];
+    const Vector axis = Vector(0.0f, 0.6f, 0.8f);
+    const float s = 1.0000001f;
+
+    latency("Quaternion::Quaternion(w, v)", a, [&](const Quaternion& q) { return Quaternion(q[0], q.v()); });
+    latency("Quaternion::v", a, [&](const Quaternion& q) { return feed(q, q.v()[1]); });
+    latency("Quaternion::w", a, [&](const Quaternion& q) { return feed(q, q.w()); });
+    latency("Quaternion::norm", a, [&](const Quaternion& q) { return feed(q, q.norm()); });
+    latency("Quaternion::magnitude", a, [&](const Quaternion& q) { return feed(q, q.magnitude()); });
+    latency("Quaternion::normalize", a, [&](const Quaternion& q) { return q.normalize(); });
+    latency("Quaternion::conjugate", a, [&](const Quaternion& q) { return q.conjugate(); });
+    latency("Quaternion::inverse", a, [&](const Quaternion& q) { return q.inverse(); });
+    latency("Quaternion::inner", a, [&](const Quaternion& q) { return feed(q, q.inner(b)); });
+    latency("Quaternion::createRotation", a, [&](const Quaternion& q) {
+      Quaternion r;
+      r.createRotation(axis, 30.0f + q.w());
+      return r;
+    });
+    latency("Quaternion::operator[]", a, [&](const Quaternion& q) { return feed(q, q[2]); });
+    latency("Quaternion::operator==", a, [&](const Quaternion& q) { return feed(q, float(q == b)); });
+    latency("Quaternion::operator!=", a, [&](const Quaternion& q) { return feed(q, float(q != b)); });
+    latency("Quaternion::operator+", a, [&](const Quaternion& q) { return q + b; });
+    latency("Quaternion::operator-", a, [&](const Quaternion& q) { return q - b; });
+    latency("Quaternion::operator* (Quaternion)", a, [&](const Quaternion& q) { return q * b; });
+    latency("Quaternion::operator* (scalar)", a, [&](const Quaternion& q) { return q * s; });
+    latency("Quaternion::operator/", a, [&](const Quaternion& q) { return q / s; });
+    latency("Quaternion::operator+=", a, [&](Quaternion q) { return q += b; });
+    latency("Quaternion::operator-=", a, [&](Quaternion q) { return q -= b; });
+    latency("Quaternion::operator*= (Quaternion)", a, [&](Quaternion q) { return q *= b; });
+    latency("Quaternion::operator*= (scalar)", a, [&](Quaternion q) { return q *= s; });
+    latency("Quaternion::operator/=", a, [&](Quaternion q) { return q /= s; });
+    latency("quaternionToMatrix", a, [&](const Quaternion& q) {
+      Quaternion r(q);
+      Matrix m;
+      quaternionToMatrix(r, m);
+      return feed(q, m[5]);
+    });
+    latency("rotate", v, [&](const Vector& x) { return rotate(a, x); });
+    latency("rotateFast", v, [&](const Vector& x) { return rotateFast(a, x); });
+    latency("nlerp", a, [&](const Quaternion& q) { return nlerp(q, b, 0.25f); });
+    latency("slerp", a, [&](const Quaternion& q) { return slerp(q, b, 0.25f); });
+
+    throughput("Quaternion::Quaternion(w, v)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = Quaternion(d.f[i], d.va[i]);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::v", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = d.qa[i].v();
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("Quaternion::w", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.qa[i].w();
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Quaternion::norm", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.qa[i].norm();
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Quaternion::magnitude", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.qa[i].magnitude();
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Quaternion::normalize", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i].normalize();
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::conjugate", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i].conjugate();
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::inverse", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i].inverse();
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::inner", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.qa[i].inner(d.qb[i]);
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Quaternion::createRotation", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i].createRotation(axis, 360.0f * d.f[i]);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator[]", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = d.qa[i][int(i % 4)];
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Quaternion::operator==", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = float(d.qa[i] == d.qb[i]);
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Quaternion::operator!=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.fout[i] = float(d.qa[i] != d.qb[i]);
+      return checksum(d.fout[n - 1]);
+    });
+    throughput("Quaternion::operator+", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i] + d.qb[i];
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator-", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i] - d.qb[i];
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator* (Quaternion)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i] * d.qb[i];
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator* (scalar)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i] * d.f[i];
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator/", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i] / s;
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator+=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] += d.qa[i];
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator-=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] -= d.qa[i];
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator*= (Quaternion)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i];
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] *= d.qb[i];
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator*= (scalar)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i];
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] *= d.f[i];
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("Quaternion::operator/=", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = d.qa[i];
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] /= s;
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("quaternionToMatrix", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        quaternionToMatrix(d.qa[i], d.mout[i]);
+      return checksum(d.mout[n - 1]);
+    });
+
+    //Packed 3x4 output in the storage of mout, which has room for 16 floats per quaternion
+    float* packed = &d.mout[0][0];
+    throughput("quaternionToMatrixBatch (3x4 rows)", [&]() {
+      quaternionToMatrixBatch(d.qa.data(), packed, n);
+      return checksum(packed[12 * n - 1]);
+    });
+    throughput("quaternionToMatrixBatch (3x4 columns)", [&]() {
+      quaternionToMatrixBatch(d.qa.data(), packed, n, cColumnMajor);
+      return checksum(packed[12 * n - 1]);
+    });
+    throughput("quaternionToMatrixBatch (3x4 rows, t and s)", [&]() {
+      quaternionToMatrixBatch(d.qa.data(), packed, n, cRowMajor, d.va.data(), d.vb.data());
+      return checksum(packed[12 * n - 1]);
+    });
+    throughput("quaternionToMatrixBatch (3x4 rows, streaming)", [&]() {
+      quaternionToMatrixBatch(d.qa.data(), packed, n, cRowMajor, nullptr, nullptr, true);
+      return checksum(packed[12 * n - 1]);
+    });
+    throughput("rotate", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = rotate(d.qa[i], d.va[i]);
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("rotateFast", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = rotateFast(d.qa[i], d.va[i]);
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("rotateBatch", [&]() {
+      rotateBatch(a, d.va.data(), d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("nlerp", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = nlerp(d.qa[i], d.qb[i], d.f[i]);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("slerp", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.qout[i] = slerp(d.qa[i], d.qb[i], d.f[i]);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("nlerpBatch (t per pair)", [&]() {
+      nlerpBatch(d.qa.data(), d.qb.data(), d.f.data(), d.qout.data(), n);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("nlerpBatch (shared t)", [&]() {
+      nlerpBatch(d.qa.data(), d.qb.data(), 0.25f, d.qout.data(), n);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("slerpBatch (t per pair)", [&]() {
+      slerpBatch(d.qa.data(), d.qb.data(), d.f.data(), d.qout.data(), n);
+      return checksum(d.qout[n - 1]);
+    });
+    throughput("slerpBatch (shared t)", [&]() {
+      slerpBatch(d.qa.data(), d.qb.data(), 0.25f, d.qout.data(), n);
+      return checksum(d.qout[n - 1]);
+    });
+  }
+
+  void benchDualQuaternion(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const DualQuaternion a(d.qa[0], d.va[0]);
+    const DualQuaternion b(d.qb[0], d.vb[0]);
+    const Vector v = d.va[1];
+
+    latency("DualQuaternion::operator*", a, [&](const DualQuaternion& q) { return q * b; });
+    latency("DualQuaternion::normalize", a, [&](const DualQuaternion& q) { return q.normalize(); });
+    latency("DualQuaternion::inverse", a, [&](const DualQuaternion& q) { return q.inverse(); });
+    latency("DualQuaternion::transformPoint", v, [&](const Vector& x) { return a.transformPoint(x); });
+
+    std::vector<DualQuaternion> dq(n);
+    for(std::size_t i = 0; i < n; i++)
+      dq[i] = DualQuaternion(d.qa[i], d.va[i]);
+
+    throughput("DualQuaternion::operator*", [&]() {
+      Vector s;
+      for(std::size_t i = 0; i + 1 < n; i++)
+        s += (dq[i] * dq[i + 1]).dual().v();
+      return checksum(s);
+    });
+    throughput("DualQuaternion::transformPoint", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = dq[i].transformPoint(d.vb[i]);
+      return checksum(d.vout[n - 1]);
+    });
+    throughput("dualQuaternionToMatrix", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        dualQuaternionToMatrix(dq[i], d.mout[i]);
+      return checksum(d.mout[n - 1]);
+    });
+
+    float* packed = &d.mout[0][0];
+    throughput("dualQuaternionToMatrixBatch (3x4 rows)", [&]() {
+      dualQuaternionToMatrixBatch(dq.data(), packed, n);
+      return checksum(packed[12 * n - 1]);
+    });
+
+    //Skinning: positions va, normals vb
+    SkinData s(n);
+    std::vector<Vector> normals(n);
+    throughput("skinning (DualQuaternion, per vertex)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        skinVertex(s, i, d.va[i], d.vb[i], d.vout[i], normals[i]);
+      return checksum(d.vout[n - 1]) + checksum(normals[n - 1]);
+    });
+    throughput("skinBatch (DualQuaternion)", [&]() {
+      skinBatch(s.bones.data(), s.indices.data(), s.weights.data(), d.va.data(), d.vout.data(), n,
+                d.vb.data(), normals.data());
+      return checksum(d.vout[n - 1]) + checksum(normals[n - 1]);
+    });
+    throughput("skinBatch (DualQuaternion, positions only)", [&]() {
+      skinBatch(s.bones.data(), s.indices.data(), s.weights.data(), d.va.data(), d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+  }
+
+  double checksum(const AABB& box) { return checksum(box.min) + checksum(box.max); }
+
+  void benchAABB(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+
+    throughput("computeAABB (scalar min/max)", [&]() {
+      AABB box;
+      for(std::size_t i = 0; i < n; i++)
+        box.extend(d.va[i]);
+      return checksum(box);
+    });
+    throughput("computeAABB (Vector array)", [&]() {
+      return checksum(computeAABB(d.va.data(), n));
+    });
+    const VectorBatch batch(d.va.data(), n);
+    throughput("computeAABB (VectorBatch)", [&]() {
+      return checksum(computeAABB(batch));
+    });
+
+    //Boxes centered on va, half sizes |vb|
+    std::vector<AABB> boxes(n), out(n);
+    for(std::size_t i = 0; i < n; i++)
+    {
+      const Vector e(std::fabs(d.vb[i][0]), std::fabs(d.vb[i][1]), std::fabs(d.vb[i][2]));
+      boxes[i] = AABB(d.va[i] - e, d.va[i] + e);
+    }
+
+    throughput("transformAABB (eight corners)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+      {
+        Vector corners[8];
+        for(int k = 0; k < 8; k++)
+          corners[k] = Vector(k & 1 ? boxes[i].max[0] : boxes[i].min[0], k & 2 ? boxes[i].max[1] : boxes[i].min[1],
+                              k & 4 ? boxes[i].max[2] : boxes[i].min[2]);
+        transformPoints(d.ma[i], corners, corners, 8);
+
+        AABB box;
+        for(int k = 0; k < 8; k++)
+          box.extend(corners[k]);
+        out[i] = box;
+      }
+      return checksum(out[n - 1]);
+    });
+    throughput("transformAABB (Matrix)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        out[i] = transformAABB(d.ma[i], boxes[i]);
+      return checksum(out[n - 1]);
+    });
+    throughput("transformAABBBatch (Matrix)", [&]() {
+      transformAABBBatch(d.ma.data(), boxes.data(), out.data(), n);
+      return checksum(out[n - 1]);
+    });
+    throughput("transformAABB (Quaternion)", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        out[i] = transformAABB(d.qa[i], d.vb[i], boxes[i]);
+      return checksum(out[n - 1]);
+    });
+    throughput("transformAABBBatch (Quaternion)", [&]() {
+      transformAABBBatch(d.qa.data(), d.vb.data(), boxes.data(), out.data(), n);
+      return checksum(out[n - 1]);
+    });
+  }
+
+  void benchFrustum(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const Vector up(0.0f, 1.0f, 0.0f);
+
+    throughput("Matrix::createLookAt", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i].createLookAt(d.va[i], d.vb[i], up);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Matrix::createPerspective", [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.mout[i].createPerspective(30.0f + 60.0f * d.f[i], 16.0f / 9.0f, 0.5f, 100.0f);
+      return checksum(d.mout[n - 1]);
+    });
+    throughput("Frustum::extract", [&]() {
+      Frustum frustum;
+      double sum = 0.0;
+      for(std::size_t i = 0; i < n; i++)
+      {
+        frustum.extract(d.ma[i]);
+        sum += frustum.planes[cFrustumFar][3];
+      }
+      return sum;
+    });
+
+    //Bounds within 50 of the origin, seen from 60 away: about a third visible
+    const Frustum frustum(viewProjection(Vector(0.0f, 10.0f, 60.0f)));
+    std::vector<Vector> centers(n), extents(n);
+    std::vector<float> radii(n);
+    for(std::size_t i = 0; i < n; i++)
+    {
+      centers[i] = d.va[i] * 50.0f;
+      extents[i] = Vector(std::fabs(d.vb[i][0]), std::fabs(d.vb[i][1]), std::fabs(d.vb[i][2]));
+      radii[i] = extents[i].norm();
+    }
+    const VectorBatch centerBatch(centers.data(), n), extentBatch(extents.data(), n);
+    std::vector<std::uint32_t> visible(n);
+
+    throughput("cullSpheres (Frustum::intersects loop)", [&]() {
+      std::size_t count = 0;
+      for(std::size_t i = 0; i < n; i++)
+        if(frustum.intersects(centers[i], radii[i]))
+          visible[count++] = std::uint32_t(i);
+      return double(count);
+    });
+    throughput("cullSpheres", [&]() {
+      return double(cullSpheres(frustum, centerBatch, radii.data(), visible.data()));
+    });
+    throughput("cullAABBs (Frustum::intersects loop)", [&]() {
+      std::size_t count = 0;
+      for(std::size_t i = 0; i < n; i++)
+        if(frustum.intersects(AABB(centers[i] - extents[i], centers[i] + extents[i])))
+          visible[count++] = std::uint32_t(i);
+      return double(count);
+    });
+    throughput("cullAABBs", [&]() {
+      return double(cullAABBs(frustum, centerBatch, extentBatch, visible.data()));
+    });
+  }
+
+  //Other scalar types and sizes, latency only
+  void benchShapes()
+  {
+    const Vector4f a4f(0.5f, -0.25f, 0.125f, 1.0f), b4f(0.6f, 0.0f, 0.8f, 0.0f);
+    const Vector4d a4d(0.5, -0.25, 0.125, 1.0), b4d(0.6, 0.0, 0.8, 0.0);
+    const Vector3d a3d(0.5, -0.25, 0.125), b3d(0.6, 0.0, 0.8);
+
+    latency("Vector4f::operator+", a4f, [&](const Vector4f& v) { return v + b4f; });
+    latency("Vector4f::dot", a4f, [&](const Vector4f& v) { return v * (1.0f + v.dot(b4f) * gZero); });
+    latency("Vector4f::normalize", a4f, [&](const Vector4f& v) { return v.normalize(); });
+    latency("Vector4d::operator+", a4d, [&](const Vector4d& v) { return v + b4d; });
+    latency("Vector4d::dot", a4d, [&](const Vector4d& v) { return v * (1.0 + v.dot(b4d) * gZero); });
+    latency("Vector4d::normalize", a4d, [&](const Vector4d& v) { return v.normalize(); });
+    latency("Vector3d::operator* (cross)", a3d, [&](const Vector3d& v) { return v * b3d; });
+    latency("Vector3d::normalize", a3d, [&](const Vector3d& v) { return v.normalize(); });
+
+    Matrix3f a3f, b3f;
+    a3f.createRotationX(30.0f);
+    b3f.createRotationZ(-20.0f);
+    Matrix4d a44d, b44d;
+    a44d.createRotationY(40.0);
+    b44d.createRotationX(-10.0);
+    b44d(0, 3) = 1.0;
+    b44d(1, 3) = -2.0;
+
+    latency("Matrix3f::operator* (Matrix)", a3f, [&](const Matrix3f& m) { return m * b3f; });
+    latency("Matrix3f::operator* (Vector)", Vector(0.6f, 0.0f, 0.8f), [&](const Vector& x) { return a3f * x; });
+    latency("Matrix3f::determinant", a3f, [&](const Matrix3f& m) { return m * (1.0f + m.determinant() * gZero); });
+    latency("Matrix3f::inverse", a3f, [&](const Matrix3f& m) { return m.inverse(); });
+    latency("Matrix4d::operator* (Matrix)", a44d, [&](const Matrix4d& m) { return m * b44d; });
+    latency("Matrix4d::operator* (Vector)", a4d, [&](const Vector4d& x) { return a44d * x; });
+    latency("Matrix4d::inverse", a44d, [&](const Matrix4d& m) { return m.inverse(); });
+    latency("Matrix4d::inverseAffine", b44d, [&](const Matrix4d& m) { return m.inverseAffine(); });
+
+    Quaterniond qa, qb;
+    qa.createRotation(Vector3d(0.0, 0.6, 0.8), 30.0);
+    qb.createRotation(Vector3d(0.6, 0.0, 0.8), -50.0);
+
+    latency("Quaterniond::operator* (Quaternion)", qa, [&](const Quaterniond& q) { return q * qb; });
+    latency("Quaterniond::normalize", qa, [&](const Quaterniond& q) { return q.normalize(); });
+    latency("Quaterniond rotateFast", a3d, [&](const Vector3d& x) { return rotateFast(qa, x); });
+    latency("Quaterniond slerp", qa, [&](const Quaterniond& q) { return slerp(q, qb, 0.25); });
+  }
+
+  void benchWorkloads(Data& d)
+  {
+    const std::size_t n = gOptions.size;
+    const std::size_t joints = n / cJoints * cJoints;
+
+    //Skeletons of cJoints joints, parents always come before their children
+    std::vector<int> parent(cJoints);
+    parent[0] = -1;
+    for(int j = 1; j < cJoints; j++)
+      parent[j] = j < 4 ? j - 1 : int(random(0.0f, float(j)));
+
+    std::vector<Quaternion>& local = d.qa;
+    std::vector<Quaternion>& blend = d.qb;
+    std::vector<Vector>& offset = d.va;
+    std::vector<Matrix> world(cJoints);
+    std::vector<Quaternion> qworld(cJoints);
+    std::vector<Vector> pworld(cJoints);
+
+    //Local rotation and offset to matrix, then world = parent world * local
+    workload("pose chain (matrix)", joints, [&]() {
+      double sum = 0.0;
+      for(std::size_t base = 0; base < joints; base += cJoints)
+      {
+        for(int j = 0; j < cJoints; j++)
+        {
+          Matrix m;
+          quaternionToMatrix(local[base + j], m);
+          m[12] = offset[base + j][0];
+          m[13] = offset[base + j][1];
+          m[14] = offset[base + j][2];
+
+          if(parent[j] < 0)
+            world[j] = m;
+          else
+            multiply(world[parent[j]], m, world[j]);
+        }
+        sum += world[cJoints - 1][12];
+      }
+      return sum;
+    });
+
+    //Same chain kept as rotation and position, converted to matrices only at the end
+    workload("pose chain (quaternion)", joints, [&]() {
+      double sum = 0.0;
+      for(std::size_t base = 0; base < joints; base += cJoints)
+      {
+        for(int j = 0; j < cJoints; j++)
+        {
+          if(parent[j] < 0)
+          {
+            qworld[j] = local[base + j];
+            pworld[j] = offset[base + j];
+          }
+          else
+          {
+            const Quaternion& q = qworld[parent[j]];
+            qworld[j] = q * local[base + j];
+            pworld[j] = pworld[parent[j]] + rotateFast(q, offset[base + j]);
+          }
+        }
+        for(int j = 0; j < cJoints; j++)
+        {
+          quaternionToMatrix(qworld[j], world[j]);
+          world[j][12] = pworld[j][0];
+          world[j][13] = pworld[j][1];
+          world[j][14] = pworld[j][2];
+        }
+        sum += world[cJoints - 1][12];
+      }
+      return sum;
+    });
+
+    //Blend two animation poses, then build the chain
+    workload("pose chain (slerp blend + matrix)", joints, [&]() {
+      slerpBatch(local.data(), blend.data(), 0.3f, d.qout.data(), joints);
+
+      double sum = 0.0;
+      for(std::size_t base = 0; base < joints; base += cJoints)
+      {
+        for(int j = 0; j < cJoints; j++)
+        {
+          Matrix m;
+          quaternionToMatrix(d.qout[base + j], m);
+          m[12] = offset[base + j][0];
+          m[13] = offset[base + j][1];
+          m[14] = offset[base + j][2];
+
+          if(parent[j] < 0)
+            world[j] = m;
+          else
+            multiply(world[parent[j]], m, world[j]);
+        }
+        sum += world[cJoints - 1][12];
+      }
+      return sum;
+    });
+
+    //Transform hierarchy of n nodes, 4 children per node, every frame 5% of the nodes move
+    TransformHierarchy tree;
+    tree.reserve(n);
+    for(std::size_t i = 0; i < n; i++)
+      tree.add(Transform(local[i], offset[i], Vector(1.0f, 1.0f, 1.0f)), i == 0 ? TransformHierarchy::cNoParent : (i - 1) / 4);
+    tree.update();
+
+    std::vector<Matrix> flat(n);
+    workload("transform hierarchy (full recompute by hand)", n, [&]() {
+      for(std::size_t i = 0; i < n; i++)
+      {
+        Matrix m;
+        tree.local(i).toMatrix(m);
+        if(i == 0)
+          flat[i] = m;
+        else
+          multiply(flat[(i - 1) / 4], m, flat[i]);
+      }
+      return checksum(flat[n - 1]);
+    });
+    workload("transform hierarchy (update, all dirty)", n, [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        tree.setRotation(i, tree.local(i).rotation);
+      tree.update();
+      return checksum(tree.world(n - 1));
+    });
+    workload("transform hierarchy (update, 5% dirty)", n, [&]() {
+      for(std::size_t i = 19; i < n; i += 20)
+        tree.setRotation(i, tree.local(i).rotation);
+      tree.update();
+      return checksum(tree.world(n - 1));
+    });
+
+    //Rotate a point cloud by one rotation
+    const Quaternion q = d.qa[0];
+    workload("point cloud rotation (rotate)", n, [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = rotate(q, d.va[i]);
+      return checksum(d.vout[n - 1]);
+    });
+    workload("point cloud rotation (rotateFast)", n, [&]() {
+      for(std::size_t i = 0; i < n; i++)
+        d.vout[i] = rotateFast(q, d.va[i]);
+      return checksum(d.vout[n - 1]);
+    });
+    workload("point cloud rotation (rotateBatch)", n, [&]() {
+      rotateBatch(q, d.va.data(), d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+    workload("point cloud rotation (matrix + transformPoints)", n, [&]() {
+      Quaternion r(q);
+      Matrix m;
+      quaternionToMatrix(r, m);
+      transformPoints(m, d.va.data(), d.vout.data(), n);
+      return checksum(d.vout[n - 1]);
+    });
+  }
+
+  //Cold start: loading matrices saved to a file, per matrix
+  void benchPoseFile(Data& d)
+  {
+    if(gOptions.mode != "all" && gOptions.mode != "workload")
+      return;
+
+    const std::size_t n = gOptions.size;
+    const std::size_t cChunk = 4096;
+    const char* path = "skmath_benchmark.skpose";
+
+    workload("PoseFileWriter::append (matrix)", n, [&]() {
+      PoseFileWriter writer;
+      writer.open(path);
+      writer.beginSection("world", cMatrixRecord);
+      for(std::size_t i = 0; i < n; i += cChunk)
+        writer.append(&d.ma[i], std::min(cChunk, n - i));
+      return double(writer.close());
+    });
+
+    //Floats read in chunks, each matrix constructed from 16 of them
+    workload("pose file load (fread, Matrix(float*))", n, [&]() {
+      std::vector<float> buffer(cChunk * cMatrixSize);
+      FILE* file = fopen(path, "rb");
+      if(!file)
+        return 0.0;
+
+      fseek(file, long(cPoseFileAlignment), SEEK_SET);
+      for(std::size_t i = 0; i < n; i += cChunk)
+      {
+        const std::size_t count = std::min(cChunk, n - i);
+        if(fread(buffer.data(), sizeof(Matrix), count, file) != count)
+          break;
+        for(std::size_t k = 0; k < count; k++)
+          d.mout[i + k] = Matrix(&buffer[k * cMatrixSize]);
+      }
+      fclose(file);
+      return checksum(d.mout[n - 1]);
+    });
+    workload("PoseFile::open (verify)", n, [&]() {
+      PoseFile file;
+      file.open(path);
+      RecordView<Matrix> world = file.view<Matrix>("world");
+      return world.empty() ? 0.0 : checksum(world[world.size() - 1]);
+    });
+    workload("PoseFile::open (no verify)", n, [&]() {
+      PoseFile file;
+      file.open(path, false);
+      RecordView<Matrix> world = file.view<Matrix>("world");
+      return world.empty() ? 0.0 : checksum(world[world.size() - 1]);
+    });
+
+    std::remove(path);
+  }
+
+  //K-d tree build, memory and queries over 256K points, next to brute force queries
+  void benchKdTree()
+  {
+    if(gOptions.mode != "all" && gOptions.mode != "workload")
+      return;
+
+    //Points in a cube of side 20, about 33 per unit volume; brute force runs fewer queries
+    const std::size_t cPoints = std::size_t(1) << 18, cQueries = 4096, cBruteQueries = 64, cK = 8;
+    const float cRadius = 0.5f;
+    std::vector<Vector> points(cPoints), queries(cQueries);
+    for(std::size_t i = 0; i < cPoints; i++)
+      points[i] = randomVector() * 10.0f;
+    for(std::size_t i = 0; i < cQueries; i++)
+      queries[i] = randomVector() * 10.0f;
+
+    //Built before the timed builds too, so a filter skipping them still queries the full tree
+    KdTree tree(points.data(), cPoints);
+    workload("KdTree::build", cPoints, [&]() {
+      tree.build(points.data(), cPoints);
+      return double(tree.size());
+    });
+    statistic("KdTree::memory", "workload", "bytes/point", double(tree.memory()) / double(cPoints));
+    statistic("KdTree::memory (points alone)", "workload", "bytes/point", double(sizeof(Vector)));
+
+    std::vector<std::uint32_t> indices(cQueries * cK), found;
+    std::vector<float> distances(cQueries * cK);
+    std::vector<std::size_t> offsets;
+
+    workload("nearest (brute force, (a - b).norm())", cBruteQueries, [&]() {
+      double sum = 0.0;
+      for(std::size_t q = 0; q < cBruteQueries; q++)
+      {
+        float best = INFINITY;
+        std::uint32_t index = 0;
+        for(std::size_t i = 0; i < cPoints; i++)
+        {
+          const float d = (points[i] - queries[q]).norm();
+          if(d < best)
+          {
+            best = d;
+            index = std::uint32_t(i);
+          }
+        }
+        sum += index;
+      }
+      return sum;
+    });
+    workload("KdTree::nearest (k = 1)", cQueries, [&]() {
+      double sum = 0.0;
+      for(std::size_t q = 0; q < cQueries; q++)
+        sum += tree.nearest(queries[q], 1, &indices[q], &distances[q]);
+      return sum;
+    });
+    workload("KdTree::nearest (k = 8)", cQueries, [&]() {
+      double sum = 0.0;
+      for(std::size_t q = 0; q < cQueries; q++)
+        sum += tree.nearest(queries[q], cK, &indices[q * cK], &distances[q * cK]);
+      return sum;
+    });
+    workload("KdTree::nearestBatch (k = 8)", cQueries, [&]() {
+      tree.nearestBatch(queries.data(), cQueries, cK, indices.data(), distances.data());
+      return double(indices[cQueries * cK - 1]);
+    });
+
+    workload("radius search (brute force, (a - b).norm())", cBruteQueries, [&]() {
+      double sum = 0.0;
+      for(std::size_t q = 0; q < cBruteQueries; q++)
+      {
+        found.clear();
+        for(std::size_t i = 0; i < cPoints; i++)
+          if((points[i] - queries[q]).norm() <= cRadius * cRadius)
+            found.push_back(std::uint32_t(i));
+        sum += double(found.size());
+      }
+      return sum;
+    });
+    workload("KdTree::radiusSearch (r = 0.5)", cQueries, [&]() {
+      double sum = 0.0;
+      for(std::size_t q = 0; q < cQueries; q++)
+        sum += double(tree.radiusSearch(queries[q], cRadius, found));
+      return sum;
+    });
+    workload("KdTree::radiusSearchBatch (r = 0.5)", cQueries, [&]() {
+      tree.radiusSearchBatch(queries.data(), cQueries, cRadius, found, offsets);
+      return double(found.size());
+    });
+  }
+
+  //Linear blend skinning of a mesh of 1M vertices, as a loop over influences and with
+  //skinBatch, next to dual quaternion skinning of the same rig
+  void benchSkinning()
+  {
+    if(gOptions.mode != "all" && gOptions.mode != "workload")
+      return;
+
+    const std::size_t cVertices = std::size_t(1) << 20;
+    std::vector<Vector> points(cVertices), normals(cVertices), outPoints(cVertices), outNormals(cVertices);
+    for(std::size_t i = 0; i < cVertices; i++)
+    {
+      points[i] = randomVector() * 10.0f;
+      normals[i] = randomVector().normalize();
+    }
+    VectorBatch p(points.data(), cVertices), n(normals.data(), cVertices), outP, outN;
+    SkinData s4(cVertices, 4), s8(cVertices, 8);
+
+    //Matrix::operator* ignores the translation, so it is added by hand
+    workload("skinning (Matrix * Vector per bone, 4 bones)", cVertices, [&]() {
+      for(std::size_t i = 0; i < cVertices; i++)
+      {
+        Vector q, r;
+        for(int k = 0; k < 4; k++)
+        {
+          const Matrix& m = s4.palette[s4.indices[4 * i + k]];
+          const float w = s4.weights[4 * i + k];
+          q += (m * points[i] + Vector(m[12], m[13], m[14])) * w;
+          r += (m * normals[i]) * w;
+        }
+        outPoints[i] = q;
+        outNormals[i] = r.normalize();
+      }
+      return checksum(outPoints[cVertices - 1]) + checksum(outNormals[cVertices - 1]);
+    });
+    workload("skinBatch (Matrix, 4 bones)", cVertices, [&]() {
+      skinBatch(s4.palette.data(), s4.indices.data(), s4.weights.data(), 4, p, n, outP, outN);
+      return checksum(outP.get(cVertices - 1)) + checksum(outN.get(cVertices - 1));
+    });
+    workload("skinBatch (Matrix, 4 bones, positions only)", cVertices, [&]() {
+      skinBatch(s4.palette.data(), s4.indices.data(), s4.weights.data(), 4, p, outP);
+      return checksum(outP.get(cVertices - 1));
+    });
+    workload("skinBatch (Matrix, 8 bones)", cVertices, [&]() {
+      skinBatch(s8.palette.data(), s8.indices.data(), s8.weights.data(), 8, p, n, outP, outN);
+      return checksum(outP.get(cVertices - 1)) + checksum(outN.get(cVertices - 1));
+    });
+    workload("skinBatch (DualQuaternion, 4 bones)", cVertices, [&]() {
+      skinBatch(s4.bones.data(), s4.indices.data(), s4.weights.data(), points.data(), outPoints.data(), cVertices,
+                normals.data(), outNormals.data());
+      return checksum(outPoints[cVertices - 1]) + checksum(outNormals[cVertices - 1]);
+    });
+  }
+
+  //Escape string for JSON
+  std::string escape(const std::string& s)
+  {
+    std::string res;
+    for(std::size_t i = 0; i < s.size(); i++)
+    {
+      if(s[i] == '"' || s[i] == '\\')
+        res += '\\';
+      if(s[i] >= 0 && s[i] < 0x20)
+        continue;
+      res += s[i];
+    }
+    return res;
+  }
+
+  const char* buildMode()
+  {
+#if defined(SKMATH_HEADER_ONLY) && defined(SKMATH_PROFILE)
+    return "header-only, profiled";
+#elif defined(SKMATH_HEADER_ONLY)
+    return "header-only";
+#elif defined(SKMATH_PROFILE)
+    return "compiled, profiled";
+#else
+    return "compiled";
+#endif
+  }
+
+  const char* simdLevel()
+  {
+#if defined(SKMATH_AVX2) && defined(SKMATH_FMA)
+    return "avx2+fma";
+#elif defined(SKMATH_AVX)
+    return "avx";
+#elif defined(SKMATH_SSE)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+  }
+
+  const char* compiler()
+  {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc";
+#else
+    return "unknown";
+#endif
+  }
+
+  //Write results as JSON, returns false if file can not be written
+  bool writeJson(const std::string& path)
+  {
+    FILE* file = path == "-" ? stdout : fopen(path.c_str(), "w");
+    if(!file)
+      return false;
+
+    fprintf(file, "{\n  \"context\": {\n");
+    fprintf(file, "    \"library\": \"skmath\",\n");
+    fprintf(file, "    \"build\": \"%s\",\n", buildMode());
+    fprintf(file, "    \"simd\": \"%s\",\n", simdLevel());
+    fprintf(file, "    \"compiler\": \"%s\",\n", escape(compiler()).c_str());
+    fprintf(file, "    \"threads\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(file, "    \"size\": %zu,\n", gOptions.size);
+    fprintf(file, "    \"samples\": %d\n", cSamples);
+    fprintf(file, "  },\n  \"benchmarks\": [\n");
+    for(std::size_t i = 0; i < gResults.size(); i++)
+    {
+      const Result& r = gResults[i];
+      fprintf(file, "    {\"name\": \"%s\", \"mode\": \"%s\", \"ns_per_op\": %.6g, \"ops_per_second\": %.6g, "
+        "\"ops\": %zu, \"iterations\": %zu, \"checksum\": %.9g",
+        escape(r.name).c_str(), r.mode.c_str(), r.ns, 1e9 / r.ns, r.ops, r.iterations, r.checksum);
+      if(r.threads)
+        fprintf(file, ", \"threads\": %zu, \"ops_per_second_per_thread\": %.6g", r.threads, 1e9 / r.ns / r.threads);
+      if(r.bytes)
+        fprintf(file, ", \"bytes_per_op\": %zu, \"mb_per_second\": %.6g", r.bytes, 1e3 * r.bytes / r.ns);
+      if(r.misses >= 0.0)
+        fprintf(file, ", \"cache_misses_per_op\": %.6g", r.misses);
+      fprintf(file, "}%s\n", i + 1 < gResults.size() ? "," : "");
+    }
+    fprintf(file, "  ],\n  \"accuracy\": [\n");
+    for(std::size_t i = 0; i < gChecks.size(); i++)
+    {
+      const Check& c = gChecks[i];
+      fprintf(file, "    {\"name\": \"%s\", \"unit\": \"%s\", \"error\": %.6g, \"bound\": %.6g, \"pass\": %s}%s\n",
+        escape(c.name).c_str(), c.unit.c_str(), c.error, c.bound, c.error <= c.bound ? "true" : "false",
+        i + 1 < gChecks.size() ? "," : "");
+    }
+    fprintf(file, "  ],\n  \"statistics\": [\n");
+    for(std::size_t i = 0; i < gStatistics.size(); i++)
+    {
+      const Statistic& s = gStatistics[i];
+      fprintf(file, "    {\"name\": \"%s\", \"mode\": \"%s\", \"unit\": \"%s\", \"value\": %.6g}%s\n",
+        escape(s.name).c_str(), s.mode.c_str(), s.unit.c_str(), s.value, i + 1 < gStatistics.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    if(file != stdout)
+      fclose(file);
+    return true;
+  }
+
+  //Parse "--name=value" option, returns true and sets value if arg is option name
+  bool option(const char* arg, const char* name, std::string& value)
+  {
+    std::size_t len = strlen(name);
+    if(strncmp(arg, name, len) != 0 || arg[len] != '=')
+      return false;
+
+    value = arg + len + 1;
+    return true;
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  gOptions.mode = "all";
+  gOptions.size = std::size_t(1) << 18;
+  gOptions.minTime = 0.01;
+  gOptions.threads = parallelThreads();
+  gOptions.list = false;
+
+  for(int i = 1; i < argc; i++)
+  {
+    std::string value;
+    if(option(argv[i], "--mode", value))
+      gOptions.mode = value;
+    else if(option(argv[i], "--filter", value))
+      gOptions.filter = value;
+    else if(option(argv[i], "--json", value))
+      gOptions.json = value;
+    else if(option(argv[i], "--size", value))
+      gOptions.size = std::max<std::size_t>(std::strtoul(value.c_str(), NULL, 10), cJoints);
+    else if(option(argv[i], "--min-time", value))
+      gOptions.minTime = std::atof(value.c_str()) / 1000.0;
+    else if(option(argv[i], "--threads", value))
+      gOptions.threads = std::max<std::size_t>(std::strtoul(value.c_str(), NULL, 10), 1);
+    else if(strcmp(argv[i], "--list") == 0)
+      gOptions.list = true;
+    else
+    {
+      fprintf(stderr, "usage: %s [--mode=latency|throughput|accuracy|workload|all] [--filter=TEXT] "
+        "[--json=FILE|-] [--size=N] [--min-time=MS] [--threads=N] [--list]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  if(gOptions.mode != "all" && gOptions.mode != "latency" && gOptions.mode != "throughput" &&
+     gOptions.mode != "accuracy" && gOptions.mode != "workload")
+  {
+    fprintf(stderr, "unknown mode %s\n", gOptions.mode.c_str());
+    return 1;
+  }
+
+  gZero = gZeroSource;
+  if(gOptions.json == "-")
+    gOut = stderr;
+
+  if(!gOptions.list)
+    fprintf(gOut, "skmath %s, %s, %u threads, %zu elements\n", buildMode(), simdLevel(),
+      std::thread::hardware_concurrency(), gOptions.size);
+
+  Data data(gOptions.list ? cJoints : gOptions.size);
+  benchVector(data);
+  benchMatrix(data);
+  benchQuaternion(data);
+  benchDualQuaternion(data);
+  benchAABB(data);
+  benchFrustum(data);
+  benchFastMath(data);
+  benchQuantize(data);
+  benchMemory(data);
+  benchThreads(data);
+  benchShapes();
+  benchWorkloads(data);
+  benchPoseFile(data);
+  benchSkinning();
+  benchKdTree();
+  checkFastMath();
+  checkConversions();
+  checkQuantize();
+  checkDualQuaternion();
+  checkTransform();
+  checkSkinning();
+  checkAABB();
+  checkFrustum();
+  checkKdTree();
+
+  if(!gOptions.json.empty() && !gOptions.list && !writeJson(gOptions.json))
+  {
+    fprintf(stderr, "can not write %s\n", gOptions.json.c_str());
+    return 1;
+  }
+
+  for(std::size_t i = 0; i < gChecks.size(); i++)
+    if(!(gChecks[i].error <= gChecks[i].bound))
+      return 1;
+
+  return 0;
+}
@@ -0,0 +1,148 @@
+/**
+* @file call_overhead.cpp
+* @author skwo
+* @brief Benchmark of the per-call cost of the small Vector, Matrix and Quaternion operations.
+*
+* Build it twice and compare the timings, the checksums must be identical:
+* @code
+* g++ -O2 -std=c++17 -I. bench/call_overhead.cpp vector.cpp matrix.cpp quaternion.cpp -o call_overhead
+* g++ -O2 -std=c++17 -I. -DSKMATH_HEADER_ONLY bench/call_overhead.cpp -o call_overhead_inline
+* @endcode
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "quaternion.hpp"
+
+using namespace skmath;
+
+namespace{
+
+  const int cCount = 1 << 16;
+  const int cRepeat = 64;
+
+  typedef std::chrono::steady_clock Clock;
+
+  //Run func cRepeat times and print nanoseconds per operation
+  template<typename Func>
+  void run(const char* name, Func func)
+  {
+    float checksum = 0.0f;
+    Clock::time_point start = Clock::now();
+    for(int r = 0; r < cRepeat; r++)
+      checksum += func();
+    Clock::time_point end = Clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-28s %8.3f ns/op  checksum %.6e\n", name, ns / (double(cRepeat) * cCount), checksum);
+  }
+
+  //Sum of vector components, keeps results alive
+  float sum(const std::vector<Vector>& v)
+  {
+    float s = 0.0f;
+    for(size_t i = 0; i < v.size(); i++)
+      s += v[i][0] + v[i][1] + v[i][2];
+    return s;
+  }
+
+}
+
+int main()
+{
+#ifdef SKMATH_HEADER_ONLY
+  printf("mode: header-only\n");
+#else
+  printf("mode: compiled\n");
+#endif
+
+  std::vector<Vector> a(cCount), b(cCount), out(cCount);
+  std::vector<Matrix> ma(cCount), mb(cCount), mout(cCount);
+  std::vector<Quaternion> qa(cCount), qb(cCount), qout(cCount);
+
+  for(int i = 0; i < cCount; i++)
+  {
+    a[i] = Vector(0.5f + i % 7, 1.0f - i % 5, 0.25f * (i % 11));
+    b[i] = Vector(1.0f - i % 3, 0.75f * (i % 13), 2.0f - i % 17);
+    ma[i].createRotationX(float(i % 360));
+    mb[i].createRotationZ(float(i % 90));
+    qa[i].createRotation(Vector(0.0f, 1.0f, 0.0f), float(i % 360));
+    qb[i].createRotation(Vector(1.0f, 0.0f, 0.0f), float(i % 180));
+  }
+
+  run("Vector::operator+", [&]() {
+    for(int i = 0; i < cCount; i++)
+      out[i] = a[i] + b[i];
+    return sum(out);
+  });
+
+  run("Vector::operator* (cross)", [&]() {
+    for(int i = 0; i < cCount; i++)
+      out[i] = a[i] * b[i];
+    return sum(out);
+  });
+
+  run("Vector::dot", [&]() {
+    float s = 0.0f;
+    for(int i = 0; i < cCount; i++)
+      s += a[i].dot(b[i]);
+    return s;
+  });
+
+  run("Vector::normalize", [&]() {
+    for(int i = 0; i < cCount; i++)
+      out[i] = a[i].normalize();
+    return sum(out);
+  });
+
+  run("Matrix::operator[]", [&]() {
+    float s = 0.0f;
+    for(int i = 0; i < cCount; i++)
+      s += ma[i][0] + ma[i][5] + ma[i][10] + ma[i][15];
+    return s;
+  });
+
+  run("Matrix::operator* (Matrix)", [&]() {
+    float s = 0.0f;
+    for(int i = 0; i < cCount; i++)
+    {
+      mout[i] = ma[i] * mb[i];
+      s += mout[i][0];
+    }
+    return s;
+  });
+
+  run("Matrix::operator* (Vector)", [&]() {
+    for(int i = 0; i < cCount; i++)
+      out[i] = ma[i] * a[i];
+    return sum(out);
+  });
+
+  run("Quaternion::operator*", [&]() {
+    float s = 0.0f;
+    for(int i = 0; i < cCount; i++)
+    {
+      qout[i] = qa[i] * qb[i];
+      s += qout[i][3];
+    }
+    return s;
+  });
+
+  run("rotate", [&]() {
+    for(int i = 0; i < cCount; i++)
+      out[i] = rotate(qa[i], a[i]);
+    return sum(out);
+  });
+
+  run("std::vector<Vector> copy", [&]() {
+    std::vector<Vector> copy(a);
+    return copy[cCount - 1][0];
+  });
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+/**
+* @file expression.cpp
+* @author skwo
+* @brief Benchmark of fused (lazy expression) against unfused (operator by operator) chains.
+*
+* @code
+* g++ -O2 -std=c++17 -pthread -I. bench/expression.cpp vector.cpp matrix.cpp quaternion.cpp vectorbatch.cpp -o expression
+* @endcode
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "expression.hpp"
+
+using namespace skmath;
+
+namespace{
+
+  const int cCount = 1 << 20;
+  const int cRepeat = 16;
+
+  typedef std::chrono::steady_clock Clock;
+
+  //Run func cRepeat times and print nanoseconds per element
+  template<typename Func>
+  void run(const char* name, Func func)
+  {
+    float checksum = 0.0f;
+    Clock::time_point start = Clock::now();
+    for(int r = 0; r < cRepeat; r++)
+      checksum += func();
+    Clock::time_point end = Clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-36s %8.3f ns/element  checksum %.6e\n", name, ns / (double(cRepeat) * cCount), checksum);
+  }
+
+}
+
+int main()
+{
+  const float s = 0.5f;
+
+  std::vector<Vector> a(cCount), b(cCount), c(cCount), out(cCount);
+  for(int i = 0; i < cCount; i++)
+  {
+    a[i] = Vector(0.5f + i % 7, 1.0f - i % 5, 0.25f * (i % 11));
+    b[i] = Vector(1.0f - i % 3, 0.75f * (i % 13), 2.0f - i % 17);
+    c[i] = Vector(0.1f * (i % 19), 3.0f - i % 23, 1.0f + i % 29);
+  }
+
+  VectorBatch ba(a.data(), cCount), bb(b.data(), cCount), bc(c.data(), cCount);
+  VectorBatch tmp1, tmp2, bout;
+
+  run("VectorBatch a + b - c * s unfused", [&]() {
+    ba.add(bb, tmp1);
+    bc.scale(s, tmp2);
+    tmp1.sub(tmp2, bout);
+    return bout.x()[cCount - 1];
+  });
+
+  run("VectorBatch a + b - c * s fused", [&]() {
+    evaluate(bout, lazy(ba) + bb - lazy(bc) * s);
+    return bout.x()[cCount - 1];
+  });
+
+  run("Vector[] a + b - c * s unfused", [&]() {
+    for(int i = 0; i < cCount; i++)
+      out[i] = a[i] + b[i] - c[i] * s;
+    return out[cCount - 1][0];
+  });
+
+  run("Vector[] a + b - c * s fused", [&]() {
+    for(int i = 0; i < cCount; i++)
+      out[i] = lazy(a[i]) + b[i] - lazy(c[i]) * s;
+    return out[cCount - 1][0];
+  });
+
+  std::vector<Matrix> ma(cCount / 16), mb(cCount / 16), mout(cCount / 16);
+  for(size_t i = 0; i < ma.size(); i++)
+  {
+    ma[i].createRotationX(float(i % 360));
+    mb[i].createRotationY(float(i % 90));
+  }
+
+  run("Matrix[] a + b - a * s unfused (x16)", [&]() {
+    for(size_t r = 0; r < 16; r++)
+      for(size_t i = 0; i < ma.size(); i++)
+        mout[i] = ma[i] + mb[i] - ma[i] * s;
+    return mout[ma.size() - 1][5];
+  });
+
+  run("Matrix[] a + b - a * s fused (x16)", [&]() {
+    for(size_t r = 0; r < 16; r++)
+      for(size_t i = 0; i < ma.size(); i++)
+        mout[i] = lazy(ma[i]) + mb[i] - lazy(ma[i]) * s;
+    return mout[ma.size() - 1][5];
+  });
+
+  return 0;
+}
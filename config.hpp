@@ -0,0 +1,26 @@
+/**
+* @file config.hpp
+* @author skwo
+* @brief Build configuration of the library.
+*
+* Define <c>SKMATH_HEADER_ONLY</c> before including any library header (or pass
+* -DSKMATH_HEADER_ONLY to the compiler) to get every function defined inline in
+* the headers. Without it the definitions are compiled once into vector.cpp,
+* matrix.cpp and quaternion.cpp. Both configurations give identical results.
+*
+* The classes are templates. Compiled mode instantiates float and double vectors of 2, 3 and 4
+* components, 3x3 and 4x4 matrices and quaternions; other types and sizes need header-only mode.
+*/
+
+#ifndef CONFIG_HPP_INCLUDED
+#define CONFIG_HPP_INCLUDED
+
+#ifdef SKMATH_HEADER_ONLY
+  #define SKMATH_INLINE inline
+  #define SKMATH_CONSTEXPR constexpr
+#else
+  #define SKMATH_INLINE
+  #define SKMATH_CONSTEXPR
+#endif
+
+#endif // CONFIG_HPP_INCLUDED
@@ -0,0 +1,23 @@
+/**
+* @file dualquaternion.cpp
+* @author skwo
+* @brief Realization of dual quaternion class.
+*/
+
+#include "dualquaternion.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "dualquaternion.inl"
+
+namespace skmath{
+
+  template class BasicDualQuaternion<float>;
+  template class BasicDualQuaternion<double>;
+
+  template void dualQuaternionToMatrix(const DualQuaternionf&, Matrix4f&);
+  template void dualQuaternionToMatrix(const DualQuaterniond&, Matrix4d&);
+  template void matrixToDualQuaternion(const Matrix4f&, DualQuaternionf&);
+  template void matrixToDualQuaternion(const Matrix4d&, DualQuaterniond&);
+
+};
+#endif
@@ -0,0 +1,231 @@
+/**
+* @file dualquaternion.hpp
+* @author skwo
+* @brief Defenition of dual quaternion class.
+*
+* BasicDualQuaternion<T> is a rigid transform, rotation and translation, as a dual quaternion
+* r + e d of two BasicQuaternion<T>: the real part r is the rotation, the dual part is
+* d = 0.5 * (0, t) * r for translation t. A point is rotated as rotate(r, p), then translated.
+* Dual quaternions blend without the shrinking of blended matrices, which makes them the
+* transform of choice for skinning. DualQuaternion is the float dual quaternion.
+*/
+
+#ifndef DUALQUATERNION_HPP_INCLUDED
+#define DUALQUATERNION_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "config.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "quaternion.hpp"
+
+namespace skmath{
+
+  template<typename T>
+  class alignas(detail::Alignment<T, 8>::value) BasicDualQuaternion{
+    static_assert(std::is_floating_point<T>::value, "BasicDualQuaternion needs a floating point type");
+
+    public:
+      typedef T Scalar;
+
+      /** Constructor. Create identity dual quaternion, (1, [0,0,0]) + e (0, [0,0,0]). */
+      SKMATH_CONSTEXPR BasicDualQuaternion();
+
+      /** Constructor. Create dual quaternion from its parts.
+      * @param real Real part.
+      * @param dual Dual part.
+      */
+      SKMATH_CONSTEXPR BasicDualQuaternion(const BasicQuaternion<T>& real, const BasicQuaternion<T>& dual);
+
+      /** Constructor. Create rigid transform, rotation then translation.
+      * @param rotation Unit quaternion of the rotation.
+      * @param translation Translation.
+      */
+      BasicDualQuaternion(const BasicQuaternion<T>& rotation, const BasicVector<T, 3>& translation);
+
+      /** Get real part.
+      * @return Const real part, the rotation.
+      */
+      SKMATH_CONSTEXPR const BasicQuaternion<T>& real() const;
+
+      /** Get real part.
+      * @return Real part, the rotation.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion<T>& real();
+
+      /** Get dual part.
+      * @return Const dual part.
+      */
+      SKMATH_CONSTEXPR const BasicQuaternion<T>& dual() const;
+
+      /** Get dual part.
+      * @return Dual part.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion<T>& dual();
+
+      /** Get rotation.
+      * @return Rotation, the real part.
+      */
+      SKMATH_CONSTEXPR const BasicQuaternion<T>& rotation() const;
+
+      /** Get translation, the vector part of 2 * d * r*.
+      * @return Translation, of a unit dual quaternion.
+      */
+      BasicVector<T, 3> translation() const;
+
+      /** Normalize. Divide by the magnitude of the real part, and remove the part of the dual
+      * part along the real one, so the result is a rigid transform again after blending.
+      * @return Unit dual quaternion.
+      */
+      BasicDualQuaternion normalize() const;
+
+      /** Conjugate, the quaternion conjugate of both parts.
+      * @return Conjugated dual quaternion.
+      */
+      SKMATH_CONSTEXPR BasicDualQuaternion conjugate() const;
+
+      /** Inverse, r^-1 + e (-r^-1 * d * r^-1). For a unit dual quaternion it equals conjugate().
+      * @return Inversed dual quaternion.
+      */
+      BasicDualQuaternion inverse() const;
+
+      /** Transform point, rotate then translate.
+      * @param point Point to transform.
+      * @return Transformed point, of a unit dual quaternion.
+      */
+      BasicVector<T, 3> transformPoint(const BasicVector<T, 3>& point) const;
+
+      /** Transform vector, rotate only.
+      * @param vec Vector to transform.
+      * @return Rotated vector, of a unit dual quaternion.
+      */
+      BasicVector<T, 3> transformVector(const BasicVector<T, 3>& vec) const;
+
+      /** Equal to operator.
+      * @param rhs Right value dual quaternion.
+      * @return True if all components are equal.
+      */
+      bool operator ==(const BasicDualQuaternion& rhs) const;
+
+      /** Not equal to operator.
+      * @param rhs Right value dual quaternion.
+      * @return True if any component differs.
+      */
+      bool operator !=(const BasicDualQuaternion& rhs) const;
+
+      /** Addition operator.
+      * @param rhs Right value dual quaternion.
+      * @return New dual quaternion, the sum of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicDualQuaternion operator +(const BasicDualQuaternion& rhs) const;
+
+      /** Multiplication operator. Composition, <c>rhs</c> is applied first.
+      * @param rhs Right value dual quaternion.
+      * @return New dual quaternion, the product of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicDualQuaternion operator *(const BasicDualQuaternion& rhs) const;
+
+      /** Multiplication operator.
+      * @param rhs Right value scalar.
+      * @return New dual quaternion, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicDualQuaternion operator *(const T& rhs) const;
+
+      /** Addition assign operator.
+      * @param rhs Right value dual quaternion.
+      * @return reference to <c>this</c>, the sum of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicDualQuaternion& operator +=(const BasicDualQuaternion& rhs);
+
+      /** Multiplication assign operator.
+      * @param rhs Right value dual quaternion.
+      * @return reference to <c>this</c>, the product of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicDualQuaternion& operator *=(const BasicDualQuaternion& rhs);
+
+      /** Multiplication assign operator.
+      * @param rhs Right value scalar.
+      * @return reference to <c>this</c>, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicDualQuaternion& operator *=(const T& rhs);
+
+    private:
+      BasicQuaternion<T> _real; /**< Real part, the rotation. */
+      BasicQuaternion<T> _dual; /**< Dual part, 0.5 * (0, t) * r. */
+  };
+
+
+  typedef BasicDualQuaternion<float> DualQuaternionf;
+  typedef BasicDualQuaternion<double> DualQuaterniond;
+  typedef DualQuaternionf DualQuaternion;
+
+  static_assert(sizeof(DualQuaternion) == 8 * sizeof(float), "DualQuaternion must be packed, real then dual");
+  static_assert(std::is_trivially_copyable<DualQuaternion>::value, "DualQuaternion must be trivially copyable");
+  static_assert(std::is_standard_layout<DualQuaternion>::value, "DualQuaternion must be standard layout");
+
+
+  /** Dual quaternion to Matrix. Convert rigid transform to the 4x4 matrix with the same effect
+  * on points through transformPoints: the rotation part is quaternionToMatrix of the conjugated
+  * real part, since quaternionToMatrix turns the other way than rotate, and the translation is
+  * in the last column, as Transform::toMatrix.
+  * @param dq Unit dual quaternion to convert.
+  * @param m Matrix to store converted dual quaternion in.
+  */
+  template<typename T>
+  void dualQuaternionToMatrix(const BasicDualQuaternion<T>& dq, BasicMatrix<T, 4, 4>& m);
+
+  /** Matrix to dual quaternion, the inverse of dualQuaternionToMatrix.
+  * @param m Rigid transform, rotation and translation, without scale.
+  * @param dq Dual quaternion to store converted matrix in.
+  */
+  template<typename T>
+  void matrixToDualQuaternion(const BasicMatrix<T, 4, 4>& m, BasicDualQuaternion<T>& dq);
+
+  /** Dual quaternion to matrix batch. Convert to packed 3x4 affine matrices, as
+  * dualQuaternionToMatrix without the constant last row, or as quaternionToMatrixBatch of the
+  * real parts with the translations. Dual quaternions are transposed into SIMD
+  * registers 8 (AVX) or 4 (SSE) at a time, and large inputs are split across threads.
+  * @param in Array of <c>size</c> unit dual quaternions.
+  * @param out Array of 12 * <c>size</c> floats to store the matrices in.
+  * @param size Number of dual quaternions.
+  * @param layout Layout of the matrices in <c>out</c>.
+  * @param nonTemporal Write <c>out</c> with streaming stores, see quaternionToMatrixBatch.
+  */
+  void dualQuaternionToMatrixBatch(const DualQuaternion* in, float* out, std::size_t size,
+                                   MatrixLayout layout = cRowMajor, bool nonTemporal = false);
+
+  /** Most bones influencing a vertex in skinBatch. */
+  const int cSkinInfluences = 4;
+
+  /** Dual quaternion skinning batch. Blend the bones of every vertex by its weights, negating
+  * bones on the other hemisphere than the first one, normalize the blend and transform the
+  * position, and rotate the normal, with it. Blends are transposed into SIMD registers 8 (AVX)
+  * or 4 (SSE) vertices at a time, and large inputs are split across threads.
+  * @param bones Palette of unit dual quaternions, bone space to model space.
+  * @param indices Array of <c>cSkinInfluences</c> * <c>size</c> bone indices, those of vertex
+  * i from <c>cSkinInfluences</c> * i.
+  * @param weights Array of <c>cSkinInfluences</c> * <c>size</c> weights, laid out as
+  * <c>indices</c>. Unused influences have weight 0 and any valid index; every vertex needs a
+  * weight that is not 0.
+  * @param positions Array of <c>size</c> positions.
+  * @param outPositions Array of <c>size</c> vectors to store the skinned positions in, may be
+  * <c>positions</c>.
+  * @param size Number of vertices.
+  * @param normals Array of <c>size</c> normals, or nullptr for none.
+  * @param outNormals Array of <c>size</c> vectors to store the skinned normals in, may be
+  * <c>normals</c>; only written when <c>normals</c> is given.
+  */
+  void skinBatch(const DualQuaternion* bones, const std::uint16_t* indices, const float* weights,
+                 const Vector* positions, Vector* outPositions, std::size_t size,
+                 const Vector* normals = nullptr, Vector* outNormals = nullptr);
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "dualquaternion.inl"
+#endif
+
+#endif // DUALQUATERNION_HPP_INCLUDED
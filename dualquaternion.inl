@@ -0,0 +1,428 @@
+/**
+* @file dualquaternion.inl
+* @author skwo
+* @brief Realization of dual quaternion class.
+* @note Included by dualquaternion.cpp, or by dualquaternion.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <cmath>
+#include <cstdint>
+
+#include "parallel.hpp"
+#include "profile.hpp"
+#include "simd.hpp"
+
+namespace skmath{
+
+  //Constructor
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicDualQuaternion<T>::BasicDualQuaternion()
+    : _real(), _dual(T(0), BasicVector<T, 3>())
+  {
+  }
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicDualQuaternion<T>::BasicDualQuaternion(const BasicQuaternion<T>& real,
+                                                                           const BasicQuaternion<T>& dual)
+    : _real(real), _dual(dual)
+  {
+  }
+  template<typename T>
+  SKMATH_INLINE BasicDualQuaternion<T>::BasicDualQuaternion(const BasicQuaternion<T>& rotation,
+                                                          const BasicVector<T, 3>& translation)
+    : _real(rotation), _dual(BasicQuaternion<T>(T(0), translation) * rotation * T(0.5))
+  {
+  }
+
+  //Get real part
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE const BasicQuaternion<T>& BasicDualQuaternion<T>::real() const
+  {
+    return _real;
+  }
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T>& BasicDualQuaternion<T>::real()
+  {
+    return _real;
+  }
+
+  //Get dual part
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE const BasicQuaternion<T>& BasicDualQuaternion<T>::dual() const
+  {
+    return _dual;
+  }
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T>& BasicDualQuaternion<T>::dual()
+  {
+    return _dual;
+  }
+
+  //Get rotation
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE const BasicQuaternion<T>& BasicDualQuaternion<T>::rotation() const
+  {
+    return _real;
+  }
+
+  //Get translation
+  template<typename T>
+  SKMATH_INLINE BasicVector<T, 3> BasicDualQuaternion<T>::translation() const
+  {
+    //Vector part of d * r*: rw dv - dw rv + rv x dv
+    return (_dual.v() * _real.w() - _real.v() * _dual.w() + _real.v() * _dual.v()) * T(2);
+  }
+
+  //Normalize
+  template<typename T>
+  SKMATH_INLINE BasicDualQuaternion<T> BasicDualQuaternion<T>::normalize() const
+  {
+    const T mag = _real.magnitude();
+    BasicQuaternion<T> r = _real / mag;
+    BasicQuaternion<T> d = _dual / mag;
+
+    return BasicDualQuaternion(r, d - r * r.inner(d));
+  }
+
+  //Conjugate
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicDualQuaternion<T> BasicDualQuaternion<T>::conjugate() const
+  {
+    return BasicDualQuaternion(_real.conjugate(), _dual.conjugate());
+  }
+
+  //Inverse
+  template<typename T>
+  SKMATH_INLINE BasicDualQuaternion<T> BasicDualQuaternion<T>::inverse() const
+  {
+    BasicQuaternion<T> r = _real.inverse();
+
+    return BasicDualQuaternion(r, r * _dual * r * T(-1));
+  }
+
+  //Transform point
+  template<typename T>
+  SKMATH_INLINE BasicVector<T, 3> BasicDualQuaternion<T>::transformPoint(const BasicVector<T, 3>& point) const
+  {
+    return rotateFast(_real, point) + translation();
+  }
+
+  //Transform vector
+  template<typename T>
+  SKMATH_INLINE BasicVector<T, 3> BasicDualQuaternion<T>::transformVector(const BasicVector<T, 3>& vec) const
+  {
+    return rotateFast(_real, vec);
+  }
+
+  //Operator ==
+  template<typename T>
+  SKMATH_INLINE bool BasicDualQuaternion<T>::operator ==(const BasicDualQuaternion& rhs) const
+  {
+    return _real == rhs.real() && _dual == rhs.dual();
+  }
+
+  //Operator !=
+  template<typename T>
+  SKMATH_INLINE bool BasicDualQuaternion<T>::operator !=(const BasicDualQuaternion& rhs) const
+  {
+    return !(*this == rhs);
+  }
+
+  //Operator +
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicDualQuaternion<T> BasicDualQuaternion<T>::operator +(const BasicDualQuaternion& rhs) const
+  {
+    return BasicDualQuaternion(_real + rhs.real(), _dual + rhs.dual());
+  }
+
+  //Operator *
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicDualQuaternion<T> BasicDualQuaternion<T>::operator *(const BasicDualQuaternion& rhs) const
+  {
+    return BasicDualQuaternion(_real * rhs.real(), _real * rhs.dual() + _dual * rhs.real());
+  }
+
+  //Operator *
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicDualQuaternion<T> BasicDualQuaternion<T>::operator *(const T& rhs) const
+  {
+    return BasicDualQuaternion(_real * rhs, _dual * rhs);
+  }
+
+  //Operator +=
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicDualQuaternion<T>& BasicDualQuaternion<T>::operator +=(const BasicDualQuaternion& rhs)
+  {
+    _real += rhs.real();
+    _dual += rhs.dual();
+
+    return *this;
+  }
+
+  //Operator *=
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicDualQuaternion<T>& BasicDualQuaternion<T>::operator *=(const BasicDualQuaternion& rhs)
+  {
+    *this = *this * rhs;
+
+    return *this;
+  }
+
+  //Operator *=
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicDualQuaternion<T>& BasicDualQuaternion<T>::operator *=(const T& rhs)
+  {
+    _real *= rhs;
+    _dual *= rhs;
+
+    return *this;
+  }
+
+  //Dual quaternion to matrix
+  template<typename T>
+  SKMATH_INLINE void dualQuaternionToMatrix(const BasicDualQuaternion<T>& dq, BasicMatrix<T, 4, 4>& m)
+  {
+    quaternionToMatrix(dq.real().conjugate(), m);
+
+    const BasicVector<T, 3> t = dq.translation();
+    m(0, 3) = t[0];
+    m(1, 3) = t[1];
+    m(2, 3) = t[2];
+  }
+
+  //Matrix to dual quaternion
+  template<typename T>
+  SKMATH_INLINE void matrixToDualQuaternion(const BasicMatrix<T, 4, 4>& m, BasicDualQuaternion<T>& dq)
+  {
+    BasicQuaternion<T> q;
+    matrixToQuaternion(m, q);
+
+    dq = BasicDualQuaternion<T>(q.conjugate(), BasicVector<T, 3>(m(0, 3), m(1, 3), m(2, 3)));
+  }
+
+  namespace detail{
+
+    //Translations of cWidth unit dual quaternions r + e d, the vector part of 2 * d * r*
+    SKMATH_INLINE void dualTranslations(simd::Float rw, simd::Float rx, simd::Float ry, simd::Float rz,
+                                        simd::Float dw, simd::Float dx, simd::Float dy, simd::Float dz,
+                                        simd::Float* t)
+    {
+      using simd::Float;
+      using simd::add;
+      using simd::sub;
+      using simd::mul;
+
+      //rw dv - dw rv + rv x dv
+      Float tx = add(sub(mul(rw, dx), mul(dw, rx)), sub(mul(ry, dz), mul(rz, dy)));
+      Float ty = add(sub(mul(rw, dy), mul(dw, ry)), sub(mul(rz, dx), mul(rx, dz)));
+      Float tz = add(sub(mul(rw, dz), mul(dw, rz)), sub(mul(rx, dy), mul(ry, dx)));
+
+      t[0] = add(tx, tx);
+      t[1] = add(ty, ty);
+      t[2] = add(tz, tz);
+    }
+
+    //Rotate cWidth vectors x, y, z by unit quaternions w, qx, qy, qz, as rotateFast
+    SKMATH_INLINE void rotateVectors(simd::Float w, simd::Float qx, simd::Float qy, simd::Float qz,
+                                     simd::Float& x, simd::Float& y, simd::Float& z)
+    {
+      using simd::Float;
+      using simd::add;
+      using simd::sub;
+      using simd::mul;
+      using simd::madd;
+
+      //t = 2 * (v x p)
+      Float tx = sub(mul(qy, z), mul(qz, y));
+      Float ty = sub(mul(qz, x), mul(qx, z));
+      Float tz = sub(mul(qx, y), mul(qy, x));
+      tx = add(tx, tx);
+      ty = add(ty, ty);
+      tz = add(tz, tz);
+
+      //p + w * t + v x t
+      Float rx = add(madd(w, tx, x), sub(mul(qy, tz), mul(qz, ty)));
+      Float ry = add(madd(w, ty, y), sub(mul(qz, tx), mul(qx, tz)));
+      Float rz = add(madd(w, tz, z), sub(mul(qx, ty), mul(qy, tx)));
+      x = rx;
+      y = ry;
+      z = rz;
+    }
+
+    //Blend of the bones of a vertex into 8 floats, real then dual part, each w, x, y, z
+    SKMATH_INLINE void blendBones(const DualQuaternion* bones, const std::uint16_t* indices, const float* weights,
+                                  float* out)
+    {
+      const float* first = &bones[indices[0]].real().w();
+
+      for(int c = 0; c < 8; c++)
+        out[c] = 0.0f;
+
+      for(int k = 0; k < cSkinInfluences; k++)
+      {
+        const float* real = &bones[indices[k]].real().w();
+        const float* dual = &bones[indices[k]].dual().w();
+        const float inner = real[0] * first[0] + real[1] * first[1] + real[2] * first[2] + real[3] * first[3];
+        const float w = inner < 0.0f ? -weights[k] : weights[k];
+
+        for(int c = 0; c < 4; c++)
+        {
+          out[c] += w * real[c];
+          out[4 + c] += w * dual[c];
+        }
+      }
+    }
+
+    //Skin cWidth vertices with their blends, 8 floats each, and packed positions and normals
+    SKMATH_INLINE void skinVertices(const float* blends, const float* positions, const float* normals,
+                                    float* outPositions, float* outNormals)
+    {
+      using simd::Float;
+      using simd::add;
+      using simd::mul;
+      using simd::madd;
+      using simd::set1;
+
+      Float rw, rx, ry, rz, dw, dx, dy, dz, t[3], x, y, z;
+      simd::loadRecords(blends, 8, rw, rx, ry, rz);
+      simd::loadRecords(blends + 4, 8, dw, dx, dy, dz);
+
+      //Normalize by the real part; the translation, the vector part of d * r*, is the same
+      //without the part of d along r, so that needs no removing
+      Float norm = madd(rw, rw, madd(rx, rx, madd(ry, ry, mul(rz, rz))));
+      Float scale = simd::div(set1(1.0f), simd::sqrt(norm));
+      rw = mul(rw, scale);
+      rx = mul(rx, scale);
+      ry = mul(ry, scale);
+      rz = mul(rz, scale);
+      dw = mul(dw, scale);
+      dx = mul(dx, scale);
+      dy = mul(dy, scale);
+      dz = mul(dz, scale);
+      dualTranslations(rw, rx, ry, rz, dw, dx, dy, dz, t);
+
+      simd::loadVectors(positions, x, y, z);
+      rotateVectors(rw, rx, ry, rz, x, y, z);
+      simd::storeVectors(outPositions, add(x, t[0]), add(y, t[1]), add(z, t[2]));
+
+      if(normals)
+      {
+        simd::loadVectors(normals, x, y, z);
+        rotateVectors(rw, rx, ry, rz, x, y, z);
+        simd::storeVectors(outNormals, x, y, z);
+      }
+    }
+
+  };
+
+  //Dual quaternion to matrix batch
+  SKMATH_INLINE void dualQuaternionToMatrixBatch(const DualQuaternion* in, float* out, std::size_t size,
+                                                 MatrixLayout layout, bool nonTemporal)
+  {
+    using simd::cWidth;
+
+    //Records are 48 bytes, so one aligned record keeps all of them aligned
+    nonTemporal = nonTemporal && (reinterpret_cast<std::uintptr_t>(out) & 15) == 0;
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      const simd::Float s[3] = { simd::set1(1.0f), simd::set1(1.0f), simd::set1(1.0f) };
+      simd::Float rw, rx, ry, rz, dw, dx, dy, dz, t[3];
+      std::size_t i = begin;
+
+      //packedMatrices turns as rotate, as dualQuaternionToMatrix
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        simd::loadRecords(&in[i].real().w(), 8, rw, rx, ry, rz);
+        simd::loadRecords(&in[i].dual().w(), 8, dw, dx, dy, dz);
+        detail::dualTranslations(rw, rx, ry, rz, dw, dx, dy, dz, t);
+
+        detail::packedMatrices(rw, rx, ry, rz, t, s, layout, out + 12 * i, nonTemporal);
+      }
+
+      //Last partial group through a full one on the stack, padded with identities
+      if(i < end)
+      {
+        const std::size_t n = end - i;
+        alignas(16) float q[8 * cWidth], m[12 * cWidth];
+        for(std::size_t k = 0; k < cWidth; k++)
+        {
+          const DualQuaternion dq = k < n ? in[i + k] : DualQuaternion();
+          q[8 * k] = dq.real().w();
+          q[8 * k + 4] = dq.dual().w();
+          for(int c = 0; c < 3; c++)
+          {
+            q[8 * k + 1 + c] = dq.real()[c];
+            q[8 * k + 5 + c] = dq.dual()[c];
+          }
+        }
+
+        simd::loadRecords(q, 8, rw, rx, ry, rz);
+        simd::loadRecords(q + 4, 8, dw, dx, dy, dz);
+        detail::dualTranslations(rw, rx, ry, rz, dw, dx, dy, dz, t);
+        detail::packedMatrices(rw, rx, ry, rz, t, s, layout, m, false);
+
+        for(std::size_t k = 0; k < 12 * n; k++)
+          out[12 * i + k] = m[k];
+      }
+
+      if(nonTemporal)
+        simd::fence();
+    });
+  }
+
+  //Skin batch
+  SKMATH_INLINE void skinBatch(const DualQuaternion* bones, const std::uint16_t* indices, const float* weights,
+                               const Vector* positions, Vector* outPositions, std::size_t size,
+                               const Vector* normals, Vector* outNormals)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileSkinBatch);
+    using simd::cWidth;
+
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      alignas(simd::cAlignment) float blends[8 * cWidth];
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        for(std::size_t k = 0; k < cWidth; k++)
+          detail::blendBones(bones, indices + cSkinInfluences * (i + k), weights + cSkinInfluences * (i + k), blends + 8 * k);
+
+        detail::skinVertices(blends, &positions[i][0], normals ? &normals[i][0] : nullptr,
+                             &outPositions[i][0], normals ? &outNormals[i][0] : nullptr);
+      }
+
+      //Last partial group through a full one on the stack, padded with identities
+      if(i < end)
+      {
+        const std::size_t n = end - i;
+        float v[4][3 * cWidth];
+        for(std::size_t k = 0; k < cWidth; k++)
+        {
+          const bool valid = k < n;
+          if(valid)
+            detail::blendBones(bones, indices + cSkinInfluences * (i + k), weights + cSkinInfluences * (i + k), blends + 8 * k);
+          else
+          {
+            for(int c = 0; c < 8; c++)
+              blends[8 * k + c] = c == 0 ? 1.0f : 0.0f;
+          }
+
+          for(int c = 0; c < 3; c++)
+          {
+            v[0][3 * k + c] = valid ? positions[i + k][c] : 0.0f;
+            v[1][3 * k + c] = valid && normals ? normals[i + k][c] : 0.0f;
+          }
+        }
+
+        detail::skinVertices(blends, v[0], normals ? v[1] : nullptr, v[2], v[3]);
+
+        for(std::size_t k = 0; k < n; k++)
+        {
+          outPositions[i + k] = Vector(&v[2][3 * k]);
+          if(normals)
+            outNormals[i + k] = Vector(&v[3][3 * k]);
+        }
+      }
+    });
+  }
+
+};
@@ -0,0 +1,134 @@
+/**
+* @file euler.hpp
+* @author skwo
+* @brief Euler angle orders and the kernels composing their rotations.
+*
+* A rotation from Euler angles is built straight from the sines and cosines of the three angles:
+* each elementary rotation after the first mixes only two rows of the matrix, or two components
+* and w of the quaternion, so no full products are needed.
+*/
+
+#ifndef EULER_HPP_INCLUDED
+#define EULER_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace skmath{
+
+  /** Order of the rotations about the x, y and z axes. The first letter is applied first, so
+  * cEulerXYZ rotates about x, then y, then z: the matrix Z * Y * X, the quaternion z * y * x.
+  * Every order stores its axes two bits each, first axis in the low bits.
+  */
+  enum EulerOrder{
+    cEulerXYZ = 0 | 1 << 2 | 2 << 4,
+    cEulerXZY = 0 | 2 << 2 | 1 << 4,
+    cEulerYXZ = 1 | 0 << 2 | 2 << 4,
+    cEulerYZX = 1 | 2 << 2 | 0 << 4,
+    cEulerZXY = 2 | 0 << 2 | 1 << 4,
+    cEulerZYX = 2 | 1 << 2 | 0 << 4
+  };
+
+  /** Unit of angles. */
+  enum AngleUnit{
+    cDegrees,
+    cRadians
+  };
+
+  /** Max absolute error of the elements of fromEulerBatch, for angles up to 8192 radians. */
+  const float cFastEulerError = 3e-7f;
+
+  namespace detail{
+
+    //Axis of rotation k of order
+    constexpr int eulerAxis(int order, int k)
+    {
+      return (order >> (2 * k)) & 3;
+    }
+
+    //Call func(std::integral_constant<int, order>()), so the axes are compile time constants.
+    //Values outside EulerOrder are taken as cEulerXYZ.
+    template<typename Func>
+    inline void eulerDispatch(EulerOrder order, Func func)
+    {
+      switch(order)
+      {
+        case cEulerXZY: func(std::integral_constant<int, cEulerXZY>()); break;
+        case cEulerYXZ: func(std::integral_constant<int, cEulerYXZ>()); break;
+        case cEulerYZX: func(std::integral_constant<int, cEulerYZX>()); break;
+        case cEulerZXY: func(std::integral_constant<int, cEulerZXY>()); break;
+        case cEulerZYX: func(std::integral_constant<int, cEulerZYX>()); break;
+        default: func(std::integral_constant<int, cEulerXYZ>()); break;
+      }
+    }
+
+    //Angles sincosBatch works on at a time, on the stack
+    const std::size_t cEulerBlock = 256;
+
+    //Sines and cosines of n <= cEulerBlock angles of x, y and z, each multiplied by scale first
+    inline void eulerSinCos(const float* x, const float* y, const float* z, std::size_t n, float scale,
+                            float (&s)[3][cEulerBlock], float (&c)[3][cEulerBlock])
+    {
+      const float* angles[3] = { x, y, z };
+      float a[cEulerBlock];
+
+      for(int k = 0; k < 3; k++)
+      {
+        for(std::size_t i = 0; i < n; i++)
+          a[i] = angles[k][i] * scale;
+        sincosBatch(a, s[k], c[k], n);
+      }
+    }
+
+    //Rotation matrix m[row][col] of Order, from sines and cosines of the angles about x, y and z.
+    //Left multiplying by a rotation about axis a turns rows i = a + 1 and j = a + 2 (mod 3) only.
+    template<int Order, typename T>
+    inline void eulerMatrix(const T* s, const T* c, T (&m)[3][3])
+    {
+      constexpr int a = eulerAxis(Order, 0), i = (a + 1) % 3, j = (a + 2) % 3;
+
+      m[a][a] = T(1);  m[a][i] = T(0);   m[a][j] = T(0);
+      m[i][a] = T(0);  m[i][i] = c[a];   m[i][j] = -s[a];
+      m[j][a] = T(0);  m[j][i] = s[a];   m[j][j] = c[a];
+
+      unroll<2>([&](auto k) {
+        constexpr int b = eulerAxis(Order, k + 1), p = (b + 1) % 3, q = (b + 2) % 3;
+        unroll<3>([&](auto col) {
+          T mp = m[p][col], mq = m[q][col];
+          m[p][col] = c[b] * mp - s[b] * mq;
+          m[q][col] = s[b] * mp + c[b] * mq;
+        });
+      });
+    }
+
+    //Rotation quaternion q = (w, x, y, z) of Order, from sines and cosines of the half angles
+    //about x, y and z. Left multiplying by (c, s e_a) gives w' = c w - s v_a, v_a' = c v_a + s w,
+    //v_i' = c v_i - s v_j, v_j' = c v_j + s v_i.
+    template<int Order, typename T>
+    inline void eulerQuaternion(const T* s, const T* c, T (&q)[4])
+    {
+      constexpr int a = eulerAxis(Order, 0);
+
+      q[0] = c[a];
+      q[1] = T(0);
+      q[2] = T(0);
+      q[3] = T(0);
+      q[1 + a] = s[a];
+
+      unroll<2>([&](auto k) {
+        constexpr int b = eulerAxis(Order, k + 1), p = (b + 1) % 3, q1 = (b + 2) % 3;
+        T w = q[0], vb = q[1 + b], vp = q[1 + p], vq = q[1 + q1];
+        q[0] = c[b] * w - s[b] * vb;
+        q[1 + b] = c[b] * vb + s[b] * w;
+        q[1 + p] = c[b] * vp - s[b] * vq;
+        q[1 + q1] = c[b] * vq + s[b] * vp;
+      });
+    }
+
+  };
+
+};
+
+#endif // EULER_HPP_INCLUDED
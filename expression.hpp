@@ -0,0 +1,297 @@
+/**
+* @file expression.hpp
+* @author skwo
+* @brief Lazy element-wise expressions over vectors, quaternions, matrices and VectorBatch.
+*
+* The operators of the classes build a new object for every step, so <c>a + b - c * s</c>
+* makes three temporaries. Wrapping the operands with <c>lazy()</c> builds an expression
+* instead, and the whole chain is evaluated in one pass when it is assigned:
+* @code
+* Vector r = lazy(a) + b - lazy(c) * s;
+* evaluate(batchOut, lazy(batchA) + batchB - lazy(batchC) * s);  //one pass, no temporaries
+* @endcode
+* Only element-wise operations fuse: +, - and unary - between objects of the same type, and
+* * and / by a scalar. Cross, Hamilton and matrix products stay eager.
+* @note An expression keeps references to its operands, never store one in <c>auto</c>.
+*/
+
+#ifndef EXPRESSION_HPP_INCLUDED
+#define EXPRESSION_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "quaternion.hpp"
+#include "vectorbatch.hpp"
+
+namespace skmath{
+
+  namespace expr{
+
+    /** Traits. How expressions read and write objects of type <c>T</c>: <c>cComponents</c>
+    * components of <c>count()</c> contiguous <c>Scalar</c>s each, component c starting at
+    * <c>data() + c * stride()</c>. The layout is read once per operand, not per element.
+    * <c>cFixed</c> types always have a count of 1 and a stride of 1, known at compile time.
+    */
+    template<typename T>
+    struct Traits;
+
+    template<typename S, int N>
+    struct Traits<BasicVector<S, N>>{
+      typedef S Scalar;
+      static const bool cFixed = true;
+      static const int cComponents = N;
+      static std::size_t count(const BasicVector<S, N>&) { return 1; }
+      static void prepare(BasicVector<S, N>&, std::size_t) { }
+      static const S* data(const BasicVector<S, N>& v) { return &v[0]; }
+      static S* data(BasicVector<S, N>& v) { return &v[0]; }
+      static std::ptrdiff_t stride(const BasicVector<S, N>&) { return 1; }
+    };
+
+    template<typename S>
+    struct Traits<BasicQuaternion<S>>{
+      typedef S Scalar;
+      static const bool cFixed = true;
+      static const int cComponents = 4;
+      static std::size_t count(const BasicQuaternion<S>&) { return 1; }
+      static void prepare(BasicQuaternion<S>&, std::size_t) { }
+      static const S* data(const BasicQuaternion<S>& q) { return &q.w(); } //w, x, y, z in memory
+      static S* data(BasicQuaternion<S>& q) { return &q.w(); }
+      static std::ptrdiff_t stride(const BasicQuaternion<S>&) { return 1; }
+    };
+
+    template<typename S, int R, int C>
+    struct Traits<BasicMatrix<S, R, C>>{
+      typedef S Scalar;
+      static const bool cFixed = true;
+      static const int cComponents = R * C;
+      static std::size_t count(const BasicMatrix<S, R, C>&) { return 1; }
+      static void prepare(BasicMatrix<S, R, C>&, std::size_t) { }
+      static const S* data(const BasicMatrix<S, R, C>& m) { return &m[0]; }
+      static S* data(BasicMatrix<S, R, C>& m) { return &m[0]; }
+      static std::ptrdiff_t stride(const BasicMatrix<S, R, C>&) { return 1; }
+    };
+
+    template<>
+    struct Traits<VectorBatch>{
+      typedef float Scalar;
+      static const bool cFixed = false;
+      static const int cComponents = cVectorSize;
+      static std::size_t count(const VectorBatch& b) { return b.size(); }
+      static void prepare(VectorBatch& b, std::size_t size) { b.resize(size); }
+      static const float* data(const VectorBatch& b) { return b.x(); }
+      static float* data(VectorBatch& b) { return b.x(); }
+      static std::ptrdiff_t stride(const VectorBatch& b) { return b.y() - b.x(); }
+    };
+
+    /** Expression. Base of every expression node <c>E</c> producing objects of type <c>T</c>. */
+    template<typename E, typename T>
+    class Expression{
+      public:
+        typedef T Result;
+
+        /** Get node.
+        * @return Reference to the derived node.
+        */
+        const E& self() const { return static_cast<const E&>(*this); }
+
+        /** Evaluate. Lets an expression be assigned to or initialize a <c>T</c>.
+        * @return New object, the value of the expression.
+        */
+        operator T() const;
+    };
+
+    /** Reference. Leaf of an expression tree. */
+    template<typename T>
+    class Ref : public Expression<Ref<T>, T>{
+      public:
+        explicit Ref(const T& v)
+          : _data(Traits<T>::data(v)), _stride(Traits<T>::stride(v)), _count(Traits<T>::count(v)) { }
+        typename Traits<T>::Scalar get(int c, std::size_t i) const { return Traits<T>::cFixed ? _data[c] : _data[c * _stride + i]; }
+        std::size_t count() const { return _count; }
+
+      private:
+        const typename Traits<T>::Scalar* _data;
+        std::ptrdiff_t _stride;
+        std::size_t _count;
+    };
+
+    struct Add{ template<typename S> static S apply(S a, S b) { return a + b; } };
+    struct Sub{ template<typename S> static S apply(S a, S b) { return a - b; } };
+    struct Mul{ template<typename S> static S apply(S a, S b) { return a * b; } };
+    struct Div{ template<typename S> static S apply(S a, S b) { return a / b; } };
+
+    /** Binary. Element-wise <c>Op</c> of two expressions. */
+    template<typename L, typename R, typename Op, typename T>
+    class Binary : public Expression<Binary<L, R, Op, T>, T>{
+      public:
+        Binary(const L& l, const R& r) : _l(l), _r(r) { }
+        typename Traits<T>::Scalar get(int c, std::size_t i) const { return Op::apply(_l.get(c, i), _r.get(c, i)); }
+        std::size_t count() const { return _l.count(); }
+
+      private:
+        L _l;
+        R _r;
+    };
+
+    /** Scalar. Element-wise <c>Op</c> of an expression and a scalar. */
+    template<typename L, typename Op, typename T>
+    class Scalar : public Expression<Scalar<L, Op, T>, T>{
+      public:
+        Scalar(const L& l, typename Traits<T>::Scalar s) : _l(l), _s(s) { }
+        typename Traits<T>::Scalar get(int c, std::size_t i) const { return Op::apply(_l.get(c, i), _s); }
+        std::size_t count() const { return _l.count(); }
+
+      private:
+        L _l;
+        typename Traits<T>::Scalar _s;
+    };
+
+    /** Negate. Element-wise negation of an expression. */
+    template<typename L, typename T>
+    class Negate : public Expression<Negate<L, T>, T>{
+      public:
+        explicit Negate(const L& l) : _l(l) { }
+        typename Traits<T>::Scalar get(int c, std::size_t i) const { return -_l.get(c, i); }
+        std::size_t count() const { return _l.count(); }
+
+      private:
+        L _l;
+    };
+
+    //Operator +
+    template<typename L, typename R, typename T>
+    Binary<L, R, Add, T> operator +(const Expression<L, T>& l, const Expression<R, T>& r)
+    {
+      return Binary<L, R, Add, T>(l.self(), r.self());
+    }
+    template<typename L, typename T>
+    Binary<L, Ref<T>, Add, T> operator +(const Expression<L, T>& l, const T& r)
+    {
+      return Binary<L, Ref<T>, Add, T>(l.self(), Ref<T>(r));
+    }
+    template<typename R, typename T>
+    Binary<Ref<T>, R, Add, T> operator +(const T& l, const Expression<R, T>& r)
+    {
+      return Binary<Ref<T>, R, Add, T>(Ref<T>(l), r.self());
+    }
+
+    //Operator -
+    template<typename L, typename R, typename T>
+    Binary<L, R, Sub, T> operator -(const Expression<L, T>& l, const Expression<R, T>& r)
+    {
+      return Binary<L, R, Sub, T>(l.self(), r.self());
+    }
+    template<typename L, typename T>
+    Binary<L, Ref<T>, Sub, T> operator -(const Expression<L, T>& l, const T& r)
+    {
+      return Binary<L, Ref<T>, Sub, T>(l.self(), Ref<T>(r));
+    }
+    template<typename R, typename T>
+    Binary<Ref<T>, R, Sub, T> operator -(const T& l, const Expression<R, T>& r)
+    {
+      return Binary<Ref<T>, R, Sub, T>(Ref<T>(l), r.self());
+    }
+    template<typename L, typename T>
+    Negate<L, T> operator -(const Expression<L, T>& l)
+    {
+      return Negate<L, T>(l.self());
+    }
+
+    //Operator *
+    template<typename L, typename T>
+    Scalar<L, Mul, T> operator *(const Expression<L, T>& l, typename Traits<T>::Scalar s)
+    {
+      return Scalar<L, Mul, T>(l.self(), s);
+    }
+    template<typename R, typename T>
+    Scalar<R, Mul, T> operator *(typename Traits<T>::Scalar s, const Expression<R, T>& r)
+    {
+      return Scalar<R, Mul, T>(r.self(), s);
+    }
+
+    //Operator /
+    template<typename L, typename T>
+    Scalar<L, Div, T> operator /(const Expression<L, T>& l, typename Traits<T>::Scalar s)
+    {
+      return Scalar<L, Div, T>(l.self(), s);
+    }
+
+  };
+
+  /** Lazy. Start an expression.
+  * @param v Vector, Quaternion, Matrix or VectorBatch.
+  * @return Expression referencing <c>v</c>.
+  */
+  template<typename T>
+  expr::Ref<T> lazy(const T& v)
+  {
+    return expr::Ref<T>(v);
+  }
+
+  namespace expr{
+
+    //Evaluate components C..., fully unrolled
+    template<typename S, typename E, std::size_t... C>
+    inline void evaluate(S* res, const E& node, std::index_sequence<C...>)
+    {
+      ((res[C] = node.get(int(C), 0)), ...);
+    }
+
+    //Evaluate fixed size expression, everything is read before out is written
+    template<typename E, typename T>
+    inline void evaluate(T& out, const E& node, std::true_type)
+    {
+      typename Traits<T>::Scalar res[Traits<T>::cComponents];
+      evaluate(res, node, std::make_index_sequence<Traits<T>::cComponents>());
+
+      typename Traits<T>::Scalar* data = Traits<T>::data(out);
+      for(int c = 0; c < Traits<T>::cComponents; c++)
+        data[c] = res[c];
+    }
+
+    //Evaluate array expression, one pass per component
+    template<typename E, typename T>
+    void evaluate(T& out, const E& node, std::false_type)
+    {
+      const std::size_t count = node.count();
+      Traits<T>::prepare(out, count);
+      typename Traits<T>::Scalar* data = Traits<T>::data(out);
+      const std::ptrdiff_t stride = Traits<T>::stride(out);
+
+      for(int c = 0; c < Traits<T>::cComponents; c++)
+      {
+        typename Traits<T>::Scalar* component = data + c * stride;
+        for(std::size_t i = 0; i < count; i++)
+          component[i] = node.get(c, i);
+      }
+    }
+
+  };
+
+  /** Evaluate. Compute an expression straight into <c>out</c>, in one pass.
+  * @param out Object to store the result in, may appear in the expression.
+  * @param e Expression to evaluate.
+  */
+  template<typename E, typename T>
+  inline void evaluate(T& out, const expr::Expression<E, T>& e)
+  {
+    expr::evaluate(out, e.self(), std::integral_constant<bool, expr::Traits<T>::cFixed>());
+  }
+
+  //Evaluate
+  template<typename E, typename T>
+  inline expr::Expression<E, T>::operator T() const
+  {
+    T res;
+    evaluate(res, *this);
+
+    return res;
+  }
+
+};
+
+#endif // EXPRESSION_HPP_INCLUDED
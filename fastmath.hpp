@@ -0,0 +1,236 @@
+/**
+* @file fastmath.hpp
+* @author skwo
+* @brief Math policies and fast approximations of rsqrt and sincos.
+*
+* Functions that take a square root or a sine and cosine come in two flavours, chosen per call
+* by passing a policy tag, or from a template parameter by passing <c>Policy()</c>:
+* @code
+* Vector n = v.normalize(Fast());
+* template<typename Policy> void step(Quaternion& q) { q = q.normalize(Policy()); }
+* @endcode
+* - Exact, the default: std::sqrt, std::sin and std::cos, and divisions.
+* - Fast: a hardware rsqrt estimate refined by one Newton step, and one polynomial sincos with
+*   shared range reduction. Float only, double types take the exact functions under Fast too,
+*   since SSE/AVX have no double rsqrt estimate. magnitude(Fast) stays exact: one hardware
+*   square root is faster than rsqrt, a Newton step and a multiply.
+*
+* The error bounds below are measured against double precision references, and checked by the
+* accuracy mode of the benchmark.
+*/
+
+#ifndef FASTMATH_HPP_INCLUDED
+#define FASTMATH_HPP_INCLUDED
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "simd.hpp"
+
+namespace skmath{
+
+  /** Exact math policy, correctly rounded sqrt and libm sin and cos. */
+  struct Exact{
+  };
+
+  /** Fast math policy, see rsqrt(float, Fast) and sincos(float, float&, float&, Fast). */
+  struct Fast{
+  };
+
+  /** Max error of rsqrt(float, Fast) in ulp, over every positive normal float. */
+  const unsigned int cFastRsqrtUlp = 4;
+
+  /** Max error of sincos(float, float&, float&, Fast) in ulp, for |a| <= pi. */
+  const unsigned int cFastSinCosUlp = 2;
+
+  /** Max absolute error of sincos(float, float&, float&, Fast), for |a| <= 8192. */
+  const float cFastSinCosError = 1.5e-7f;
+
+  /** Max error in ulp of the components of normalize(Fast) of float vectors and quaternions,
+  * relative to the largest component.
+  */
+  const unsigned int cFastNormalizeUlp = 5;
+
+  /** Reciprocal square root, exact.
+  * @param x Positive value.
+  * @return 1 / sqrt(<c>x</c>).
+  */
+  template<typename T>
+  inline T rsqrt(T x, Exact)
+  {
+    return T(1) / std::sqrt(x);
+  }
+
+  /** Reciprocal square root, hardware estimate refined by one Newton-Raphson step.
+  * Max error <c>cFastRsqrtUlp</c> ulp.
+  * @param x Positive, finite value.
+  * @return 1 / sqrt(<c>x</c>).
+  */
+  inline float rsqrt(float x, Fast)
+  {
+#if defined(SKMATH_SSE)
+    //Newton step written as a correction of y, y + y / 2 * (1 - x y^2), rounds better than y (3 - x y^2) / 2
+    float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+    float e = 1.0f - x * y * y;
+    return y + 0.5f * y * e;
+#else
+    return 1.0f / std::sqrt(x);
+#endif
+  }
+
+  /** Reciprocal square root, as rsqrt(x, Exact) for double.
+  * @param x Positive value.
+  * @return 1 / sqrt(<c>x</c>).
+  */
+  inline double rsqrt(double x, Fast)
+  {
+    return 1.0 / std::sqrt(x);
+  }
+
+  /** Sine and cosine, exact.
+  * @param a Angle in radians.
+  * @param s Sine of <c>a</c>.
+  * @param c Cosine of <c>a</c>.
+  */
+  template<typename T>
+  inline void sincos(T a, T& s, T& c, Exact)
+  {
+    s = std::sin(a);
+    c = std::cos(a);
+  }
+
+  namespace detail{
+
+    //Cody-Waite split of pi / 2, the first two parts have trailing zero bits so q * part is exact
+    const float cHalfPi1 = 1.5703125f;
+    const float cHalfPi2 = 4.837512969970703125e-4f;
+    const float cHalfPi3 = 7.54978995489188216e-8f;
+    const float cTwoOverPi = 0.636619772367581343f;
+
+    //Minimax polynomials of sin and cos on [-pi / 4, pi / 4] (Cephes sinf and cosf)
+    const float cSin1 = -1.6666654611e-1f;
+    const float cSin2 = 8.3321608736e-3f;
+    const float cSin3 = -1.9515295891e-4f;
+    const float cCos1 = 4.166664568298827e-2f;
+    const float cCos2 = -1.388731625493765e-3f;
+    const float cCos3 = 2.443315711809948e-5f;
+
+  };
+
+  /** Sine and cosine, fast. Reduces <c>a</c> once to [-pi / 4, pi / 4] and evaluates both
+  * polynomials on it. Max error <c>cFastSinCosUlp</c> ulp for |a| <= pi, and below
+  * <c>cFastSinCosError</c> for |a| <= 8192.
+  * @param a Angle in radians.
+  * @param s Sine of <c>a</c>.
+  * @param c Cosine of <c>a</c>.
+  */
+  inline void sincos(float a, float& s, float& c, Fast)
+  {
+    using namespace detail;
+
+    //Round to nearest by adding and subtracting 1.5 * 2^23, valid for |q| < 2^22
+    float q = (a * cTwoOverPi + 12582912.0f) - 12582912.0f;
+    float r = ((a - q * cHalfPi1) - q * cHalfPi2) - q * cHalfPi3;
+    float z = r * r;
+
+    float sr = ((cSin3 * z + cSin2) * z + cSin1) * z * r + r;
+    float cr = ((cCos3 * z + cCos2) * z + cCos1) * z * z - 0.5f * z + 1.0f;
+
+    //sin(r + q pi / 2) is sin r, cos r, -sin r, -cos r for q = 0, 1, 2, 3 mod 4. Swap and
+    //negate with masks, random angles would mispredict branches
+    std::uint32_t quadrant = std::uint32_t(std::int32_t(q));
+    std::uint32_t swap = 0u - (quadrant & 1u);
+    std::uint32_t sBits, cBits;
+    std::memcpy(&sBits, &sr, sizeof(float));
+    std::memcpy(&cBits, &cr, sizeof(float));
+
+    std::uint32_t sRes = ((cBits & swap) | (sBits & ~swap)) ^ ((quadrant & 2u) << 30);
+    std::uint32_t cRes = ((sBits & swap) | (cBits & ~swap)) ^ (((quadrant + 1u) & 2u) << 30);
+    std::memcpy(&s, &sRes, sizeof(float));
+    std::memcpy(&c, &cRes, sizeof(float));
+  }
+
+  /** Sine and cosine, as sincos(a, s, c, Exact) for double.
+  * @param a Angle in radians.
+  * @param s Sine of <c>a</c>.
+  * @param c Cosine of <c>a</c>.
+  */
+  inline void sincos(double a, double& s, double& c, Fast)
+  {
+    s = std::sin(a);
+    c = std::cos(a);
+  }
+
+  namespace simd{
+
+    /** Reciprocal square root of every lane, as rsqrt(float, Fast).
+    * @param x Positive, finite values.
+    */
+    inline Float rsqrt(Float x, Fast)
+    {
+#if defined(SKMATH_SSE)
+      Float y = rsqrt(x);
+      Float e = nmadd(mul(x, y), y, set1(1.0f));
+      return madd(mul(set1(0.5f), y), e, y);
+#else
+      return rsqrt(x);
+#endif
+    }
+
+    /** Sine and cosine of every lane, as sincos(float, float&, float&, Fast).
+    * @param a Angles in radians.
+    * @param s Sines of <c>a</c>.
+    * @param c Cosines of <c>a</c>.
+    */
+    inline void sincos(Float a, Float& s, Float& c, Fast)
+    {
+      using namespace detail;
+
+      Float q = round(mul(a, set1(cTwoOverPi)));
+      Float r = nmadd(q, set1(cHalfPi3), nmadd(q, set1(cHalfPi2), nmadd(q, set1(cHalfPi1), a)));
+      Float z = mul(r, r);
+
+      Float sr = madd(mul(madd(madd(set1(cSin3), z, set1(cSin2)), z, set1(cSin1)), z), r, r);
+      Float cr = madd(mul(madd(madd(set1(cCos3), z, set1(cCos2)), z, set1(cCos1)), z), z, nmadd(set1(0.5f), z, set1(1.0f)));
+
+      //Quadrant q - 4 round(q / 4) in {-2, -1, 0, 1, 2}, without integer SIMD
+      Float m = nmadd(set1(4.0f), round(mul(q, set1(0.25f))), q);
+      Float h = mul(q, set1(0.5f));
+      Float odd = cmpneq(h, round(h));
+
+      Float sv = select(odd, cr, sr);
+      Float cv = select(odd, sr, cr);
+
+      //Sine is negated for m = -2, -1, 2, cosine for m = -2, 1, 2
+      s = select(cmplt(m, zero()), neg(sv), select(cmplt(set1(1.5f), m), neg(sv), sv));
+      c = select(cmplt(set1(0.5f), m), neg(cv), select(cmplt(m, set1(-1.5f)), neg(cv), cv));
+    }
+
+  };
+
+  /** Sine and cosine batch, as sincos(float, float&, float&, Fast) with SSE/AVX.
+  * @param a Array of <c>size</c> angles in radians.
+  * @param s Array of <c>size</c> floats to store sines in.
+  * @param c Array of <c>size</c> floats to store cosines in.
+  * @param size Number of angles.
+  */
+  inline void sincosBatch(const float* a, float* s, float* c, std::size_t size)
+  {
+    std::size_t i = 0;
+    for(; i + simd::cWidth <= size; i += simd::cWidth)
+    {
+      simd::Float vs, vc;
+      simd::sincos(simd::loadu(a + i), vs, vc, Fast());
+      simd::storeu(s + i, vs);
+      simd::storeu(c + i, vc);
+    }
+
+    for(; i < size; i++)
+      sincos(a[i], s[i], c[i], Fast());
+  }
+
+};
+
+#endif // FASTMATH_HPP_INCLUDED
@@ -0,0 +1,11 @@
+/**
+* @file frustum.cpp
+* @author skwo
+* @brief Realization of view frustum and frustum culling.
+*/
+
+#include "frustum.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "frustum.inl"
+#endif
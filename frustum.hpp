@@ -0,0 +1,98 @@
+/**
+* @file frustum.hpp
+* @author skwo
+* @brief Defenition of view frustum and frustum culling.
+*
+* A Frustum is the six planes of a view volume, extracted from a combined view projection matrix
+* with Gribb and Hartmann's method: each plane is the last row of the matrix plus or minus one of
+* the others. Points inside are on the positive side of all six. cullSpheres and cullAABBs test
+* VectorBatch streams of bounds against the planes 8 (AVX) or 4 (SSE) at a time and write the
+* indices of the visible ones in order, without branches per element.
+*/
+
+#ifndef FRUSTUM_HPP_INCLUDED
+#define FRUSTUM_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#include "config.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "aabb.hpp"
+#include "vectorbatch.hpp"
+
+namespace skmath{
+
+  /** Frustum planes, the order of Frustum::planes. */
+  enum FrustumPlane{
+    cFrustumLeft,
+    cFrustumRight,
+    cFrustumBottom,
+    cFrustumTop,
+    cFrustumNear,
+    cFrustumFar
+  };
+
+  /** View frustum, six planes facing inwards. */
+  struct Frustum{
+    /** Constructor. Create frustum of zero planes, which contains everything. */
+    Frustum();
+
+    /** Constructor. Create frustum of view projection matrix, as extract(viewProjection).
+    * @param viewProjection Projection * view matrix.
+    */
+    explicit Frustum(const Matrix& viewProjection);
+
+    /** Extract planes of view projection matrix. A world space point p is inside when its clip
+    * space position viewProjection * (p, 1) is, so the planes are in world space; pass a
+    * projection matrix alone for view space planes.
+    * @param viewProjection Projection * view matrix, as built by createPerspective or
+    * createOrthographic times createLookAt.
+    */
+    void extract(const Matrix& viewProjection);
+
+    /** Intersects sphere.
+    * @param center Center of sphere.
+    * @param radius Radius of sphere.
+    * @return False if the sphere is fully outside one of the planes.
+    */
+    bool intersects(const Vector& center, float radius) const;
+
+    /** Intersects box.
+    * @param box Box.
+    * @return False if the box is empty or fully outside one of the planes. Boxes outside the
+    * frustum but near its edges, outside no single plane, are reported as intersecting.
+    */
+    bool intersects(const AABB& box) const;
+
+    Vector4f planes[6]; /**< Plane normals x, y, z of unit length, and distance w from the origin. */
+  };
+
+  /** Cull spheres, the SIMD version of Frustum::intersects(center, radius).
+  * @param frustum Frustum.
+  * @param centers Batch of sphere centers.
+  * @param radii Array of <c>centers.size()</c> radii.
+  * @param visible Array of <c>centers.size()</c> indices to store the indices of the visible
+  * spheres in, in increasing order.
+  * @return Number of visible spheres.
+  */
+  std::size_t cullSpheres(const Frustum& frustum, const VectorBatch& centers, const float* radii, std::uint32_t* visible);
+
+  /** Cull boxes, the SIMD version of Frustum::intersects(box).
+  * @param frustum Frustum.
+  * @param centers Batch of box centers.
+  * @param extents Batch of box half sizes, one per center, none negative.
+  * @param visible Array of <c>centers.size()</c> indices to store the indices of the visible
+  * boxes in, in increasing order.
+  * @return Number of visible boxes.
+  */
+  std::size_t cullAABBs(const Frustum& frustum, const VectorBatch& centers, const VectorBatch& extents, std::uint32_t* visible);
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "frustum.inl"
+#endif
+
+#endif // FRUSTUM_HPP_INCLUDED
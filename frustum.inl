@@ -0,0 +1,199 @@
+/**
+* @file frustum.inl
+* @author skwo
+* @brief Realization of view frustum and frustum culling.
+* @note Included by frustum.cpp, or by frustum.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <cmath>
+
+#include "profile.hpp"
+#include "simd.hpp"
+
+namespace skmath{
+
+  namespace detail{
+
+    //Planes broadcast to registers, normal x, y, z and w, and the absolute normals for boxes
+    struct FrustumRegisters{
+      explicit FrustumRegisters(const Frustum& frustum)
+      {
+        for(int p = 0; p < 6; p++)
+        {
+          const float* plane = &frustum.planes[p][0];
+          for(int k = 0; k < 4; k++)
+            n[p][k] = simd::set1(plane[k]);
+          for(int k = 0; k < 3; k++)
+            a[p][k] = simd::set1(std::fabs(plane[k]));
+        }
+      }
+
+      simd::Float n[6][4];
+      simd::Float a[6][3];
+    };
+
+    //Append indices i + k of the lanes k < lanes set in bits. Every lane is written, only visible
+    //ones are counted, so the next visible lane overwrites an invisible one.
+    SKMATH_INLINE std::size_t appendVisible(int bits, std::size_t i, std::size_t lanes, std::uint32_t* visible, std::size_t count)
+    {
+      for(std::size_t k = 0; k < lanes; k++)
+      {
+        visible[count] = static_cast<std::uint32_t>(i + k);
+        count += (bits >> k) & 1;
+      }
+      return count;
+    }
+
+    //Lanes of group i holding elements of size
+    SKMATH_INLINE std::size_t lanes(std::size_t i, std::size_t size)
+    {
+      return size - i < simd::cWidth ? size - i : simd::cWidth;
+    }
+
+  };
+
+  //Constructor
+  SKMATH_INLINE Frustum::Frustum()
+  {
+  }
+  SKMATH_INLINE Frustum::Frustum(const Matrix& viewProjection)
+  {
+    extract(viewProjection);
+  }
+
+  //Extract
+  SKMATH_INLINE void Frustum::extract(const Matrix& viewProjection)
+  {
+    //Column major, row r of the matrix is m[r], m[r + 4], m[r + 8], m[r + 12]
+    const float* m = &viewProjection[0];
+
+    for(int p = 0; p < 6; p++)
+    {
+      //Left and right from row 0, bottom and top from row 1, near and far from row 2
+      const int row = p / 2;
+      const float sign = (p % 2 == 0) ? 1.0f : -1.0f;
+      float plane[4];
+      for(int k = 0; k < 4; k++)
+        plane[k] = m[3 + 4 * k] + sign * m[row + 4 * k];
+
+      const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+      const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+      planes[p] = Vector4f(plane[0] * scale, plane[1] * scale, plane[2] * scale, plane[3] * scale);
+    }
+  }
+
+  //Intersects
+  SKMATH_INLINE bool Frustum::intersects(const Vector& center, float radius) const
+  {
+    const float* c = &center[0];
+    for(int p = 0; p < 6; p++)
+    {
+      const float* plane = &planes[p][0];
+      if(plane[0] * c[0] + plane[1] * c[1] + plane[2] * c[2] + plane[3] < -radius)
+        return false;
+    }
+    return true;
+  }
+  SKMATH_INLINE bool Frustum::intersects(const AABB& box) const
+  {
+    if(box.isEmpty())
+      return false;
+
+    const float* lo = &box.min[0];
+    const float* hi = &box.max[0];
+    const float c[3] = { (lo[0] + hi[0]) * 0.5f, (lo[1] + hi[1]) * 0.5f, (lo[2] + hi[2]) * 0.5f };
+    const float e[3] = { (hi[0] - lo[0]) * 0.5f, (hi[1] - lo[1]) * 0.5f, (hi[2] - lo[2]) * 0.5f };
+
+    //Distance of the corner furthest along the normal
+    for(int p = 0; p < 6; p++)
+    {
+      const float* plane = &planes[p][0];
+      const float distance = plane[0] * c[0] + plane[1] * c[1] + plane[2] * c[2] + plane[3];
+      const float radius = std::fabs(plane[0]) * e[0] + std::fabs(plane[1]) * e[1] + std::fabs(plane[2]) * e[2];
+      if(distance < -radius)
+        return false;
+    }
+    return true;
+  }
+
+  //Cull spheres
+  SKMATH_INLINE std::size_t cullSpheres(const Frustum& frustum, const VectorBatch& centers, const float* radii, std::uint32_t* visible)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileCull);
+    using simd::Float;
+    using simd::cWidth;
+    using simd::madd;
+
+    const detail::FrustumRegisters f(frustum);
+    const std::size_t size = centers.size();
+    std::size_t count = 0;
+
+    for(std::size_t i = 0; i < size; i += cWidth)
+    {
+      const std::size_t lanes = detail::lanes(i, size);
+      const Float x = simd::load(centers.x() + i);
+      const Float y = simd::load(centers.y() + i);
+      const Float z = simd::load(centers.z() + i);
+
+      //Radii are not padded, the last group reads a copy
+      Float r;
+      if(lanes == cWidth)
+        r = simd::loadu(radii + i);
+      else
+      {
+        alignas(simd::cAlignment) float tail[cWidth] = {};
+        for(std::size_t k = 0; k < lanes; k++)
+          tail[k] = radii[i + k];
+        r = simd::load(tail);
+      }
+
+      //Least signed distance over the planes, plus the radius; negative when outside one
+      Float margin = simd::set1(INFINITY);
+      for(int p = 0; p < 6; p++)
+        margin = simd::min(margin, madd(f.n[p][0], x, madd(f.n[p][1], y, madd(f.n[p][2], z, f.n[p][3]))));
+      margin = simd::add(margin, r);
+
+      const int outside = simd::movemask(simd::cmplt(margin, simd::zero()));
+      count = detail::appendVisible(~outside, i, lanes, visible, count);
+    }
+
+    return count;
+  }
+
+  //Cull AABBs
+  SKMATH_INLINE std::size_t cullAABBs(const Frustum& frustum, const VectorBatch& centers, const VectorBatch& extents, std::uint32_t* visible)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileCull);
+    using simd::Float;
+    using simd::cWidth;
+    using simd::madd;
+
+    const detail::FrustumRegisters f(frustum);
+    const std::size_t size = centers.size();
+    std::size_t count = 0;
+
+    for(std::size_t i = 0; i < size; i += cWidth)
+    {
+      const Float x = simd::load(centers.x() + i);
+      const Float y = simd::load(centers.y() + i);
+      const Float z = simd::load(centers.z() + i);
+      const Float ex = simd::load(extents.x() + i);
+      const Float ey = simd::load(extents.y() + i);
+      const Float ez = simd::load(extents.z() + i);
+
+      //Signed distance of the corner furthest along each normal, least over the planes
+      Float margin = simd::set1(INFINITY);
+      for(int p = 0; p < 6; p++)
+      {
+        Float distance = madd(f.n[p][0], x, madd(f.n[p][1], y, madd(f.n[p][2], z, f.n[p][3])));
+        margin = simd::min(margin, madd(f.a[p][0], ex, madd(f.a[p][1], ey, madd(f.a[p][2], ez, distance))));
+      }
+
+      const int outside = simd::movemask(simd::cmplt(margin, simd::zero()));
+      count = detail::appendVisible(~outside, i, detail::lanes(i, size), visible, count);
+    }
+
+    return count;
+  }
+
+};
@@ -0,0 +1,11 @@
+/**
+* @file kdtree.cpp
+* @author skwo
+* @brief Realization of k-d tree class.
+*/
+
+#include "kdtree.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "kdtree.inl"
+#endif
@@ -0,0 +1,132 @@
+/**
+* @file kdtree.hpp
+* @author skwo
+* @brief Defenition of k-d tree class.
+*
+* A KdTree indexes a static array of points for nearest neighbor and radius queries. The tree is
+* balanced and implicit: node i has children 2i + 1 and 2i + 2, each split halves the points of
+* its node at the median along the widest axis, and a node only stores its split, so the whole
+* tree is a flat array of 8-byte nodes. Points are copied in tree order to x, y and z arrays, and
+* the leaf buckets of up to <c>cKdTreeLeafSize</c> points are scanned 8 (AVX) or 4 (SSE) at a time.
+*/
+
+#ifndef KDTREE_HPP_INCLUDED
+#define KDTREE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "config.hpp"
+#include "vector.hpp"
+#include "memory.hpp"
+
+namespace skmath{
+
+  /** Most points in a leaf of a KdTree. */
+  const std::size_t cKdTreeLeafSize = 16;
+
+  class KdTree{
+    public:
+      /** Index of missing neighbors, when fewer points than asked for are in the tree. */
+      static const std::uint32_t cNoPoint = ~std::uint32_t(0);
+
+      /** Constructor. Create empty tree. */
+      KdTree();
+
+      /** Constructor. Create tree of points, as build(points, size).
+      * @param points Array of <c>size</c> points.
+      * @param size Number of points.
+      */
+      KdTree(const Vector* points, std::size_t size);
+
+      /** Build tree. Points are copied, so the array may change or go away afterwards; queries
+      * return indices into it. Levels of the tree are split across threads.
+      * @param points Array of <c>size</c> points.
+      * @param size Number of points, less than 2^32 - 1.
+      */
+      void build(const Vector* points, std::size_t size);
+
+      /** Get size.
+      * @return Number of points.
+      */
+      std::size_t size() const;
+
+      /** Get memory.
+      * @return Bytes allocated by the tree.
+      */
+      std::size_t memory() const;
+
+      /** Nearest neighbors.
+      * @param query Point to find the neighbors of.
+      * @param k Number of neighbors to find, at least 1.
+      * @param indices Array of <c>k</c> indices to store the indices of the neighbors in, nearest
+      * first. Entries past the number found are <c>cNoPoint</c>.
+      * @param distances Array of <c>k</c> floats to store the distances of the neighbors in.
+      * Entries past the number found are infinity.
+      * @return Number of neighbors found, <c>k</c> unless the tree has fewer points.
+      */
+      std::size_t nearest(const Vector& query, std::size_t k, std::uint32_t* indices, float* distances) const;
+
+      /** Radius search.
+      * @param query Point to search around.
+      * @param radius Radius.
+      * @param indices Vector to store the indices of the points at most <c>radius</c> from
+      * <c>query</c> in, in no particular order. Cleared first.
+      * @return Number of points found.
+      */
+      std::size_t radiusSearch(const Vector& query, float radius, std::vector<std::uint32_t>& indices) const;
+
+      /** Nearest neighbors batch, query i as nearest(queries[i], k, indices + k * i,
+      * distances + k * i). Queries are split across threads.
+      * @param queries Array of <c>count</c> points.
+      * @param count Number of queries.
+      * @param k Number of neighbors of each query, at least 1.
+      * @param indices Array of <c>k</c> * <c>count</c> indices.
+      * @param distances Array of <c>k</c> * <c>count</c> floats.
+      */
+      void nearestBatch(const Vector* queries, std::size_t count, std::size_t k, std::uint32_t* indices, float* distances) const;
+
+      /** Radius search batch. Queries are split across threads, counted first and then searched
+      * again straight into place.
+      * @param queries Array of <c>count</c> points.
+      * @param count Number of queries.
+      * @param radius Radius.
+      * @param indices Vector to store the points found in, those of query i from
+      * <c>offsets[i]</c> to <c>offsets[i + 1]</c>.
+      * @param offsets Vector resized to <c>count</c> + 1 offsets into <c>indices</c>.
+      */
+      void radiusSearchBatch(const Vector* queries, std::size_t count, float radius,
+                             std::vector<std::uint32_t>& indices, std::vector<std::size_t>& offsets) const;
+
+    private:
+      /** Inner node, split plane along one axis. */
+      struct Node{
+        float split; /**< Points of the left child are at most, of the right child at least split. */
+        std::uint32_t axis; /**< Axis, 0 to 2. */
+      };
+
+      //Visit the leaves of points [begin, end) that may be within sqrt(bound) of q, nearest
+      //first; leaf may lower bound
+      template<typename Leaf>
+      void traverse(const float* q, float& bound, Leaf leaf) const;
+
+      //Call found(index) for every point within radius of q
+      template<typename Found>
+      void within(const float* q, float radius, Found found) const;
+
+      std::vector<Node> _nodes; /**< Inner nodes, the root first. */
+      AlignedArray<float> _x; /**< x of the points in tree order, padded by a register. */
+      AlignedArray<float> _y; /**< y of the points in tree order, padded by a register. */
+      AlignedArray<float> _z; /**< z of the points in tree order, padded by a register. */
+      std::vector<std::uint32_t> _index; /**< Index of the points in tree order. */
+      std::size_t _size; /**< Number of points. */
+  };
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "kdtree.inl"
+#endif
+
+#endif // KDTREE_HPP_INCLUDED
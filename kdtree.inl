@@ -0,0 +1,326 @@
+/**
+* @file kdtree.inl
+* @author skwo
+* @brief Realization of k-d tree class.
+* @note Included by kdtree.cpp, or by kdtree.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "parallel.hpp"
+#include "profile.hpp"
+#include "simd.hpp"
+
+namespace skmath{
+
+  namespace detail{
+
+    //Point and its index, sorted into tree order by build
+    struct KdItem{
+      float p[3];
+      std::uint32_t index;
+    };
+
+    //Points [begin, end) of node j of a level: every level halves the range of its parent, the
+    //left child taking the smaller half, and the bits of j from the top are the path to the node
+    SKMATH_INLINE void kdRange(std::size_t j, std::size_t level, std::size_t size, std::size_t& begin, std::size_t& end)
+    {
+      begin = 0;
+      end = size;
+      for(std::size_t l = level; l-- > 0;)
+      {
+        const std::size_t mid = begin + (end - begin) / 2;
+        if((j >> l) & 1)
+          begin = mid;
+        else
+          end = mid;
+      }
+    }
+
+    //Bits of the first lanes of a register
+    SKMATH_INLINE int laneMask(std::size_t lanes)
+    {
+      return lanes < simd::cWidth ? (1 << lanes) - 1 : (1 << simd::cWidth) - 1;
+    }
+
+    //Queries per thread chunk, each one visits a few leaves
+    const std::size_t cKdTreeQueryGrain = cParallelGrain / 64;
+
+  };
+
+  //Constructor
+  SKMATH_INLINE KdTree::KdTree()
+    : _size(0)
+  {
+  }
+  SKMATH_INLINE KdTree::KdTree(const Vector* points, std::size_t size)
+    : _size(0)
+  {
+    build(points, size);
+  }
+
+  //Build
+  SKMATH_INLINE void KdTree::build(const Vector* points, std::size_t size)
+  {
+    //Enough levels for leaves of at most cKdTreeLeafSize points
+    std::size_t depth = 0;
+    for(std::size_t leaf = size; leaf > cKdTreeLeafSize; leaf = (leaf + 1) / 2)
+      depth++;
+
+    _size = size;
+    _nodes.assign((std::size_t(1) << depth) - 1, Node());
+
+    std::vector<detail::KdItem> items(size);
+    const float* p = size ? &points[0][0] : nullptr;
+    for(std::size_t i = 0; i < size; i++)
+      items[i] = detail::KdItem{ { p[3 * i], p[3 * i + 1], p[3 * i + 2] }, static_cast<std::uint32_t>(i) };
+
+    //A level at a time, the nodes of a level own disjoint ranges of items
+    for(std::size_t level = 0; level < depth; level++)
+    {
+      const std::size_t first = (std::size_t(1) << level) - 1;
+      const std::size_t perNode = std::max<std::size_t>(size >> level, 1);
+
+      parallelFor(std::size_t(1) << level, std::max<std::size_t>(cParallelGrain / perNode, 1), [&](std::size_t begin, std::size_t end) {
+        for(std::size_t j = begin; j < end; j++)
+        {
+          std::size_t lo, hi;
+          detail::kdRange(j, level, size, lo, hi);
+
+          float low[3] = { INFINITY, INFINITY, INFINITY }, high[3] = { -INFINITY, -INFINITY, -INFINITY };
+          for(std::size_t i = lo; i < hi; i++)
+          {
+            for(int a = 0; a < 3; a++)
+            {
+              low[a] = std::min(low[a], items[i].p[a]);
+              high[a] = std::max(high[a], items[i].p[a]);
+            }
+          }
+
+          std::uint32_t axis = 0;
+          for(std::uint32_t a = 1; a < 3; a++)
+            if(high[a] - low[a] > high[axis] - low[axis])
+              axis = a;
+
+          const std::size_t mid = lo + (hi - lo) / 2;
+          std::nth_element(items.begin() + lo, items.begin() + mid, items.begin() + hi,
+                           [axis](const detail::KdItem& a, const detail::KdItem& b) { return a.p[axis] < b.p[axis]; });
+          _nodes[first + j] = Node{ items[mid].p[axis], axis };
+        }
+      });
+    }
+
+    //Leaves are scanned a register at a time, so the last one may read a register past the end
+    _x.assign(size + simd::cWidth, 0.0f);
+    _y.assign(size + simd::cWidth, 0.0f);
+    _z.assign(size + simd::cWidth, 0.0f);
+    _index.resize(size);
+    for(std::size_t i = 0; i < size; i++)
+    {
+      _x[i] = items[i].p[0];
+      _y[i] = items[i].p[1];
+      _z[i] = items[i].p[2];
+      _index[i] = items[i].index;
+    }
+  }
+
+  //Get size
+  SKMATH_INLINE std::size_t KdTree::size() const
+  {
+    return _size;
+  }
+
+  //Get memory
+  SKMATH_INLINE std::size_t KdTree::memory() const
+  {
+    return _nodes.capacity() * sizeof(Node) + (_x.capacity() + _y.capacity() + _z.capacity()) * sizeof(float) +
+           _index.capacity() * sizeof(std::uint32_t);
+  }
+
+  //Traverse
+  template<typename Leaf>
+  SKMATH_INLINE void KdTree::traverse(const float* q, float& bound, Leaf leaf) const
+  {
+    //Far children wait on the stack with the squared distance to their split plane, at most one
+    //per level
+    struct Entry{
+      std::size_t node, begin, end;
+      float distance;
+    };
+    Entry stack[64];
+    int top = 0;
+    stack[top++] = Entry{ 0, 0, _size, 0.0f };
+
+    const std::size_t inner = _nodes.size();
+    while(top > 0)
+    {
+      const Entry e = stack[--top];
+      if(e.distance > bound)
+        continue;
+
+      std::size_t node = e.node, begin = e.begin, end = e.end;
+      while(node < inner)
+      {
+        const Node& n = _nodes[node];
+        const std::size_t mid = begin + (end - begin) / 2;
+        const float diff = q[n.axis] - n.split;
+        const float distance = std::max(e.distance, diff * diff);
+
+        if(diff < 0.0f)
+        {
+          stack[top++] = Entry{ 2 * node + 2, mid, end, distance };
+          node = 2 * node + 1;
+          end = mid;
+        }
+        else
+        {
+          stack[top++] = Entry{ 2 * node + 1, begin, mid, distance };
+          node = 2 * node + 2;
+          begin = mid;
+        }
+      }
+
+      leaf(begin, end);
+    }
+  }
+
+  //Nearest
+  SKMATH_INLINE std::size_t KdTree::nearest(const Vector& query, std::size_t k, std::uint32_t* indices, float* distances) const
+  {
+    SKMATH_PROFILE_SAMPLE(cProfileKdTreeNearest);
+    using simd::Float;
+    using simd::cWidth;
+
+    for(std::size_t i = 0; i < k; i++)
+    {
+      indices[i] = cNoPoint;
+      distances[i] = INFINITY;
+    }
+    if(_size == 0)
+      return 0;
+
+    const float* q = &query[0];
+    const Float qx = simd::set1(q[0]), qy = simd::set1(q[1]), qz = simd::set1(q[2]);
+    std::size_t found = 0;
+    float bound = INFINITY;
+
+    //distances holds squared distances, sorted, until the end
+    traverse(q, bound, [&](std::size_t begin, std::size_t end) {
+      alignas(simd::cAlignment) float d2[cWidth];
+
+      for(std::size_t s = begin; s < end; s += cWidth)
+      {
+        const Float dx = simd::sub(simd::loadu(_x.data() + s), qx);
+        const Float dy = simd::sub(simd::loadu(_y.data() + s), qy);
+        const Float dz = simd::sub(simd::loadu(_z.data() + s), qz);
+        const Float d = simd::madd(dx, dx, simd::madd(dy, dy, simd::mul(dz, dz)));
+
+        const int bits = simd::movemask(simd::cmplt(d, simd::set1(bound))) & detail::laneMask(end - s);
+        if(!bits)
+          continue;
+
+        simd::store(d2, d);
+        for(std::size_t l = 0; l < cWidth; l++)
+        {
+          if(!((bits >> l) & 1) || !(d2[l] < bound))
+            continue;
+
+          std::size_t j = found < k ? found++ : k - 1;
+          for(; j > 0 && distances[j - 1] > d2[l]; j--)
+          {
+            distances[j] = distances[j - 1];
+            indices[j] = indices[j - 1];
+          }
+          distances[j] = d2[l];
+          indices[j] = _index[s + l];
+
+          if(found == k)
+            bound = distances[k - 1];
+        }
+      }
+    });
+
+    for(std::size_t i = 0; i < found; i++)
+      distances[i] = std::sqrt(distances[i]);
+    return found;
+  }
+
+  //Within
+  template<typename Found>
+  SKMATH_INLINE void KdTree::within(const float* q, float radius, Found found) const
+  {
+    using simd::Float;
+    using simd::cWidth;
+
+    if(_size == 0)
+      return;
+
+    const Float qx = simd::set1(q[0]), qy = simd::set1(q[1]), qz = simd::set1(q[2]);
+    float bound = radius * radius;
+    const Float r2 = simd::set1(bound);
+
+    traverse(q, bound, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t s = begin; s < end; s += cWidth)
+      {
+        const Float dx = simd::sub(simd::loadu(_x.data() + s), qx);
+        const Float dy = simd::sub(simd::loadu(_y.data() + s), qy);
+        const Float dz = simd::sub(simd::loadu(_z.data() + s), qz);
+        const Float d = simd::madd(dx, dx, simd::madd(dy, dy, simd::mul(dz, dz)));
+
+        const int bits = ~simd::movemask(simd::cmplt(r2, d)) & detail::laneMask(end - s);
+        for(std::size_t l = 0; bits >> l; l++)
+          if((bits >> l) & 1)
+            found(_index[s + l]);
+      }
+    });
+  }
+
+  //Radius search
+  SKMATH_INLINE std::size_t KdTree::radiusSearch(const Vector& query, float radius, std::vector<std::uint32_t>& indices) const
+  {
+    SKMATH_PROFILE_SAMPLE(cProfileKdTreeRadius);
+    indices.clear();
+    within(&query[0], radius, [&](std::uint32_t index) { indices.push_back(index); });
+    return indices.size();
+  }
+
+  //Nearest batch
+  SKMATH_INLINE void KdTree::nearestBatch(const Vector* queries, std::size_t count, std::size_t k, std::uint32_t* indices,
+                                          float* distances) const
+  {
+    parallelFor(count, detail::cKdTreeQueryGrain, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; i++)
+        nearest(queries[i], k, indices + k * i, distances + k * i);
+    });
+  }
+
+  //Radius search batch
+  SKMATH_INLINE void KdTree::radiusSearchBatch(const Vector* queries, std::size_t count, float radius,
+                                               std::vector<std::uint32_t>& indices, std::vector<std::size_t>& offsets) const
+  {
+    SKMATH_PROFILE_SCOPE(cProfileKdTreeRadiusBatch);
+    offsets.assign(count + 1, 0);
+    parallelFor(count, detail::cKdTreeQueryGrain, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; i++)
+      {
+        std::size_t found = 0;
+        within(&queries[i][0], radius, [&](std::uint32_t) { found++; });
+        offsets[i + 1] = found;
+      }
+    });
+
+    for(std::size_t i = 0; i < count; i++)
+      offsets[i + 1] += offsets[i];
+
+    indices.resize(offsets[count]);
+    parallelFor(count, detail::cKdTreeQueryGrain, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; i++)
+      {
+        std::uint32_t* out = indices.data() + offsets[i];
+        within(&queries[i][0], radius, [&](std::uint32_t index) { *out++ = index; });
+      }
+    });
+  }
+
+};
@@ -1,145 +1,498 @@
-/**
-* @file matrix.hpp
-* @author skwo
-* @brief Defenition of matrix class.
-* @note Translation matrix is not supported.
-*/
-
-#ifndef MATRIX_HPP_INCLUDED
-#define MATRIX_HPP_INCLUDED
-
-#include "vector.hpp"
-
-const unsigned short int cMatrixSize = 16;
-const float cAngToRad = 0.0174532925199432957693f;
-
-namespace skmath{
-
-  class Quaternion;
-
-  class Matrix{
-    public:
-      friend void matrixToQuaternion(Matrix& m, Quaternion& q);
-      /** Constructor. Create identity matrix. */
-      Matrix();
-
-      /** Constructor. Create matrix with <c>x</c> <c>y</c> and <c>z</c> axes.
-      * @param x X axis.
-      * @param y Y axis.
-      * @param z Z axis.
-      */
-      Matrix(Vector& x, Vector& y, Vector& z);
-
-      /** Constructor. Create matrix from <c>m</c>.
-      * @param m Matrix to create from.
-      */
-      Matrix(float m[cMatrixSize]);
-
-      /** Destructor. */
-      ~Matrix();
-
-      /** Create identity matrix. */
-      void createIdentity();
-
-      /** Create matrix with <c>x</c> <c>y</c> and <c>z</c> axes.
-      * @param x X axis.
-      * @param y Y axis.
-      * @param z Z axis.
-      */
-      void create(Vector& x, Vector& y, Vector& z);
-
-      /** Create matrix from <c>m</c>.
-      * @param m Matrix to create from.
-      */
-      void create(float m[cMatrixSize]);
-
-      /** Create rotation matrix around x axis.
-      * @param angle Angle of rotation (degrees).
-      */
-      void createRotationX(float angle);
-
-      /** Create rotation matrix around y axis.
-      * @param angle Angle of rotation (degrees).
-      */
-      void createRotationY(float angle);
-
-      /** Create rotation matrix around z axis.
-      * @param angle Angle of rotation (degrees).
-      */
-      void createRotationZ(float angle);
-
-      /** Get Current matrix.
-      * @param m Array to store matrix in.
-      */
-      void get(float m[cMatrixSize]);
-
-      /** Access operator.
-      * @param place Place of component.
-      * @return Const reference to component in <c>place</c>.
-      * @note Place msut be between in range [0,15]!.
-      */
-      const float& operator [](const int place) const;
-
-      /** Access operator.
-      * @param place Place of component.
-      * @return Reference to component in <c>place</c>.
-      * @note Place msut be between in range [0,15]!.
-      */
-      float& operator [](const int place);
-
-      /** Equal to operator.
-      * @param rhs Right value matrix.
-      * @return true if <c>this</c> and <c>rhs</c> are equal, otherwise false.
-      */
-      bool operator ==(const Matrix& rhs) const;
-
-      /** Not equal to operator.
-      * @param rhs Right value matrix.
-      * @return true if <c>this</c> and <c>rhs</c> are not equal, otherwise false.
-      */
-      bool operator !=(const Matrix& rhs) const;
-
-      /** Assign operator.
-      * @param rhs Right value matrix.
-      * @return reference to <c>this</c>.
-      */
-      Matrix& operator =(const Matrix& rhs);
-
-      /** Addition operator.
-      * @param rhs Right value matrix.
-      * @return New matrix, the sum of <c>this</c> and <c>rhs</c>.
-      */
-      Matrix operator +(const Matrix& rhs) const;
-
-      /** Substraction operator.
-      * @param rhs Right value matrix.
-      * @return New matrix, the substract of <c>this</c> and <c>rhs</c>.
-      */
-      Matrix operator -(const Matrix& rhs) const;
-
-      /** Multiplication operator.
-      * @param rhs Right value.
-      * @return New matrix, the multiplication of <c>this</c> and <c>rhs</c>.
-      */
-      Matrix operator *(const Matrix& rhs) const;
-
-      /** Multiplication operator.
-      * @param rhs Right value.
-      * @return New vector, the multiplication of <c>this</c> and <c>rhs</c>.
-      */
-      Vector operator *(const Vector& rhs) const;
-
-    private:
-      float _m[cMatrixSize];
-  };
-
-
-  /** Matrix toquaternion. Convert matrix to quaternion.
-  * @param m Matrix to convert.
-  * @param q Quaternion to store converted matrix in.
-  */
-  void matrixToQuaternion(Matrix& m, Quaternion& q);
-
-};
-
-#endif // MATRIX_HPP_INCLUDED
+/**
+* @file matrix.hpp
+* @author skwo
+* @brief Defenition of matrix class.
+*
+* BasicMatrix<T, R, C> is a column major matrix of <c>R</c> rows and <c>C</c> columns of type
+* <c>T</c>, unrolled at compile time. Float and double 4x4 matrices multiply with SSE/AVX.
+* Matrix, the 4x4 float matrix, is the one the rest of the library works with.
+* @note Matrix * Vector ignores translation, use transformPoints to apply it.
+*/
+
+#ifndef MATRIX_HPP_INCLUDED
+#define MATRIX_HPP_INCLUDED
+
+#include <cstddef>
+
+#include "config.hpp"
+#include "euler.hpp"
+#include "vector.hpp"
+
+const unsigned short int cMatrixSize = 16;
+const float cAngToRad = 0.0174532925199432957693f;
+const unsigned short int cMatrixAlignment = 32;
+
+namespace skmath{
+
+  namespace detail{
+
+    //Degrees to radians, in the precision of T
+    template<typename T>
+    constexpr T radians(T degrees)
+    {
+      return degrees * T(0.0174532925199432957693);
+    }
+
+  };
+
+  template<typename T, int R, int C>
+  class alignas(detail::Alignment<T, R * C>::value) BasicMatrix{
+    static_assert(std::is_floating_point<T>::value, "BasicMatrix needs a floating point type");
+    static_assert(R > 0 && C > 0, "BasicMatrix needs at least one row and column");
+
+    public:
+      typedef T Scalar;
+      static const int cRows = R;
+      static const int cColumns = C;
+      static const int cSize = R * C;
+
+      /** Constructor. Create identity matrix. */
+      BasicMatrix();
+
+      /** Constructor. Create matrix with <c>x</c> <c>y</c> and <c>z</c> axes.
+      * @param x X axis.
+      * @param y Y axis.
+      * @param z Z axis.
+      */
+      BasicMatrix(const BasicVector<T, 3>& x, const BasicVector<T, 3>& y, const BasicVector<T, 3>& z);
+
+      /** Constructor. Create matrix from <c>m</c>.
+      * @param m Matrix to create from, <c>R * C</c> values column major.
+      */
+      BasicMatrix(const T* m);
+
+      /** Copy constructor.
+      * @param m Matrix to copy.
+      */
+      BasicMatrix(const BasicMatrix& m) = default;
+
+      /** Destructor. */
+      ~BasicMatrix() = default;
+
+      /** Create identity matrix. */
+      void createIdentity();
+
+      /** Create matrix with <c>x</c> <c>y</c> and <c>z</c> axes, the rest of identity.
+      * @param x X axis.
+      * @param y Y axis.
+      * @param z Z axis.
+      * @note Matrix must be at least 3x3.
+      */
+      void create(const BasicVector<T, 3>& x, const BasicVector<T, 3>& y, const BasicVector<T, 3>& z);
+
+      /** Create matrix from <c>m</c>.
+      * @param m Matrix to create from, <c>R * C</c> values column major.
+      */
+      void create(const T* m);
+
+      /** Create rotation matrix around x axis.
+      * @param angle Angle of rotation (degrees).
+      * @note Matrix must be at least 3x3.
+      */
+      void createRotationX(T angle);
+
+      /** Create rotation matrix around x axis, as createRotationX(angle).
+      * @param angle Angle of rotation (degrees).
+      */
+      void createRotationX(T angle, Exact);
+
+      /** Create rotation matrix around x axis, with sincos(Fast).
+      * @param angle Angle of rotation (degrees).
+      */
+      void createRotationX(T angle, Fast);
+
+      /** Create rotation matrix around y axis.
+      * @param angle Angle of rotation (degrees).
+      * @note Matrix must be at least 3x3.
+      */
+      void createRotationY(T angle);
+
+      /** Create rotation matrix around y axis, as createRotationY(angle).
+      * @param angle Angle of rotation (degrees).
+      */
+      void createRotationY(T angle, Exact);
+
+      /** Create rotation matrix around y axis, with sincos(Fast).
+      * @param angle Angle of rotation (degrees).
+      */
+      void createRotationY(T angle, Fast);
+
+      /** Create rotation matrix around z axis.
+      * @param angle Angle of rotation (degrees).
+      * @note Matrix must be at least 3x3.
+      */
+      void createRotationZ(T angle);
+
+      /** Create rotation matrix around z axis, as createRotationZ(angle).
+      * @param angle Angle of rotation (degrees).
+      */
+      void createRotationZ(T angle, Exact);
+
+      /** Create rotation matrix around z axis, with sincos(Fast).
+      * @param angle Angle of rotation (degrees).
+      */
+      void createRotationZ(T angle, Fast);
+
+      /** Create rotation matrix from Euler angles, the product of the rotations about the axes
+      * in <c>order</c>: cEulerXYZ gives createRotationZ(z) * createRotationY(y) * createRotationX(x).
+      * @param x Angle of rotation around x axis.
+      * @param y Angle of rotation around y axis.
+      * @param z Angle of rotation around z axis.
+      * @param order Order the rotations are applied in.
+      * @param unit Unit of the angles.
+      * @note Matrix must be at least 3x3.
+      */
+      void createFromEuler(T x, T y, T z, EulerOrder order = cEulerXYZ, AngleUnit unit = cDegrees);
+
+      /** Create perspective projection matrix, as gluPerspective: right handed view space
+      * looking down -z, clip space depth from -1 at <c>zNear</c> to 1 at <c>zFar</c>.
+      * @param fovY Vertical field of view.
+      * @param aspect Width over height of the viewport.
+      * @param zNear Distance to the near plane, greater than 0.
+      * @param zFar Distance to the far plane, greater than <c>zNear</c>.
+      * @param unit Unit of <c>fovY</c>.
+      * @note Matrix must be 4x4. A member template, so 3x3 matrices still instantiate.
+      */
+      template<int N = R>
+      void createPerspective(T fovY, T aspect, T zNear, T zFar, AngleUnit unit = cDegrees);
+
+      /** Create orthographic projection matrix, as glOrtho: the box <c>left</c> to <c>right</c>,
+      * <c>bottom</c> to <c>top</c> and -<c>zNear</c> to -<c>zFar</c> along z maps to the cube
+      * -1 to 1.
+      * @param left Left plane.
+      * @param right Right plane.
+      * @param bottom Bottom plane.
+      * @param top Top plane.
+      * @param zNear Distance to the near plane.
+      * @param zFar Distance to the far plane.
+      * @note Matrix must be 4x4.
+      */
+      template<int N = R>
+      void createOrthographic(T left, T right, T bottom, T top, T zNear, T zFar);
+
+      /** Create view matrix, as gluLookAt: a rigid transform moving <c>eye</c> to the origin and
+      * looking down -z towards <c>target</c>, with <c>up</c> towards +y.
+      * @param eye Position of the camera.
+      * @param target Point to look at, not <c>eye</c>.
+      * @param up Up direction, not parallel to <c>target</c> - <c>eye</c>.
+      * @note Matrix must be 4x4. The result inverts with inverseOrthonormal.
+      */
+      template<int N = R>
+      void createLookAt(const BasicVector<T, 3>& eye, const BasicVector<T, 3>& target, const BasicVector<T, 3>& up);
+
+      /** Get Current matrix.
+      * @param m Array of <c>R * C</c> values to store matrix in, column major.
+      */
+      void get(T* m) const;
+
+      /** Determinant, square matrices only.
+      * @return Determinant of matrix.
+      */
+      T determinant() const;
+
+      /** Transpose.
+      * @return Transposed matrix.
+      */
+      BasicMatrix<T, C, R> transpose() const;
+
+      /** Inverse, square matrices only. SSE for float 4x4 when enabled.
+      * @return Inversed matrix, or identity matrix if <c>this</c> is singular.
+      */
+      BasicMatrix inverse() const;
+
+      /** Inverse of affine matrix.
+      * Faster inverse for matrices whose last row is 0,..,0,1, such as the ones built by
+      * <c>create(x, y, z)</c> with any axes plus a translation in the last column: inverse of
+      * the upper left block and translation fix-up.
+      * @return Inversed matrix, or identity matrix if the upper left block is singular.
+      * @note The last row is assumed to be 0,..,0,1 and is not read.
+      */
+      BasicMatrix inverseAffine() const;
+
+      /** Inverse of orthonormal matrix.
+      * Fastest inverse for rotation matrices plus translation, such as the ones built by
+      * <c>createRotationX/Y/Z</c> or <c>create(x, y, z)</c> with orthonormal axes: transpose
+      * of the upper left block and translation fix-up.
+      * @return Inversed matrix.
+      * @note The upper left block is assumed orthonormal and the last row 0,..,0,1.
+      * Nothing is checked.
+      */
+      BasicMatrix inverseOrthonormal() const;
+
+      /** Access operator.
+      * @param place Place of component.
+      * @return Const reference to component in <c>place</c>.
+      * @note Place msut be between in range [0,R*C)!.
+      */
+      SKMATH_CONSTEXPR const T& operator [](const int place) const;
+
+      /** Access operator.
+      * @param place Place of component.
+      * @return Reference to component in <c>place</c>.
+      * @note Place msut be between in range [0,R*C)!.
+      */
+      SKMATH_CONSTEXPR T& operator [](const int place);
+
+      /** Access operator.
+      * @param row Row of component.
+      * @param column Column of component.
+      * @return Const reference to component in <c>row</c> and <c>column</c>.
+      */
+      SKMATH_CONSTEXPR const T& operator ()(const int row, const int column) const;
+
+      /** Access operator.
+      * @param row Row of component.
+      * @param column Column of component.
+      * @return Reference to component in <c>row</c> and <c>column</c>.
+      */
+      SKMATH_CONSTEXPR T& operator ()(const int row, const int column);
+
+      /** Equal to operator.
+      * @param rhs Right value matrix.
+      * @return true if <c>this</c> and <c>rhs</c> are equal, otherwise false.
+      */
+      bool operator ==(const BasicMatrix& rhs) const;
+
+      /** Not equal to operator.
+      * @param rhs Right value matrix.
+      * @return true if <c>this</c> and <c>rhs</c> are not equal, otherwise false.
+      */
+      bool operator !=(const BasicMatrix& rhs) const;
+
+      /** Assign operator.
+      * @param rhs Right value matrix.
+      * @return reference to <c>this</c>.
+      */
+      BasicMatrix& operator =(const BasicMatrix& rhs) = default;
+
+      /** Addition operator.
+      * @param rhs Right value matrix.
+      * @return New matrix, the sum of <c>this</c> and <c>rhs</c>.
+      */
+      BasicMatrix operator +(const BasicMatrix& rhs) const;
+
+      /** Substraction operator.
+      * @param rhs Right value matrix.
+      * @return New matrix, the substract of <c>this</c> and <c>rhs</c>.
+      */
+      BasicMatrix operator -(const BasicMatrix& rhs) const;
+
+      /** Multiplication operator.
+      * @param rhs Right value.
+      * @return New matrix, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      template<int K>
+      BasicMatrix<T, R, K> operator *(const BasicMatrix<T, C, K>& rhs) const;
+
+      /** Multiplication operator.
+      * A vector of <c>C</c> components is multiplied as is. A vector of <c>C - 1</c> components
+      * (e.g. a Vector by a Matrix) is a direction: only the upper left block is applied.
+      * @param rhs Right value.
+      * @return New vector, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      template<int M>
+      BasicVector<T, M == C ? R : M> operator *(const BasicVector<T, M>& rhs) const;
+
+      /** Multiplication operator.
+      * @param rhs Right value scalar.
+      * @return New matrix, every component multiplied by <c>rhs</c>.
+      */
+      BasicMatrix operator *(const T& rhs) const;
+
+      /** Division operator.
+      * @param rhs Right value scalar.
+      * @return New matrix, every component divided by <c>rhs</c>.
+      */
+      BasicMatrix operator /(const T& rhs) const;
+
+      /** Addition assign operator.
+      * @param rhs Right value matrix.
+      * @return reference to <c>this</c>, the sum of <c>this</c> and <c>rhs</c>.
+      */
+      BasicMatrix& operator +=(const BasicMatrix& rhs);
+
+      /** Substraction assign operator.
+      * @param rhs Right value matrix.
+      * @return reference to <c>this</c>, the substract of <c>this</c> and <c>rhs</c>.
+      */
+      BasicMatrix& operator -=(const BasicMatrix& rhs);
+
+      /** Multiplication assign operator.
+      * @param rhs Right value.
+      * @return reference to <c>this</c>, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      BasicMatrix& operator *=(const BasicMatrix<T, C, C>& rhs);
+
+      /** Multiplication assign operator.
+      * @param rhs Right value scalar.
+      * @return reference to <c>this</c>, every component multiplied by <c>rhs</c>.
+      */
+      BasicMatrix& operator *=(const T& rhs);
+
+      /** Division assign operator.
+      * @param rhs Right value scalar.
+      * @return reference to <c>this</c>, every component divided by <c>rhs</c>.
+      */
+      BasicMatrix& operator /=(const T& rhs);
+
+    private:
+      T _m[R * C]; /**< Column major, aligned for SIMD loads. */
+  };
+
+  typedef BasicMatrix<float, 3, 3> Matrix3f;
+  typedef BasicMatrix<float, 4, 4> Matrix4f;
+  typedef BasicMatrix<double, 3, 3> Matrix3d;
+  typedef BasicMatrix<double, 4, 4> Matrix4d;
+  typedef Matrix4f Matrix;
+
+  static_assert(sizeof(Matrix) == cMatrixSize * sizeof(float), "Matrix must be packed");
+  static_assert(alignof(Matrix) == cMatrixAlignment, "Matrix must be aligned for AVX loads");
+  static_assert(std::is_trivially_copyable<Matrix>::value, "Matrix must be trivially copyable");
+  static_assert(std::is_standard_layout<Matrix>::value, "Matrix must be standard layout");
+
+  template<typename T>
+  class BasicQuaternion;
+
+  /** Matrix toquaternion. Convert rotation matrix to quaternion, the inverse of
+  * quaternionToMatrix. Robust for every rotation, including 180 degree ones: the square root is
+  * taken of the largest enough of w, x, y and z (Shepperd's method), picked without branches.
+  * @param m Matrix to convert, 3x3 or 4x4.
+  * @param q Quaternion to store converted matrix in, with <c>w</c> >= 0.
+  */
+  template<typename T, int N>
+  void matrixToQuaternion(const BasicMatrix<T, N, N>& m, BasicQuaternion<T>& q);
+
+  /** Multiply. Multiply two matrices straight into <c>out</c>.
+  * @param lhs Left value matrix.
+  * @param rhs Right value matrix.
+  * @param out Matrix to store <c>lhs</c> * <c>rhs</c> in, may be <c>lhs</c> or <c>rhs</c>.
+  */
+  template<typename T, int R, int C, int K>
+  void multiply(const BasicMatrix<T, R, C>& lhs, const BasicMatrix<T, C, K>& rhs, BasicMatrix<T, R, K>& out);
+
+  /** Multiply. Multiply two 4x4 float matrices straight into <c>out</c>, without temporaries.
+  * Uses AVX/FMA or SSE when enabled at compile time.
+  * @param lhs Left value matrix.
+  * @param rhs Right value matrix.
+  * @param out Matrix to store <c>lhs</c> * <c>rhs</c> in, may be <c>lhs</c> or <c>rhs</c>.
+  */
+  void multiply(const Matrix& lhs, const Matrix& rhs, Matrix& out);
+
+  /** Multiply. Multiply two 4x4 double matrices straight into <c>out</c>, without temporaries.
+  * Uses AVX/FMA when enabled at compile time.
+  * @param lhs Left value matrix.
+  * @param rhs Right value matrix.
+  * @param out Matrix to store <c>lhs</c> * <c>rhs</c> in, may be <c>lhs</c> or <c>rhs</c>.
+  */
+  void multiply(const Matrix4d& lhs, const Matrix4d& rhs, Matrix4d& out);
+
+  /** Multiply batch, <c>out[i]</c> = <c>lhs[i]</c> * <c>rhs[i]</c>. Large batches are split across
+  * the thread pool of parallelFor; give <c>out</c> 64-byte alignment (simd::alignedAlloc) so
+  * no two threads write the same cache line.
+  * @param lhs Array of <c>size</c> left value matrices.
+  * @param rhs Array of <c>size</c> right value matrices.
+  * @param out Array of <c>size</c> matrices to store result in, may be <c>lhs</c> or <c>rhs</c>.
+  * @param size Number of matrices.
+  */
+  void multiplyBatch(const Matrix* lhs, const Matrix* rhs, Matrix* out, std::size_t size);
+
+  /** Multiply batch, <c>out[i]</c> = <c>lhs</c> * <c>rhs[i]</c>, e.g. one parent transform applied
+  * to many children.
+  * @param lhs Left value matrix, not an element of <c>out</c>.
+  * @param rhs Array of <c>size</c> right value matrices.
+  * @param out Array of <c>size</c> matrices to store result in, may be <c>rhs</c>.
+  * @param size Number of matrices.
+  */
+  void multiplyBatch(const Matrix& lhs, const Matrix* rhs, Matrix* out, std::size_t size);
+
+  /** Multiply batch, <c>out[i]</c> = <c>lhs[i]</c> * <c>rhs</c>.
+  * @param lhs Array of <c>size</c> left value matrices.
+  * @param rhs Right value matrix, not an element of <c>out</c>.
+  * @param out Array of <c>size</c> matrices to store result in, may be <c>lhs</c>.
+  * @param size Number of matrices.
+  */
+  void multiplyBatch(const Matrix* lhs, const Matrix& rhs, Matrix* out, std::size_t size);
+
+  /** Euler angles batch, <c>out[i]</c> as createFromEuler(x[i], y[i], z[i], order, unit).
+  * The angles are structure of arrays, so sines and cosines come from sincosBatch (Fast) a block
+  * at a time; max error of the elements is <c>cFastEulerError</c>.
+  * @param x Array of <c>size</c> angles of rotation around x axis.
+  * @param y Array of <c>size</c> angles of rotation around y axis.
+  * @param z Array of <c>size</c> angles of rotation around z axis.
+  * @param out Array of <c>size</c> matrices to store the rotations in.
+  * @param size Number of rotations.
+  * @param order Order the rotations are applied in.
+  * @param unit Unit of the angles.
+  */
+  void fromEulerBatch(const float* x, const float* y, const float* z, Matrix* out, std::size_t size,
+                      EulerOrder order = cEulerXYZ, AngleUnit unit = cDegrees);
+
+  /** Matrix to quaternion batch, as matrixToQuaternion. Converts <c>simd::cWidth</c> matrices
+  * at a time with SSE/AVX, and splits large batches across threads.
+  * @param in Array of <c>size</c> rotation matrices.
+  * @param out Array of <c>size</c> quaternions to store converted matrices in.
+  * @param size Number of matrices.
+  */
+  void matrixToQuaternionBatch(const Matrix* in, BasicQuaternion<float>* out, std::size_t size);
+
+  /** Transform points. Apply the full affine matrix, including translation <c>m[12..14]</c>.
+  * @param m Transformation matrix.
+  * @param in Array of <c>size</c> points.
+  * @param out Array of <c>size</c> vectors to store transformed points in, may be <c>in</c>.
+  * @param size Number of points.
+  * @param nonTemporal Write <c>out</c> with streaming stores that bypass the cache. Use it when
+  * <c>out</c> is too large to stay in cache and is not read back right away.
+  */
+  void transformPoints(const Matrix& m, const Vector* in, Vector* out, std::size_t size, bool nonTemporal = false);
+
+  /** Transform directions. Apply only the 3x3 rotation/scale part of the matrix.
+  * @param m Transformation matrix.
+  * @param in Array of <c>size</c> directions.
+  * @param out Array of <c>size</c> vectors to store transformed directions in, may be <c>in</c>.
+  * @param size Number of directions.
+  * @param nonTemporal Write <c>out</c> with streaming stores that bypass the cache.
+  */
+  void transformDirections(const Matrix& m, const Vector* in, Vector* out, std::size_t size, bool nonTemporal = false);
+
+  /** Determinant batch.
+  * @param in Array of <c>size</c> matrices.
+  * @param out Array of <c>size</c> floats to store determinants in.
+  * @param size Number of matrices.
+  */
+  void determinantBatch(const Matrix* in, float* out, std::size_t size);
+
+  /** Transpose batch.
+  * @param in Array of <c>size</c> matrices.
+  * @param out Array of <c>size</c> matrices to store result in, may be <c>in</c>.
+  * @param size Number of matrices.
+  */
+  void transposeBatch(const Matrix* in, Matrix* out, std::size_t size);
+
+  /** Inverse batch, as Matrix::inverse.
+  * @param in Array of <c>size</c> matrices.
+  * @param out Array of <c>size</c> matrices to store result in, may be <c>in</c>.
+  * @param size Number of matrices.
+  */
+  void inverseBatch(const Matrix* in, Matrix* out, std::size_t size);
+
+  /** Inverse of affine matrices batch, as Matrix::inverseAffine.
+  * @param in Array of <c>size</c> matrices.
+  * @param out Array of <c>size</c> matrices to store result in, may be <c>in</c>.
+  * @param size Number of matrices.
+  */
+  void inverseAffineBatch(const Matrix* in, Matrix* out, std::size_t size);
+
+  /** Inverse of orthonormal matrices batch, as Matrix::inverseOrthonormal.
+  * @param in Array of <c>size</c> matrices.
+  * @param out Array of <c>size</c> matrices to store result in, may be <c>in</c>.
+  * @param size Number of matrices.
+  */
+  void inverseOrthonormalBatch(const Matrix* in, Matrix* out, std::size_t size);
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "matrix.inl"
+#endif
+
+#endif // MATRIX_HPP_INCLUDED
@@ -0,0 +1,1174 @@
+/**
+* @file matrix.inl
+* @author skwo
+* @brief Realization of matrix class.
+* @note Included by matrix.cpp, or by matrix.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <cmath>
+#include <cstdint>
+
+#include "parallel.hpp"
+#include "profile.hpp"
+#include "quaternion.hpp"
+#include "simd.hpp"
+
+namespace skmath{
+
+  namespace detail{
+
+    template<int N>
+    using Size = std::integral_constant<int, N>;
+
+    //Rotation about axis 0, 1 or 2 with s = sin(angle) and c = cos(angle)
+    template<typename T, int R, int C>
+    SKMATH_INLINE void rotation(BasicMatrix<T, R, C>& m, int axis, T s, T c)
+    {
+      static_assert(R >= 3 && C >= 3, "Rotations need a matrix of at least 3x3");
+
+      const int i = (axis + 1) % 3;
+      const int j = (axis + 2) % 3;
+
+      m.createIdentity();
+      m(i, i) = c;  m(i, j) = -s;
+      m(j, i) = s;  m(j, j) =  c;
+    }
+
+#if defined(SKMATH_SSE)
+    //2x2 matrices packed in a register as (m00, m01, m10, m11)
+
+    //A * B
+    SKMATH_INLINE __m128 mat2Mul(__m128 a, __m128 b)
+    {
+      return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+                        _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+
+    //Adjugate(A) * B
+    SKMATH_INLINE __m128 mat2AdjMul(__m128 a, __m128 b)
+    {
+      return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                        _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+
+    //A * Adjugate(B)
+    SKMATH_INLINE __m128 mat2MulAdj(__m128 a, __m128 b)
+    {
+      return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+                        _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+#endif
+
+
+    //Determinant of a column major N x N matrix
+    template<typename T>
+    SKMATH_INLINE T determinant(const T* m, Size<1>)
+    {
+      return m[0];
+    }
+    template<typename T>
+    SKMATH_INLINE T determinant(const T* m, Size<2>)
+    {
+      return m[0] * m[3] - m[2] * m[1];
+    }
+    template<typename T>
+    SKMATH_INLINE T determinant(const T* m, Size<3>)
+    {
+      //x . (y x z) of the columns
+      return m[0] * (m[4] * m[8] - m[5] * m[7]) +
+             m[1] * (m[5] * m[6] - m[3] * m[8]) +
+             m[2] * (m[3] * m[7] - m[4] * m[6]);
+    }
+    template<typename T>
+    SKMATH_INLINE T determinant(const T* m, Size<4>)
+    {
+      T s0 = m[0] * m[5] - m[4] * m[1];
+      T s1 = m[0] * m[6] - m[4] * m[2];
+      T s2 = m[0] * m[7] - m[4] * m[3];
+      T s3 = m[1] * m[6] - m[5] * m[2];
+      T s4 = m[1] * m[7] - m[5] * m[3];
+      T s5 = m[2] * m[7] - m[6] * m[3];
+
+      T c5 = m[10] * m[15] - m[14] * m[11];
+      T c4 = m[ 9] * m[15] - m[13] * m[11];
+      T c3 = m[ 9] * m[14] - m[13] * m[10];
+      T c2 = m[ 8] * m[15] - m[12] * m[11];
+      T c1 = m[ 8] * m[14] - m[12] * m[10];
+      T c0 = m[ 8] * m[13] - m[12] * m[ 9];
+
+      return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+    template<typename T, int N>
+    SKMATH_INLINE T determinant(const T* m, Size<N>)
+    {
+      //Gaussian elimination with partial pivoting
+      T a[N * N];
+      for(int i = 0; i < N * N; i++)
+        a[i] = m[i];
+
+      T res = T(1);
+      for(int c = 0; c < N; c++)
+      {
+        int pivot = c;
+        for(int r = c + 1; r < N; r++)
+          if(std::fabs(a[c * N + r]) > std::fabs(a[c * N + pivot]))
+            pivot = r;
+
+        if(a[c * N + pivot] == T(0))
+          return T(0);
+
+        if(pivot != c)
+        {
+          for(int k = 0; k < N; k++)
+            std::swap(a[k * N + c], a[k * N + pivot]);
+          res = -res;
+        }
+
+        res *= a[c * N + c];
+        for(int r = c + 1; r < N; r++)
+        {
+          T f = a[c * N + r] / a[c * N + c];
+          for(int k = c; k < N; k++)
+            a[k * N + r] -= f * a[k * N + c];
+        }
+      }
+
+      return res;
+    }
+
+    //Inverse of a column major N x N matrix, r may be m. Returns false if singular.
+    template<typename T>
+    SKMATH_INLINE bool inverse(const T* m, T* r, Size<1>)
+    {
+      if(m[0] == T(0))
+        return false;
+
+      r[0] = T(1) / m[0];
+      return true;
+    }
+    template<typename T>
+    SKMATH_INLINE bool inverse(const T* m, T* r, Size<2>)
+    {
+      T det = m[0] * m[3] - m[2] * m[1];
+      if(det == T(0))
+        return false;
+
+      T a = m[0], b = m[1], c = m[2], d = m[3];
+      r[0] =  d / det;
+      r[1] = -b / det;
+      r[2] = -c / det;
+      r[3] =  a / det;
+      return true;
+    }
+    template<typename T>
+    SKMATH_INLINE bool inverse(const T* m, T* r, Size<3>)
+    {
+      //Rows of the inverse are the cross products of the columns x, y, z over x . (y x z)
+      T yz0 = m[4] * m[8] - m[5] * m[7], yz1 = m[5] * m[6] - m[3] * m[8], yz2 = m[3] * m[7] - m[4] * m[6];
+      T zx0 = m[7] * m[2] - m[8] * m[1], zx1 = m[8] * m[0] - m[6] * m[2], zx2 = m[6] * m[1] - m[7] * m[0];
+      T xy0 = m[1] * m[5] - m[2] * m[4], xy1 = m[2] * m[3] - m[0] * m[5], xy2 = m[0] * m[4] - m[1] * m[3];
+
+      T det = m[0] * yz0 + m[1] * yz1 + m[2] * yz2;
+      if(det == T(0))
+        return false;
+
+      r[0] = yz0 / det;  r[3] = yz1 / det;  r[6] = yz2 / det;
+      r[1] = zx0 / det;  r[4] = zx1 / det;  r[7] = zx2 / det;
+      r[2] = xy0 / det;  r[5] = xy1 / det;  r[8] = xy2 / det;
+      return true;
+    }
+    template<typename T>
+    SKMATH_INLINE bool inverse(const T* m, T* r, Size<4>)
+    {
+      //Laplace expansion with 2x2 sub-determinants
+      T s0 = m[0] * m[5] - m[4] * m[1];
+      T s1 = m[0] * m[6] - m[4] * m[2];
+      T s2 = m[0] * m[7] - m[4] * m[3];
+      T s3 = m[1] * m[6] - m[5] * m[2];
+      T s4 = m[1] * m[7] - m[5] * m[3];
+      T s5 = m[2] * m[7] - m[6] * m[3];
+
+      T c5 = m[10] * m[15] - m[14] * m[11];
+      T c4 = m[ 9] * m[15] - m[13] * m[11];
+      T c3 = m[ 9] * m[14] - m[13] * m[10];
+      T c2 = m[ 8] * m[15] - m[12] * m[11];
+      T c1 = m[ 8] * m[14] - m[12] * m[10];
+      T c0 = m[ 8] * m[13] - m[12] * m[ 9];
+
+      T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+      if(det == T(0))
+        return false;
+
+      T inv = T(1) / det;
+      T t[16];
+
+      t[ 0] = ( m[ 5] * c5 - m[ 6] * c4 + m[ 7] * c3) * inv;
+      t[ 1] = (-m[ 1] * c5 + m[ 2] * c4 - m[ 3] * c3) * inv;
+      t[ 2] = ( m[13] * s5 - m[14] * s4 + m[15] * s3) * inv;
+      t[ 3] = (-m[ 9] * s5 + m[10] * s4 - m[11] * s3) * inv;
+
+      t[ 4] = (-m[ 4] * c5 + m[ 6] * c2 - m[ 7] * c1) * inv;
+      t[ 5] = ( m[ 0] * c5 - m[ 2] * c2 + m[ 3] * c1) * inv;
+      t[ 6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * inv;
+      t[ 7] = ( m[ 8] * s5 - m[10] * s2 + m[11] * s1) * inv;
+
+      t[ 8] = ( m[ 4] * c4 - m[ 5] * c2 + m[ 7] * c0) * inv;
+      t[ 9] = (-m[ 0] * c4 + m[ 1] * c2 - m[ 3] * c0) * inv;
+      t[10] = ( m[12] * s4 - m[13] * s2 + m[15] * s0) * inv;
+      t[11] = (-m[ 8] * s4 + m[ 9] * s2 - m[11] * s0) * inv;
+
+      t[12] = (-m[ 4] * c3 + m[ 5] * c1 - m[ 6] * c0) * inv;
+      t[13] = ( m[ 0] * c3 - m[ 1] * c1 + m[ 2] * c0) * inv;
+      t[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * inv;
+      t[15] = ( m[ 8] * s3 - m[ 9] * s1 + m[10] * s0) * inv;
+
+      for(int i = 0; i < 16; i++)
+        r[i] = t[i];
+      return true;
+    }
+    template<typename T, int N>
+    SKMATH_INLINE bool inverse(const T* m, T* r, Size<N>)
+    {
+      //Gauss-Jordan elimination with partial pivoting
+      T a[N * N];
+      T b[N * N];
+      for(int i = 0; i < N * N; i++)
+      {
+        a[i] = m[i];
+        b[i] = (i % N == i / N) ? T(1) : T(0);
+      }
+
+      for(int c = 0; c < N; c++)
+      {
+        int pivot = c;
+        for(int k = c + 1; k < N; k++)
+          if(std::fabs(a[c * N + k]) > std::fabs(a[c * N + pivot]))
+            pivot = k;
+
+        if(a[c * N + pivot] == T(0))
+          return false;
+
+        for(int k = 0; k < N; k++)
+        {
+          std::swap(a[k * N + c], a[k * N + pivot]);
+          std::swap(b[k * N + c], b[k * N + pivot]);
+        }
+
+        T inv = T(1) / a[c * N + c];
+        for(int k = 0; k < N; k++)
+        {
+          a[k * N + c] *= inv;
+          b[k * N + c] *= inv;
+        }
+
+        for(int row = 0; row < N; row++)
+        {
+          T f = a[c * N + row];
+          if(row == c || f == T(0))
+            continue;
+
+          for(int k = 0; k < N; k++)
+          {
+            a[k * N + row] -= f * a[k * N + c];
+            b[k * N + row] -= f * b[k * N + c];
+          }
+        }
+      }
+
+      for(int i = 0; i < N * N; i++)
+        r[i] = b[i];
+      return true;
+    }
+
+#if defined(SKMATH_SSE)
+    //Float 4x4 with SSE, m and r aligned to 16 bytes
+    SKMATH_INLINE bool inverse(const float* m, float* r, Size<4>)
+    {
+      //Block method with 2x2 adjugates, see M = | A B |
+      //                                         | C D |
+      __m128 c0 = _mm_load_ps(m);
+      __m128 c1 = _mm_load_ps(m + 4);
+      __m128 c2 = _mm_load_ps(m + 8);
+      __m128 c3 = _mm_load_ps(m + 12);
+
+      __m128 a = _mm_movelh_ps(c0, c1);
+      __m128 b = _mm_movehl_ps(c1, c0);
+      __m128 c = _mm_movelh_ps(c2, c3);
+      __m128 d = _mm_movehl_ps(c3, c2);
+
+      //|A| |B| |C| |D|
+      __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+      __m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+      __m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+      __m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+      __m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+      //D#C and A#B
+      __m128 dc = mat2AdjMul(d, c);
+      __m128 ab = mat2AdjMul(a, b);
+
+      //X# = |D|A - B(D#C), W# = |A|D - C(A#B)
+      __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2Mul(b, dc));
+      __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2Mul(c, ab));
+
+      //Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+      __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2MulAdj(d, ab));
+      __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2MulAdj(a, dc));
+
+      //|M| = |A||D| + |B||C| - tr((A#B)(D#C))
+      __m128 tr = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+      tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(2, 3, 0, 1)));
+      tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 0, 3, 2)));
+      __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+      if(_mm_cvtss_f32(det) == 0.0f)
+        return false;
+
+      __m128 rDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+      x = _mm_mul_ps(x, rDet);
+      y = _mm_mul_ps(y, rDet);
+      z = _mm_mul_ps(z, rDet);
+      w = _mm_mul_ps(w, rDet);
+
+      //Adjugate and store
+      _mm_store_ps(r,      _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+      _mm_store_ps(r + 4,  _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+      _mm_store_ps(r + 8,  _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+      _mm_store_ps(r + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+
+      return true;
+    }
+#endif
+
+    //Transpose
+    template<typename T, int R, int C>
+    SKMATH_INLINE void transpose(const BasicMatrix<T, R, C>& m, BasicMatrix<T, C, R>& r)
+    {
+      unroll<C>([&](auto c) {
+        unroll<R>([&](auto row) { r(c, row) = m(row, c); });
+      });
+    }
+
+#if defined(SKMATH_SSE)
+    SKMATH_INLINE void transpose(const Matrix4f& m, Matrix4f& r)
+    {
+      __m128 c0 = _mm_load_ps(&m[0]);
+      __m128 c1 = _mm_load_ps(&m[4]);
+      __m128 c2 = _mm_load_ps(&m[8]);
+      __m128 c3 = _mm_load_ps(&m[12]);
+      _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+      _mm_store_ps(&r[0], c0);
+      _mm_store_ps(&r[4], c1);
+      _mm_store_ps(&r[8], c2);
+      _mm_store_ps(&r[12], c3);
+    }
+#endif
+
+    //Multiply, unrolled. The result is kept in registers until the end, so out may alias.
+    template<typename T, int R, int C, int K>
+    SKMATH_INLINE void multiply(const BasicMatrix<T, R, C>& lhs, const BasicMatrix<T, C, K>& rhs, BasicMatrix<T, R, K>& out)
+    {
+      T res[R * K];
+      unroll<K>([&](auto j) {
+        unroll<R>([&](auto i) {
+          T sum = lhs(i, 0) * rhs(0, j);
+          unroll<C - 1>([&](auto k) { sum += lhs(i, k + 1) * rhs(k + 1, j); });
+          res[j * R + i] = sum;
+        });
+      });
+
+      unroll<R * K>([&](auto i) { out[i] = res[i]; });
+    }
+
+  };
+
+  //Constructor
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C>::BasicMatrix()
+  {
+    createIdentity();
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C>::BasicMatrix(const BasicVector<T, 3>& x, const BasicVector<T, 3>& y, const BasicVector<T, 3>& z)
+  {
+    create(x, y, z);
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C>::BasicMatrix(const T* m)
+  {
+    create(m);
+  }
+
+  //Create identity
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createIdentity()
+  {
+    detail::unroll<R * C>([&](auto i) { _m[i] = (i % R == i / R) ? T(1) : T(0); });
+  }
+
+  //Create
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::create(const BasicVector<T, 3>& x, const BasicVector<T, 3>& y, const BasicVector<T, 3>& z)
+  {
+    static_assert(R >= 3 && C >= 3, "Axes need a matrix of at least 3x3");
+
+    const T* px = &x[0];
+    const T* py = &y[0];
+    const T* pz = &z[0];
+
+    createIdentity();
+    detail::unroll<3>([&](auto r) {
+      (*this)(r, 0) = px[r];
+      (*this)(r, 1) = py[r];
+      (*this)(r, 2) = pz[r];
+    });
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::create(const T* m)
+  {
+    detail::unroll<R * C>([&](auto i) { _m[i] = m[i]; });
+  }
+
+  //Create rotation X
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createRotationX(T angle)
+  {
+    this->createRotationX(angle, Exact());
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createRotationX(T angle, Exact)
+  {
+    T s, c;
+    sincos(detail::radians(angle), s, c, Exact());
+    detail::rotation(*this, 0, s, c);
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createRotationX(T angle, Fast)
+  {
+    T s, c;
+    sincos(detail::radians(angle), s, c, Fast());
+    detail::rotation(*this, 0, s, c);
+  }
+
+  //Create rotation Y
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createRotationY(T angle)
+  {
+    this->createRotationY(angle, Exact());
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createRotationY(T angle, Exact)
+  {
+    T s, c;
+    sincos(detail::radians(angle), s, c, Exact());
+    detail::rotation(*this, 1, s, c);
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createRotationY(T angle, Fast)
+  {
+    T s, c;
+    sincos(detail::radians(angle), s, c, Fast());
+    detail::rotation(*this, 1, s, c);
+  }
+
+  //Create rotation Z
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createRotationZ(T angle)
+  {
+    this->createRotationZ(angle, Exact());
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createRotationZ(T angle, Exact)
+  {
+    T s, c;
+    sincos(detail::radians(angle), s, c, Exact());
+    detail::rotation(*this, 2, s, c);
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createRotationZ(T angle, Fast)
+  {
+    T s, c;
+    sincos(detail::radians(angle), s, c, Fast());
+    detail::rotation(*this, 2, s, c);
+  }
+
+  //Create from Euler angles
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createFromEuler(T x, T y, T z, EulerOrder order, AngleUnit unit)
+  {
+    static_assert(R >= 3 && C >= 3, "Rotations need a matrix of at least 3x3");
+
+    const T angles[3] = { x, y, z };
+    T s[3], c[3], m[3][3];
+    for(int a = 0; a < 3; a++)
+      sincos(unit == cDegrees ? detail::radians(angles[a]) : angles[a], s[a], c[a], Exact());
+
+    detail::eulerDispatch(order, [&](auto o) { detail::eulerMatrix<decltype(o)::value>(s, c, m); });
+
+    createIdentity();
+    detail::unroll<3>([&](auto r) {
+      detail::unroll<3>([&](auto col) { (*this)(r, col) = m[r][col]; });
+    });
+  }
+
+  //Create perspective
+  template<typename T, int R, int C>
+  template<int N>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createPerspective(T fovY, T aspect, T zNear, T zFar, AngleUnit unit)
+  {
+    static_assert(N == 4 && C == 4, "Projections need a 4x4 matrix");
+
+    const T f = T(1) / std::tan((unit == cDegrees ? detail::radians(fovY) : fovY) * T(0.5));
+    const T depth = T(1) / (zNear - zFar);
+
+    detail::unroll<R * C>([&](auto i) { _m[i] = T(0); });
+    (*this)(0, 0) = f / aspect;
+    (*this)(1, 1) = f;
+    (*this)(2, 2) = (zFar + zNear) * depth;
+    (*this)(2, 3) = T(2) * zFar * zNear * depth;
+    (*this)(3, 2) = T(-1);
+  }
+
+  //Create orthographic
+  template<typename T, int R, int C>
+  template<int N>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createOrthographic(T left, T right, T bottom, T top, T zNear, T zFar)
+  {
+    static_assert(N == 4 && C == 4, "Projections need a 4x4 matrix");
+
+    const T width = T(1) / (right - left);
+    const T height = T(1) / (top - bottom);
+    const T depth = T(1) / (zFar - zNear);
+
+    createIdentity();
+    (*this)(0, 0) = T(2) * width;
+    (*this)(1, 1) = T(2) * height;
+    (*this)(2, 2) = T(-2) * depth;
+    (*this)(0, 3) = -(right + left) * width;
+    (*this)(1, 3) = -(top + bottom) * height;
+    (*this)(2, 3) = -(zFar + zNear) * depth;
+  }
+
+  //Create look at
+  template<typename T, int R, int C>
+  template<int N>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::createLookAt(const BasicVector<T, 3>& eye, const BasicVector<T, 3>& target,
+                                                      const BasicVector<T, 3>& up)
+  {
+    static_assert(N == 4 && C == 4, "View matrices need a 4x4 matrix");
+
+    //Forward, side and true up are the rows; the translation moves eye to the origin
+    const BasicVector<T, 3> f = (target - eye).normalize();
+    const BasicVector<T, 3> s = (f * up).normalize();
+    const BasicVector<T, 3> u = s * f;
+    const T* ps = &s[0];
+    const T* pu = &u[0];
+    const T* pf = &f[0];
+
+    createIdentity();
+    detail::unroll<3>([&](auto c) {
+      (*this)(0, c) = ps[c];
+      (*this)(1, c) = pu[c];
+      (*this)(2, c) = -pf[c];
+    });
+    (*this)(0, 3) = -s.dot(eye);
+    (*this)(1, 3) = -u.dot(eye);
+    (*this)(2, 3) = f.dot(eye);
+  }
+
+  //Get Current matrix
+  template<typename T, int R, int C>
+  SKMATH_INLINE void BasicMatrix<T, R, C>::get(T* m) const
+  {
+    detail::unroll<R * C>([&](auto i) { m[i] = _m[i]; });
+  }
+
+  //Determinant
+  template<typename T, int R, int C>
+  SKMATH_INLINE T BasicMatrix<T, R, C>::determinant() const
+  {
+    static_assert(R == C, "Determinant needs a square matrix");
+
+    return detail::determinant(_m, detail::Size<R>());
+  }
+
+  //Transpose
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, C, R> BasicMatrix<T, R, C>::transpose() const
+  {
+    BasicMatrix<T, C, R> res;
+    detail::transpose(*this, res);
+
+    return res;
+  }
+
+  //Inverse
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C> BasicMatrix<T, R, C>::inverse() const
+  {
+    SKMATH_PROFILE_SAMPLE(cProfileMatrixInverse);
+    static_assert(R == C, "Inverse needs a square matrix");
+
+    BasicMatrix res;
+
+    if(!detail::inverse(_m, res._m, detail::Size<R>()))
+      res.createIdentity();
+
+    return res;
+  }
+
+  //Inverse affine
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C> BasicMatrix<T, R, C>::inverseAffine() const
+  {
+    static_assert(R == C && R >= 2, "Affine inverse needs a square matrix of at least 2x2");
+
+    const int D = R - 1;
+    alignas(detail::Alignment<T, D * D>::value) T block[D * D];
+    alignas(detail::Alignment<T, D * D>::value) T inv[D * D];
+    BasicMatrix res;
+
+    detail::unroll<D>([&](auto c) {
+      detail::unroll<D>([&](auto r) { block[c * D + r] = (*this)(r, c); });
+    });
+
+    if(!detail::inverse(block, inv, detail::Size<D>()))
+      return res;
+
+    //Translation of the inverse is -inverse(block) * translation
+    detail::unroll<D>([&](auto r) {
+      T t = inv[r] * (*this)(0, D);
+      detail::unroll<D>([&](auto c) {
+        res(r, c) = inv[c * D + r];
+        if(c > 0)
+          t += inv[c * D + r] * (*this)(c, D);
+      });
+      res(r, D) = -t;
+    });
+
+    return res;
+  }
+
+  //Inverse orthonormal
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C> BasicMatrix<T, R, C>::inverseOrthonormal() const
+  {
+    static_assert(R == C && R >= 2, "Orthonormal inverse needs a square matrix of at least 2x2");
+
+    const int D = R - 1;
+    BasicMatrix res;
+
+    //Transposed block, translation of the inverse is -transpose(block) * translation
+    detail::unroll<D>([&](auto r) {
+      T t = (*this)(0, r) * (*this)(0, D);
+      detail::unroll<D>([&](auto c) {
+        res(r, c) = (*this)(c, r);
+        if(c > 0)
+          t += (*this)(c, r) * (*this)(c, D);
+      });
+      res(r, D) = -t;
+    });
+
+    return res;
+  }
+
+  //Operator []
+  template<typename T, int R, int C>
+  SKMATH_CONSTEXPR SKMATH_INLINE const T& BasicMatrix<T, R, C>::operator [](const int place) const
+  {
+    return _m[place];
+  }
+  template<typename T, int R, int C>
+  SKMATH_CONSTEXPR SKMATH_INLINE T& BasicMatrix<T, R, C>::operator [](const int place)
+  {
+    return _m[place];
+  }
+
+  //Operator ()
+  template<typename T, int R, int C>
+  SKMATH_CONSTEXPR SKMATH_INLINE const T& BasicMatrix<T, R, C>::operator ()(const int row, const int column) const
+  {
+    return _m[column * R + row];
+  }
+  template<typename T, int R, int C>
+  SKMATH_CONSTEXPR SKMATH_INLINE T& BasicMatrix<T, R, C>::operator ()(const int row, const int column)
+  {
+    return _m[column * R + row];
+  }
+
+  //Operator ==
+  template<typename T, int R, int C>
+  SKMATH_INLINE bool BasicMatrix<T, R, C>::operator ==(const BasicMatrix& rhs) const
+  {
+    if(&rhs == this)
+      return true;
+
+    for(int i = 0; i < R * C; i++)
+      if(_m[i] != rhs[i])
+        return false;
+
+    return true;
+  }
+
+  //Operator !=
+  template<typename T, int R, int C>
+  SKMATH_INLINE bool BasicMatrix<T, R, C>::operator !=(const BasicMatrix& rhs) const
+  {
+    return !(*this == rhs);
+  }
+
+  //Operator +
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C> BasicMatrix<T, R, C>::operator +(const BasicMatrix& rhs) const
+  {
+    BasicMatrix res(*this);
+    res += rhs;
+
+    return res;
+  }
+
+  //Operator -
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C> BasicMatrix<T, R, C>::operator -(const BasicMatrix& rhs) const
+  {
+    BasicMatrix res(*this);
+    res -= rhs;
+
+    return res;
+  }
+
+  //Operator *
+  template<typename T, int R, int C>
+  template<int K>
+  SKMATH_INLINE BasicMatrix<T, R, K> BasicMatrix<T, R, C>::operator *(const BasicMatrix<T, C, K>& rhs) const
+  {
+    SKMATH_PROFILE_SAMPLE(cProfileMatrixMultiply);
+    BasicMatrix<T, R, K> res;
+    multiply(*this, rhs, res);
+
+    return res;
+  }
+  template<typename T, int R, int C>
+  template<int M>
+  SKMATH_INLINE BasicVector<T, M == C ? R : M> BasicMatrix<T, R, C>::operator *(const BasicVector<T, M>& rhs) const
+  {
+    SKMATH_PROFILE_SAMPLE(cProfileMatrixVector);
+    static_assert(M == C || (M == C - 1 && R == C), "Vector must have as many components as the matrix columns, or one less");
+
+    const T* v = &rhs[0];
+    T res[M == C ? R : M];
+    detail::unroll<M == C ? R : M>([&](auto r) {
+      T sum = (*this)(r, 0) * v[0];
+      detail::unroll<M - 1>([&](auto c) { sum += (*this)(r, c + 1) * v[c + 1]; });
+      res[r] = sum;
+    });
+
+    return BasicVector<T, M == C ? R : M>(res);
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C> BasicMatrix<T, R, C>::operator *(const T& rhs) const
+  {
+    BasicMatrix res(*this);
+    res *= rhs;
+
+    return res;
+  }
+
+  //Operator /
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C> BasicMatrix<T, R, C>::operator /(const T& rhs) const
+  {
+    BasicMatrix res(*this);
+    res /= rhs;
+
+    return res;
+  }
+
+  //Operator +=
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C>& BasicMatrix<T, R, C>::operator +=(const BasicMatrix& rhs)
+  {
+    for(int i = 0; i < R * C; i++)
+      _m[i] += rhs[i];
+
+    return *this;
+  }
+
+  //Operator -=
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C>& BasicMatrix<T, R, C>::operator -=(const BasicMatrix& rhs)
+  {
+    for(int i = 0; i < R * C; i++)
+      _m[i] -= rhs[i];
+
+    return *this;
+  }
+
+  //Operator *=
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C>& BasicMatrix<T, R, C>::operator *=(const BasicMatrix<T, C, C>& rhs)
+  {
+    multiply(*this, rhs, *this);
+
+    return *this;
+  }
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C>& BasicMatrix<T, R, C>::operator *=(const T& rhs)
+  {
+    for(int i = 0; i < R * C; i++)
+      _m[i] *= rhs;
+
+    return *this;
+  }
+
+  //Operator /=
+  template<typename T, int R, int C>
+  SKMATH_INLINE BasicMatrix<T, R, C>& BasicMatrix<T, R, C>::operator /=(const T& rhs)
+  {
+    for(int i = 0; i < R * C; i++)
+      _m[i] /= rhs;
+
+    return *this;
+  }
+
+
+  //Matrix to quaternion. Shepperd's method: 4 w^2, 4 x^2, 4 y^2 and 4 z^2 are 1 plus or minus
+  //the diagonal elements; take the square root of a large one, t, and the other components
+  //from off diagonal sums and differences divided by it. The case is picked from m(2, 2) and
+  //m(0, 0) against m(1, 1) as in Day's "Converting a Rotation Matrix to a Quaternion", which
+  //keeps t >= 1, with selects the compiler turns into blends rather than branches.
+  template<typename T, int N>
+  SKMATH_INLINE void matrixToQuaternion(const BasicMatrix<T, N, N>& m, BasicQuaternion<T>& q)
+  {
+    SKMATH_PROFILE_SAMPLE(cProfileMatrixToQuaternion);
+    static_assert(N == 3 || N == 4, "Rotation matrix must be 3x3 or 4x4");
+
+    const T m00 = m(0, 0), m11 = m(1, 1), m22 = m(2, 2);
+    const T p01 = m(0, 1) + m(1, 0), p20 = m(2, 0) + m(0, 2), p12 = m(1, 2) + m(2, 1);
+    const T n01 = m(0, 1) - m(1, 0), n20 = m(2, 0) - m(0, 2), n12 = m(1, 2) - m(2, 1);
+
+    //c && d: x largest, c && !d: y, !c && d: z, !c && !d: w
+    const bool c = m22 < T(0);
+    const bool d = c ? m11 < m00 : m00 < -m11;
+
+    const T t = T(1) + (c ? -m22 : m22) + (c ? (d ? m00 - m11 : m11 - m00) : (d ? -(m00 + m11) : m00 + m11));
+    const T x = c ? (d ? t : p01) : (d ? p20 : n12);
+    const T y = c ? (d ? p01 : t) : (d ? p12 : n20);
+    const T z = c ? (d ? p20 : p12) : (d ? t : n01);
+    const T w = c ? (d ? n12 : n20) : (d ? n01 : t);
+
+    //Scale to unit length, and to w >= 0 like the trace formula gives
+    const T f = (w < T(0) ? T(-0.5) : T(0.5)) / std::sqrt(t);
+    q[0] = x * f;
+    q[1] = y * f;
+    q[2] = z * f;
+    q[3] = w * f;
+  }
+
+  //Multiply
+  template<typename T, int R, int C, int K>
+  SKMATH_INLINE void multiply(const BasicMatrix<T, R, C>& lhs, const BasicMatrix<T, C, K>& rhs, BasicMatrix<T, R, K>& out)
+  {
+    detail::multiply(lhs, rhs, out);
+  }
+  SKMATH_INLINE void multiply(const Matrix& lhs, const Matrix& rhs, Matrix& out)
+  {
+    const float* a = &lhs[0];
+    const float* b = &rhs[0];
+    float* r = &out[0];
+
+    //Column j of the result is lhs * (column j of rhs). Every column of lhs is loaded
+    //before anything is stored, and column j of rhs is read before column j of out is
+    //written, so out may alias either operand.
+#if defined(SKMATH_AVX)
+    //Two columns per register, lhs columns repeated in both halves
+    __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+    __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+    __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+    __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+
+    for(int j = 0; j < cMatrixSize; j += 8)
+    {
+      __m256 bj = _mm256_load_ps(b + j);
+      __m256 rj = _mm256_mul_ps(a0, _mm256_permute_ps(bj, _MM_SHUFFLE(0, 0, 0, 0)));
+  #if defined(SKMATH_FMA)
+      rj = _mm256_fmadd_ps(a1, _mm256_permute_ps(bj, _MM_SHUFFLE(1, 1, 1, 1)), rj);
+      rj = _mm256_fmadd_ps(a2, _mm256_permute_ps(bj, _MM_SHUFFLE(2, 2, 2, 2)), rj);
+      rj = _mm256_fmadd_ps(a3, _mm256_permute_ps(bj, _MM_SHUFFLE(3, 3, 3, 3)), rj);
+  #else
+      rj = _mm256_add_ps(rj, _mm256_mul_ps(a1, _mm256_permute_ps(bj, _MM_SHUFFLE(1, 1, 1, 1))));
+      rj = _mm256_add_ps(rj, _mm256_mul_ps(a2, _mm256_permute_ps(bj, _MM_SHUFFLE(2, 2, 2, 2))));
+      rj = _mm256_add_ps(rj, _mm256_mul_ps(a3, _mm256_permute_ps(bj, _MM_SHUFFLE(3, 3, 3, 3))));
+  #endif
+      _mm256_store_ps(r + j, rj);
+    }
+#elif defined(SKMATH_SSE)
+    __m128 a0 = _mm_load_ps(a);
+    __m128 a1 = _mm_load_ps(a + 4);
+    __m128 a2 = _mm_load_ps(a + 8);
+    __m128 a3 = _mm_load_ps(a + 12);
+
+    for(int j = 0; j < cMatrixSize; j += 4)
+    {
+      __m128 bj = _mm_load_ps(b + j);
+      __m128 rj = _mm_mul_ps(a0, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(0, 0, 0, 0)));
+      rj = _mm_add_ps(rj, _mm_mul_ps(a1, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(1, 1, 1, 1))));
+      rj = _mm_add_ps(rj, _mm_mul_ps(a2, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(2, 2, 2, 2))));
+      rj = _mm_add_ps(rj, _mm_mul_ps(a3, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(3, 3, 3, 3))));
+      _mm_store_ps(r + j, rj);
+    }
+#else
+    (void)a;
+    (void)b;
+    (void)r;
+    detail::multiply(lhs, rhs, out);
+#endif
+  }
+
+  SKMATH_INLINE void multiply(const Matrix4d& lhs, const Matrix4d& rhs, Matrix4d& out)
+  {
+#if defined(SKMATH_AVX)
+    const double* a = &lhs[0];
+    const double* b = &rhs[0];
+    double* r = &out[0];
+
+    //One column per register, every column of lhs is loaded before anything is stored
+    __m256d a0 = _mm256_load_pd(a);
+    __m256d a1 = _mm256_load_pd(a + 4);
+    __m256d a2 = _mm256_load_pd(a + 8);
+    __m256d a3 = _mm256_load_pd(a + 12);
+
+    for(int j = 0; j < 16; j += 4)
+    {
+      __m256d rj = _mm256_mul_pd(a0, _mm256_broadcast_sd(b + j));
+  #if defined(SKMATH_FMA)
+      rj = _mm256_fmadd_pd(a1, _mm256_broadcast_sd(b + j + 1), rj);
+      rj = _mm256_fmadd_pd(a2, _mm256_broadcast_sd(b + j + 2), rj);
+      rj = _mm256_fmadd_pd(a3, _mm256_broadcast_sd(b + j + 3), rj);
+  #else
+      rj = _mm256_add_pd(rj, _mm256_mul_pd(a1, _mm256_broadcast_sd(b + j + 1)));
+      rj = _mm256_add_pd(rj, _mm256_mul_pd(a2, _mm256_broadcast_sd(b + j + 2)));
+      rj = _mm256_add_pd(rj, _mm256_mul_pd(a3, _mm256_broadcast_sd(b + j + 3)));
+  #endif
+      _mm256_store_pd(r + j, rj);
+    }
+#else
+    detail::multiply(lhs, rhs, out);
+#endif
+  }
+
+  namespace detail{
+
+    //Transform vectors by the 3x3 part of m plus w times the translation
+    SKMATH_INLINE void transformVectors(const Matrix& m, const Vector* in, Vector* out,
+                                        std::size_t size, float w, bool nonTemporal)
+    {
+      if(size == 0)
+        return;
+
+      const float tx = m[12] * w, ty = m[13] * w, tz = m[14] * w;
+      const float* src = &in[0][0];
+      float* dst = &out[0][0];
+      std::size_t i = 0;
+
+      //Streaming stores need aligned addresses, 4 vectors are 48 bytes so one
+      //aligned start keeps every following block aligned
+      if(nonTemporal)
+        for(; i < size && (reinterpret_cast<std::uintptr_t>(dst + 3 * i) & 15) != 0; i++)
+          out[i] = Vector(m[0] * in[i][0] + m[4] * in[i][1] + m[ 8] * in[i][2] + tx,
+                          m[1] * in[i][0] + m[5] * in[i][1] + m[ 9] * in[i][2] + ty,
+                          m[2] * in[i][0] + m[6] * in[i][1] + m[10] * in[i][2] + tz);
+
+      const simd::Float m0 = simd::set1(m[0]), m1 = simd::set1(m[1]), m2  = simd::set1(m[2]);
+      const simd::Float m4 = simd::set1(m[4]), m5 = simd::set1(m[5]), m6  = simd::set1(m[6]);
+      const simd::Float m8 = simd::set1(m[8]), m9 = simd::set1(m[9]), m10 = simd::set1(m[10]);
+      const simd::Float vtx = simd::set1(tx), vty = simd::set1(ty), vtz = simd::set1(tz);
+
+      for(; i + simd::cWidth <= size; i += simd::cWidth)
+      {
+        simd::Float x, y, z;
+        simd::loadVectors(src + 3 * i, x, y, z);
+
+        simd::Float rx = simd::madd(m0, x, simd::madd(m4, y, simd::madd(m8, z, vtx)));
+        simd::Float ry = simd::madd(m1, x, simd::madd(m5, y, simd::madd(m9, z, vty)));
+        simd::Float rz = simd::madd(m2, x, simd::madd(m6, y, simd::madd(m10, z, vtz)));
+
+        simd::storeVectors(dst + 3 * i, rx, ry, rz, nonTemporal);
+      }
+
+      for(; i < size; i++)
+        out[i] = Vector(m[0] * in[i][0] + m[4] * in[i][1] + m[ 8] * in[i][2] + tx,
+                        m[1] * in[i][0] + m[5] * in[i][1] + m[ 9] * in[i][2] + ty,
+                        m[2] * in[i][0] + m[6] * in[i][1] + m[10] * in[i][2] + tz);
+
+      if(nonTemporal)
+        simd::fence();
+    }
+
+  };
+
+  //Multiply batch
+  SKMATH_INLINE void multiplyBatch(const Matrix* lhs, const Matrix* rhs, Matrix* out, std::size_t size)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileMultiplyBatch);
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; i++)
+        multiply(lhs[i], rhs[i], out[i]);
+    });
+  }
+  SKMATH_INLINE void multiplyBatch(const Matrix& lhs, const Matrix* rhs, Matrix* out, std::size_t size)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileMultiplyBatch);
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      //Local copy, so lhs stays in registers across the stores to out
+      const Matrix l(lhs);
+      for(std::size_t i = begin; i < end; i++)
+        multiply(l, rhs[i], out[i]);
+    });
+  }
+  SKMATH_INLINE void multiplyBatch(const Matrix* lhs, const Matrix& rhs, Matrix* out, std::size_t size)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileMultiplyBatch);
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      const Matrix r(rhs);
+      for(std::size_t i = begin; i < end; i++)
+        multiply(lhs[i], r, out[i]);
+    });
+  }
+
+  //Euler angles batch
+  SKMATH_INLINE void fromEulerBatch(const float* x, const float* y, const float* z, Matrix* out, std::size_t size,
+                                    EulerOrder order, AngleUnit unit)
+  {
+    using detail::cEulerBlock;
+    const float scale = unit == cDegrees ? detail::radians(1.0f) : 1.0f;
+
+    detail::eulerDispatch(order, [&](auto o) {
+      parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+        float s[3][cEulerBlock], c[3][cEulerBlock];
+
+        for(std::size_t b = begin; b < end; b += cEulerBlock)
+        {
+          std::size_t n = end - b < cEulerBlock ? end - b : cEulerBlock;
+          detail::eulerSinCos(x + b, y + b, z + b, n, scale, s, c);
+
+          for(std::size_t i = 0; i < n; i++)
+          {
+            const float si[3] = { s[0][i], s[1][i], s[2][i] };
+            const float ci[3] = { c[0][i], c[1][i], c[2][i] };
+            float m[3][3];
+            detail::eulerMatrix<decltype(o)::value>(si, ci, m);
+
+            Matrix& r = out[b + i];
+            r.createIdentity();
+            detail::unroll<3>([&](auto row) {
+              detail::unroll<3>([&](auto col) { r(row, col) = m[row][col]; });
+            });
+          }
+        }
+      });
+    });
+  }
+
+  //Transform points
+  SKMATH_INLINE void transformPoints(const Matrix& m, const Vector* in, Vector* out, std::size_t size, bool nonTemporal)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileTransformPoints);
+    detail::transformVectors(m, in, out, size, 1.0f, nonTemporal);
+  }
+
+  //Transform directions
+  SKMATH_INLINE void transformDirections(const Matrix& m, const Vector* in, Vector* out, std::size_t size, bool nonTemporal)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileTransformPoints);
+    detail::transformVectors(m, in, out, size, 0.0f, nonTemporal);
+  }
+
+  //Determinant batch
+  SKMATH_INLINE void determinantBatch(const Matrix* in, float* out, std::size_t size)
+  {
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; i++)
+        out[i] = in[i].determinant();
+    });
+  }
+
+  //Matrix to quaternion batch
+  SKMATH_INLINE void matrixToQuaternionBatch(const Matrix* in, Quaternion* out, std::size_t size)
+  {
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      std::size_t i = begin;
+#if defined(SKMATH_SSE)
+      using namespace simd;
+
+      //matrixToQuaternion for cWidth matrices at a time, columns transposed into registers
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        Float m00, m10, m20, m30, m01, m11, m21, m31, m02, m12, m22, m32;
+        loadRecords(&in[i][0], cMatrixSize, m00, m10, m20, m30);
+        loadRecords(&in[i][4], cMatrixSize, m01, m11, m21, m31);
+        loadRecords(&in[i][8], cMatrixSize, m02, m12, m22, m32);
+
+        Float p01 = add(m01, m10), p20 = add(m20, m02), p12 = add(m12, m21);
+        Float n01 = sub(m01, m10), n20 = sub(m20, m02), n12 = sub(m12, m21);
+
+        Float c = cmplt(m22, zero());
+        Float d = select(c, cmplt(m11, m00), cmplt(m00, neg(m11)));
+
+        Float s = add(m00, m11), r = sub(m00, m11);
+        Float t = add(add(set1(1.0f), select(c, neg(m22), m22)), select(c, select(d, r, neg(r)), select(d, neg(s), s)));
+        Float x = select(c, select(d, t, p01), select(d, p20, n12));
+        Float y = select(c, select(d, p01, t), select(d, p12, n20));
+        Float z = select(c, select(d, p20, p12), select(d, t, n01));
+        Float w = select(c, select(d, n12, n20), select(d, n01, t));
+
+        Float f = div(set1(0.5f), sqrt(t));
+        f = select(cmplt(w, zero()), neg(f), f);
+        storeQuaternions(&out[i].w(), mul(w, f), mul(x, f), mul(y, f), mul(z, f));
+      }
+#endif
+
+      for(; i < end; i++)
+        matrixToQuaternion(in[i], out[i]);
+    });
+  }
+
+  //Transpose batch
+  SKMATH_INLINE void transposeBatch(const Matrix* in, Matrix* out, std::size_t size)
+  {
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; i++)
+        out[i] = in[i].transpose();
+    });
+  }
+
+  //Inverse batch
+  SKMATH_INLINE void inverseBatch(const Matrix* in, Matrix* out, std::size_t size)
+  {
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; i++)
+        out[i] = in[i].inverse();
+    });
+  }
+
+  //Inverse affine batch
+  SKMATH_INLINE void inverseAffineBatch(const Matrix* in, Matrix* out, std::size_t size)
+  {
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; i++)
+        out[i] = in[i].inverseAffine();
+    });
+  }
+
+  //Inverse orthonormal batch
+  SKMATH_INLINE void inverseOrthonormalBatch(const Matrix* in, Matrix* out, std::size_t size)
+  {
+    parallelFor(size, cParallelGrain / 16, [&](std::size_t begin, std::size_t end) {
+      for(std::size_t i = begin; i < end; i++)
+        out[i] = in[i].inverseOrthonormal();
+    });
+  }
+
+};
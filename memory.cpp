@@ -0,0 +1,11 @@
+/**
+* @file memory.cpp
+* @author skwo
+* @brief Realization of the frame arena.
+*/
+
+#include "memory.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "memory.inl"
+#endif
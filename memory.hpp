@@ -0,0 +1,224 @@
+/**
+* @file memory.hpp
+* @author skwo
+* @brief Defenition of aligned allocation: allocator, aligned types and frame arena.
+*
+* Matrix (32 bytes) and Quaternion (16 bytes) are aligned by their declaration, but an array of
+* 64-byte matrices from <c>new</c> or <c>std::vector</c> only starts on a 32-byte boundary: when
+* it starts in the middle of a cache line every matrix straddles two lines, and a 12-byte Vector
+* has no alignment beyond float.
+* - AlignedAllocator gives <c>std::vector</c> and other containers storage aligned to 16, 32 or
+*   64 bytes, e.g. <c>AlignedArray<Matrix></c> puts every matrix in one cache line.
+* - Aligned<T, A> is T with alignment A, and the size padded to it: PaddedVector is a 16-byte
+*   Vector for aligned SSE loads, LineMatrix a matrix that owns its cache line in any array.
+* - Arena hands out aligned memory for per-frame temporaries by bumping a pointer, and
+*   releases all of it at once in constant time.
+*/
+
+#ifndef MEMORY_HPP_INCLUDED
+#define MEMORY_HPP_INCLUDED
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "config.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "quaternion.hpp"
+
+namespace skmath{
+
+  /** Allocator of memory aligned to Alignment bytes, for <c>std::vector</c> and other standard
+  * containers.
+  * @note Throws std::bad_alloc on failure, like std::allocator.
+  */
+  template<typename T, std::size_t Alignment = simd::cAlignment>
+  class AlignedAllocator{
+    static_assert((Alignment & (Alignment - 1)) == 0, "AlignedAllocator needs a power of two alignment");
+    static_assert(Alignment >= alignof(T), "AlignedAllocator can not align below the alignment of T");
+
+    public:
+      typedef T value_type;
+
+      template<typename U>
+      struct rebind{
+        typedef AlignedAllocator<U, Alignment> other;
+      };
+
+      /** Constructor. */
+      AlignedAllocator()
+      {
+      }
+
+      /** Constructor. Copy of an allocator of another type. */
+      template<typename U>
+      AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+      {
+      }
+
+      /** Allocate.
+      * @param size Number of elements.
+      * @return Uninitialized memory for <c>size</c> elements, aligned to Alignment.
+      */
+      T* allocate(std::size_t size)
+      {
+        if(size > ~std::size_t(0) / sizeof(T))
+          throw std::bad_alloc();
+
+        return static_cast<T*>(simd::alignedAlloc(size * sizeof(T), Alignment));
+      }
+
+      /** Deallocate.
+      * @param p Memory returned by allocate.
+      * @param size Number of elements it was allocated for.
+      */
+      void deallocate(T* p, std::size_t size)
+      {
+        (void)size;
+        simd::alignedFree(p);
+      }
+
+      /** Operator ==. Any two allocators of the same alignment can free each other's memory. */
+      template<typename U>
+      bool operator ==(const AlignedAllocator<U, Alignment>&) const
+      {
+        return true;
+      }
+
+      /** Operator !=. */
+      template<typename U>
+      bool operator !=(const AlignedAllocator<U, Alignment>&) const
+      {
+        return false;
+      }
+  };
+
+  /** <c>std::vector</c> of elements aligned to Alignment bytes. */
+  template<typename T, std::size_t Alignment = simd::cAlignment>
+  using AlignedArray = std::vector<T, AlignedAllocator<T, Alignment>>;
+
+  /** T with alignment, and size padded to a multiple of, Alignment bytes. Converts to and from
+  * T, and has every operation of T, which return T.
+  */
+  template<typename T, std::size_t Alignment>
+  class alignas(Alignment) Aligned : public T{
+    static_assert(Alignment >= alignof(T), "Aligned can not align below the alignment of T");
+
+    public:
+      using T::T;
+
+      /** Constructor. As T(). */
+      Aligned()
+        : T()
+      {
+      }
+
+      /** Constructor. Copy of t.
+      * @param t Value.
+      */
+      Aligned(const T& t)
+        : T(t)
+      {
+      }
+
+      /** Operator =. Assign t.
+      * @param t Value.
+      * @return Reference to this.
+      */
+      Aligned& operator =(const T& t)
+      {
+        T::operator =(t);
+        return *this;
+      }
+  };
+
+  /** Vector padded to 16 bytes and aligned to them, one SSE register. */
+  typedef Aligned<Vector, 16> PaddedVector;
+
+  /** Matrix aligned to a cache line, so no matrix of an array straddles two lines. */
+  typedef Aligned<Matrix, 64> LineMatrix;
+
+  /** Quaternion, already 16 bytes and aligned to them; for symmetry with the others. */
+  typedef Aligned<Quaternion, 16> AlignedQuaternion;
+
+  /** Arena of memory for temporaries that share a lifetime, typically one frame. Allocations
+  * bump a pointer through blocks of memory, and reset() makes all of it free again in constant
+  * time. Blocks are kept across resets, so after the first frames an arena no longer allocates.
+  * @note Not thread safe; use an arena per thread. Memory is not initialized and destructors
+  * are not run, so only trivially destructible types belong in an arena.
+  */
+  class Arena{
+    public:
+      /** Default size of a block, 1 MiB. */
+      static const std::size_t cBlockSize = std::size_t(1) << 20;
+
+      /** Constructor. Create arena; the first block is allocated by the first allocation.
+      * @param blockSize Size of a block, larger allocations get a block of their own.
+      */
+      explicit Arena(std::size_t blockSize = cBlockSize);
+
+      /** Destructor. Free every block. */
+      ~Arena();
+
+      Arena(const Arena&) = delete;
+      Arena& operator =(const Arena&) = delete;
+
+      /** Allocate memory.
+      * @param bytes Number of bytes.
+      * @param alignment Alignment, a power of two up to <c>simd::cAlignment</c>.
+      * @return Memory of <c>bytes</c> bytes, valid until the next reset().
+      * @note Throws std::bad_alloc if a new block can not be allocated.
+      */
+      void* allocate(std::size_t bytes, std::size_t alignment = 16);
+
+      /** Allocate array.
+      * @param size Number of elements.
+      * @return Uninitialized memory for <c>size</c> elements of type T, aligned for T, valid until
+      * the next reset().
+      */
+      template<typename T>
+      T* allocate(std::size_t size)
+      {
+        static_assert(alignof(T) <= simd::cAlignment, "Arena can not align beyond simd::cAlignment");
+
+        if(size > ~std::size_t(0) / sizeof(T))
+          throw std::bad_alloc();
+
+        return static_cast<T*>(allocate(size * sizeof(T), alignof(T) < 16 ? 16 : alignof(T)));
+      }
+
+      /** Reset. Free every allocation at once, keeping the blocks. */
+      void reset();
+
+      /** Get used memory.
+      * @return Bytes allocated since the last reset, with alignment padding.
+      */
+      std::size_t used() const;
+
+      /** Get capacity.
+      * @return Bytes in all blocks.
+      */
+      std::size_t capacity() const;
+
+    private:
+      struct Block{
+        unsigned char* data; /**< Memory, aligned to simd::cAlignment. */
+        std::size_t size; /**< Size in bytes. */
+      };
+
+      std::vector<Block> _blocks; /**< Blocks in order of use. */
+      std::size_t _blockSize; /**< Size of a new block. */
+      std::size_t _block; /**< Block allocations come from. */
+      std::size_t _offset; /**< Used bytes of the current block. */
+      std::size_t _used; /**< Used bytes of the earlier blocks since the last reset. */
+  };
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "memory.inl"
+#endif
+
+#endif // MEMORY_HPP_INCLUDED
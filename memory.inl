@@ -0,0 +1,81 @@
+/**
+* @file memory.inl
+* @author skwo
+* @brief Realization of the frame arena.
+* @note Included by memory.cpp, or by memory.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+namespace skmath{
+
+  //Constructor
+  SKMATH_INLINE Arena::Arena(std::size_t blockSize)
+    : _blockSize(blockSize), _block(0), _offset(0), _used(0)
+  {
+  }
+
+  //Destructor
+  SKMATH_INLINE Arena::~Arena()
+  {
+    for(std::size_t i = 0; i < _blocks.size(); i++)
+      simd::alignedFree(_blocks[i].data);
+  }
+
+  //Allocate
+  SKMATH_INLINE void* Arena::allocate(std::size_t bytes, std::size_t alignment)
+  {
+    //Rest of the current block
+    if(_block < _blocks.size())
+    {
+      const Block& block = _blocks[_block];
+      const std::size_t offset = (_offset + alignment - 1) & ~(alignment - 1);
+      if(offset <= block.size && bytes <= block.size - offset)
+      {
+        _offset = offset + bytes;
+        return block.data + offset;
+      }
+
+      _used += _offset;
+      _offset = 0;
+      _block++;
+    }
+
+    //Blocks start aligned to simd::cAlignment, so the next one that is large enough will do
+    while(_block < _blocks.size() && _blocks[_block].size < bytes)
+      _block++;
+
+    if(_block == _blocks.size())
+    {
+      Block block;
+      block.size = bytes > _blockSize ? bytes : _blockSize;
+      block.data = static_cast<unsigned char*>(simd::alignedAlloc(block.size));
+      _blocks.push_back(block);
+    }
+
+    _offset = bytes;
+    return _blocks[_block].data;
+  }
+
+  //Reset
+  SKMATH_INLINE void Arena::reset()
+  {
+    _block = 0;
+    _offset = 0;
+    _used = 0;
+  }
+
+  //Used
+  SKMATH_INLINE std::size_t Arena::used() const
+  {
+    return _used + _offset;
+  }
+
+  //Capacity
+  SKMATH_INLINE std::size_t Arena::capacity() const
+  {
+    std::size_t size = 0;
+    for(std::size_t i = 0; i < _blocks.size(); i++)
+      size += _blocks[i].size;
+    return size;
+  }
+
+};
@@ -0,0 +1,337 @@
+/**
+* @file parallel.hpp
+* @author skwo
+* @brief Splitting of batch kernels across threads.
+*
+* Batch kernels run on a work-stealing thread pool, started on first use and kept for the
+* lifetime of the program. A parallel for splits its range into chunks and gives every thread
+* an equal, contiguous run of them; a thread takes chunks from the front of its own run, and
+* once it is empty steals the back half of the run of another thread. Each run is one atomic on
+* a cache line of its own, so taking and stealing chunks needs neither locks nor shares lines.
+*/
+
+#ifndef PARALLEL_HPP_INCLUDED
+#define PARALLEL_HPP_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace skmath{
+
+  /** Smallest number of elements worth handing to a thread of its own. */
+  const std::size_t cParallelGrain = 16384;
+
+  /** Number of chunks per thread a parallel for splits its range into, so threads that finish
+  * early have chunks left to steal.
+  */
+  const std::size_t cParallelSplit = 8;
+
+  namespace detail{
+
+    /** Work-stealing thread pool behind parallelFor. */
+    class ThreadPool{
+      public:
+        /** Get pool.
+        * @return Pool shared by the whole program.
+        */
+        static ThreadPool& instance()
+        {
+          static ThreadPool pool;
+          return pool;
+        }
+
+        /** Destructor. Stop and join the worker threads. */
+        ~ThreadPool()
+        {
+          {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+          }
+          _wake.notify_all();
+
+          for(std::size_t i = 0; i < _workers.size(); i++)
+            _workers[i].join();
+        }
+
+        /** Get number of threads.
+        * @return Number of threads a run is split across, including the calling thread.
+        */
+        std::size_t threads() const
+        {
+          return _threads.load(std::memory_order_relaxed);
+        }
+
+        /** Set number of threads.
+        * @param threads Number of threads a run is split across, including the calling thread,
+        * 0 for the number of hardware threads.
+        */
+        void setThreads(std::size_t threads)
+        {
+          _threads.store(threads ? threads : hardwareThreads(), std::memory_order_relaxed);
+        }
+
+        /** Run. Call <c>task(context, i)</c> for every i in [0, <c>tasks</c>) and wait for all
+        * of them. Runs on the calling thread alone when called from inside a task, or while
+        * another thread runs.
+        * @param tasks Number of tasks, less than 2^32.
+        * @param task Task, must not throw.
+        * @param context Passed to <c>task</c>.
+        */
+        void run(std::size_t tasks, void (*task)(void*, std::size_t), void* context)
+        {
+          std::size_t threads = this->threads();
+          if(threads > tasks)
+            threads = tasks;
+
+          if(threads < 2 || inside() || _busy.exchange(true, std::memory_order_acquire))
+          {
+            for(std::size_t i = 0; i < tasks; i++)
+              task(context, i);
+            return;
+          }
+
+          start(threads);
+
+          //Equal contiguous runs, the calling thread takes the first
+          for(std::size_t t = 0; t < threads; t++)
+            _runs[t].tasks.store(pack(tasks * t / threads, tasks * (t + 1) / threads), std::memory_order_relaxed);
+
+          {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task = task;
+            _context = context;
+            _participants = threads;
+            _pending = threads - 1;
+            _generation++;
+          }
+          _wake.notify_all();
+
+          inside() = true;
+          work(0);
+          inside() = false;
+
+          //Workers still read _runs, _task and _context until they leave the run
+          {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _done.wait(lock, [this]() { return _pending == 0; });
+          }
+
+          _busy.store(false, std::memory_order_release);
+        }
+
+      private:
+        /** Run of tasks [begin, end) of one thread, begin in the low and end in the high half. */
+        struct alignas(64) Run{
+          std::atomic<std::uint64_t> tasks;
+        };
+
+        ThreadPool()
+          : _threads(hardwareThreads()), _busy(false), _capacity(0), _task(nullptr), _context(nullptr),
+            _participants(0), _pending(0), _generation(0), _stop(false)
+        {
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator =(const ThreadPool&) = delete;
+
+        static std::size_t hardwareThreads()
+        {
+          unsigned int threads = std::thread::hardware_concurrency();
+          return threads ? threads : 1;
+        }
+
+        //Is the calling thread running tasks of the pool
+        static bool& inside()
+        {
+          static thread_local bool inside = false;
+          return inside;
+        }
+
+        static std::uint64_t pack(std::size_t begin, std::size_t end)
+        {
+          return std::uint64_t(begin) | (std::uint64_t(end) << 32);
+        }
+
+        //Make sure there are runs for and workers besides the calling thread for threads threads
+        void start(std::size_t threads)
+        {
+          if(threads > _capacity)
+          {
+            //No worker touches the runs between two runs
+            _runs.reset(new Run[threads]);
+            _capacity = threads;
+          }
+
+          while(_workers.size() + 1 < threads)
+            _workers.push_back(std::thread(&ThreadPool::loop, this, _workers.size() + 1, _generation));
+        }
+
+        //Worker thread, runs tasks as participant index of every run after run seen it takes part in
+        void loop(std::size_t index, std::uint64_t seen)
+        {
+          inside() = true;
+
+          for(;;)
+          {
+            {
+              std::unique_lock<std::mutex> lock(_mutex);
+              _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+              if(_stop)
+                return;
+
+              seen = _generation;
+              if(index >= _participants)
+                continue;
+            }
+
+            work(index);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if(--_pending == 0)
+              _done.notify_one();
+          }
+        }
+
+        //Run tasks of own run, then steal, until no run has tasks left
+        void work(std::size_t index)
+        {
+          std::size_t i;
+          while(take(index, i) || steal(index, i))
+            _task(_context, i);
+        }
+
+        //Take the first task of own run
+        bool take(std::size_t index, std::size_t& i)
+        {
+          std::uint64_t run = _runs[index].tasks.load(std::memory_order_acquire);
+          for(;;)
+          {
+            std::uint64_t begin = run & 0xffffffffu, end = run >> 32;
+            if(begin >= end)
+              return false;
+
+            if(_runs[index].tasks.compare_exchange_weak(run, pack(begin + 1, end), std::memory_order_acq_rel))
+            {
+              i = begin;
+              return true;
+            }
+          }
+        }
+
+        //Steal the back half of the run of another thread, run its first task now and keep the rest
+        bool steal(std::size_t index, std::size_t& i)
+        {
+          for(std::size_t k = 1; k < _participants; k++)
+          {
+            std::atomic<std::uint64_t>& victim = _runs[(index + k) % _participants].tasks;
+            std::uint64_t run = victim.load(std::memory_order_acquire);
+
+            for(;;)
+            {
+              std::uint64_t begin = run & 0xffffffffu, end = run >> 32;
+              if(begin >= end)
+                break;
+
+              std::uint64_t middle = begin + (end - begin) / 2;
+              if(victim.compare_exchange_weak(run, pack(begin, middle), std::memory_order_acq_rel))
+              {
+                //Own run is empty, so no other thread writes it now
+                _runs[index].tasks.store(pack(middle + 1, end), std::memory_order_release);
+                i = middle;
+                return true;
+              }
+            }
+          }
+
+          return false;
+        }
+
+        std::atomic<std::size_t> _threads; /**< Threads per run, including the calling thread. */
+        std::atomic<bool> _busy; /**< A run is in progress. */
+
+        std::unique_ptr<Run[]> _runs; /**< Run of every participant. */
+        std::size_t _capacity; /**< Size of _runs. */
+        std::vector<std::thread> _workers; /**< Worker threads, participants 1 and up. */
+
+        //Current run, guarded by _mutex
+        void (*_task)(void*, std::size_t);
+        void* _context;
+        std::size_t _participants; /**< Threads taking part, including the calling thread. */
+        std::size_t _pending; /**< Workers that have not left the run yet. */
+        std::uint64_t _generation; /**< Incremented by every run. */
+        bool _stop; /**< Workers must exit. */
+
+        std::mutex _mutex;
+        std::condition_variable _wake; /**< Signals workers a new run or stop. */
+        std::condition_variable _done; /**< Signals the calling thread the last worker left. */
+    };
+
+    //Call task(i) through a type erased pointer
+    template<typename Task>
+    void invoke(void* task, std::size_t i)
+    {
+      (*static_cast<Task*>(task))(i);
+    }
+
+  };
+
+  /** Get number of parallel threads.
+  * @return Number of threads parallelFor splits work across, including the calling thread.
+  */
+  inline std::size_t parallelThreads()
+  {
+    return detail::ThreadPool::instance().threads();
+  }
+
+  /** Set number of parallel threads.
+  * @param threads Number of threads parallelFor splits work across, including the calling
+  * thread, 0 for the number of hardware threads (the default).
+  */
+  inline void setParallelThreads(std::size_t threads)
+  {
+    detail::ThreadPool::instance().setThreads(threads);
+  }
+
+  /** Parallel for. Split range [0, <c>size</c>) into contiguous chunks of at least
+  * <c>grain</c> elements and run <c>func(begin, end)</c> for each chunk on the thread pool.
+  * Ranges smaller than two grains run on the calling thread.
+  * Chunk boundaries are multiples of 16 elements, so chunks of 4-byte or larger elements of a
+  * 64-byte aligned array never share a cache line.
+  * @param size Number of elements.
+  * @param grain Smallest number of elements per chunk.
+  * @param func Callable as <c>func(std::size_t begin, std::size_t end)</c>, must not throw.
+  */
+  template<typename Func>
+  void parallelFor(std::size_t size, std::size_t grain, Func func)
+  {
+    std::size_t threads = parallelThreads();
+    std::size_t chunks = grain ? size / grain : size;
+
+    if(chunks > threads * cParallelSplit)
+      chunks = threads * cParallelSplit;
+
+    if(chunks < 2 || threads < 2)
+    {
+      func(std::size_t(0), size);
+      return;
+    }
+
+    const std::size_t chunk = ((size + chunks - 1) / chunks + 15) & ~std::size_t(15);
+    chunks = (size + chunk - 1) / chunk;
+
+    auto task = [&](std::size_t i) {
+      std::size_t begin = i * chunk;
+      func(begin, begin + chunk < size ? begin + chunk : size);
+    };
+    detail::ThreadPool::instance().run(chunks, &detail::invoke<decltype(task)>, &task);
+  }
+
+};
+
+#endif // PARALLEL_HPP_INCLUDED
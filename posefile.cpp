@@ -0,0 +1,11 @@
+/**
+* @file posefile.cpp
+* @author skwo
+* @brief Realization of the binary pose file.
+*/
+
+#include "posefile.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "posefile.inl"
+#endif
@@ -0,0 +1,369 @@
+/**
+* @file posefile.hpp
+* @author skwo
+* @brief Defenition of the binary pose file, arrays of vectors, matrices and quaternions.
+*
+* A pose file stores named arrays (sections) of Vector, Matrix or Quaternion records in their
+* memory layout, so a PoseFile maps the file and hands out views of the records in place,
+* without parsing or copying them. PoseFileWriter writes a file section by section, appending
+* records in chunks of any size.
+*
+* Layout, in the byte order of the writer, every part starting at a multiple of
+* <c>cPoseFileAlignment</c> bytes:
+* - file header (detail::PoseFileHeader), 64 bytes.
+* - records of every section, padded with zeros to the next multiple of the alignment.
+* - directory, a detail::PoseFileSection of 64 bytes per section.
+*
+* The writer streams the records and keeps only the directory in memory; the file header is
+* written last. Readers reject files of a newer version, another byte order or with a damaged
+* header or directory entry; the checksums of the records are checked when the file is opened
+* unless told not to.
+*/
+
+#ifndef POSEFILE_HPP_INCLUDED
+#define POSEFILE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "quaternion.hpp"
+
+namespace skmath{
+
+  /** Version of the pose file format written, and the newest one read. */
+  const std::uint32_t cPoseFileVersion = 1;
+
+  /** Alignment in bytes of headers and records in a pose file. One cache line. */
+  const std::size_t cPoseFileAlignment = 64;
+
+  /** Longest section name, in characters. */
+  const std::size_t cPoseFileNameLength = 23;
+
+  /** Type of the records of a pose file section. */
+  enum RecordType{
+    cUnknownRecord = 0, /**< Written by a newer version, records can not be viewed. */
+    cVectorRecord = 1, /**< Vector, 3 floats. */
+    cMatrixRecord = 2, /**< Matrix, 16 floats, column major. */
+    cQuaternionRecord = 3 /**< Quaternion, 4 floats: w, x, y, z. */
+  };
+
+  /** Record type of a class, <c>RecordTraits<T>::cType</c>. */
+  template<typename T>
+  struct RecordTraits{
+    static const RecordType cType = cUnknownRecord;
+  };
+  template<>
+  struct RecordTraits<Vector>{
+    static const RecordType cType = cVectorRecord;
+  };
+  template<>
+  struct RecordTraits<Matrix>{
+    static const RecordType cType = cMatrixRecord;
+  };
+  template<>
+  struct RecordTraits<Quaternion>{
+    static const RecordType cType = cQuaternionRecord;
+  };
+
+  namespace detail{
+
+    /** Pose file header. */
+    struct PoseFileHeader{
+      char magic[8]; /**< "SKPOSE\0\0". */
+      std::uint32_t version; /**< Version of the format. */
+      std::uint32_t byteOrder; /**< 0x01020304 in the byte order of the writer. */
+      std::uint32_t headerSize; /**< Size of this header. */
+      std::uint32_t alignment; /**< Alignment of every part of the file. */
+      std::uint64_t sections; /**< Number of sections. */
+      std::uint64_t directory; /**< Offset of the directory. */
+      std::uint64_t fileSize; /**< Size of the file. */
+      std::uint8_t reserved[12]; /**< Zero. */
+      std::uint32_t checksum; /**< CRC-32C of the fields above. */
+    };
+
+    /** Pose file directory entry of a section. */
+    struct PoseFileSection{
+      std::uint32_t type; /**< RecordType of the records. */
+      std::uint32_t recordSize; /**< Size of a record. */
+      std::uint64_t count; /**< Number of records. */
+      std::uint64_t offset; /**< Offset of the first record. */
+      std::uint64_t bytes; /**< Size of the records, without padding. */
+      std::uint32_t dataChecksum; /**< CRC-32C of the records. */
+      char name[cPoseFileNameLength + 1]; /**< Name, zero terminated. */
+      std::uint32_t checksum; /**< CRC-32C of the fields above. */
+    };
+
+  };
+
+  /** CRC-32C (Castagnoli) of data, with the SSE4.2 crc32 instruction when enabled.
+  * @param data Data.
+  * @param size Size of <c>data</c> in bytes.
+  * @param crc CRC-32C of the data before <c>data</c>, to checksum data in parts.
+  * @return CRC-32C of the data so far.
+  */
+  std::uint32_t crc32c(const void* data, std::size_t size, std::uint32_t crc = 0);
+
+  /** Read only view of an array of records. */
+  template<typename T>
+  class RecordView{
+    public:
+      /** Constructor. Create empty view. */
+      RecordView()
+        : _data(nullptr), _size(0)
+      {
+      }
+
+      /** Constructor. Create view.
+      * @param data First record.
+      * @param size Number of records.
+      */
+      RecordView(const T* data, std::size_t size)
+        : _data(data), _size(size)
+      {
+      }
+
+      /** Get data.
+      * @return First record, null for an empty view.
+      */
+      const T* data() const { return _data; }
+
+      /** Get size.
+      * @return Number of records.
+      */
+      std::size_t size() const { return _size; }
+
+      /** Is empty.
+      * @return True if the view has no records.
+      */
+      bool empty() const { return _size == 0; }
+
+      /** Begin.
+      * @return First record, for range based for.
+      */
+      const T* begin() const { return _data; }
+
+      /** End.
+      * @return Record past the last one.
+      */
+      const T* end() const { return _data + _size; }
+
+      /** Operator []. Get record.
+      * @param i Index, less than size().
+      * @return Const reference to record <c>i</c>.
+      */
+      const T& operator[](std::size_t i) const { return _data[i]; }
+
+    private:
+      const T* _data; /**< First record. */
+      std::size_t _size; /**< Number of records. */
+  };
+
+  /** Pose file opened for reading, mapped into memory. Views stay valid until the file is
+  * closed or another one opened.
+  */
+  class PoseFile{
+    public:
+      /** Section that is not in the file. */
+      static const std::size_t cNoSection = ~std::size_t(0);
+
+      /** Constructor. Create closed file. */
+      PoseFile();
+
+      /** Destructor. Close file. */
+      ~PoseFile();
+
+      PoseFile(const PoseFile&) = delete;
+      PoseFile& operator =(const PoseFile&) = delete;
+
+      /** Open file. Map it into memory and check its headers.
+      * @param path Path of the file.
+      * @param verify Also check the checksums of the records, reading them all once.
+      * @return True on success; false if the file can not be mapped or is not a valid pose file,
+      * in which case the file is closed.
+      */
+      bool open(const char* path, bool verify = true);
+
+      /** Close file. Unmap it; views of its records become invalid. */
+      void close();
+
+      /** Is open.
+      * @return True if a file is open.
+      */
+      bool isOpen() const;
+
+      /** Get version.
+      * @return Version of the format of the open file.
+      */
+      std::uint32_t version() const;
+
+      /** Get number of sections.
+      * @return Number of sections.
+      */
+      std::size_t sections() const;
+
+      /** Find section.
+      * @param name Name of the section.
+      * @return First section called <c>name</c>, or <c>cNoSection</c>.
+      */
+      std::size_t find(const char* name) const;
+
+      /** Get section name.
+      * @param section Section, less than sections().
+      * @return Name of <c>section</c>.
+      */
+      const std::string& name(std::size_t section) const;
+
+      /** Get section record type.
+      * @param section Section, less than sections().
+      * @return Type of the records of <c>section</c>.
+      */
+      RecordType type(std::size_t section) const;
+
+      /** Get section size.
+      * @param section Section, less than sections().
+      * @return Number of records of <c>section</c>.
+      */
+      std::size_t size(std::size_t section) const;
+
+      /** Get records.
+      * @param section Section, less than sections(), or <c>cNoSection</c>.
+      * @return View of the records of <c>section</c>, empty if they are not of type T.
+      */
+      template<typename T>
+      RecordView<T> view(std::size_t section) const
+      {
+        std::size_t size = 0;
+        const void* data = records(section, RecordTraits<T>::cType, size);
+        return RecordView<T>(static_cast<const T*>(data), size);
+      }
+
+      /** Get records.
+      * @param name Name of the section.
+      * @return View of the records of the first section called <c>name</c>, empty if there is
+      * none or its records are not of type T.
+      */
+      template<typename T>
+      RecordView<T> view(const char* name) const
+      {
+        return view<T>(find(name));
+      }
+
+    private:
+      struct Section{
+        std::string name; /**< Name. */
+        RecordType type; /**< Type of the records. */
+        std::size_t size; /**< Number of records. */
+        const unsigned char* data; /**< First record, in the mapping. */
+      };
+
+      //Records of section, if they are of type, and their number
+      const void* records(std::size_t section, RecordType type, std::size_t& size) const;
+
+      //Check headers and, if verify, data of the mapped file
+      bool parse(bool verify);
+
+      const unsigned char* _data; /**< Mapping of the file. */
+      std::size_t _size; /**< Size of the mapping. */
+      void* _mapping; /**< File mapping handle, Windows only. */
+      std::uint32_t _version; /**< Version of the format of the file. */
+      std::vector<Section> _sections; /**< Sections in file order. */
+  };
+
+  /** Pose file opened for writing. Records are written as they are appended; the directory
+  * and the file header are written when the file is closed.
+  */
+  class PoseFileWriter{
+    public:
+      /** Constructor. Create closed writer. */
+      PoseFileWriter();
+
+      /** Destructor. Close file. */
+      ~PoseFileWriter();
+
+      PoseFileWriter(const PoseFileWriter&) = delete;
+      PoseFileWriter& operator =(const PoseFileWriter&) = delete;
+
+      /** Open file. Create or truncate it.
+      * @param path Path of the file.
+      * @return True on success.
+      */
+      bool open(const char* path);
+
+      /** Close file. End the current section and complete the file header.
+      * @return True if every write since open succeeded, so the file is valid.
+      */
+      bool close();
+
+      /** Is open.
+      * @return True if a file is open.
+      */
+      bool isOpen() const;
+
+      /** Begin section. Ends the current section, if any.
+      * @param name Name of the section, up to <c>cPoseFileNameLength</c> characters.
+      * @param type Type of the records of the section.
+      * @return True on success; false if no file is open, the name is too long, the type is
+      * <c>cUnknownRecord</c>, or writing failed.
+      */
+      bool beginSection(const char* name, RecordType type);
+
+      /** Append records to the current section.
+      * @param records Array of <c>size</c> records.
+      * @param size Number of records.
+      * @return True on success; false if there is no section of this record type, or writing
+      * failed.
+      */
+      bool append(const Vector* records, std::size_t size);
+
+      /** Append records to the current section.
+      * @param records Array of <c>size</c> records.
+      * @param size Number of records.
+      * @return True on success; false if there is no section of this record type, or writing
+      * failed.
+      */
+      bool append(const Matrix* records, std::size_t size);
+
+      /** Append records to the current section.
+      * @param records Array of <c>size</c> records.
+      * @param size Number of records.
+      * @return True on success; false if there is no section of this record type, or writing
+      * failed.
+      */
+      bool append(const Quaternion* records, std::size_t size);
+
+      /** End section. Pad the records and add the section to the directory.
+      * @return True on success, or if there is no current section.
+      */
+      bool endSection();
+
+    private:
+      //Append size records of type to the current section
+      bool appendRecords(const void* records, RecordType type, std::size_t size);
+
+      //Write bytes at the end of the file
+      bool write(const void* data, std::size_t bytes);
+
+      //Write zeros up to the next multiple of the alignment
+      bool pad();
+
+      std::FILE* _file; /**< File, null when closed. */
+      bool _failed; /**< Some write failed. */
+      std::uint64_t _offset; /**< Size of the file so far. */
+      std::vector<detail::PoseFileSection> _directory; /**< Ended sections. */
+      bool _inSection; /**< A section is begun and not ended. */
+      detail::PoseFileSection _section; /**< Current section, its checksum not yet set. */
+  };
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "posefile.inl"
+#endif
+
+#endif // POSEFILE_HPP_INCLUDED
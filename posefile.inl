@@ -0,0 +1,457 @@
+/**
+* @file posefile.inl
+* @author skwo
+* @brief Realization of the binary pose file.
+* @note Included by posefile.cpp, or by posefile.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <cstddef>
+#include <cstring>
+
+#include "simd.hpp"
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace skmath{
+
+  namespace detail{
+
+    static_assert(sizeof(PoseFileHeader) == cPoseFileAlignment, "PoseFileHeader must be 64 bytes");
+    static_assert(sizeof(PoseFileSection) == cPoseFileAlignment, "PoseFileSection must be 64 bytes");
+
+    const char cPoseFileMagic[8] = { 'S', 'K', 'P', 'O', 'S', 'E', 0, 0 };
+    const std::uint32_t cPoseFileByteOrder = 0x01020304u;
+
+    //Size of a record of type, 0 if unknown
+    SKMATH_INLINE std::uint32_t recordSize(std::uint32_t type)
+    {
+      switch(type)
+      {
+        case cVectorRecord:
+          return sizeof(Vector);
+        case cMatrixRecord:
+          return sizeof(Matrix);
+        case cQuaternionRecord:
+          return sizeof(Quaternion);
+        default:
+          return 0;
+      }
+    }
+
+    //Offset rounded up to the alignment
+    SKMATH_INLINE std::uint64_t alignOffset(std::uint64_t offset)
+    {
+      return (offset + cPoseFileAlignment - 1) & ~std::uint64_t(cPoseFileAlignment - 1);
+    }
+
+    //Table of the byte at a time CRC-32C, reflected polynomial 0x82f63b78
+    SKMATH_INLINE const std::uint32_t* crc32cTable()
+    {
+      static const struct Table{
+        Table()
+        {
+          for(std::uint32_t i = 0; i < 256; i++)
+          {
+            std::uint32_t c = i;
+            for(int k = 0; k < 8; k++)
+              c = c & 1u ? (c >> 1) ^ 0x82f63b78u : c >> 1;
+            t[i] = c;
+          }
+        }
+
+        std::uint32_t t[256];
+      } table;
+
+      return table.t;
+    }
+
+  };
+
+  //CRC-32C
+  SKMATH_INLINE std::uint32_t crc32c(const void* data, std::size_t size, std::uint32_t crc)
+  {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+
+#if defined(SKMATH_SSE42)
+  #if defined(__x86_64__) || defined(_M_X64)
+    std::uint64_t c = crc;
+    for(; size >= 8; p += 8, size -= 8)
+    {
+      std::uint64_t v;
+      std::memcpy(&v, p, sizeof(v));
+      c = _mm_crc32_u64(c, v);
+    }
+    crc = std::uint32_t(c);
+  #endif
+    for(; size; p++, size--)
+      crc = _mm_crc32_u8(crc, *p);
+#else
+    const std::uint32_t* table = detail::crc32cTable();
+    for(; size; p++, size--)
+      crc = table[(crc ^ *p) & 0xffu] ^ (crc >> 8);
+#endif
+
+    return ~crc;
+  }
+
+  //Constructor
+  SKMATH_INLINE PoseFile::PoseFile()
+    : _data(nullptr), _size(0), _mapping(nullptr), _version(0)
+  {
+  }
+
+  //Destructor
+  SKMATH_INLINE PoseFile::~PoseFile()
+  {
+    close();
+  }
+
+  //Open
+  SKMATH_INLINE bool PoseFile::open(const char* path, bool verify)
+  {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER size;
+    if(GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+      _mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if(_mapping)
+      {
+        _data = static_cast<const unsigned char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+        _size = std::size_t(size.QuadPart);
+      }
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(path, O_RDONLY);
+    if(file < 0)
+      return false;
+
+    struct stat status;
+    if(fstat(file, &status) == 0 && status.st_size > 0)
+    {
+      void* data = mmap(nullptr, std::size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+      if(data != MAP_FAILED)
+      {
+        _data = static_cast<const unsigned char*>(data);
+        _size = std::size_t(status.st_size);
+      }
+    }
+    ::close(file);
+#endif
+
+    if(!_data || !parse(verify))
+    {
+      close();
+      return false;
+    }
+
+    return true;
+  }
+
+  //Close
+  SKMATH_INLINE void PoseFile::close()
+  {
+#ifdef _WIN32
+    if(_data)
+      UnmapViewOfFile(_data);
+    if(_mapping)
+      CloseHandle(_mapping);
+#else
+    if(_data)
+      munmap(const_cast<unsigned char*>(_data), _size);
+#endif
+
+    _data = nullptr;
+    _size = 0;
+    _mapping = nullptr;
+    _version = 0;
+    _sections.clear();
+  }
+
+  //Is open
+  SKMATH_INLINE bool PoseFile::isOpen() const
+  {
+    return _data != nullptr;
+  }
+
+  //Version
+  SKMATH_INLINE std::uint32_t PoseFile::version() const
+  {
+    return _version;
+  }
+
+  //Sections
+  SKMATH_INLINE std::size_t PoseFile::sections() const
+  {
+    return _sections.size();
+  }
+
+  //Find
+  SKMATH_INLINE std::size_t PoseFile::find(const char* name) const
+  {
+    for(std::size_t i = 0; i < _sections.size(); i++)
+      if(_sections[i].name == name)
+        return i;
+
+    return cNoSection;
+  }
+
+  //Name
+  SKMATH_INLINE const std::string& PoseFile::name(std::size_t section) const
+  {
+    return _sections[section].name;
+  }
+
+  //Type
+  SKMATH_INLINE RecordType PoseFile::type(std::size_t section) const
+  {
+    return _sections[section].type;
+  }
+
+  //Size
+  SKMATH_INLINE std::size_t PoseFile::size(std::size_t section) const
+  {
+    return _sections[section].size;
+  }
+
+  //Records
+  SKMATH_INLINE const void* PoseFile::records(std::size_t section, RecordType type, std::size_t& size) const
+  {
+    size = 0;
+    if(section >= _sections.size() || type == cUnknownRecord || _sections[section].type != type)
+      return nullptr;
+
+    size = _sections[section].size;
+    return _sections[section].data;
+  }
+
+  //Parse
+  SKMATH_INLINE bool PoseFile::parse(bool verify)
+  {
+    detail::PoseFileHeader header;
+    if(_size < sizeof(header))
+      return false;
+    std::memcpy(&header, _data, sizeof(header));
+
+    if(std::memcmp(header.magic, detail::cPoseFileMagic, sizeof(header.magic)) != 0 ||
+       header.byteOrder != detail::cPoseFileByteOrder || header.version == 0 ||
+       header.version > cPoseFileVersion || header.headerSize != sizeof(header) ||
+       header.alignment != cPoseFileAlignment || header.fileSize != _size ||
+       header.checksum != crc32c(&header, offsetof(detail::PoseFileHeader, checksum)))
+      return false;
+
+    //The directory ends the file
+    if(header.directory < sizeof(header) || header.directory > _size ||
+       header.sections != (_size - header.directory) / sizeof(detail::PoseFileSection) ||
+       (_size - header.directory) % sizeof(detail::PoseFileSection) != 0)
+      return false;
+
+    _version = header.version;
+    _sections.resize(std::size_t(header.sections));
+
+    for(std::size_t i = 0; i < _sections.size(); i++)
+    {
+      detail::PoseFileSection entry;
+      std::memcpy(&entry, _data + header.directory + i * sizeof(entry), sizeof(entry));
+
+      if(entry.checksum != crc32c(&entry, offsetof(detail::PoseFileSection, checksum)) ||
+         entry.name[cPoseFileNameLength] != 0 || entry.offset % cPoseFileAlignment != 0 ||
+         entry.offset < sizeof(header) || entry.offset > header.directory ||
+         entry.bytes > header.directory - entry.offset)
+        return false;
+
+      //Records of unknown types are kept out of reach, but must still add up
+      const std::uint32_t size = detail::recordSize(entry.type);
+      if((size && entry.recordSize != size) || entry.recordSize == 0 ||
+         entry.bytes % entry.recordSize != 0 || entry.bytes / entry.recordSize != entry.count)
+        return false;
+
+      if(verify && crc32c(_data + entry.offset, std::size_t(entry.bytes)) != entry.dataChecksum)
+        return false;
+
+      Section& section = _sections[i];
+      section.name = entry.name;
+      section.type = size ? RecordType(entry.type) : cUnknownRecord;
+      section.size = std::size_t(entry.count);
+      section.data = _data + entry.offset;
+    }
+
+    return true;
+  }
+
+  //Constructor
+  SKMATH_INLINE PoseFileWriter::PoseFileWriter()
+    : _file(nullptr), _failed(false), _offset(0), _inSection(false), _section()
+  {
+  }
+
+  //Destructor
+  SKMATH_INLINE PoseFileWriter::~PoseFileWriter()
+  {
+    close();
+  }
+
+  //Open
+  SKMATH_INLINE bool PoseFileWriter::open(const char* path)
+  {
+    close();
+
+    _file = std::fopen(path, "wb");
+    if(!_file)
+      return false;
+
+    _failed = false;
+    _offset = 0;
+    _directory.clear();
+    _inSection = false;
+
+    //Placeholder, the header is written by close
+    detail::PoseFileHeader header = {};
+    return write(&header, sizeof(header));
+  }
+
+  //Close
+  SKMATH_INLINE bool PoseFileWriter::close()
+  {
+    if(!_file)
+      return false;
+
+    endSection();
+
+    detail::PoseFileHeader header = {};
+    std::memcpy(header.magic, detail::cPoseFileMagic, sizeof(header.magic));
+    header.version = cPoseFileVersion;
+    header.byteOrder = detail::cPoseFileByteOrder;
+    header.headerSize = sizeof(header);
+    header.alignment = cPoseFileAlignment;
+    header.sections = _directory.size();
+    header.directory = _offset;
+    header.fileSize = _offset + _directory.size() * sizeof(detail::PoseFileSection);
+    header.checksum = crc32c(&header, offsetof(detail::PoseFileHeader, checksum));
+
+    if(!_directory.empty())
+      write(_directory.data(), _directory.size() * sizeof(detail::PoseFileSection));
+
+    if(std::fseek(_file, 0, SEEK_SET) != 0 || std::fwrite(&header, sizeof(header), 1, _file) != 1)
+      _failed = true;
+    if(std::fclose(_file) != 0)
+      _failed = true;
+
+    _file = nullptr;
+    _directory.clear();
+    return !_failed;
+  }
+
+  //Is open
+  SKMATH_INLINE bool PoseFileWriter::isOpen() const
+  {
+    return _file != nullptr;
+  }
+
+  //Begin section
+  SKMATH_INLINE bool PoseFileWriter::beginSection(const char* name, RecordType type)
+  {
+    if(!_file || type == cUnknownRecord || detail::recordSize(type) == 0 || std::strlen(name) > cPoseFileNameLength)
+      return false;
+
+    if(!endSection())
+      return false;
+
+    _section = detail::PoseFileSection();
+    _section.type = type;
+    _section.recordSize = detail::recordSize(type);
+    _section.offset = _offset;
+    std::strcpy(_section.name, name);
+    _inSection = true;
+    return true;
+  }
+
+  //Append
+  SKMATH_INLINE bool PoseFileWriter::append(const Vector* records, std::size_t size)
+  {
+    return appendRecords(records, cVectorRecord, size);
+  }
+  SKMATH_INLINE bool PoseFileWriter::append(const Matrix* records, std::size_t size)
+  {
+    return appendRecords(records, cMatrixRecord, size);
+  }
+  SKMATH_INLINE bool PoseFileWriter::append(const Quaternion* records, std::size_t size)
+  {
+    return appendRecords(records, cQuaternionRecord, size);
+  }
+
+  //End section
+  SKMATH_INLINE bool PoseFileWriter::endSection()
+  {
+    if(!_inSection)
+      return !_failed;
+
+    _inSection = false;
+    if(!pad())
+      return false;
+
+    _section.checksum = crc32c(&_section, offsetof(detail::PoseFileSection, checksum));
+    _directory.push_back(_section);
+    return true;
+  }
+
+  //Append records
+  SKMATH_INLINE bool PoseFileWriter::appendRecords(const void* records, RecordType type, std::size_t size)
+  {
+    if(!_inSection || _section.type != std::uint32_t(type))
+      return false;
+
+    const std::size_t bytes = size * _section.recordSize;
+    if(!write(records, bytes))
+      return false;
+
+    _section.count += size;
+    _section.bytes += bytes;
+    _section.dataChecksum = crc32c(records, bytes, _section.dataChecksum);
+    return true;
+  }
+
+  //Write
+  SKMATH_INLINE bool PoseFileWriter::write(const void* data, std::size_t bytes)
+  {
+    if(_failed)
+      return false;
+
+    if(bytes && std::fwrite(data, bytes, 1, _file) != 1)
+    {
+      _failed = true;
+      return false;
+    }
+
+    _offset += bytes;
+    return true;
+  }
+
+  //Pad
+  SKMATH_INLINE bool PoseFileWriter::pad()
+  {
+    static const unsigned char zeros[cPoseFileAlignment] = {};
+    return write(zeros, std::size_t(detail::alignOffset(_offset) - _offset));
+  }
+
+};
@@ -0,0 +1,11 @@
+/**
+* @file profile.cpp
+* @author skwo
+* @brief Realization of call profiling.
+*/
+
+#include "profile.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "profile.inl"
+#endif
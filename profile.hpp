@@ -0,0 +1,243 @@
+/**
+* @file profile.hpp
+* @author skwo
+* @brief Defenition of call profiling.
+*
+* Define <c>SKMATH_PROFILE</c> (CMake option of the same name) to count the calls of the hot
+* library functions and time them. Every thread counts into a block of its own, reached through a
+* thread local pointer, with relaxed atomic loads and stores only, so counting takes no locks and
+* shares no cache lines. Times are read with the time stamp counter on x86 and the steady clock
+* elsewhere, by out of line functions kept off the hot path.
+* - Short calls, such as Matrix * Matrix or rotate, time one call in <c>cProfileSampleRate</c>
+*   (SKMATH_PROFILE_SAMPLE). The other calls pay a counter increment and a predicted branch; the
+*   total time is estimated as calls times the mean time of the sampled calls.
+* - Batch calls, which run over whole arrays, time every call (SKMATH_PROFILE_SCOPE).
+*
+* profileReport sums the blocks of all threads, finished ones included, and writes text or JSON;
+* it runs by itself at exit, to stderr unless setProfileOutput says otherwise. Reported times
+* have the cost of reading the clock, measured when reporting, taken off.
+*
+* Without <c>SKMATH_PROFILE</c> both macros expand to nothing and nothing is counted; the report
+* functions still exist and report no calls.
+* @note Calls made by other library functions are counted too, and float and double versions
+* of a function share a counter. Functions that are constexpr in header-only mode, such as the
+* Vector and Quaternion operators, are not counted.
+*/
+
+#ifndef PROFILE_HPP_INCLUDED
+#define PROFILE_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+#include "config.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  #define SKMATH_PROFILE_RDTSC 1
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #else
+    #include <x86intrin.h>
+  #endif
+#else
+  #include <chrono>
+#endif
+
+//Header-only builds define the timer inline, where noinline is not allowed; cold alone keeps it
+//off the hot path there
+#if defined(__GNUC__) && defined(SKMATH_HEADER_ONLY)
+  #define SKMATH_PROFILE_UNLIKELY(x) __builtin_expect(!!(x), 0)
+  #define SKMATH_PROFILE_COLD __attribute__((cold))
+#elif defined(__GNUC__)
+  #define SKMATH_PROFILE_UNLIKELY(x) __builtin_expect(!!(x), 0)
+  #define SKMATH_PROFILE_COLD __attribute__((noinline, cold))
+#elif defined(_MSC_VER) && !defined(SKMATH_HEADER_ONLY)
+  #define SKMATH_PROFILE_UNLIKELY(x) (x)
+  #define SKMATH_PROFILE_COLD __declspec(noinline)
+#else
+  #define SKMATH_PROFILE_UNLIKELY(x) (x)
+  #define SKMATH_PROFILE_COLD
+#endif
+
+#ifdef SKMATH_PROFILE
+  /** Count a call of the enclosing function as <c>counter</c>, and time one call in
+  * cProfileSampleRate until the end of the scope.
+  */
+  #define SKMATH_PROFILE_SAMPLE(counter) \
+    const ::skmath::ProfileScope skmathProfileScope(counter, ::skmath::cProfileSampleRate)
+  /** Count a call of the enclosing function as <c>counter</c>, and time it until the end of the scope. */
+  #define SKMATH_PROFILE_SCOPE(counter) const ::skmath::ProfileScope skmathProfileScope(counter, 1)
+#else
+  #define SKMATH_PROFILE_SAMPLE(counter)
+  #define SKMATH_PROFILE_SCOPE(counter)
+#endif
+
+namespace skmath{
+
+  /** Profiled functions. Batch functions time every call, the others a sample. */
+  enum ProfileCounter{
+    cProfileMatrixMultiply, /**< Matrix * Matrix. */
+    cProfileMatrixVector, /**< Matrix * Vector. */
+    cProfileMatrixInverse, /**< Matrix::inverse. */
+    cProfileMultiplyBatch, /**< multiplyBatch. */
+    cProfileTransformPoints, /**< transformPoints and transformDirections. */
+    cProfileRotate, /**< rotate. */
+    cProfileRotateBatch, /**< rotateBatch. */
+    cProfileQuaternionToMatrix, /**< quaternionToMatrix. */
+    cProfileMatrixToQuaternion, /**< matrixToQuaternion. */
+    cProfileQuaternionToMatrixBatch, /**< quaternionToMatrixBatch. */
+    cProfileSkinBatch, /**< skinBatch, linear blend and dual quaternion. */
+    cProfileHierarchyUpdate, /**< TransformHierarchy::update. */
+    cProfileComputeAABB, /**< computeAABB. */
+    cProfileTransformAABBBatch, /**< transformAABBBatch. */
+    cProfileCull, /**< cullSpheres and cullAABBs. */
+    cProfileKdTreeNearest, /**< KdTree::nearest, batches included. */
+    cProfileKdTreeRadius, /**< KdTree::radiusSearch. */
+    cProfileKdTreeRadiusBatch, /**< KdTree::radiusSearchBatch. */
+    cProfileCounters /**< Number of counters. */
+  };
+
+  /** One call in cProfileSampleRate of a sampled function is timed, a power of two. */
+  const std::uint64_t cProfileSampleRate = 64;
+
+  /** Format of profile reports. */
+  enum ProfileFormat{
+    cProfileText,
+    cProfileJson
+  };
+
+  /** Profile of a function, summed over threads. */
+  struct ProfileEntry{
+    const char* name; /**< Name of the function. */
+    std::uint64_t calls; /**< Calls. */
+    std::uint64_t timed; /**< Calls timed, all of them or a sample. */
+    std::uint64_t ticks; /**< Time of the timed calls, in cycles on x86 and nanoseconds elsewhere. */
+  };
+
+  namespace detail{
+
+    /** Counters of one thread. Written by that thread only, read by any. */
+    struct ProfileBlock{
+      std::atomic<std::uint64_t> calls[cProfileCounters];
+      std::atomic<std::uint64_t> timed[cProfileCounters];
+      std::atomic<std::uint64_t> ticks[cProfileCounters];
+      ProfileBlock* next; /**< Block of the thread registered before. */
+    };
+
+    /** Block of the calling thread, null until its first counted call. */
+    inline thread_local ProfileBlock* tProfileBlock = nullptr;
+
+    /** Allocate and link the block of the calling thread. Blocks are never freed, so counts of
+    * finished threads stay in the reports.
+    * @return Block of the calling thread.
+    */
+    ProfileBlock* profileRegister();
+
+    /** Time stamp, in cycles on x86 and nanoseconds elsewhere. */
+    inline std::uint64_t profileTicks()
+    {
+#ifdef SKMATH_PROFILE_RDTSC
+      return __rdtsc();
+#else
+      return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /** Relaxed increment of a counter only its thread writes, a plain add without a lock prefix. */
+    inline std::uint64_t profileAdd(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+    {
+      const std::uint64_t sum = counter.load(std::memory_order_relaxed) + value;
+      counter.store(sum, std::memory_order_relaxed);
+      return sum;
+    }
+
+    /** Start timing a call, out of line.
+    * @return Time stamp, never 0.
+    */
+    SKMATH_PROFILE_COLD std::uint64_t profileStart();
+
+    /** Add the time of a call since <c>start</c>, out of line.
+    * @param block Block of the calling thread.
+    * @param counter Function called.
+    * @param start Time stamp of profileStart.
+    */
+    SKMATH_PROFILE_COLD void profileStop(ProfileBlock* block, ProfileCounter counter, std::uint64_t start);
+
+  };
+
+  /** Counts a call when constructed, and times it until destroyed if it is one of the timed
+  * calls. Use through SKMATH_PROFILE_SAMPLE or SKMATH_PROFILE_SCOPE.
+  */
+  class ProfileScope{
+    public:
+      /** Constructor. Count a call, and start timing it if it is timed.
+      * @param counter Function called.
+      * @param sampleRate Time the first call and then one in <c>sampleRate</c>, a power of two;
+      * 1 times every call.
+      */
+      ProfileScope(ProfileCounter counter, std::uint64_t sampleRate)
+        : _block(detail::tProfileBlock), _counter(counter), _start(0)
+      {
+        if(!_block)
+          _block = detail::profileRegister();
+
+        const std::uint64_t calls = detail::profileAdd(_block->calls[counter], 1);
+        if(SKMATH_PROFILE_UNLIKELY(((calls - 1) & (sampleRate - 1)) == 0))
+          _start = detail::profileStart();
+      }
+
+      /** Destructor. Add the time of a timed call. */
+      ~ProfileScope()
+      {
+        if(SKMATH_PROFILE_UNLIKELY(_start != 0))
+          detail::profileStop(_block, _counter, _start);
+      }
+
+      ProfileScope(const ProfileScope&) = delete;
+      ProfileScope& operator =(const ProfileScope&) = delete;
+
+    private:
+      detail::ProfileBlock* _block; /**< Block of the calling thread. */
+      ProfileCounter _counter; /**< Function called. */
+      std::uint64_t _start; /**< Time stamp of the start of a timed call, 0 otherwise. */
+  };
+
+  /** Get name of profiled function.
+  * @param counter Counter.
+  * @return Name, such as "Matrix * Matrix".
+  */
+  const char* profileName(ProfileCounter counter);
+
+  /** Get profile.
+  * @param entries Array of <c>cProfileCounters</c> entries to store the counts of every
+  * function in, summed over all threads. Counts of calls running meanwhile may be missed.
+  */
+  void profileSnapshot(ProfileEntry* entries);
+
+  /** Reset profile. Zero the counts of all threads. Calls running meanwhile may be counted
+  * either side.
+  */
+  void profileReset();
+
+  /** Write profile report, the functions with calls only.
+  * @param file File to write to, such as stdout.
+  * @param format Text, a table with estimated total times, or JSON.
+  */
+  void profileReport(FILE* file, ProfileFormat format = cProfileText);
+
+  /** Set output of the report written at exit, which is written only if a call was counted.
+  * @param path File to write the report to, stderr if null (the default).
+  * @param format Format of the report.
+  * @param enabled Write a report at exit.
+  */
+  void setProfileOutput(const char* path, ProfileFormat format = cProfileText, bool enabled = true);
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "profile.inl"
+#endif
+
+#endif // PROFILE_HPP_INCLUDED
@@ -0,0 +1,236 @@
+/**
+* @file profile.inl
+* @author skwo
+* @brief Realization of call profiling.
+* @note Included by profile.cpp, or by profile.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <algorithm>
+#include <cinttypes>
+#include <mutex>
+#include <string>
+
+namespace skmath{
+
+  namespace detail{
+
+    //Registered blocks, and the report written at exit
+    struct ProfileState{
+      ProfileState()
+        : head(nullptr), format(cProfileText), atExit(true)
+      {
+      }
+
+      //Report at exit, if any thread counted a call
+      ~ProfileState()
+      {
+        if(!atExit || !head.load(std::memory_order_acquire))
+          return;
+
+        FILE* file = path.empty() ? stderr : fopen(path.c_str(), "w");
+        if(!file)
+          return;
+
+        profileReport(file, format);
+        if(file != stderr)
+          fclose(file);
+      }
+
+      std::atomic<ProfileBlock*> head; /**< Last registered block, linked to the earlier ones. */
+      std::mutex mutex; /**< Guards the output settings. */
+      std::string path; /**< Report file, stderr if empty. */
+      ProfileFormat format; /**< Report format. */
+      bool atExit; /**< Write a report at exit. */
+    };
+
+    SKMATH_INLINE ProfileState& profileState()
+    {
+      static ProfileState state;
+      return state;
+    }
+
+    //Register
+    SKMATH_INLINE ProfileBlock* profileRegister()
+    {
+      ProfileState& state = profileState();
+
+      ProfileBlock* block = new ProfileBlock();
+      for(int c = 0; c < cProfileCounters; c++)
+      {
+        block->calls[c].store(0, std::memory_order_relaxed);
+        block->timed[c].store(0, std::memory_order_relaxed);
+        block->ticks[c].store(0, std::memory_order_relaxed);
+      }
+
+      //Push on the list; blocks are only ever added, so readers walk it without locks
+      block->next = state.head.load(std::memory_order_relaxed);
+      while(!state.head.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed))
+        ;
+
+      tProfileBlock = block;
+      return block;
+    }
+
+    //Start
+    SKMATH_INLINE std::uint64_t profileStart()
+    {
+      const std::uint64_t ticks = profileTicks();
+      return ticks ? ticks : 1;
+    }
+
+    //Stop
+    SKMATH_INLINE void profileStop(ProfileBlock* block, ProfileCounter counter, std::uint64_t start)
+    {
+      profileAdd(block->ticks[counter], profileTicks() - start);
+      profileAdd(block->timed[counter], 1);
+    }
+
+    //Ticks of an empty timed call, the least of a few
+    SKMATH_INLINE std::uint64_t profileOverhead()
+    {
+      std::uint64_t best = ~std::uint64_t(0);
+      for(int i = 0; i < 256; i++)
+      {
+        const std::uint64_t start = profileStart();
+        const std::uint64_t ticks = profileTicks() - start;
+        best = ticks < best ? ticks : best;
+      }
+      return best;
+    }
+
+  };
+
+  //Get name
+  SKMATH_INLINE const char* profileName(ProfileCounter counter)
+  {
+    static const char* const names[cProfileCounters] = {
+      "Matrix * Matrix",
+      "Matrix * Vector",
+      "Matrix::inverse",
+      "multiplyBatch",
+      "transformPoints, transformDirections",
+      "rotate",
+      "rotateBatch",
+      "quaternionToMatrix",
+      "matrixToQuaternion",
+      "quaternionToMatrixBatch",
+      "skinBatch",
+      "TransformHierarchy::update",
+      "computeAABB",
+      "transformAABBBatch",
+      "cullSpheres, cullAABBs",
+      "KdTree::nearest",
+      "KdTree::radiusSearch",
+      "KdTree::radiusSearchBatch"
+    };
+
+    return counter >= 0 && counter < cProfileCounters ? names[counter] : "";
+  }
+
+  //Get profile
+  SKMATH_INLINE void profileSnapshot(ProfileEntry* entries)
+  {
+    for(int c = 0; c < cProfileCounters; c++)
+      entries[c] = ProfileEntry{ profileName(ProfileCounter(c)), 0, 0, 0 };
+
+    for(const detail::ProfileBlock* block = detail::profileState().head.load(std::memory_order_acquire); block; block = block->next)
+    {
+      for(int c = 0; c < cProfileCounters; c++)
+      {
+        entries[c].calls += block->calls[c].load(std::memory_order_relaxed);
+        entries[c].timed += block->timed[c].load(std::memory_order_relaxed);
+        entries[c].ticks += block->ticks[c].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  //Reset profile
+  SKMATH_INLINE void profileReset()
+  {
+    for(detail::ProfileBlock* block = detail::profileState().head.load(std::memory_order_acquire); block; block = block->next)
+    {
+      for(int c = 0; c < cProfileCounters; c++)
+      {
+        block->calls[c].store(0, std::memory_order_relaxed);
+        block->timed[c].store(0, std::memory_order_relaxed);
+        block->ticks[c].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  //Write profile report
+  SKMATH_INLINE void profileReport(FILE* file, ProfileFormat format)
+  {
+    ProfileEntry entries[cProfileCounters];
+    profileSnapshot(entries);
+
+    std::size_t threads = 0;
+    for(const detail::ProfileBlock* block = detail::profileState().head.load(std::memory_order_acquire); block; block = block->next)
+      threads++;
+
+#ifdef SKMATH_PROFILE_RDTSC
+    const char* unit = "cycles";
+#else
+    const char* unit = "ns";
+#endif
+
+    //Mean time of the timed calls, less the time of reading the clock, and the total estimated
+    //from it for all calls
+    const double overhead = double(detail::profileOverhead());
+    double perCall[cProfileCounters], total[cProfileCounters];
+    for(int c = 0; c < cProfileCounters; c++)
+    {
+      const ProfileEntry& e = entries[c];
+      perCall[c] = e.timed ? std::max(double(e.ticks) / double(e.timed) - overhead, 0.0) : 0.0;
+      total[c] = perCall[c] * double(e.calls);
+    }
+
+    if(format == cProfileJson)
+    {
+      fprintf(file, "{\n  \"unit\": \"%s\",\n  \"sampleRate\": %" PRIu64 ",\n  \"timerOverhead\": %.0f,\n"
+              "  \"threads\": %zu,\n  \"functions\": [", unit, cProfileSampleRate, overhead, threads);
+
+      const char* separator = "\n";
+      for(int c = 0; c < cProfileCounters; c++)
+      {
+        const ProfileEntry& e = entries[c];
+        if(!e.calls)
+          continue;
+
+        fprintf(file, "%s    {\"name\": \"%s\", \"calls\": %" PRIu64 ", \"timed\": %" PRIu64 ", \"ticks\": %" PRIu64
+                ", \"ticksPerCall\": %.1f, \"estimatedTicks\": %.0f}", separator, e.name, e.calls, e.timed, e.ticks,
+                perCall[c], total[c]);
+        separator = ",\n";
+      }
+      fprintf(file, "\n  ]\n}\n");
+    }
+    else
+    {
+      fprintf(file, "skmath profile of %zu thread%s in %s, short calls timed 1 in %" PRIu64 ", %.0f of timer overhead taken off\n",
+              threads, threads == 1 ? "" : "s", unit, cProfileSampleRate, overhead);
+      fprintf(file, "%-40s %16s %16s %16s %16s\n", "function", "calls", "timed", "per call", "total (M)");
+      for(int c = 0; c < cProfileCounters; c++)
+      {
+        const ProfileEntry& e = entries[c];
+        if(!e.calls)
+          continue;
+
+        fprintf(file, "%-40s %16" PRIu64 " %16" PRIu64 " %16.1f %16.3f\n", e.name, e.calls, e.timed, perCall[c],
+                total[c] * 1e-6);
+      }
+    }
+
+    fflush(file);
+  }
+
+  //Set profile output
+  SKMATH_INLINE void setProfileOutput(const char* path, ProfileFormat format, bool enabled)
+  {
+    detail::ProfileState& state = detail::profileState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.path = path ? path : "";
+    state.format = format;
+    state.atExit = enabled;
+  }
+
+};
@@ -0,0 +1,11 @@
+/**
+* @file quantize.cpp
+* @author skwo
+* @brief Realization of compact storage formats of quaternions and vectors.
+*/
+
+#include "quantize.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "quantize.inl"
+#endif
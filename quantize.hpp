@@ -0,0 +1,239 @@
+/**
+* @file quantize.hpp
+* @author skwo
+* @brief Defenition of compact storage formats of quaternions and vectors.
+*
+* Poses and point data rarely need 32-bit floats per component. The formats here trade a bounded
+* error for size:
+* - PackedQuaternion32 and PackedQuaternion48, smallest three: the largest component of a unit
+*   quaternion is left out and rebuilt from the other three, which lie in [-1/sqrt(2), 1/sqrt(2)],
+*   so their bits are not spent on a range they never reach. 4 or 6 bytes instead of 16.
+* - HalfVector, IEEE half floats, 6 bytes instead of 12, for values of any scale.
+* - FixedVector, 16-bit fixed point within a box given at encode and decode, 6 bytes.
+* - OctNormal, unit vectors mapped onto an octahedron and unfolded onto a square, 4 bytes.
+*
+* Every format has encode and decode of one element and batch versions that work on
+* <c>simd::cWidth</c> elements at a time with SSE/AVX (half floats with F16C) and split large
+* batches across threads. The error bounds below are checked by the accuracy mode of the benchmark.
+*/
+
+#ifndef QUANTIZE_HPP_INCLUDED
+#define QUANTIZE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#include "config.hpp"
+#include "vector.hpp"
+#include "quaternion.hpp"
+
+namespace skmath{
+
+  /** Max error of the components of a decoded PackedQuaternion32, up to the sign of the whole
+  * quaternion, for unit quaternions. The worst case is three components of 0.5, each off by half
+  * a step, which add up in the rebuilt largest one.
+  */
+  const float cPackedQuaternion32Error = 2.1e-3f;
+
+  /** Max error of the components of a decoded PackedQuaternion48, as cPackedQuaternion32Error. */
+  const float cPackedQuaternion48Error = 6.6e-5f;
+
+  /** Max relative error of the components of a decoded HalfVector, for magnitudes from 2^-14
+  * (6.1e-5) to 65504; below it the absolute error is at most 2^-25.
+  */
+  const float cHalfVectorError = 4.8828125e-4f;
+
+  /** Max error of the components of a decoded FixedVector, as a fraction of the extent of the
+  * box along that axis, for vectors inside the box: half a step of 1/65535 plus float rounding.
+  */
+  const float cFixedVectorError = 7.8e-6f;
+
+  /** Max angle in radians between a unit vector and its decoded OctNormal. */
+  const float cOctNormalError = 7e-5f;
+
+  /** Unit quaternion in 32 bits: index of the largest component (x, y, z, w) in the top 2 bits,
+  * and the other three in order, 10 bits each.
+  */
+  struct PackedQuaternion32{
+    std::uint32_t bits; /**< index << 30 | a << 20 | b << 10 | c. */
+  };
+
+  /** Unit quaternion in 48 bits: the other three components in the low 15 bits of each word,
+  * index of the largest component in the top bit of the first two.
+  */
+  struct PackedQuaternion48{
+    std::uint16_t bits[3]; /**< a | (index & 1) << 15, b | (index >> 1) << 15, c. */
+  };
+
+  /** Vector of IEEE 754 half floats. */
+  struct HalfVector{
+    std::uint16_t v[3]; /**< x, y, z. */
+  };
+
+  /** Vector of 16-bit fixed point values within a box: 0 is the minimum, 65535 the maximum. */
+  struct FixedVector{
+    std::uint16_t v[3]; /**< x, y, z. */
+  };
+
+  /** Unit vector in octahedral encoding, two snorm16 values. */
+  struct OctNormal{
+    std::int16_t v[2]; /**< u, v in [-32767, 32767]. */
+  };
+
+  /** Float to half float, rounded to nearest even; out of range values become infinity.
+  * @param f Float.
+  * @return Bits of the half float.
+  */
+  std::uint16_t floatToHalf(float f);
+
+  /** Half float to float, exact.
+  * @param h Bits of the half float.
+  * @return Float.
+  */
+  float halfToFloat(std::uint16_t h);
+
+  /** Encode quaternion, smallest three in 32 bits.
+  * @param q Unit quaternion.
+  * @param out Packed quaternion to store <c>q</c> in.
+  */
+  void encode(const Quaternion& q, PackedQuaternion32& out);
+
+  /** Decode quaternion, max error <c>cPackedQuaternion32Error</c>.
+  * @param in Packed quaternion.
+  * @param q Quaternion to store the result in, with its largest component positive.
+  */
+  void decode(const PackedQuaternion32& in, Quaternion& q);
+
+  /** Encode quaternion, smallest three in 48 bits.
+  * @param q Unit quaternion.
+  * @param out Packed quaternion to store <c>q</c> in.
+  */
+  void encode(const Quaternion& q, PackedQuaternion48& out);
+
+  /** Decode quaternion, max error <c>cPackedQuaternion48Error</c>.
+  * @param in Packed quaternion.
+  * @param q Quaternion to store the result in, with its largest component positive.
+  */
+  void decode(const PackedQuaternion48& in, Quaternion& q);
+
+  /** Encode vector as half floats.
+  * @param v Vector.
+  * @param out Half vector to store <c>v</c> in.
+  */
+  void encode(const Vector& v, HalfVector& out);
+
+  /** Decode vector of half floats, max relative error <c>cHalfVectorError</c>.
+  * @param in Half vector.
+  * @param v Vector to store the result in.
+  */
+  void decode(const HalfVector& in, Vector& v);
+
+  /** Encode vector as fixed point within the box [<c>min</c>, <c>max</c>].
+  * @param v Vector, clamped to the box.
+  * @param min Smallest corner of the box.
+  * @param max Largest corner of the box, larger than <c>min</c> along every axis.
+  * @param out Fixed vector to store <c>v</c> in.
+  */
+  void encode(const Vector& v, const Vector& min, const Vector& max, FixedVector& out);
+
+  /** Decode fixed point vector, max error <c>cFixedVectorError</c> times the extent of the box.
+  * @param in Fixed vector.
+  * @param min Smallest corner of the box it was encoded with.
+  * @param max Largest corner of the box it was encoded with.
+  * @param v Vector to store the result in.
+  */
+  void decode(const FixedVector& in, const Vector& min, const Vector& max, Vector& v);
+
+  /** Encode unit vector, octahedral.
+  * @param n Unit vector; other vectors are encoded as their direction, the zero vector as +z.
+  * @param out Octahedral normal to store <c>n</c> in.
+  */
+  void encode(const Vector& n, OctNormal& out);
+
+  /** Decode unit vector, max angle error <c>cOctNormalError</c>.
+  * @param in Octahedral normal.
+  * @param n Vector to store the result in, of unit length.
+  */
+  void decode(const OctNormal& in, Vector& n);
+
+  /** Encode batch, as encode(q, out).
+  * @param in Array of <c>size</c> unit quaternions.
+  * @param out Array of <c>size</c> packed quaternions to store the result in.
+  * @param size Number of quaternions.
+  */
+  void encodeBatch(const Quaternion* in, PackedQuaternion32* out, std::size_t size);
+
+  /** Decode batch, as decode(in, q).
+  * @param in Array of <c>size</c> packed quaternions.
+  * @param out Array of <c>size</c> quaternions to store the result in.
+  * @param size Number of quaternions.
+  */
+  void decodeBatch(const PackedQuaternion32* in, Quaternion* out, std::size_t size);
+
+  /** Encode batch, as encode(q, out).
+  * @param in Array of <c>size</c> unit quaternions.
+  * @param out Array of <c>size</c> packed quaternions to store the result in.
+  * @param size Number of quaternions.
+  */
+  void encodeBatch(const Quaternion* in, PackedQuaternion48* out, std::size_t size);
+
+  /** Decode batch, as decode(in, q).
+  * @param in Array of <c>size</c> packed quaternions.
+  * @param out Array of <c>size</c> quaternions to store the result in.
+  * @param size Number of quaternions.
+  */
+  void decodeBatch(const PackedQuaternion48* in, Quaternion* out, std::size_t size);
+
+  /** Encode batch, as encode(v, out). Uses F16C when enabled at compile time.
+  * @param in Array of <c>size</c> vectors.
+  * @param out Array of <c>size</c> half vectors to store the result in.
+  * @param size Number of vectors.
+  */
+  void encodeBatch(const Vector* in, HalfVector* out, std::size_t size);
+
+  /** Decode batch, as decode(in, v). Uses F16C when enabled at compile time.
+  * @param in Array of <c>size</c> half vectors.
+  * @param out Array of <c>size</c> vectors to store the result in.
+  * @param size Number of vectors.
+  */
+  void decodeBatch(const HalfVector* in, Vector* out, std::size_t size);
+
+  /** Encode batch, as encode(v, min, max, out).
+  * @param in Array of <c>size</c> vectors.
+  * @param min Smallest corner of the box.
+  * @param max Largest corner of the box.
+  * @param out Array of <c>size</c> fixed vectors to store the result in.
+  * @param size Number of vectors.
+  */
+  void encodeBatch(const Vector* in, const Vector& min, const Vector& max, FixedVector* out, std::size_t size);
+
+  /** Decode batch, as decode(in, min, max, v).
+  * @param in Array of <c>size</c> fixed vectors.
+  * @param min Smallest corner of the box they were encoded with.
+  * @param max Largest corner of the box they were encoded with.
+  * @param out Array of <c>size</c> vectors to store the result in.
+  * @param size Number of vectors.
+  */
+  void decodeBatch(const FixedVector* in, const Vector& min, const Vector& max, Vector* out, std::size_t size);
+
+  /** Encode batch, as encode(n, out).
+  * @param in Array of <c>size</c> unit vectors.
+  * @param out Array of <c>size</c> octahedral normals to store the result in.
+  * @param size Number of vectors.
+  */
+  void encodeBatch(const Vector* in, OctNormal* out, std::size_t size);
+
+  /** Decode batch, as decode(in, n).
+  * @param in Array of <c>size</c> octahedral normals.
+  * @param out Array of <c>size</c> vectors to store the result in.
+  * @param size Number of vectors.
+  */
+  void decodeBatch(const OctNormal* in, Vector* out, std::size_t size);
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "quantize.inl"
+#endif
+
+#endif // QUANTIZE_HPP_INCLUDED
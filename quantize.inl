@@ -0,0 +1,634 @@
+/**
+* @file quantize.inl
+* @author skwo
+* @brief Realization of compact storage formats of quaternions and vectors.
+* @note Included by quantize.cpp, or by quantize.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "parallel.hpp"
+#include "simd.hpp"
+
+namespace skmath{
+
+  static_assert(sizeof(PackedQuaternion32) == 4, "PackedQuaternion32 must be packed");
+  static_assert(sizeof(PackedQuaternion48) == 6, "PackedQuaternion48 must be packed");
+  static_assert(sizeof(HalfVector) == 6, "HalfVector must be packed");
+  static_assert(sizeof(FixedVector) == 6, "FixedVector must be packed");
+  static_assert(sizeof(OctNormal) == 4, "OctNormal must be packed");
+
+  namespace detail{
+
+    //Smallest three components in [-1/sqrt(2), 1/sqrt(2)] map to [0, 2 half], 0 to half
+    const float cSqrt2 = 1.41421356237309505f;
+    const float cQuaternion32Half = 511.0f;
+    const float cQuaternion48Half = 16383.0f;
+    const float cFixedMax = 65535.0f;
+    const float cSnorm16 = 32767.0f;
+
+    //Smallest three of q: index of the largest of x, y, z, w (the first of equal ones), and the
+    //others in order, multiplied by the sign of the largest and quantized
+    SKMATH_INLINE void smallestThree(const Quaternion& q, float half, std::uint32_t& index, std::uint32_t (&c)[3])
+    {
+      const float v[4] = { q[0], q[1], q[2], q.w() };
+      const float m = std::max(std::max(std::fabs(v[0]), std::fabs(v[1])), std::max(std::fabs(v[2]), std::fabs(v[3])));
+
+      index = 3;
+      for(int k = 2; k >= 0; k--)
+        if(!(std::fabs(v[k]) < m))
+          index = std::uint32_t(k);
+
+      const float s = v[index] < 0.0f ? -half * cSqrt2 : half * cSqrt2;
+      for(std::uint32_t k = 0; k < 3; k++)
+        c[k] = std::uint32_t(std::nearbyint(std::min(std::max(v[k < index ? k : k + 1] * s + half, 0.0f), 2.0f * half)));
+    }
+
+    //Quaternion from smallest three, the largest component rebuilt from unit length
+    SKMATH_INLINE void fromSmallestThree(std::uint32_t index, const std::uint32_t (&c)[3], float half, Quaternion& q)
+    {
+      const float inv = 1.0f / (half * cSqrt2);
+      const float f[3] = { (float(c[0]) - half) * inv, (float(c[1]) - half) * inv, (float(c[2]) - half) * inv };
+      const float big = std::sqrt(std::max(0.0f, 1.0f - f[0] * f[0] - f[1] * f[1] - f[2] * f[2]));
+
+      float v[4];
+      for(std::uint32_t k = 0; k < 4; k++)
+        v[k] = k < index ? f[k] : (k == index ? big : f[k - 1]);
+
+      q.w() = v[3];
+      q[0] = v[0];
+      q[1] = v[1];
+      q[2] = v[2];
+    }
+
+    //smallestThree of cWidth quaternions at q, as floats into aligned index, a, b and c
+    SKMATH_INLINE void smallestThree(const float* q, float half, float* index, float* a, float* b, float* c)
+    {
+      //Declarations, detail::sub of vectors would hide simd::sub
+      using simd::Float;
+      using simd::abs;
+      using simd::cmplt;
+      using simd::madd;
+      using simd::max;
+      using simd::min;
+      using simd::round;
+      using simd::select;
+      using simd::set1;
+      using simd::store;
+      using simd::zero;
+
+      Float w, x, y, z;
+      simd::loadQuaternions(q, w, x, y, z);
+
+      Float ax = abs(x), ay = abs(y), az = abs(z), aw = abs(w);
+      Float m = max(max(ax, ay), max(az, aw));
+
+      Float i = set1(3.0f), big = w;
+      Float lt = cmplt(az, m);
+      i = select(lt, i, set1(2.0f));
+      big = select(lt, big, z);
+      lt = cmplt(ay, m);
+      i = select(lt, i, set1(1.0f));
+      big = select(lt, big, y);
+      lt = cmplt(ax, m);
+      i = select(lt, i, zero());
+      big = select(lt, big, x);
+
+      Float s = select(cmplt(big, zero()), set1(-half * cSqrt2), set1(half * cSqrt2));
+      Float h = set1(half), top = set1(2.0f * half);
+      Float fa = select(cmplt(i, set1(0.5f)), y, x);
+      Float fb = select(cmplt(i, set1(1.5f)), z, y);
+      Float fc = select(cmplt(i, set1(2.5f)), w, z);
+
+      store(index, i);
+      store(a, round(min(max(madd(fa, s, h), zero()), top)));
+      store(b, round(min(max(madd(fb, s, h), zero()), top)));
+      store(c, round(min(max(madd(fc, s, h), zero()), top)));
+    }
+
+    //fromSmallestThree of cWidth quaternions from aligned floats index, a, b and c, into q
+    SKMATH_INLINE void fromSmallestThree(const float* index, const float* a, const float* b, const float* c, float half, float* q)
+    {
+      using simd::Float;
+      using simd::cmplt;
+      using simd::load;
+      using simd::max;
+      using simd::mul;
+      using simd::nmadd;
+      using simd::select;
+      using simd::set1;
+      using simd::sqrt;
+      using simd::sub;
+      using simd::zero;
+
+      Float inv = set1(1.0f / (half * cSqrt2)), h = set1(half);
+      Float i = load(index);
+      Float fa = mul(sub(load(a), h), inv);
+      Float fb = mul(sub(load(b), h), inv);
+      Float fc = mul(sub(load(c), h), inv);
+      Float big = sqrt(max(zero(), nmadd(fc, fc, nmadd(fb, fb, nmadd(fa, fa, set1(1.0f))))));
+
+      Float i0 = cmplt(i, set1(0.5f)), i1 = cmplt(i, set1(1.5f)), i2 = cmplt(i, set1(2.5f));
+      Float x = select(i0, big, fa);
+      Float y = select(i0, fa, select(i1, big, fb));
+      Float z = select(i1, fb, select(i2, big, fc));
+      Float w = select(i2, fc, big);
+
+      simd::storeQuaternions(q, w, x, y, z);
+    }
+
+    //Octahedral u and v in [-1, 1] of direction x, y, z
+    SKMATH_INLINE void octahedral(float x, float y, float z, float& u, float& v)
+    {
+      const float l = std::max(std::fabs(x) + std::fabs(y) + std::fabs(z), std::numeric_limits<float>::min());
+      u = x / l;
+      v = y / l;
+
+      //Fold the lower half over the diagonals
+      if(z < 0.0f)
+      {
+        const float fu = (1.0f - std::fabs(v)) * (u < 0.0f ? -1.0f : 1.0f);
+        const float fv = (1.0f - std::fabs(u)) * (v < 0.0f ? -1.0f : 1.0f);
+        u = fu;
+        v = fv;
+      }
+    }
+
+    //Snorm16 of value in [-1, 1]
+    SKMATH_INLINE std::int16_t snorm16(float f)
+    {
+      return std::int16_t(std::nearbyint(std::min(std::max(f, -1.0f), 1.0f) * cSnorm16));
+    }
+
+  };
+
+  //Float to half
+  SKMATH_INLINE std::uint16_t floatToHalf(float f)
+  {
+    //Rounding to nearest even with integer arithmetic, after F. Giesen's float_to_half_fast3_rtne
+    std::uint32_t x;
+    std::memcpy(&x, &f, sizeof(float));
+    const std::uint32_t sign = x & 0x80000000u;
+    x ^= sign;
+
+    std::uint32_t h;
+    if(x >= 0x47800000u)
+    {
+      //65536 and up overflows, NaN stays NaN
+      h = x > 0x7f800000u ? 0x7e00u : 0x7c00u;
+    }
+    else if(x < 0x38800000u)
+    {
+      //Below 2^-14, subnormal or zero: adding 0.5 aligns the mantissa, the FPU rounds
+      const std::uint32_t magicBits = 0x3f000000u;
+      float magic, r;
+      std::memcpy(&magic, &magicBits, sizeof(float));
+      std::memcpy(&r, &x, sizeof(float));
+      r += magic;
+      std::memcpy(&h, &r, sizeof(float));
+      h -= magicBits;
+    }
+    else
+    {
+      //Rebias the exponent and round the 13 dropped mantissa bits, ties to even
+      const std::uint32_t odd = (x >> 13) & 1u;
+      h = (x + 0xc8000fffu + odd) >> 13;
+    }
+
+    return std::uint16_t(h | (sign >> 16));
+  }
+
+  //Half to float
+  SKMATH_INLINE float halfToFloat(std::uint16_t h)
+  {
+    std::uint32_t x = std::uint32_t(h & 0x7fffu) << 13;
+    const std::uint32_t exponent = x & 0x0f800000u;
+    x += 0x38000000u;
+
+    if(exponent == 0x0f800000u)
+      x += 0x38000000u; //Infinity or NaN
+    else if(exponent == 0)
+    {
+      //Subnormal: renormalize by letting the FPU subtract the implicit bit
+      x += 0x00800000u;
+      const std::uint32_t magicBits = 0x38800000u;
+      float r, magic;
+      std::memcpy(&r, &x, sizeof(float));
+      std::memcpy(&magic, &magicBits, sizeof(float));
+      r -= magic;
+      std::memcpy(&x, &r, sizeof(float));
+    }
+
+    x |= std::uint32_t(h & 0x8000u) << 16;
+    float f;
+    std::memcpy(&f, &x, sizeof(float));
+    return f;
+  }
+
+  //Encode quaternion 32
+  SKMATH_INLINE void encode(const Quaternion& q, PackedQuaternion32& out)
+  {
+    std::uint32_t index, c[3];
+    detail::smallestThree(q, detail::cQuaternion32Half, index, c);
+    out.bits = index << 30 | c[0] << 20 | c[1] << 10 | c[2];
+  }
+
+  //Decode quaternion 32
+  SKMATH_INLINE void decode(const PackedQuaternion32& in, Quaternion& q)
+  {
+    const std::uint32_t c[3] = { (in.bits >> 20) & 1023u, (in.bits >> 10) & 1023u, in.bits & 1023u };
+    detail::fromSmallestThree(in.bits >> 30, c, detail::cQuaternion32Half, q);
+  }
+
+  //Encode quaternion 48
+  SKMATH_INLINE void encode(const Quaternion& q, PackedQuaternion48& out)
+  {
+    std::uint32_t index, c[3];
+    detail::smallestThree(q, detail::cQuaternion48Half, index, c);
+    out.bits[0] = std::uint16_t(c[0] | (index & 1u) << 15);
+    out.bits[1] = std::uint16_t(c[1] | (index >> 1) << 15);
+    out.bits[2] = std::uint16_t(c[2]);
+  }
+
+  //Decode quaternion 48
+  SKMATH_INLINE void decode(const PackedQuaternion48& in, Quaternion& q)
+  {
+    const std::uint32_t c[3] = { in.bits[0] & 0x7fffu, in.bits[1] & 0x7fffu, in.bits[2] & 0x7fffu };
+    const std::uint32_t index = std::uint32_t(in.bits[0] >> 15) | std::uint32_t(in.bits[1] >> 15) << 1;
+    detail::fromSmallestThree(index, c, detail::cQuaternion48Half, q);
+  }
+
+  //Encode half vector
+  SKMATH_INLINE void encode(const Vector& v, HalfVector& out)
+  {
+    for(int k = 0; k < 3; k++)
+      out.v[k] = floatToHalf(v[k]);
+  }
+
+  //Decode half vector
+  SKMATH_INLINE void decode(const HalfVector& in, Vector& v)
+  {
+    v = Vector(halfToFloat(in.v[0]), halfToFloat(in.v[1]), halfToFloat(in.v[2]));
+  }
+
+  //Encode fixed vector
+  SKMATH_INLINE void encode(const Vector& v, const Vector& min, const Vector& max, FixedVector& out)
+  {
+    for(int k = 0; k < 3; k++)
+    {
+      const float scale = detail::cFixedMax / (max[k] - min[k]);
+      out.v[k] = std::uint16_t(std::nearbyint(std::min(std::max((v[k] - min[k]) * scale, 0.0f), detail::cFixedMax)));
+    }
+  }
+
+  //Decode fixed vector
+  SKMATH_INLINE void decode(const FixedVector& in, const Vector& min, const Vector& max, Vector& v)
+  {
+    float r[3];
+    for(int k = 0; k < 3; k++)
+      r[k] = float(in.v[k]) * ((max[k] - min[k]) / detail::cFixedMax) + min[k];
+    v = Vector(r[0], r[1], r[2]);
+  }
+
+  //Encode octahedral normal
+  SKMATH_INLINE void encode(const Vector& n, OctNormal& out)
+  {
+    float u, v;
+    detail::octahedral(n[0], n[1], n[2], u, v);
+    out.v[0] = detail::snorm16(u);
+    out.v[1] = detail::snorm16(v);
+  }
+
+  //Decode octahedral normal
+  SKMATH_INLINE void decode(const OctNormal& in, Vector& n)
+  {
+    float x = float(in.v[0]) / detail::cSnorm16;
+    float y = float(in.v[1]) / detail::cSnorm16;
+    const float z = 1.0f - std::fabs(x) - std::fabs(y);
+
+    //Unfold the lower half
+    const float t = std::max(-z, 0.0f);
+    x += x < 0.0f ? t : -t;
+    y += y < 0.0f ? t : -t;
+
+    const float inv = 1.0f / std::sqrt(x * x + y * y + z * z);
+    n = Vector(x * inv, y * inv, z * inv);
+  }
+
+  //Encode batch quaternion 32
+  SKMATH_INLINE void encodeBatch(const Quaternion* in, PackedQuaternion32* out, std::size_t size)
+  {
+    using simd::cWidth;
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      alignas(simd::cAlignment) float index[cWidth], a[cWidth], b[cWidth], c[cWidth];
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        detail::smallestThree(&in[i].w(), detail::cQuaternion32Half, index, a, b, c);
+        for(std::size_t k = 0; k < cWidth; k++)
+          out[i + k].bits = std::uint32_t(index[k]) << 30 | std::uint32_t(a[k]) << 20 | std::uint32_t(b[k]) << 10 | std::uint32_t(c[k]);
+      }
+
+      for(; i < end; i++)
+        encode(in[i], out[i]);
+    });
+  }
+
+  //Decode batch quaternion 32
+  SKMATH_INLINE void decodeBatch(const PackedQuaternion32* in, Quaternion* out, std::size_t size)
+  {
+    using simd::cWidth;
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      alignas(simd::cAlignment) float index[cWidth], a[cWidth], b[cWidth], c[cWidth];
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        for(std::size_t k = 0; k < cWidth; k++)
+        {
+          const std::uint32_t bits = in[i + k].bits;
+          index[k] = float(bits >> 30);
+          a[k] = float((bits >> 20) & 1023u);
+          b[k] = float((bits >> 10) & 1023u);
+          c[k] = float(bits & 1023u);
+        }
+        detail::fromSmallestThree(index, a, b, c, detail::cQuaternion32Half, &out[i].w());
+      }
+
+      for(; i < end; i++)
+        decode(in[i], out[i]);
+    });
+  }
+
+  //Encode batch quaternion 48
+  SKMATH_INLINE void encodeBatch(const Quaternion* in, PackedQuaternion48* out, std::size_t size)
+  {
+    using simd::cWidth;
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      alignas(simd::cAlignment) float index[cWidth], a[cWidth], b[cWidth], c[cWidth];
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        detail::smallestThree(&in[i].w(), detail::cQuaternion48Half, index, a, b, c);
+        for(std::size_t k = 0; k < cWidth; k++)
+        {
+          const std::uint32_t n = std::uint32_t(index[k]);
+          out[i + k].bits[0] = std::uint16_t(std::uint32_t(a[k]) | (n & 1u) << 15);
+          out[i + k].bits[1] = std::uint16_t(std::uint32_t(b[k]) | (n >> 1) << 15);
+          out[i + k].bits[2] = std::uint16_t(c[k]);
+        }
+      }
+
+      for(; i < end; i++)
+        encode(in[i], out[i]);
+    });
+  }
+
+  //Decode batch quaternion 48
+  SKMATH_INLINE void decodeBatch(const PackedQuaternion48* in, Quaternion* out, std::size_t size)
+  {
+    using simd::cWidth;
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      alignas(simd::cAlignment) float index[cWidth], a[cWidth], b[cWidth], c[cWidth];
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        for(std::size_t k = 0; k < cWidth; k++)
+        {
+          const std::uint16_t* bits = in[i + k].bits;
+          index[k] = float((bits[0] >> 15) | (bits[1] >> 15) << 1);
+          a[k] = float(bits[0] & 0x7fffu);
+          b[k] = float(bits[1] & 0x7fffu);
+          c[k] = float(bits[2] & 0x7fffu);
+        }
+        detail::fromSmallestThree(index, a, b, c, detail::cQuaternion48Half, &out[i].w());
+      }
+
+      for(; i < end; i++)
+        decode(in[i], out[i]);
+    });
+  }
+
+  //Encode batch half vector
+  SKMATH_INLINE void encodeBatch(const Vector* in, HalfVector* out, std::size_t size)
+  {
+    if(size == 0)
+      return;
+
+    //Vectors and half vectors are packed, so both are flat arrays of 3 * size components
+    const float* src = &in[0][0];
+    std::uint16_t* dst = out[0].v;
+
+    parallelFor(3 * size, cParallelGrain / 2, [&](std::size_t begin, std::size_t end) {
+      std::size_t i = begin;
+#if defined(SKMATH_F16C)
+      for(; i + 8 <= end; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+      for(; i < end; i++)
+        dst[i] = floatToHalf(src[i]);
+    });
+  }
+
+  //Decode batch half vector
+  SKMATH_INLINE void decodeBatch(const HalfVector* in, Vector* out, std::size_t size)
+  {
+    if(size == 0)
+      return;
+
+    const std::uint16_t* src = in[0].v;
+    float* dst = &out[0][0];
+
+    parallelFor(3 * size, cParallelGrain / 2, [&](std::size_t begin, std::size_t end) {
+      std::size_t i = begin;
+#if defined(SKMATH_F16C)
+      for(; i + 8 <= end; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+#endif
+      for(; i < end; i++)
+        dst[i] = halfToFloat(src[i]);
+    });
+  }
+
+  namespace detail{
+
+    //Scale and offset of fixed point, per component of the flat arrays of cWidth vectors: lane l
+    //of register r holds axis (r cWidth + l) mod 3
+    SKMATH_INLINE void fixedLanes(const float (&scale)[3], const float (&offset)[3], simd::Float (&s)[3], simd::Float (&o)[3])
+    {
+      alignas(simd::cAlignment) float ls[3 * simd::cWidth], lo[3 * simd::cWidth];
+      for(std::size_t k = 0; k < 3 * simd::cWidth; k++)
+      {
+        ls[k] = scale[k % 3];
+        lo[k] = offset[k % 3];
+      }
+
+      for(std::size_t r = 0; r < 3; r++)
+      {
+        s[r] = simd::load(ls + r * simd::cWidth);
+        o[r] = simd::load(lo + r * simd::cWidth);
+      }
+    }
+
+  };
+
+  //Encode batch fixed vector
+  SKMATH_INLINE void encodeBatch(const Vector* in, const Vector& min, const Vector& max, FixedVector* out, std::size_t size)
+  {
+    using simd::cWidth;
+
+    float scale[3], offset[3];
+    for(int k = 0; k < 3; k++)
+    {
+      scale[k] = detail::cFixedMax / (max[k] - min[k]);
+      offset[k] = min[k];
+    }
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      simd::Float s[3], o[3];
+      detail::fixedLanes(scale, offset, s, o);
+      alignas(simd::cAlignment) float q[3 * cWidth];
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        const float* src = &in[i][0];
+        for(std::size_t r = 0; r < 3; r++)
+        {
+          simd::Float v = simd::mul(simd::sub(simd::loadu(src + r * cWidth), o[r]), s[r]);
+          simd::store(q + r * cWidth, simd::round(simd::min(simd::max(v, simd::zero()), simd::set1(detail::cFixedMax))));
+        }
+
+        std::uint16_t* dst = out[i].v;
+        for(std::size_t k = 0; k < 3 * cWidth; k++)
+          dst[k] = std::uint16_t(q[k]);
+      }
+
+      for(; i < end; i++)
+        encode(in[i], min, max, out[i]);
+    });
+  }
+
+  //Decode batch fixed vector
+  SKMATH_INLINE void decodeBatch(const FixedVector* in, const Vector& min, const Vector& max, Vector* out, std::size_t size)
+  {
+    using simd::cWidth;
+
+    float scale[3], offset[3];
+    for(int k = 0; k < 3; k++)
+    {
+      scale[k] = (max[k] - min[k]) / detail::cFixedMax;
+      offset[k] = min[k];
+    }
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      simd::Float s[3], o[3];
+      detail::fixedLanes(scale, offset, s, o);
+      alignas(simd::cAlignment) float q[3 * cWidth];
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        const std::uint16_t* src = in[i].v;
+        for(std::size_t k = 0; k < 3 * cWidth; k++)
+          q[k] = float(src[k]);
+
+        float* dst = &out[i][0];
+        for(std::size_t r = 0; r < 3; r++)
+          simd::storeu(dst + r * cWidth, simd::madd(simd::load(q + r * cWidth), s[r], o[r]));
+      }
+
+      for(; i < end; i++)
+        decode(in[i], min, max, out[i]);
+    });
+  }
+
+  //Encode batch octahedral normal
+  SKMATH_INLINE void encodeBatch(const Vector* in, OctNormal* out, std::size_t size)
+  {
+    using simd::cWidth;
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      using namespace simd;
+
+      alignas(cAlignment) float u[cWidth], v[cWidth];
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        Float x, y, z;
+        loadVectors(&in[i][0], x, y, z);
+
+        Float l = max(add(add(abs(x), abs(y)), abs(z)), set1(std::numeric_limits<float>::min()));
+        Float fu = div(x, l), fv = div(y, l);
+
+        //Fold the lower half over the diagonals, the sign of 0 taken as +
+        Float su = select(cmplt(fu, zero()), set1(-1.0f), set1(1.0f));
+        Float sv = select(cmplt(fv, zero()), set1(-1.0f), set1(1.0f));
+        Float lower = cmplt(z, zero());
+        Float gu = select(lower, mul(sub(set1(1.0f), abs(fv)), su), fu);
+        Float gv = select(lower, mul(sub(set1(1.0f), abs(fu)), sv), fv);
+
+        Float one = set1(1.0f), scale = set1(detail::cSnorm16);
+        store(u, round(mul(min(max(gu, neg(one)), one), scale)));
+        store(v, round(mul(min(max(gv, neg(one)), one), scale)));
+
+        for(std::size_t k = 0; k < cWidth; k++)
+        {
+          out[i + k].v[0] = std::int16_t(u[k]);
+          out[i + k].v[1] = std::int16_t(v[k]);
+        }
+      }
+
+      for(; i < end; i++)
+        encode(in[i], out[i]);
+    });
+  }
+
+  //Decode batch octahedral normal
+  SKMATH_INLINE void decodeBatch(const OctNormal* in, Vector* out, std::size_t size)
+  {
+    using simd::cWidth;
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      using namespace simd;
+
+      alignas(cAlignment) float u[cWidth], v[cWidth];
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        for(std::size_t k = 0; k < cWidth; k++)
+        {
+          u[k] = float(in[i + k].v[0]);
+          v[k] = float(in[i + k].v[1]);
+        }
+
+        Float x = div(load(u), set1(detail::cSnorm16));
+        Float y = div(load(v), set1(detail::cSnorm16));
+        Float z = sub(sub(set1(1.0f), abs(x)), abs(y));
+
+        Float t = max(neg(z), zero());
+        x = select(cmplt(x, zero()), add(x, t), sub(x, t));
+        y = select(cmplt(y, zero()), add(y, t), sub(y, t));
+
+        Float inv = div(set1(1.0f), sqrt(madd(x, x, madd(y, y, mul(z, z)))));
+        storeVectors(&out[i][0], mul(x, inv), mul(y, inv), mul(z, inv));
+      }
+
+      for(; i < end; i++)
+        decode(in[i], out[i]);
+    });
+  }
+
+};
@@ -1,185 +1,422 @@
-/**
-* @file quaternion.hpp
-* @author skwo
-* @brief Defenition of quaternion class.
-*/
-
-#ifndef QUATERNION_HPP_INCLUDED
-#define QUATERNION_HPP_INCLUDED
-
-#include "vector.hpp"
-
-namespace skmath{
-
-  class Matrix;
-
-  class Quaternion{
-    public:
-      friend void quaternionToMatrix(Quaternion& q, Matrix& m);
-
-      /** Constructor. Create identity quaternion.
-      * @note The identity quaternion which created is a
-      * Multiplication quaternion (1, [0,0,0]) and <b>NOT</b> Addition quaternion (0, [0,0,0]).
-      */
-      Quaternion();
-
-      /** Copy constructor.
-      * @param q Quaternion to copy.
-      */
-      Quaternion(const Quaternion& q);
-
-      /** Constructor. Create quaternion.
-      * @param w Scalar component of quaternion.
-      * @param vec Vector component of quaternion.
-      */
-      Quaternion(float w, const Vector& vec);
-
-      /** Destructor. */
-      ~Quaternion();
-
-
-      /** Get Vector.
-      * @return Const vector component of quaternion.
-      */
-      const Vector& v() const;
-
-      /** Get Vector.
-      * @return Vector component of quaternion.
-      */
-      Vector& v();
-
-      /** Get Scalar.
-      * @return Const scalar component of quaternion.
-      */
-      const float& w() const;
-
-      /** Get Scalar.
-      * @return Const scalar component of quaternion.
-      */
-      float& w();
-
-      /** Norma. (xx + yy + zz + ww)
-      * @return Sum of components in square.
-      */
-      float norm() const;
-
-      /** Magnitude.
-      * @return Length/magnitude of quaternion.
-      */
-      float magnitude() const;
-
-      /** Normalize.
-      * @return Normalized quaternion.
-      */
-      Quaternion normalize() const;
-
-      /** Conjugate.
-      * @return Conjugated quaternion.
-      */
-      Quaternion conjugate() const;
-
-      /** Inverese.
-      * @return Inversed quaternion.
-      */
-      Quaternion inverse() const;
-
-      /** Inner product of 2 quaternions.
-      * @param rhs Right value quaternion.
-      * @return Scalar number, inner product of <c>this</c> and <c>rhs</c>.
-      */
-      float inner(const Quaternion& rhs) const;
-
-      /** Create rotation.
-      * Create from current quaternion a rotation quaternion around the axis <c>vec</c> with
-      * angle <c>angle</c>.
-      * @param vec Axis of rotation.
-      * @param angle Angle of rotation (degrees).
-      */
-      void createRotation(const Vector& vec, float angle);
-
-
-      /** Const access operator.
-      * @param place Place of component.
-      * @return Const reference to component in <c>place</c>.
-      * @note Place msut be 1, 2, 3 - for vector components, or 4 for scalat <c>w</c>!.
-      */
-      const float& operator [](const int place) const;
-
-      /** Access operator.
-      * @param place Place of component.
-      * @return Reference to component in <c>place</c>.
-      * @note Place msut be 1, 2, 3 - for vector components, or 4 for scalat <c>w</c>!.
-      */
-      float& operator [](const int place);
-
-      /** Equal to operator.
-      * @param rhs Right value quaternion.
-      * @return true if <c>this</c> and <c>rhs</c> are equal, otherwise false.
-      */
-      bool operator ==(const Quaternion& rhs) const;
-
-      /** Not equal to operator.
-      * @param rhs Right value quaternion.
-      * @return true if <c>this</c> and <c>rhs</c> are not equal, otherwise false.
-      */
-      bool operator !=(const Quaternion& rhs) const;
-
-      /** Assign operator.
-      * @param rhs Right value quaternion.
-      * @return reference to <c>this</c>.
-      */
-      Quaternion& operator =(const Quaternion& rhs);
-
-      /** Addition operator.
-      * @param rhs Right value quaternion.
-      * @return New quaternion, the sum of <c>this</c> and <c>rhs</c>.
-      */
-      Quaternion operator +(const Quaternion& rhs) const;
-
-      /** Substraction operator.
-      * @param rhs Right value quaternion.
-      * @return New quaternion, the substract of <c>this</c> and <c>rhs</c>.
-      */
-      Quaternion operator -(const Quaternion& rhs) const;
-
-      /** Multiplication operator.
-      * @param rhs Right value.
-      * @return New quaternion, the multiplication of <c>this</c> and <c>rhs</c>.
-      */
-      Quaternion operator *(const Quaternion& rhs) const;
-
-      /** Multiplication operator.
-      * @param rhs Right value.
-      * @return New quaternion, the multiplication of <c>this</c> and <c>rhs</c>.
-      */
-      Quaternion operator *(const float& rhs) const;
-
-      /** Division operator.
-      * @param rhs Right value.
-      * @return New quaternion, the division of <c>this</c> and <c>rhs</c>.
-      */
-      Quaternion operator /(const float& rhs) const;
-
-    private:
-      float _w; /**< Scalar component of quaternion. */
-      Vector _v; /**< Vector component of quaternion. */
-  };
-
-
-  /** Quaternion to Matrix. Convert quaternion to matrix.
-  * @param q Quaternion to convert.
-  * @param m Matrix to store converted quaternion in.
-  */
-  void quaternionToMatrix(Quaternion& q, Matrix& m);
-
-  /** Rotate.
-  * Rotate <c>point</c> around <c>rotQuat</c>.
-  * @param rotQuat Rotation Quaternion.
-  * @param point Point to rotate.
-  * @return New point, the result of rotation.
-  */
-  Vector rotate(const Quaternion& rotQuat, const Vector& point);
-
-};
-
-#endif // QUATERNION_HPP_INCLUDED
+/**
+* @file quaternion.hpp
+* @author skwo
+* @brief Defenition of quaternion class.
+*
+* BasicQuaternion<T> is a quaternion of type <c>T</c>, stored w, x, y, z. Products of float and
+* double quaternions use SSE/AVX. Quaternion is the float quaternion.
+*/
+
+#ifndef QUATERNION_HPP_INCLUDED
+#define QUATERNION_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+
+#include "config.hpp"
+#include "euler.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+
+namespace skmath{
+
+  template<typename T, int R, int C>
+  class BasicMatrix;
+
+  template<typename T>
+  class alignas(detail::Alignment<T, 4>::value) BasicQuaternion{
+    static_assert(std::is_floating_point<T>::value, "BasicQuaternion needs a floating point type");
+
+    public:
+      typedef T Scalar;
+
+      /** Constructor. Create identity quaternion.
+      * @note The identity quaternion which created is a
+      * Multiplication quaternion (1, [0,0,0]) and <b>NOT</b> Addition quaternion (0, [0,0,0]).
+      */
+      SKMATH_CONSTEXPR BasicQuaternion();
+
+      /** Copy constructor.
+      * @param q Quaternion to copy.
+      */
+      BasicQuaternion(const BasicQuaternion& q) = default;
+
+      /** Constructor. Create quaternion.
+      * @param w Scalar component of quaternion.
+      * @param vec Vector component of quaternion.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion(T w, const BasicVector<T, 3>& vec);
+
+      /** Destructor. */
+      ~BasicQuaternion() = default;
+
+
+      /** Get Vector.
+      * @return Const vector component of quaternion.
+      */
+      SKMATH_CONSTEXPR const BasicVector<T, 3>& v() const;
+
+      /** Get Vector.
+      * @return Vector component of quaternion.
+      */
+      SKMATH_CONSTEXPR BasicVector<T, 3>& v();
+
+      /** Get Scalar.
+      * @return Const scalar component of quaternion.
+      */
+      SKMATH_CONSTEXPR const T& w() const;
+
+      /** Get Scalar.
+      * @return Const scalar component of quaternion.
+      */
+      SKMATH_CONSTEXPR T& w();
+
+      /** Norma. (xx + yy + zz + ww)
+      * @return Sum of components in square.
+      */
+      SKMATH_CONSTEXPR T norm() const;
+
+      /** Magnitude.
+      * @return Length/magnitude of quaternion.
+      */
+      T magnitude() const;
+
+      /** Magnitude, as magnitude().
+      * @return Length/magnitude of quaternion.
+      */
+      T magnitude(Exact) const;
+
+      /** Magnitude, as magnitude(). The hardware square root is faster than rsqrt(Fast) and a
+      * multiply.
+      * @return Length/magnitude of quaternion.
+      */
+      T magnitude(Fast) const;
+
+      /** Normalize.
+      * @return Normalized quaternion.
+      */
+      BasicQuaternion normalize() const;
+
+      /** Normalize, as normalize().
+      * @return Normalized quaternion.
+      */
+      BasicQuaternion normalize(Exact) const;
+
+      /** Normalize, multiplying by rsqrt(Fast) of the norm instead of dividing by the magnitude.
+      * @return Normalized quaternion, components within <c>cFastNormalizeUlp</c> ulp.
+      */
+      BasicQuaternion normalize(Fast) const;
+
+      /** Conjugate.
+      * @return Conjugated quaternion.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion conjugate() const;
+
+      /** Inverese.
+      * @return Inversed quaternion.
+      */
+      BasicQuaternion inverse() const;
+
+      /** Inner product of 2 quaternions.
+      * @param rhs Right value quaternion.
+      * @return Scalar number, inner product of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR T inner(const BasicQuaternion& rhs) const;
+
+      /** Create rotation.
+      * Create from current quaternion a rotation quaternion around the axis <c>vec</c> with
+      * angle <c>angle</c>.
+      * @param vec Axis of rotation.
+      * @param angle Angle of rotation (degrees).
+      */
+      void createRotation(const BasicVector<T, 3>& vec, T angle);
+
+      /** Create rotation, as createRotation(vec, angle).
+      * @param vec Axis of rotation.
+      * @param angle Angle of rotation (degrees).
+      */
+      void createRotation(const BasicVector<T, 3>& vec, T angle, Exact);
+
+      /** Create rotation, with sincos(Fast) of the half angle.
+      * @param vec Axis of rotation.
+      * @param angle Angle of rotation (degrees).
+      */
+      void createRotation(const BasicVector<T, 3>& vec, T angle, Fast);
+
+      /** Create rotation from Euler angles, the product of the rotations about the axes in
+      * <c>order</c>: cEulerXYZ gives qz * qy * qx, with qx the rotation around x axis by <c>x</c>.
+      * @param x Angle of rotation around x axis.
+      * @param y Angle of rotation around y axis.
+      * @param z Angle of rotation around z axis.
+      * @param order Order the rotations are applied in.
+      * @param unit Unit of the angles.
+      */
+      void createFromEuler(T x, T y, T z, EulerOrder order = cEulerXYZ, AngleUnit unit = cDegrees);
+
+
+      /** Const access operator.
+      * @param place Place of component.
+      * @return Const reference to component in <c>place</c>.
+      * @note Place msut be 1, 2, 3 - for vector components, or 4 for scalat <c>w</c>!.
+      */
+      SKMATH_CONSTEXPR const T& operator [](const int place) const;
+
+      /** Access operator.
+      * @param place Place of component.
+      * @return Reference to component in <c>place</c>.
+      * @note Place msut be 1, 2, 3 - for vector components, or 4 for scalat <c>w</c>!.
+      */
+      SKMATH_CONSTEXPR T& operator [](const int place);
+
+      /** Equal to operator.
+      * @param rhs Right value quaternion.
+      * @return true if <c>this</c> and <c>rhs</c> are equal, otherwise false.
+      */
+      bool operator ==(const BasicQuaternion& rhs) const;
+
+      /** Not equal to operator.
+      * @param rhs Right value quaternion.
+      * @return true if <c>this</c> and <c>rhs</c> are not equal, otherwise false.
+      */
+      bool operator !=(const BasicQuaternion& rhs) const;
+
+      /** Assign operator.
+      * @param rhs Right value quaternion.
+      * @return reference to <c>this</c>.
+      */
+      BasicQuaternion& operator =(const BasicQuaternion& rhs) = default;
+
+      /** Addition operator.
+      * @param rhs Right value quaternion.
+      * @return New quaternion, the sum of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion operator +(const BasicQuaternion& rhs) const;
+
+      /** Substraction operator.
+      * @param rhs Right value quaternion.
+      * @return New quaternion, the substract of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion operator -(const BasicQuaternion& rhs) const;
+
+      /** Multiplication operator.
+      * @param rhs Right value.
+      * @return New quaternion, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion operator *(const BasicQuaternion& rhs) const;
+
+      /** Multiplication operator.
+      * @param rhs Right value.
+      * @return New quaternion, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion operator *(const T& rhs) const;
+
+      /** Division operator.
+      * @param rhs Right value.
+      * @return New quaternion, the division of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion operator /(const T& rhs) const;
+
+      /** Addition assign operator.
+      * @param rhs Right value quaternion.
+      * @return reference to <c>this</c>, the sum of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion& operator +=(const BasicQuaternion& rhs);
+
+      /** Substraction assign operator.
+      * @param rhs Right value quaternion.
+      * @return reference to <c>this</c>, the substract of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion& operator -=(const BasicQuaternion& rhs);
+
+      /** Multiplication assign operator.
+      * @param rhs Right value quaternion.
+      * @return reference to <c>this</c>, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion& operator *=(const BasicQuaternion& rhs);
+
+      /** Multiplication assign operator.
+      * @param rhs Right value scalar.
+      * @return reference to <c>this</c>, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion& operator *=(const T& rhs);
+
+      /** Division assign operator.
+      * @param rhs Right value scalar.
+      * @return reference to <c>this</c>, the division of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicQuaternion& operator /=(const T& rhs);
+
+    private:
+      T _w; /**< Scalar component of quaternion. */
+      BasicVector<T, 3> _v; /**< Vector component of quaternion. */
+  };
+
+
+  typedef BasicQuaternion<float> Quaternionf;
+  typedef BasicQuaternion<double> Quaterniond;
+  typedef Quaternionf Quaternion;
+
+  static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion must be packed, w, x, y, z");
+  static_assert(std::is_trivially_copyable<Quaternion>::value, "Quaternion must be trivially copyable");
+  static_assert(std::is_standard_layout<Quaternion>::value, "Quaternion must be standard layout");
+
+
+  /** Quaternion to Matrix. Convert quaternion to matrix.
+  * @param q Quaternion to convert.
+  * @param m Matrix to store converted quaternion in, 3x3 or 4x4.
+  */
+  template<typename T, int N>
+  void quaternionToMatrix(const BasicQuaternion<T>& q, BasicMatrix<T, N, N>& m);
+
+  /** Rotate.
+  * Rotate <c>point</c> around <c>rotQuat</c>.
+  * @param rotQuat Rotation Quaternion.
+  * @param point Point to rotate.
+  * @return New point, the result of rotation.
+  */
+  template<typename T>
+  BasicVector<T, 3> rotate(const BasicQuaternion<T>& rotQuat, const BasicVector<T, 3>& point);
+
+  /** Rotate, fast path.
+  * Rotate <c>point</c> around unit quaternion <c>rotQuat</c> with the reduced formula
+  * p' = p + w * t + v x t, where t = 2 * (v x p). About half the flops of rotate and
+  * no temporary quaternions; results agree with rotate to a few ulp.
+  * @param rotQuat Rotation Quaternion, must be normalized.
+  * @param point Point to rotate.
+  * @return New point, the result of rotation.
+  */
+  template<typename T>
+  BasicVector<T, 3> rotateFast(const BasicQuaternion<T>& rotQuat, const BasicVector<T, 3>& point);
+
+  /** Rotate batch.
+  * Rotate <c>size</c> points around the same unit quaternion, as rotateFast.
+  * Points are transposed into SIMD registers 8 (AVX) or 4 (SSE) at a time, and large
+  * inputs are split across threads.
+  * @param rotQuat Rotation Quaternion, must be normalized.
+  * @param in Array of <c>size</c> points.
+  * @param out Array of <c>size</c> vectors to store rotated points in, may be <c>in</c>.
+  * @param size Number of points.
+  */
+  void rotateBatch(const Quaternion& rotQuat, const Vector* in, Vector* out, std::size_t size);
+
+  /** Euler angles batch, <c>out[i]</c> as createFromEuler(x[i], y[i], z[i], order, unit), with
+  * sincosBatch (Fast) of the half angles, see fromEulerBatch of matrices.
+  * @param x Array of <c>size</c> angles of rotation around x axis.
+  * @param y Array of <c>size</c> angles of rotation around y axis.
+  * @param z Array of <c>size</c> angles of rotation around z axis.
+  * @param out Array of <c>size</c> quaternions to store the rotations in.
+  * @param size Number of rotations.
+  * @param order Order the rotations are applied in.
+  * @param unit Unit of the angles.
+  */
+  void fromEulerBatch(const float* x, const float* y, const float* z, Quaternion* out, std::size_t size,
+                      EulerOrder order = cEulerXYZ, AngleUnit unit = cDegrees);
+
+  /** Layout of packed 3x4 affine matrices, 12 floats each. */
+  enum MatrixLayout{
+    cRowMajor, /**< Rows (m00 m01 m02 tx) (m10 m11 m12 ty) (m20 m21 m22 tz). */
+    cColumnMajor /**< Columns (m00 m10 m20) (m01 m11 m21) (m02 m12 m22) (tx ty tz). */
+  };
+
+  /** Quaternion to matrix batch. Convert rotations, with optional translations and scales, to
+  * packed 3x4 affine matrices translation * rotation * scale, as Transform::toMatrix without the
+  * constant last row, so points turn as rotate(q, scale * p) + translation and the matrices
+  * match dualQuaternionToMatrixBatch of the same rigid transforms. The rotation part is
+  * quaternionToMatrix of the conjugate, since quaternionToMatrix turns the other way than rotate.
+  * Quaternions are transposed into SIMD registers 8 (AVX) or 4 (SSE) at a time, and large
+  * inputs are split across threads.
+  * @param in Array of <c>size</c> unit quaternions.
+  * @param out Array of 12 * <c>size</c> floats to store the matrices in.
+  * @param size Number of quaternions.
+  * @param layout Layout of the matrices in <c>out</c>.
+  * @param translation Array of <c>size</c> translations, or nullptr for none.
+  * @param scale Array of <c>size</c> scales along each axis, or nullptr for none.
+  * @param nonTemporal Write <c>out</c> with streaming stores that bypass the cache, when it is
+  * 16-byte aligned. Use it when <c>out</c> is too large to stay in cache and is not read back
+  * right away, e.g. an upload buffer.
+  */
+  void quaternionToMatrixBatch(const Quaternion* in, float* out, std::size_t size, MatrixLayout layout = cRowMajor,
+                               const Vector* translation = nullptr, const Vector* scale = nullptr, bool nonTemporal = false);
+
+  namespace detail{
+
+    //Packed 3x4 matrices of cWidth quaternions w, x, y, z, rotating as rotate, with translations
+    //t and scales s, into records of 12 floats; shared by quaternionToMatrixBatch and
+    //dualQuaternionToMatrixBatch
+    void packedMatrices(simd::Float w, simd::Float x, simd::Float y, simd::Float z,
+                        const simd::Float* t, const simd::Float* s, MatrixLayout layout,
+                        float* out, bool nonTemporal);
+
+  };
+
+  /** Normalized linear interpolation.
+  * @param from Quaternion at <c>t</c> = 0.
+  * @param to Quaternion at <c>t</c> = 1.
+  * @param t Interpolation parameter, usually in [0,1].
+  * @param shortestPath Negate <c>to</c> when <c>from.inner(to)</c> is negative, so the
+  * interpolation goes the short way around.
+  * @return New normalized quaternion.
+  */
+  template<typename T>
+  BasicQuaternion<T> nlerp(const BasicQuaternion<T>& from, const BasicQuaternion<T>& to,
+                           typename BasicQuaternion<T>::Scalar t, bool shortestPath = true);
+
+  /** Spherical linear interpolation, exact (acos and sin).
+  * Falls back to nlerp when the quaternions are nearly parallel.
+  * @param from Unit quaternion at <c>t</c> = 0.
+  * @param to Unit quaternion at <c>t</c> = 1.
+  * @param t Interpolation parameter in [0,1].
+  * @param shortestPath Negate <c>to</c> when <c>from.inner(to)</c> is negative.
+  * @return New quaternion.
+  */
+  template<typename T>
+  BasicQuaternion<T> slerp(const BasicQuaternion<T>& from, const BasicQuaternion<T>& to,
+                           typename BasicQuaternion<T>::Scalar t, bool shortestPath = true);
+
+  /** Normalized linear interpolation batch, shortest path, with a <c>t</c> per pair.
+  * @param from Array of <c>size</c> quaternions at <c>t</c> = 0.
+  * @param to Array of <c>size</c> quaternions at <c>t</c> = 1.
+  * @param t Array of <c>size</c> interpolation parameters.
+  * @param out Array of <c>size</c> quaternions to store the result in, may be <c>from</c> or <c>to</c>.
+  * @param size Number of pairs.
+  */
+  void nlerpBatch(const Quaternion* from, const Quaternion* to, const float* t, Quaternion* out, std::size_t size);
+
+  /** Normalized linear interpolation batch, shortest path, with one <c>t</c> for all pairs.
+  * @param from Array of <c>size</c> quaternions at <c>t</c> = 0.
+  * @param to Array of <c>size</c> quaternions at <c>t</c> = 1.
+  * @param t Interpolation parameter.
+  * @param out Array of <c>size</c> quaternions to store the result in, may be <c>from</c> or <c>to</c>.
+  * @param size Number of pairs.
+  */
+  void nlerpBatch(const Quaternion* from, const Quaternion* to, float t, Quaternion* out, std::size_t size);
+
+  /** Spherical linear interpolation batch, shortest path, with a <c>t</c> per pair.
+  * Uses Eberly's polynomial approximation of sin(t * a) / sin(a) in cos(a) instead of acos and
+  * sin, so it vectorizes. The approximation error of the weights is below 7.2e-7; for unit
+  * inputs and <c>t</c> in [0,1] the components are within 1.5e-6 of the exact slerp.
+  * @param from Array of <c>size</c> unit quaternions at <c>t</c> = 0.
+  * @param to Array of <c>size</c> unit quaternions at <c>t</c> = 1.
+  * @param t Array of <c>size</c> interpolation parameters in [0,1].
+  * @param out Array of <c>size</c> quaternions to store the result in, may be <c>from</c> or <c>to</c>.
+  * @param size Number of pairs.
+  */
+  void slerpBatch(const Quaternion* from, const Quaternion* to, const float* t, Quaternion* out, std::size_t size);
+
+  /** Spherical linear interpolation batch, shortest path, with one <c>t</c> for all pairs.
+  * Same approximation and error bound as the per pair version.
+  * @param from Array of <c>size</c> unit quaternions at <c>t</c> = 0.
+  * @param to Array of <c>size</c> unit quaternions at <c>t</c> = 1.
+  * @param t Interpolation parameter in [0,1].
+  * @param out Array of <c>size</c> quaternions to store the result in, may be <c>from</c> or <c>to</c>.
+  * @param size Number of pairs.
+  */
+  void slerpBatch(const Quaternion* from, const Quaternion* to, float t, Quaternion* out, std::size_t size);
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "quaternion.inl"
+#endif
+
+#endif // QUATERNION_HPP_INCLUDED
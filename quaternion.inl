@@ -0,0 +1,794 @@
+/**
+* @file quaternion.inl
+* @author skwo
+* @brief Realization of quaternion class.
+* @note Included by quaternion.cpp, or by quaternion.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "profile.hpp"
+#include "simd.hpp"
+
+namespace skmath{
+
+  namespace detail{
+
+    //Hamilton product a * b into r, r may be a or b. The overloads below use one SSE/AVX
+    //register for the whole quaternion, laid out w, x, y, z.
+    template<typename T>
+    SKMATH_CONSTEXPR SKMATH_INLINE void hamilton(const BasicQuaternion<T>& a, const BasicQuaternion<T>& b, BasicQuaternion<T>& r)
+    {
+      T w = a.w() * b.w() - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+      T x = a.w() * b[0] + a[0] * b.w() + a[1] * b[2] - a[2] * b[1];
+      T y = a.w() * b[1] + a[1] * b.w() + a[2] * b[0] - a[0] * b[2];
+      T z = a.w() * b[2] + a[2] * b.w() + a[0] * b[1] - a[1] * b[0];
+
+      r.w() = w;
+      r[0] = x;
+      r[1] = y;
+      r[2] = z;
+    }
+
+#if defined(SKMATH_SSE)
+    //r = aw * (bw, bx, by, bz) + ax * (-bx, bw, -bz, by) + ay * (-by, bz, bw, -bx) + az * (-bz, -by, bx, bw)
+    SKMATH_INLINE void hamilton(const Quaternionf& a, const Quaternionf& b, Quaternionf& r)
+    {
+      __m128 qa = _mm_load_ps(&a.w());
+      __m128 qb = _mm_load_ps(&b.w());
+
+      __m128 bx = _mm_xor_ps(_mm_shuffle_ps(qb, qb, _MM_SHUFFLE(2, 3, 0, 1)), _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f));
+      __m128 by = _mm_xor_ps(_mm_shuffle_ps(qb, qb, _MM_SHUFFLE(1, 0, 3, 2)), _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+      __m128 bz = _mm_xor_ps(_mm_shuffle_ps(qb, qb, _MM_SHUFFLE(0, 1, 2, 3)), _mm_setr_ps(-0.0f, -0.0f, 0.0f, 0.0f));
+
+      __m128 res = _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(0, 0, 0, 0)), qb);
+      res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(1, 1, 1, 1)), bx));
+      res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(2, 2, 2, 2)), by));
+      res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(3, 3, 3, 3)), bz));
+
+      _mm_store_ps(&r.w(), res);
+    }
+
+  #if defined(SKMATH_AVX)
+    SKMATH_INLINE void hamilton(const Quaterniond& a, const Quaterniond& b, Quaterniond& r)
+    {
+      __m256d qb = _mm256_load_pd(&b.w());
+
+      //Swap pairs, swap halves, both
+      __m256d bx = _mm256_permute_pd(qb, 0x5);
+      __m256d by = _mm256_permute2f128_pd(qb, qb, 0x01);
+      __m256d bz = _mm256_permute_pd(by, 0x5);
+      bx = _mm256_xor_pd(bx, _mm256_setr_pd(-0.0, 0.0, -0.0, 0.0));
+      by = _mm256_xor_pd(by, _mm256_setr_pd(-0.0, 0.0, 0.0, -0.0));
+      bz = _mm256_xor_pd(bz, _mm256_setr_pd(-0.0, -0.0, 0.0, 0.0));
+
+      __m256d res = _mm256_mul_pd(_mm256_broadcast_sd(&a.w()), qb);
+      res = _mm256_add_pd(res, _mm256_mul_pd(_mm256_broadcast_sd(&a[0]), bx));
+      res = _mm256_add_pd(res, _mm256_mul_pd(_mm256_broadcast_sd(&a[1]), by));
+      res = _mm256_add_pd(res, _mm256_mul_pd(_mm256_broadcast_sd(&a[2]), bz));
+
+      _mm256_store_pd(&r.w(), res);
+    }
+  #endif
+#endif
+
+  };
+
+  //Constructor
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T>::BasicQuaternion()
+    : _w(1), _v() //Multiplicaiton identity quaternion
+  {
+  }
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T>::BasicQuaternion(T w, const BasicVector<T, 3>& vec)
+    : _w(w), _v(vec)
+  {
+  }
+
+  //Get Vector
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE const BasicVector<T, 3>& BasicQuaternion<T>::v() const
+  {
+    return _v;
+  }
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, 3>& BasicQuaternion<T>::v()
+  {
+    return _v;
+  }
+
+  //Get Scalar
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE const T& BasicQuaternion<T>::w() const
+  {
+    return _w;
+  }
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE T& BasicQuaternion<T>::w()
+  {
+    return _w;
+  }
+
+  //Norm
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE T BasicQuaternion<T>::norm() const
+  {
+    return (_w * _w + _v[0] * _v[0] + _v[1] * _v[1] + _v[2] * _v[2]);
+  }
+
+  //Magnitude
+  template<typename T>
+  SKMATH_INLINE T BasicQuaternion<T>::magnitude() const
+  {
+    return std::sqrt(this->norm());
+  }
+  template<typename T>
+  SKMATH_INLINE T BasicQuaternion<T>::magnitude(Exact) const
+  {
+    return this->magnitude();
+  }
+  template<typename T>
+  SKMATH_INLINE T BasicQuaternion<T>::magnitude(Fast) const
+  {
+    return this->magnitude();
+  }
+
+  //Normalize
+  template<typename T>
+  SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::normalize() const
+  {
+    T length = this->magnitude();
+
+    BasicQuaternion res;
+
+    if(length != T(0))
+    {
+      res[3] = _w / length;
+      res[0] = _v[0] / length;
+      res[1] = _v[1] / length;
+      res[2] = _v[2] / length;
+    }
+
+    return res;
+  }
+  template<typename T>
+  SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::normalize(Exact) const
+  {
+    return this->normalize();
+  }
+  template<typename T>
+  SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::normalize(Fast) const
+  {
+    T n = this->norm();
+
+    //Zero and subnormal norms are out of range of the rsqrt estimate
+    if(n < std::numeric_limits<T>::min())
+      return this->normalize();
+
+    T s = rsqrt(n, Fast());
+    BasicQuaternion res;
+    res[3] = _w * s;
+    res[0] = _v[0] * s;
+    res[1] = _v[1] * s;
+    res[2] = _v[2] * s;
+
+    return res;
+  }
+
+  //Conjugate
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::conjugate() const
+  {
+    BasicQuaternion res(_w, _v.inverse());
+
+    return res;
+  }
+
+  //Inverse
+  template<typename T>
+  SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::inverse() const
+  {
+    return conjugate() / norm();
+  }
+
+  //Dot
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE T BasicQuaternion<T>::inner(const BasicQuaternion& rhs) const
+  {
+    return (_v[0] * rhs[0] + _v[1] * rhs[1] + _v[2] * rhs[2] + _w * rhs.w());
+  }
+
+  //Create Rotation
+  template<typename T>
+  SKMATH_INLINE void BasicQuaternion<T>::createRotation(const BasicVector<T, 3>& vec, T angle)
+  {
+    T a = detail::radians(angle);
+    T half_a = a / T(2);
+
+    _v = vec * std::sin(half_a);
+    _w = std::cos(half_a);
+  }
+  template<typename T>
+  SKMATH_INLINE void BasicQuaternion<T>::createRotation(const BasicVector<T, 3>& vec, T angle, Exact)
+  {
+    this->createRotation(vec, angle);
+  }
+  template<typename T>
+  SKMATH_INLINE void BasicQuaternion<T>::createRotation(const BasicVector<T, 3>& vec, T angle, Fast)
+  {
+    T s, c;
+    sincos(detail::radians(angle) / T(2), s, c, Fast());
+
+    _v = vec * s;
+    _w = c;
+  }
+
+  //Create from Euler angles
+  template<typename T>
+  SKMATH_INLINE void BasicQuaternion<T>::createFromEuler(T x, T y, T z, EulerOrder order, AngleUnit unit)
+  {
+    const T angles[3] = { x, y, z };
+    T s[3], c[3], q[4];
+    for(int a = 0; a < 3; a++)
+      sincos((unit == cDegrees ? detail::radians(angles[a]) : angles[a]) / T(2), s[a], c[a], Exact());
+
+    detail::eulerDispatch(order, [&](auto o) { detail::eulerQuaternion<decltype(o)::value>(s, c, q); });
+
+    _w = q[0];
+    _v[0] = q[1];
+    _v[1] = q[2];
+    _v[2] = q[3];
+  }
+
+  //Operator []
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE const T& BasicQuaternion<T>::operator [](const int place) const
+  {
+    if((place >= 0) && (place <= 2))
+      return _v[place];
+
+    return _w;
+  }
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE T& BasicQuaternion<T>::operator [](const int place)
+  {
+    if((place >= 0) && (place <= 2))
+      return _v[place];
+
+    return _w;
+  }
+
+  //Operator ==
+  template<typename T>
+  SKMATH_INLINE bool BasicQuaternion<T>::operator ==(const BasicQuaternion& rhs) const
+  {
+    if(&rhs == this)
+      return true;
+    else
+    {
+      if((_w == rhs.w()) && (_v == rhs.v()))
+        return true;
+      else
+        return false;
+    }
+
+    return false;
+  }
+
+  //Operator !=
+  template<typename T>
+  SKMATH_INLINE bool BasicQuaternion<T>::operator !=(const BasicQuaternion& rhs) const
+  {
+    return !(*this == rhs);
+  }
+
+  //Operator +
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::operator +(const BasicQuaternion& rhs) const
+  {
+    BasicVector<T, 3> resV = _v + rhs.v();
+    BasicQuaternion res(_w + rhs.w(), resV);
+
+    return res;
+  }
+
+  //Operator -
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::operator -(const BasicQuaternion& rhs) const
+  {
+    BasicVector<T, 3> resV = _v - rhs.v();
+    BasicQuaternion res(_w - rhs.w(), resV);
+
+    return res;
+  }
+
+  //Operator *
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::operator *(const BasicQuaternion& rhs) const
+  {
+    BasicQuaternion res;
+    detail::hamilton(*this, rhs, res);
+
+    return res;
+  }
+
+  //Operator *
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::operator *(const T& rhs) const
+  {
+    BasicVector<T, 3> resV = _v * rhs;
+    BasicQuaternion res(_w * rhs, resV);
+
+    return res;
+  }
+
+  //Operator /
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T> BasicQuaternion<T>::operator /(const T& rhs) const
+  {
+    BasicVector<T, 3> resV = _v / rhs;
+    BasicQuaternion res(_w / rhs, resV);
+
+    return res;
+  }
+
+  //Operator +=
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T>& BasicQuaternion<T>::operator +=(const BasicQuaternion& rhs)
+  {
+    _w += rhs.w();
+    _v += rhs.v();
+
+    return *this;
+  }
+
+  //Operator -=
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T>& BasicQuaternion<T>::operator -=(const BasicQuaternion& rhs)
+  {
+    _w -= rhs.w();
+    _v -= rhs.v();
+
+    return *this;
+  }
+
+  //Operator *=
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T>& BasicQuaternion<T>::operator *=(const BasicQuaternion& rhs)
+  {
+    *this = *this * rhs;
+
+    return *this;
+  }
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T>& BasicQuaternion<T>::operator *=(const T& rhs)
+  {
+    _w *= rhs;
+    _v *= rhs;
+
+    return *this;
+  }
+
+  //Operator /=
+  template<typename T>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicQuaternion<T>& BasicQuaternion<T>::operator /=(const T& rhs)
+  {
+    _w /= rhs;
+    _v /= rhs;
+
+    return *this;
+  }
+
+
+  //Quaternion to matrix
+  template<typename T, int N>
+  SKMATH_INLINE void quaternionToMatrix(const BasicQuaternion<T>& q, BasicMatrix<T, N, N>& m)
+  {
+    SKMATH_PROFILE_SAMPLE(cProfileQuaternionToMatrix);
+    static_assert(N == 3 || N == 4, "Rotation matrix must be 3x3 or 4x4");
+
+    T qx, qy, qz, qw;
+    qx = q[0];
+    qy = q[1];
+    qz = q[2];
+    qw = q[3];
+
+    m.createIdentity();
+
+    m(0, 0) = T(1) - T(2) * (qy * qy + qz * qz);
+    m(1, 0) =        T(2) * (qx * qy - qz * qw);
+    m(2, 0) =        T(2) * (qx * qz + qy * qw);
+
+    m(0, 1) =        T(2) * (qx * qy + qz * qw);
+    m(1, 1) = T(1) - T(2) * (qx * qx + qz * qz);
+    m(2, 1) =        T(2) * (qy * qz - qx * qw);
+
+    m(0, 2) =        T(2) * (qx * qz - qy * qw);
+    m(1, 2) =        T(2) * (qy * qz + qx * qw);
+    m(2, 2) = T(1) - T(2) * (qx * qx + qy * qy);
+  }
+
+  //Rotate
+  template<typename T>
+  SKMATH_INLINE BasicVector<T, 3> rotate(const BasicQuaternion<T>& rotQuat, const BasicVector<T, 3>& point)
+  {
+    SKMATH_PROFILE_SAMPLE(cProfileRotate);
+    BasicQuaternion<T> p(T(0), point); //convert point to quaternion.
+
+    BasicQuaternion<T> result = (rotQuat * p) * rotQuat.conjugate();
+
+    BasicVector<T, 3> res(result[0], result[1], result[2]);
+
+    return res;
+  }
+
+  //Rotate fast
+  template<typename T>
+  SKMATH_INLINE BasicVector<T, 3> rotateFast(const BasicQuaternion<T>& rotQuat, const BasicVector<T, 3>& point)
+  {
+    const BasicVector<T, 3>& v = rotQuat.v();
+    BasicVector<T, 3> t = (v * point) * T(2);
+
+    return point + t * rotQuat.w() + v * t;
+  }
+
+  namespace detail{
+
+    //Rotate range [begin, end) of in into out
+    SKMATH_INLINE void rotateRange(const Quaternion& rotQuat, const Vector* in, Vector* out,
+                                   std::size_t begin, std::size_t end)
+    {
+      const simd::Float qx = simd::set1(rotQuat[0]);
+      const simd::Float qy = simd::set1(rotQuat[1]);
+      const simd::Float qz = simd::set1(rotQuat[2]);
+      const simd::Float qw = simd::set1(rotQuat[3]);
+      const simd::Float two = simd::set1(2.0f);
+      std::size_t i = begin;
+
+      for(; i + simd::cWidth <= end; i += simd::cWidth)
+      {
+        simd::Float px, py, pz;
+        simd::loadVectors(&in[i][0], px, py, pz);
+
+        //t = 2 * (v x p)
+        simd::Float tx = simd::mul(two, simd::sub(simd::mul(qy, pz), simd::mul(qz, py)));
+        simd::Float ty = simd::mul(two, simd::sub(simd::mul(qz, px), simd::mul(qx, pz)));
+        simd::Float tz = simd::mul(two, simd::sub(simd::mul(qx, py), simd::mul(qy, px)));
+
+        //p + w * t + v x t
+        simd::Float rx = simd::add(simd::madd(qw, tx, px), simd::sub(simd::mul(qy, tz), simd::mul(qz, ty)));
+        simd::Float ry = simd::add(simd::madd(qw, ty, py), simd::sub(simd::mul(qz, tx), simd::mul(qx, tz)));
+        simd::Float rz = simd::add(simd::madd(qw, tz, pz), simd::sub(simd::mul(qx, ty), simd::mul(qy, tx)));
+
+        simd::storeVectors(&out[i][0], rx, ry, rz);
+      }
+
+      for(; i < end; i++)
+        out[i] = rotateFast(rotQuat, in[i]);
+    }
+
+  };
+
+  //Rotate batch
+  SKMATH_INLINE void rotateBatch(const Quaternion& rotQuat, const Vector* in, Vector* out, std::size_t size)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileRotateBatch);
+    parallelFor(size, cParallelGrain, [&](std::size_t begin, std::size_t end) {
+      detail::rotateRange(rotQuat, in, out, begin, end);
+    });
+  }
+
+  //Euler angles batch
+  SKMATH_INLINE void fromEulerBatch(const float* x, const float* y, const float* z, Quaternion* out, std::size_t size,
+                                    EulerOrder order, AngleUnit unit)
+  {
+    using detail::cEulerBlock;
+    const float scale = (unit == cDegrees ? detail::radians(1.0f) : 1.0f) * 0.5f;
+
+    detail::eulerDispatch(order, [&](auto o) {
+      parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+        float s[3][cEulerBlock], c[3][cEulerBlock];
+
+        for(std::size_t b = begin; b < end; b += cEulerBlock)
+        {
+          std::size_t n = end - b < cEulerBlock ? end - b : cEulerBlock;
+          detail::eulerSinCos(x + b, y + b, z + b, n, scale, s, c);
+
+          for(std::size_t i = 0; i < n; i++)
+          {
+            const float si[3] = { s[0][i], s[1][i], s[2][i] };
+            const float ci[3] = { c[0][i], c[1][i], c[2][i] };
+            float q[4];
+            detail::eulerQuaternion<decltype(o)::value>(si, ci, q);
+
+            //Laid out w, x, y, z
+            float* r = &out[b + i].w();
+            r[0] = q[0];
+            r[1] = q[1];
+            r[2] = q[2];
+            r[3] = q[3];
+          }
+        }
+      });
+    });
+  }
+
+  //Nlerp
+  template<typename T>
+  SKMATH_INLINE BasicQuaternion<T> nlerp(const BasicQuaternion<T>& from, const BasicQuaternion<T>& to,
+                                         typename BasicQuaternion<T>::Scalar t, bool shortestPath)
+  {
+    T b = t;
+    if(shortestPath && from.inner(to) < T(0))
+      b = -t;
+
+    return (from * (T(1) - t) + to * b).normalize();
+  }
+
+  //Slerp
+  template<typename T>
+  SKMATH_INLINE BasicQuaternion<T> slerp(const BasicQuaternion<T>& from, const BasicQuaternion<T>& to,
+                                         typename BasicQuaternion<T>::Scalar t, bool shortestPath)
+  {
+    T cosAngle = from.inner(to);
+    T sign = T(1);
+
+    if(shortestPath && cosAngle < T(0))
+    {
+      cosAngle = -cosAngle;
+      sign = T(-1);
+    }
+
+    //sin(angle) too small to divide by
+    if(cosAngle > T(0.9995))
+      return nlerp(from, to * sign, t, false);
+
+    T angle = std::acos(cosAngle);
+    T s = std::sin(angle);
+    T a = std::sin((T(1) - t) * angle) / s;
+    T b = std::sin(t * angle) / s * sign;
+
+    return from * a + to * b;
+  }
+
+  namespace detail{
+
+    //Eberly, "A Fast and Accurate Algorithm for Computing SLERP": sin(t * a) / sin(a) is a
+    //series in x = cos(a) with terms u = 1 / (i * (2i + 1)), v = i / (2i + 1). Truncated after
+    //12 terms, the last one scaled by mu fitted over a in [0, 90] degrees (the range left after
+    //the shortest path flip). The truncation error is below 7.2e-7.
+    const int cSlerpTerms = 12;
+    const float cSlerpMu = 1.894f;
+    const float cSlerpU[cSlerpTerms] = { 1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9),
+                                         1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), 1.0f / (8 * 17),
+                                         1.0f / (9 * 19), 1.0f / (10 * 21), 1.0f / (11 * 23), cSlerpMu / (12 * 25) };
+    const float cSlerpV[cSlerpTerms] = { 1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9,
+                                         5.0f / 11, 6.0f / 13, 7.0f / 15, 8.0f / 17,
+                                         9.0f / 19, 10.0f / 21, 11.0f / 23, cSlerpMu * 12 / 25 };
+
+    //Weight of the t end: sin(t * a) / sin(a), where xm1 = cos(a) - 1
+    SKMATH_INLINE simd::Float slerpWeight(simd::Float t, simd::Float xm1)
+    {
+      simd::Float one = simd::set1(1.0f);
+      simd::Float tt = simd::mul(t, t);
+      simd::Float c = one;
+
+      for(int i = cSlerpTerms - 1; i >= 0; i--)
+      {
+        simd::Float b = simd::mul(simd::sub(simd::mul(simd::set1(cSlerpU[i]), tt), simd::set1(cSlerpV[i])), xm1);
+        c = simd::madd(b, c, one);
+      }
+
+      return simd::mul(t, c);
+    }
+
+    //Interpolate pairs, t is read from t[i * tStride]
+    SKMATH_INLINE void interpolate(const Quaternion* from, const Quaternion* to, const float* t, std::size_t tStride,
+                                   Quaternion* out, std::size_t size, bool spherical)
+    {
+      const simd::Float zero = simd::zero();
+      const simd::Float one = simd::set1(1.0f);
+      std::size_t i = 0;
+
+      for(; i + simd::cWidth <= size; i += simd::cWidth)
+      {
+        simd::Float aw, ax, ay, az, bw, bx, by, bz;
+        simd::loadQuaternions(&from[i].w(), aw, ax, ay, az);
+        simd::loadQuaternions(&to[i].w(), bw, bx, by, bz);
+        simd::Float vt = tStride ? simd::loadu(t + i) : simd::set1(*t);
+
+        //Shortest path, negate to when the inner product is negative
+        simd::Float d = simd::madd(aw, bw, simd::madd(ax, bx, simd::madd(ay, by, simd::mul(az, bz))));
+        simd::Float flip = simd::cmplt(d, zero);
+        bw = simd::select(flip, simd::neg(bw), bw);
+        bx = simd::select(flip, simd::neg(bx), bx);
+        by = simd::select(flip, simd::neg(by), by);
+        bz = simd::select(flip, simd::neg(bz), bz);
+
+        simd::Float wa, wb;
+        if(spherical)
+        {
+          simd::Float xm1 = simd::sub(simd::abs(d), one);
+          wa = slerpWeight(simd::sub(one, vt), xm1);
+          wb = slerpWeight(vt, xm1);
+        }
+        else
+        {
+          wa = simd::sub(one, vt);
+          wb = vt;
+        }
+
+        simd::Float rw = simd::madd(aw, wa, simd::mul(bw, wb));
+        simd::Float rx = simd::madd(ax, wa, simd::mul(bx, wb));
+        simd::Float ry = simd::madd(ay, wa, simd::mul(by, wb));
+        simd::Float rz = simd::madd(az, wa, simd::mul(bz, wb));
+
+        if(!spherical)
+        {
+          //Zero length gives the identity, as Quaternion::normalize
+          simd::Float length = simd::sqrt(simd::madd(rw, rw, simd::madd(rx, rx, simd::madd(ry, ry, simd::mul(rz, rz)))));
+          simd::Float nonZero = simd::cmpneq(length, zero);
+          rw = simd::select(nonZero, simd::div(rw, length), one);
+          rx = simd::select(nonZero, simd::div(rx, length), zero);
+          ry = simd::select(nonZero, simd::div(ry, length), zero);
+          rz = simd::select(nonZero, simd::div(rz, length), zero);
+        }
+
+        simd::storeQuaternions(&out[i].w(), rw, rx, ry, rz);
+      }
+
+      for(; i < size; i++)
+      {
+        float ti = t[i * tStride];
+        if(!spherical)
+        {
+          out[i] = nlerp(from[i], to[i], ti);
+          continue;
+        }
+
+        float d = from[i].inner(to[i]);
+        float sign = d < 0.0f ? -1.0f : 1.0f;
+        float xm1 = d * sign - 1.0f;
+        float tt[2] = { 1.0f - ti, ti };
+        float w[2];
+
+        for(int k = 0; k < 2; k++)
+        {
+          float c = 1.0f;
+          for(int j = cSlerpTerms - 1; j >= 0; j--)
+            c = (cSlerpU[j] * tt[k] * tt[k] - cSlerpV[j]) * xm1 * c + 1.0f;
+          w[k] = tt[k] * c;
+        }
+
+        out[i] = from[i] * w[0] + to[i] * (w[1] * sign);
+      }
+    }
+
+  };
+
+  namespace detail{
+
+    //Packed matrices
+    SKMATH_INLINE void packedMatrices(simd::Float w, simd::Float x, simd::Float y, simd::Float z,
+                                      const simd::Float* t, const simd::Float* s, MatrixLayout layout,
+                                      float* out, bool nonTemporal)
+    {
+      using simd::Float;
+      using simd::add;
+      using simd::sub;
+      using simd::mul;
+      using simd::set1;
+      using simd::storeRecords;
+
+      //As quaternionToMatrix of the conjugate, which negates the w terms, so the rotation turns
+      //as rotate; 2 (a b) computed as a (2 b), which rounds the same
+      Float x2 = add(x, x), y2 = add(y, y), z2 = add(z, z);
+      Float xx = mul(x, x2), yy = mul(y, y2), zz = mul(z, z2);
+      Float xy = mul(x, y2), xz = mul(x, z2), yz = mul(y, z2);
+      Float wx = mul(w, x2), wy = mul(w, y2), wz = mul(w, z2);
+      Float one = set1(1.0f);
+
+      Float m00 = mul(sub(one, add(yy, zz)), s[0]), m10 = mul(add(xy, wz), s[0]), m20 = mul(sub(xz, wy), s[0]);
+      Float m01 = mul(sub(xy, wz), s[1]), m11 = mul(sub(one, add(xx, zz)), s[1]), m21 = mul(add(yz, wx), s[1]);
+      Float m02 = mul(add(xz, wy), s[2]), m12 = mul(sub(yz, wx), s[2]), m22 = mul(sub(one, add(xx, yy)), s[2]);
+
+      if(layout == cRowMajor)
+      {
+        storeRecords(out, 12, m00, m01, m02, t[0], nonTemporal);
+        storeRecords(out + 4, 12, m10, m11, m12, t[1], nonTemporal);
+        storeRecords(out + 8, 12, m20, m21, m22, t[2], nonTemporal);
+      }
+      else
+      {
+        storeRecords(out, 12, m00, m10, m20, m01, nonTemporal);
+        storeRecords(out + 4, 12, m11, m21, m02, m12, nonTemporal);
+        storeRecords(out + 8, 12, m22, t[0], t[1], t[2], nonTemporal);
+      }
+    }
+
+  };
+
+  //Quaternion to matrix batch
+  SKMATH_INLINE void quaternionToMatrixBatch(const Quaternion* in, float* out, std::size_t size, MatrixLayout layout,
+                                             const Vector* translation, const Vector* scale, bool nonTemporal)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileQuaternionToMatrixBatch);
+    using simd::cWidth;
+
+    //Records are 48 bytes, so one aligned record keeps all of them aligned
+    nonTemporal = nonTemporal && (reinterpret_cast<std::uintptr_t>(out) & 15) == 0;
+
+    parallelFor(size, cParallelGrain / 4, [&](std::size_t begin, std::size_t end) {
+      simd::Float t[3] = { simd::zero(), simd::zero(), simd::zero() };
+      simd::Float s[3] = { simd::set1(1.0f), simd::set1(1.0f), simd::set1(1.0f) };
+      simd::Float w, x, y, z;
+      std::size_t i = begin;
+
+      for(; i + cWidth <= end; i += cWidth)
+      {
+        simd::loadQuaternions(&in[i].w(), w, x, y, z);
+        if(translation)
+          simd::loadVectors(&translation[i][0], t[0], t[1], t[2]);
+        if(scale)
+          simd::loadVectors(&scale[i][0], s[0], s[1], s[2]);
+
+        detail::packedMatrices(w, x, y, z, t, s, layout, out + 12 * i, nonTemporal);
+      }
+
+      //Last partial group through a full one on the stack, padded with identities
+      if(i < end)
+      {
+        const std::size_t n = end - i;
+        alignas(16) float q[4 * cWidth], v[2][3 * cWidth], m[12 * cWidth];
+        for(std::size_t k = 0; k < cWidth; k++)
+        {
+          const bool valid = k < n;
+          q[4 * k] = valid ? in[i + k].w() : 1.0f;
+          for(int c = 0; c < 3; c++)
+          {
+            q[4 * k + 1 + c] = valid ? in[i + k][c] : 0.0f;
+            v[0][3 * k + c] = valid && translation ? translation[i + k][c] : 0.0f;
+            v[1][3 * k + c] = valid && scale ? scale[i + k][c] : 1.0f;
+          }
+        }
+
+        simd::loadQuaternions(q, w, x, y, z);
+        simd::loadVectors(v[0], t[0], t[1], t[2]);
+        simd::loadVectors(v[1], s[0], s[1], s[2]);
+        detail::packedMatrices(w, x, y, z, t, s, layout, m, false);
+
+        for(std::size_t k = 0; k < 12 * n; k++)
+          out[12 * i + k] = m[k];
+      }
+
+      if(nonTemporal)
+        simd::fence();
+    });
+  }
+
+  //Nlerp batch
+  SKMATH_INLINE void nlerpBatch(const Quaternion* from, const Quaternion* to, const float* t, Quaternion* out, std::size_t size)
+  {
+    detail::interpolate(from, to, t, 1, out, size, false);
+  }
+  SKMATH_INLINE void nlerpBatch(const Quaternion* from, const Quaternion* to, float t, Quaternion* out, std::size_t size)
+  {
+    detail::interpolate(from, to, &t, 0, out, size, false);
+  }
+
+  //Slerp batch
+  SKMATH_INLINE void slerpBatch(const Quaternion* from, const Quaternion* to, const float* t, Quaternion* out, std::size_t size)
+  {
+    detail::interpolate(from, to, t, 1, out, size, true);
+  }
+  SKMATH_INLINE void slerpBatch(const Quaternion* from, const Quaternion* to, float t, Quaternion* out, std::size_t size)
+  {
+    detail::interpolate(from, to, &t, 0, out, size, true);
+  }
+
+};
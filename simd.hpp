@@ -0,0 +1,380 @@
+/**
+* @file simd.hpp
+* @author skwo
+* @brief Thin wrapper over SSE/AVX intrinsics used by the batch kernels.
+*
+* The widest instruction set enabled by the compiler flags is picked (-mavx, -mavx2, -mfma or
+* -march=native), F16C and SSE4.2 included. Define <c>SKMATH_NO_SIMD</c> to force the scalar
+* fallback.
+*/
+
+#ifndef SIMD_HPP_INCLUDED
+#define SIMD_HPP_INCLUDED
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifndef SKMATH_NO_SIMD
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SKMATH_SSE 1
+  #endif
+  #if defined(__AVX__)
+    #define SKMATH_AVX 1
+  #endif
+  #if defined(__AVX2__)
+    #define SKMATH_AVX2 1
+  #endif
+  #if defined(__FMA__)
+    #define SKMATH_FMA 1
+  #endif
+  #if defined(__F16C__) && defined(__AVX__)
+    #define SKMATH_F16C 1
+  #endif
+  #if defined(__SSE4_2__)
+    #define SKMATH_SSE42 1
+  #endif
+#endif
+
+#if defined(SKMATH_SSE) || defined(SKMATH_AVX)
+  #include <immintrin.h>
+#endif
+
+#ifdef _WIN32
+  #include <malloc.h>
+#endif
+
+namespace skmath{
+
+  namespace simd{
+
+    /** Alignment (bytes) of every buffer handed to the batch kernels. One cache line. */
+    const std::size_t cAlignment = 64;
+
+    /** Allocate aligned memory.
+    * @param size Number of bytes to allocate.
+    * @param alignment Alignment in bytes, must be a power of two.
+    * @return Pointer to the allocated memory.
+    * @note Throws std::bad_alloc on failure. Release with alignedFree.
+    */
+    inline void* alignedAlloc(std::size_t size, std::size_t alignment = cAlignment)
+    {
+      void* p = 0;
+#ifdef _WIN32
+      p = _aligned_malloc(size ? size : 1, alignment);
+#else
+      if(posix_memalign(&p, alignment < sizeof(void*) ? sizeof(void*) : alignment, size ? size : 1) != 0)
+        p = 0;
+#endif
+      if(!p)
+        throw std::bad_alloc();
+
+      return p;
+    }
+
+    /** Free memory allocated with alignedAlloc.
+    * @param p Pointer to free, may be null.
+    */
+    inline void alignedFree(void* p)
+    {
+#ifdef _WIN32
+      _aligned_free(p);
+#else
+      free(p);
+#endif
+    }
+
+#if defined(SKMATH_AVX)
+
+    typedef __m256 Float; /**< A register of floats. */
+    const std::size_t cWidth = 8; /**< Number of floats in a register. */
+
+    inline Float load(const float* p) { return _mm256_load_ps(p); }
+    inline Float loadu(const float* p) { return _mm256_loadu_ps(p); }
+    inline void store(float* p, Float a) { _mm256_store_ps(p, a); }
+    inline void storeu(float* p, Float a) { _mm256_storeu_ps(p, a); }
+    inline void stream(float* p, Float a) { _mm256_stream_ps(p, a); }
+    inline Float set1(float a) { return _mm256_set1_ps(a); }
+    inline Float zero() { return _mm256_setzero_ps(); }
+    inline Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    inline Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    inline Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    inline Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+    inline Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+    inline Float rsqrt(Float a) { return _mm256_rsqrt_ps(a); } /**< Estimate, relative error below 1.5 * 2^-12. */
+    inline Float round(Float a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    inline Float min(Float a, Float b) { return _mm256_min_ps(a, b); }
+    inline Float max(Float a, Float b) { return _mm256_max_ps(a, b); }
+    inline Float neg(Float a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    inline Float abs(Float a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    inline Float cmpneq(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+    inline Float cmplt(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    inline Float select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+    inline int movemask(Float mask) { return _mm256_movemask_ps(mask); } /**< Bit k set if lane k of mask is. */
+  #if defined(SKMATH_FMA)
+    inline Float madd(Float a, Float b, Float c) { return _mm256_fmadd_ps(a, b, c); }
+    inline Float nmadd(Float a, Float b, Float c) { return _mm256_fnmadd_ps(a, b, c); }
+  #else
+    inline Float madd(Float a, Float b, Float c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+    inline Float nmadd(Float a, Float b, Float c) { return _mm256_sub_ps(c, _mm256_mul_ps(a, b)); }
+  #endif
+    inline void fence() { _mm_sfence(); }
+
+#elif defined(SKMATH_SSE)
+
+    typedef __m128 Float; /**< A register of floats. */
+    const std::size_t cWidth = 4; /**< Number of floats in a register. */
+
+    inline Float load(const float* p) { return _mm_load_ps(p); }
+    inline Float loadu(const float* p) { return _mm_loadu_ps(p); }
+    inline void store(float* p, Float a) { _mm_store_ps(p, a); }
+    inline void storeu(float* p, Float a) { _mm_storeu_ps(p, a); }
+    inline void stream(float* p, Float a) { _mm_stream_ps(p, a); }
+    inline Float set1(float a) { return _mm_set1_ps(a); }
+    inline Float zero() { return _mm_setzero_ps(); }
+    inline Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    inline Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+    inline Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+    inline Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+    inline Float sqrt(Float a) { return _mm_sqrt_ps(a); }
+    inline Float rsqrt(Float a) { return _mm_rsqrt_ps(a); } /**< Estimate, relative error below 1.5 * 2^-12. */
+    inline Float round(Float a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); } /**< |a| < 2^31 only. */
+    inline Float min(Float a, Float b) { return _mm_min_ps(a, b); }
+    inline Float max(Float a, Float b) { return _mm_max_ps(a, b); }
+    inline Float neg(Float a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    inline Float abs(Float a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    inline Float cmpneq(Float a, Float b) { return _mm_cmpneq_ps(a, b); }
+    inline Float cmplt(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+    inline Float select(Float mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    inline int movemask(Float mask) { return _mm_movemask_ps(mask); } /**< Bit k set if lane k of mask is. */
+    inline Float madd(Float a, Float b, Float c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    inline Float nmadd(Float a, Float b, Float c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+    inline void fence() { _mm_sfence(); }
+
+#else
+
+    typedef float Float; /**< A register of floats. */
+    const std::size_t cWidth = 1; /**< Number of floats in a register. */
+
+    inline Float load(const float* p) { return *p; }
+    inline Float loadu(const float* p) { return *p; }
+    inline void store(float* p, Float a) { *p = a; }
+    inline void storeu(float* p, Float a) { *p = a; }
+    inline void stream(float* p, Float a) { *p = a; }
+    inline Float set1(float a) { return a; }
+    inline Float zero() { return 0.0f; }
+    inline Float add(Float a, Float b) { return a + b; }
+    inline Float sub(Float a, Float b) { return a - b; }
+    inline Float mul(Float a, Float b) { return a * b; }
+    inline Float div(Float a, Float b) { return a / b; }
+    inline Float sqrt(Float a) { return static_cast<float>(std::sqrt(a)); }
+    inline Float rsqrt(Float a) { return 1.0f / static_cast<float>(std::sqrt(a)); }
+    inline Float round(Float a) { return std::nearbyint(a); }
+    inline Float min(Float a, Float b) { return a < b ? a : b; }
+    inline Float max(Float a, Float b) { return a > b ? a : b; }
+    inline Float neg(Float a) { return -a; }
+    inline Float abs(Float a) { return std::fabs(a); }
+    inline Float cmpneq(Float a, Float b) { return a != b ? 1.0f : 0.0f; }
+    inline Float cmplt(Float a, Float b) { return a < b ? 1.0f : 0.0f; }
+    inline Float select(Float mask, Float a, Float b) { return mask != 0.0f ? a : b; }
+    inline int movemask(Float mask) { return mask != 0.0f ? 1 : 0; } /**< Bit k set if lane k of mask is. */
+    inline Float madd(Float a, Float b, Float c) { return a * b + c; }
+    inline Float nmadd(Float a, Float b, Float c) { return c - a * b; }
+    inline void fence() { }
+
+#endif
+
+#if defined(SKMATH_SSE)
+
+    /** Transpose 4 packed vectors [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3] into x, y and z registers.
+    * @param p 12 floats, no alignment required.
+    */
+    inline void loadVectors4(const float* p, __m128& x, __m128& y, __m128& z)
+    {
+      __m128 a = _mm_loadu_ps(p);
+      __m128 b = _mm_loadu_ps(p + 4);
+      __m128 c = _mm_loadu_ps(p + 8);
+
+      __m128 t = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));        //x2 x2 x3 x3
+      x = _mm_shuffle_ps(a, t, _MM_SHUFFLE(2, 0, 3, 0));
+
+      t = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));               //y0 y0 y1 y1
+      __m128 u = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));        //y2 y2 y3 y3
+      y = _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0));
+
+      t = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));               //z0 z0 z1 z1
+      u = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));               //z2 z2 z3 z3
+      z = _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0));
+    }
+
+    /** Transpose x, y and z registers back into 4 packed vectors, the inverse of loadVectors4.
+    * @param p 12 floats, must be 16-byte aligned when <c>nonTemporal</c> is true.
+    * @param nonTemporal Use streaming stores that bypass the cache.
+    */
+    inline void storeVectors4(float* p, __m128 x, __m128 y, __m128 z, bool nonTemporal = false)
+    {
+      __m128 t = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));        //z0 z0 x1 x1
+      __m128 a = _mm_shuffle_ps(_mm_unpacklo_ps(x, y), t, _MM_SHUFFLE(2, 0, 1, 0));
+
+      t = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));               //y1 y1 z1 z1
+      __m128 u = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));        //x2 x2 y2 y2
+      __m128 b = _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0));
+
+      t = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));               //z2 z2 x3 x3
+      u = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));               //y3 y3 z3 z3
+      __m128 c = _mm_shuffle_ps(t, u, _MM_SHUFFLE(2, 0, 2, 0));
+
+      if(nonTemporal)
+      {
+        _mm_stream_ps(p, a);
+        _mm_stream_ps(p + 4, b);
+        _mm_stream_ps(p + 8, c);
+      }
+      else
+      {
+        _mm_storeu_ps(p, a);
+        _mm_storeu_ps(p + 4, b);
+        _mm_storeu_ps(p + 8, c);
+      }
+    }
+
+#endif
+
+    /** Load <c>cWidth</c> packed vectors (3 * <c>cWidth</c> floats) into x, y and z registers.
+    * @param p Packed vectors, no alignment required.
+    */
+    inline void loadVectors(const float* p, Float& x, Float& y, Float& z)
+    {
+#if defined(SKMATH_AVX)
+      __m128 xl, yl, zl, xh, yh, zh;
+      loadVectors4(p, xl, yl, zl);
+      loadVectors4(p + 12, xh, yh, zh);
+      x = _mm256_insertf128_ps(_mm256_castps128_ps256(xl), xh, 1);
+      y = _mm256_insertf128_ps(_mm256_castps128_ps256(yl), yh, 1);
+      z = _mm256_insertf128_ps(_mm256_castps128_ps256(zl), zh, 1);
+#elif defined(SKMATH_SSE)
+      loadVectors4(p, x, y, z);
+#else
+      x = p[0];
+      y = p[1];
+      z = p[2];
+#endif
+    }
+
+    /** Store x, y and z registers as <c>cWidth</c> packed vectors, the inverse of loadVectors.
+    * @param p Packed vectors, must be 16-byte aligned when <c>nonTemporal</c> is true.
+    * @param nonTemporal Use streaming stores that bypass the cache.
+    */
+    inline void storeVectors(float* p, Float x, Float y, Float z, bool nonTemporal = false)
+    {
+#if defined(SKMATH_AVX)
+      storeVectors4(p, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), nonTemporal);
+      storeVectors4(p + 12, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), nonTemporal);
+#elif defined(SKMATH_SSE)
+      storeVectors4(p, x, y, z, nonTemporal);
+#else
+      (void)nonTemporal;
+      p[0] = x;
+      p[1] = y;
+      p[2] = z;
+#endif
+    }
+
+    /** Load 4-float records, <c>stride</c> floats apart, of <c>cWidth</c> elements into 4
+    * registers, e.g. a column of <c>cWidth</c> matrices with stride 16.
+    * @param p First record, no alignment required.
+    * @param stride Floats from one record to the next.
+    */
+    inline void loadRecords(const float* p, std::size_t stride, Float& a, Float& b, Float& c, Float& d)
+    {
+#if defined(SKMATH_AVX)
+      __m128 r0 = _mm_loadu_ps(p), r1 = _mm_loadu_ps(p + stride), r2 = _mm_loadu_ps(p + 2 * stride), r3 = _mm_loadu_ps(p + 3 * stride);
+      __m128 h0 = _mm_loadu_ps(p + 4 * stride), h1 = _mm_loadu_ps(p + 5 * stride);
+      __m128 h2 = _mm_loadu_ps(p + 6 * stride), h3 = _mm_loadu_ps(p + 7 * stride);
+      _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+      _MM_TRANSPOSE4_PS(h0, h1, h2, h3);
+      a = _mm256_insertf128_ps(_mm256_castps128_ps256(r0), h0, 1);
+      b = _mm256_insertf128_ps(_mm256_castps128_ps256(r1), h1, 1);
+      c = _mm256_insertf128_ps(_mm256_castps128_ps256(r2), h2, 1);
+      d = _mm256_insertf128_ps(_mm256_castps128_ps256(r3), h3, 1);
+#elif defined(SKMATH_SSE)
+      a = _mm_loadu_ps(p);
+      b = _mm_loadu_ps(p + stride);
+      c = _mm_loadu_ps(p + 2 * stride);
+      d = _mm_loadu_ps(p + 3 * stride);
+      _MM_TRANSPOSE4_PS(a, b, c, d);
+#else
+      (void)stride;
+      a = p[0];
+      b = p[1];
+      c = p[2];
+      d = p[3];
+#endif
+    }
+
+    /** Load <c>cWidth</c> packed 4-float records, such as quaternions (w, x, y, z), into 4 registers.
+    * @param p Packed records, no alignment required.
+    */
+    inline void loadQuaternions(const float* p, Float& w, Float& x, Float& y, Float& z)
+    {
+      loadRecords(p, 4, w, x, y, z);
+    }
+
+    /** Store 4 registers as 4-float records, <c>stride</c> floats apart, of <c>cWidth</c>
+    * elements, the inverse of loadRecords.
+    * @param p First record, must be 16-byte aligned when <c>nonTemporal</c> is true.
+    * @param stride Floats from one record to the next, a multiple of 4 when <c>nonTemporal</c> is true.
+    * @param nonTemporal Use streaming stores that bypass the cache.
+    */
+    inline void storeRecords(float* p, std::size_t stride, Float a, Float b, Float c, Float d, bool nonTemporal = false)
+    {
+#if defined(SKMATH_SSE)
+  #if defined(SKMATH_AVX)
+      __m128 r[8] = { _mm256_castps256_ps128(a), _mm256_castps256_ps128(b), _mm256_castps256_ps128(c), _mm256_castps256_ps128(d),
+                      _mm256_extractf128_ps(a, 1), _mm256_extractf128_ps(b, 1), _mm256_extractf128_ps(c, 1), _mm256_extractf128_ps(d, 1) };
+      _MM_TRANSPOSE4_PS(r[4], r[5], r[6], r[7]);
+  #else
+      __m128 r[4] = { a, b, c, d };
+  #endif
+      _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+
+      if(nonTemporal)
+        for(std::size_t k = 0; k < cWidth; k++)
+          _mm_stream_ps(p + k * stride, r[k]);
+      else
+        for(std::size_t k = 0; k < cWidth; k++)
+          _mm_storeu_ps(p + k * stride, r[k]);
+#else
+      (void)stride;
+      (void)nonTemporal;
+      p[0] = a;
+      p[1] = b;
+      p[2] = c;
+      p[3] = d;
+#endif
+    }
+
+    /** Store 4 registers as <c>cWidth</c> packed 4-float records, the inverse of loadQuaternions.
+    * @param p Packed records, no alignment required.
+    */
+    inline void storeQuaternions(float* p, Float w, Float x, Float y, Float z)
+    {
+      storeRecords(p, 4, w, x, y, z);
+    }
+
+    /** Round <c>n</c> up to a multiple of <c>m</c>.
+    * @param n Number to round.
+    * @param m Multiple, must be a power of two.
+    * @return Rounded number.
+    */
+    inline std::size_t roundUp(std::size_t n, std::size_t m)
+    {
+      return (n + m - 1) & ~(m - 1);
+    }
+
+  };
+
+};
+
+#endif // SIMD_HPP_INCLUDED
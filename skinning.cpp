@@ -0,0 +1,11 @@
+/**
+* @file skinning.cpp
+* @author skwo
+* @brief Realization of linear blend skinning.
+*/
+
+#include "skinning.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "skinning.inl"
+#endif
@@ -0,0 +1,72 @@
+/**
+* @file skinning.hpp
+* @author skwo
+* @brief Defenition of linear blend skinning.
+*
+* Linear blend skinning deforms the vertices of a mesh by a palette of bone matrices: every
+* vertex is moved by the sum of its bones' matrices, weighted. The matrices of a vertex are
+* blended once, so every position and normal costs one 3x4 transform, translation included,
+* however many bones move it. Vertices are read and written as VectorBatch streams, 8 (AVX) or
+* 4 (SSE) at a time, and large meshes are split across threads.
+*
+* Bone influences are packed per vertex: the <c>influences</c> bone indices of vertex i from
+* <c>influences</c> * i, and their weights laid out the same. skinBatch of dualquaternion.hpp
+* is the dual quaternion version, which keeps the volume of twisting joints.
+*/
+
+#ifndef SKINNING_HPP_INCLUDED
+#define SKINNING_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#include "config.hpp"
+#include "matrix.hpp"
+#include "vectorbatch.hpp"
+
+namespace skmath{
+
+  /** Most bones influencing a vertex in linear blend skinning. */
+  const int cMaxBlendInfluences = 8;
+
+  /** Linear blend skinning batch, positions only. <c>outPositions[i]</c> is the sum over the
+  * influences of vertex i of <c>weights[k]</c> * transformPoints(<c>palette[indices[k]]</c>, p).
+  * @param palette Bone matrices, rigid or affine, bone space to model space.
+  * @param indices Array of <c>influences</c> * <c>positions.size()</c> bone indices.
+  * @param weights Array of <c>influences</c> * <c>positions.size()</c> weights. Unused
+  * influences have weight 0 and any valid index.
+  * @param influences Influences per vertex, 1 to <c>cMaxBlendInfluences</c>; usually 4 or 8.
+  * @param positions Positions in bind pose.
+  * @param outPositions Batch to store the skinned positions in, resized to
+  * <c>positions.size()</c>; may be <c>positions</c>.
+  */
+  void skinBatch(const Matrix* palette, const std::uint16_t* indices, const float* weights, int influences,
+                 const VectorBatch& positions, VectorBatch& outPositions);
+
+  /** Linear blend skinning batch, positions and normals. Positions as the positions only
+  * version; normals are transformed by the 3x3 part of the same blended matrix, without
+  * translation, and normalized again, since blended matrices shrink. For matrices with non
+  * uniform scale, pass normals in the space of the inverse transpose.
+  * @param palette Bone matrices, rigid or affine, bone space to model space.
+  * @param indices Array of <c>influences</c> * <c>positions.size()</c> bone indices.
+  * @param weights Array of <c>influences</c> * <c>positions.size()</c> weights. Unused
+  * influences have weight 0 and any valid index.
+  * @param influences Influences per vertex, 1 to <c>cMaxBlendInfluences</c>; usually 4 or 8.
+  * @param positions Positions in bind pose.
+  * @param normals Normals in bind pose, one per position.
+  * @param outPositions Batch to store the skinned positions in, resized to
+  * <c>positions.size()</c>; may be <c>positions</c>.
+  * @param outNormals Batch to store the skinned normals in, resized to <c>positions.size()</c>;
+  * may be <c>normals</c>. Zero length results are zero vectors.
+  */
+  void skinBatch(const Matrix* palette, const std::uint16_t* indices, const float* weights, int influences,
+                 const VectorBatch& positions, const VectorBatch& normals,
+                 VectorBatch& outPositions, VectorBatch& outNormals);
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "skinning.inl"
+#endif
+
+#endif // SKINNING_HPP_INCLUDED
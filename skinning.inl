@@ -0,0 +1,118 @@
+/**
+* @file skinning.inl
+* @author skwo
+* @brief Realization of linear blend skinning.
+* @note Included by skinning.cpp, or by skinning.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include "parallel.hpp"
+#include "profile.hpp"
+#include "simd.hpp"
+
+namespace skmath{
+
+  namespace detail{
+
+    //Blend of the matrices of a vertex, all 16 floats, column major
+    SKMATH_INLINE void blendMatrices(const Matrix* palette, const std::uint16_t* indices, const float* weights,
+                                     int influences, float* out)
+    {
+      for(int c = 0; c < 16; c++)
+        out[c] = 0.0f;
+
+      for(int k = 0; k < influences; k++)
+      {
+        const float* m = &palette[indices[k]][0];
+        const float w = weights[k];
+
+        for(int c = 0; c < 16; c++)
+          out[c] += w * m[c];
+      }
+    }
+
+    //Skin every vertex, and normal if given. Padding lanes get a zero matrix, their results are
+    //never read.
+    SKMATH_INLINE void blendSkin(const Matrix* palette, const std::uint16_t* indices, const float* weights, int influences,
+                                 const VectorBatch& positions, const VectorBatch* normals,
+                                 VectorBatch& outPositions, VectorBatch* outNormals)
+    {
+      using simd::Float;
+      using simd::cWidth;
+      using simd::madd;
+      using simd::mul;
+
+      const std::size_t size = positions.size();
+      outPositions.resize(size);
+      if(normals)
+        outNormals->resize(size);
+
+      const std::size_t groups = simd::roundUp(size, cWidth) / cWidth;
+      parallelFor(groups, cParallelGrain / (16 * cWidth), [&](std::size_t begin, std::size_t end) {
+        alignas(simd::cAlignment) float blends[16 * cWidth];
+        Float m00, m10, m20, m30, m01, m11, m21, m31, m02, m12, m22, m32, tx, ty, tz, m33;
+
+        for(std::size_t g = begin; g < end; g++)
+        {
+          const std::size_t i = g * cWidth;
+          for(std::size_t k = 0; k < cWidth; k++)
+          {
+            if(i + k < size)
+              blendMatrices(palette, indices + influences * (i + k), weights + influences * (i + k), influences, blends + 16 * k);
+            else
+            {
+              for(int c = 0; c < 16; c++)
+                blends[16 * k + c] = 0.0f;
+            }
+          }
+
+          //Columns of the blended matrices
+          simd::loadRecords(blends, 16, m00, m10, m20, m30);
+          simd::loadRecords(blends + 4, 16, m01, m11, m21, m31);
+          simd::loadRecords(blends + 8, 16, m02, m12, m22, m32);
+          simd::loadRecords(blends + 12, 16, tx, ty, tz, m33);
+
+          Float x = simd::load(positions.x() + i);
+          Float y = simd::load(positions.y() + i);
+          Float z = simd::load(positions.z() + i);
+          simd::store(outPositions.x() + i, madd(m00, x, madd(m01, y, madd(m02, z, tx))));
+          simd::store(outPositions.y() + i, madd(m10, x, madd(m11, y, madd(m12, z, ty))));
+          simd::store(outPositions.z() + i, madd(m20, x, madd(m21, y, madd(m22, z, tz))));
+
+          if(normals)
+          {
+            x = simd::load(normals->x() + i);
+            y = simd::load(normals->y() + i);
+            z = simd::load(normals->z() + i);
+            Float nx = madd(m00, x, madd(m01, y, mul(m02, z)));
+            Float ny = madd(m10, x, madd(m11, y, mul(m12, z)));
+            Float nz = madd(m20, x, madd(m21, y, mul(m22, z)));
+
+            //As VectorBatch::normalize
+            Float length = simd::sqrt(madd(nx, nx, madd(ny, ny, mul(nz, nz))));
+            Float nonZero = simd::cmpneq(length, simd::zero());
+            simd::store(outNormals->x() + i, simd::select(nonZero, simd::div(nx, length), simd::zero()));
+            simd::store(outNormals->y() + i, simd::select(nonZero, simd::div(ny, length), simd::zero()));
+            simd::store(outNormals->z() + i, simd::select(nonZero, simd::div(nz, length), simd::zero()));
+          }
+        }
+      });
+    }
+
+  };
+
+  //Skin batch
+  SKMATH_INLINE void skinBatch(const Matrix* palette, const std::uint16_t* indices, const float* weights, int influences,
+                               const VectorBatch& positions, VectorBatch& outPositions)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileSkinBatch);
+    detail::blendSkin(palette, indices, weights, influences, positions, nullptr, outPositions, nullptr);
+  }
+  SKMATH_INLINE void skinBatch(const Matrix* palette, const std::uint16_t* indices, const float* weights, int influences,
+                               const VectorBatch& positions, const VectorBatch& normals,
+                               VectorBatch& outPositions, VectorBatch& outNormals)
+  {
+    SKMATH_PROFILE_SCOPE(cProfileSkinBatch);
+    detail::blendSkin(palette, indices, weights, influences, positions, &normals, outPositions, &outNormals);
+  }
+
+};
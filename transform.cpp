@@ -0,0 +1,11 @@
+/**
+* @file transform.cpp
+* @author skwo
+* @brief Realization of transform hierarchy class.
+*/
+
+#include "transform.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "transform.inl"
+#endif
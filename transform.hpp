@@ -0,0 +1,176 @@
+/**
+* @file transform.hpp
+* @author skwo
+* @brief Defenition of transform hierarchy class.
+*
+* A TransformHierarchy keeps a tree of nodes, each with a local rotation, translation and scale,
+* and computes their world matrices, world = parent world * local. Nodes are stored in flat
+* arrays ordered by depth, so every parent is computed before its children, and a level is
+* computed in parallel. Only nodes that changed since the last update, and their subtrees, are
+* recomputed; local matrices are rebuilt with quaternionToMatrix only when the local transform
+* changed.
+*/
+
+#ifndef TRANSFORM_HPP_INCLUDED
+#define TRANSFORM_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "config.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "quaternion.hpp"
+
+namespace skmath{
+
+  /** Smallest number of nodes of one level worth handing to a thread of its own. */
+  const std::size_t cHierarchyGrain = 2048;
+
+  /** Transform. Rotation, translation and scale, applied scale first. */
+  struct Transform{
+    /** Constructor. Create identity transform. */
+    Transform();
+
+    /** Constructor. Create transform.
+    * @param r Rotation.
+    * @param t Translation.
+    * @param s Scale along each axis.
+    */
+    Transform(const Quaternion& r, const Vector& t, const Vector& s);
+
+    /** To matrix. Convert transform to matrix, translation * rotation * scale, with the same
+    * effect on points through transformPoints as rotate(rotation, scale * p) + translation.
+    * @param m Matrix to store converted transform in. The rotation part is quaternionToMatrix of
+    * the conjugated rotation, since quaternionToMatrix turns the other way than rotate.
+    */
+    void toMatrix(Matrix& m) const;
+
+    Quaternion rotation; /**< Rotation. */
+    Vector translation; /**< Translation. */
+    Vector scale; /**< Scale along each axis. */
+  };
+
+  class TransformHierarchy{
+    public:
+      /** Parent of root nodes. */
+      static const std::size_t cNoParent = ~std::size_t(0);
+
+      /** Constructor. Create empty hierarchy. */
+      TransformHierarchy();
+
+      /** Add node.
+      * @param local Local transform, relative to <c>parent</c>.
+      * @param parent Parent node, or <c>cNoParent</c> for a root.
+      * @return Node, valid for the lifetime of the hierarchy.
+      * @note <c>parent</c> must be an existing node. Adding a node shallower than the last added
+      * node makes the next update sort the arrays by depth again, so add nodes level by level when
+      * building large trees.
+      */
+      std::size_t add(const Transform& local, std::size_t parent = cNoParent);
+
+      /** Reserve memory.
+      * @param size Number of nodes to reserve memory for.
+      */
+      void reserve(std::size_t size);
+
+      /** Remove all nodes. */
+      void clear();
+
+      /** Get size.
+      * @return Number of nodes.
+      */
+      std::size_t size() const;
+
+      /** Get parent.
+      * @param node Node.
+      * @return Parent of <c>node</c>, or <c>cNoParent</c> for a root.
+      */
+      std::size_t parent(std::size_t node) const;
+
+      /** Get depth.
+      * @param node Node.
+      * @return Depth of <c>node</c>, 0 for a root.
+      */
+      std::size_t depth(std::size_t node) const;
+
+      /** Get local transform.
+      * @param node Node.
+      * @return Const reference to local transform of <c>node</c>.
+      */
+      const Transform& local(std::size_t node) const;
+
+      /** Set local transform. Marks <c>node</c> and its subtree for the next update.
+      * @param node Node.
+      * @param local New local transform.
+      */
+      void setLocal(std::size_t node, const Transform& local);
+
+      /** Set local rotation. Marks <c>node</c> and its subtree for the next update.
+      * @param node Node.
+      * @param rotation New local rotation.
+      */
+      void setRotation(std::size_t node, const Quaternion& rotation);
+
+      /** Set local translation. Marks <c>node</c> and its subtree for the next update.
+      * @param node Node.
+      * @param translation New local translation.
+      */
+      void setTranslation(std::size_t node, const Vector& translation);
+
+      /** Set local scale. Marks <c>node</c> and its subtree for the next update.
+      * @param node Node.
+      * @param scale New local scale.
+      */
+      void setScale(std::size_t node, const Vector& scale);
+
+      /** Get world matrix.
+      * @param node Node.
+      * @return Const reference to world matrix of <c>node</c> as of the last update.
+      */
+      const Matrix& world(std::size_t node) const;
+
+      /** Update. Recompute the world matrices of changed nodes and their subtrees, level by
+      * level, splitting large levels across threads.
+      */
+      void update();
+
+    private:
+      enum Flags{
+        cLocalDirty = 1, /**< Local matrix is out of date. */
+        cWorldDirty = 2, /**< World matrix is out of date. */
+        cChanged = 4 /**< World matrix was recomputed by the running update. */
+      };
+
+      //Mark slot for the next update
+      void mark(std::size_t slot);
+
+      //Stable sort of the slots by depth
+      void sort();
+
+      //Update slots [begin, end) of one level
+      void updateRange(std::size_t begin, std::size_t end);
+
+      //Per slot, ordered by depth
+      std::vector<std::size_t> _parent; /**< Slot of parent, or cNoParent. */
+      std::vector<std::size_t> _depth; /**< Depth. */
+      std::vector<std::size_t> _node; /**< Node stored in slot. */
+      std::vector<std::uint32_t> _flags; /**< Flags. */
+      std::vector<Transform> _local; /**< Local transform. */
+      std::vector<Matrix> _localMatrix; /**< Local transform as matrix. */
+      std::vector<Matrix> _world; /**< World matrix. */
+
+      std::vector<std::size_t> _slot; /**< Slot of node. */
+      std::vector<std::size_t> _levels; /**< First slot of every depth, then the number of slots. */
+      bool _sorted; /**< Slots are ordered by depth. */
+      bool _dirty; /**< Some slot is marked. */
+  };
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "transform.inl"
+#endif
+
+#endif // TRANSFORM_HPP_INCLUDED
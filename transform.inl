@@ -0,0 +1,278 @@
+/**
+* @file transform.inl
+* @author skwo
+* @brief Realization of transform hierarchy class.
+* @note Included by transform.cpp, or by transform.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include "parallel.hpp"
+#include "profile.hpp"
+
+namespace skmath{
+
+  //Constructor
+  SKMATH_INLINE Transform::Transform()
+    : rotation(), translation(), scale(1.0f, 1.0f, 1.0f)
+  {
+  }
+  SKMATH_INLINE Transform::Transform(const Quaternion& r, const Vector& t, const Vector& s)
+    : rotation(r), translation(t), scale(s)
+  {
+  }
+
+  //To matrix
+  SKMATH_INLINE void Transform::toMatrix(Matrix& m) const
+  {
+    //quaternionToMatrix turns the other way than rotate, see dualQuaternionToMatrix
+    quaternionToMatrix(rotation.conjugate(), m);
+
+    for(int c = 0; c < 3; c++)
+    {
+      m(0, c) *= scale[c];
+      m(1, c) *= scale[c];
+      m(2, c) *= scale[c];
+    }
+
+    m(0, 3) = translation[0];
+    m(1, 3) = translation[1];
+    m(2, 3) = translation[2];
+  }
+
+  //Constructor
+  SKMATH_INLINE TransformHierarchy::TransformHierarchy()
+    : _levels(1, 0), _sorted(true), _dirty(false)
+  {
+  }
+
+  //Add
+  SKMATH_INLINE std::size_t TransformHierarchy::add(const Transform& local, std::size_t parent)
+  {
+    const std::size_t node = _slot.size();
+    const std::size_t slot = _parent.size();
+    std::size_t parentSlot = parent;
+    std::size_t depth = 0;
+
+    if(parent != cNoParent)
+    {
+      parentSlot = _slot[parent];
+      depth = _depth[parentSlot] + 1;
+    }
+
+    //Appending keeps the order unless the node is shallower than the last one
+    if(slot != 0 && depth < _depth[slot - 1])
+      _sorted = false;
+
+    _parent.push_back(parentSlot);
+    _depth.push_back(depth);
+    _node.push_back(node);
+    _flags.push_back(cLocalDirty | cWorldDirty);
+    _local.push_back(local);
+    _localMatrix.push_back(Matrix());
+    _world.push_back(Matrix());
+    _slot.push_back(slot);
+    _dirty = true;
+
+    if(_sorted)
+    {
+      if(depth + 1 == _levels.size())
+        _levels.push_back(slot + 1);
+      else
+        _levels.back() = slot + 1;
+    }
+
+    return node;
+  }
+
+  //Reserve
+  SKMATH_INLINE void TransformHierarchy::reserve(std::size_t size)
+  {
+    _parent.reserve(size);
+    _depth.reserve(size);
+    _node.reserve(size);
+    _flags.reserve(size);
+    _local.reserve(size);
+    _localMatrix.reserve(size);
+    _world.reserve(size);
+    _slot.reserve(size);
+  }
+
+  //Clear
+  SKMATH_INLINE void TransformHierarchy::clear()
+  {
+    _parent.clear();
+    _depth.clear();
+    _node.clear();
+    _flags.clear();
+    _local.clear();
+    _localMatrix.clear();
+    _world.clear();
+    _slot.clear();
+    _levels.assign(1, 0);
+    _sorted = true;
+    _dirty = false;
+  }
+
+  //Size
+  SKMATH_INLINE std::size_t TransformHierarchy::size() const
+  {
+    return _slot.size();
+  }
+
+  //Parent
+  SKMATH_INLINE std::size_t TransformHierarchy::parent(std::size_t node) const
+  {
+    std::size_t parentSlot = _parent[_slot[node]];
+
+    return parentSlot == cNoParent ? parentSlot : _node[parentSlot];
+  }
+
+  //Depth
+  SKMATH_INLINE std::size_t TransformHierarchy::depth(std::size_t node) const
+  {
+    return _depth[_slot[node]];
+  }
+
+  //Local
+  SKMATH_INLINE const Transform& TransformHierarchy::local(std::size_t node) const
+  {
+    return _local[_slot[node]];
+  }
+  SKMATH_INLINE void TransformHierarchy::setLocal(std::size_t node, const Transform& local)
+  {
+    std::size_t slot = _slot[node];
+    _local[slot] = local;
+    mark(slot);
+  }
+  SKMATH_INLINE void TransformHierarchy::setRotation(std::size_t node, const Quaternion& rotation)
+  {
+    std::size_t slot = _slot[node];
+    _local[slot].rotation = rotation;
+    mark(slot);
+  }
+  SKMATH_INLINE void TransformHierarchy::setTranslation(std::size_t node, const Vector& translation)
+  {
+    std::size_t slot = _slot[node];
+    _local[slot].translation = translation;
+    mark(slot);
+  }
+  SKMATH_INLINE void TransformHierarchy::setScale(std::size_t node, const Vector& scale)
+  {
+    std::size_t slot = _slot[node];
+    _local[slot].scale = scale;
+    mark(slot);
+  }
+
+  //World
+  SKMATH_INLINE const Matrix& TransformHierarchy::world(std::size_t node) const
+  {
+    return _world[_slot[node]];
+  }
+
+  //Update
+  SKMATH_INLINE void TransformHierarchy::update()
+  {
+    SKMATH_PROFILE_SCOPE(cProfileHierarchyUpdate);
+    if(!_dirty)
+      return;
+
+    if(!_sorted)
+      sort();
+
+    //Parents are on earlier levels, so their flags are final when a level reads them
+    for(std::size_t d = 0; d + 1 < _levels.size(); d++)
+    {
+      const std::size_t begin = _levels[d];
+      parallelFor(_levels[d + 1] - begin, cHierarchyGrain, [this, begin](std::size_t first, std::size_t last) {
+        updateRange(begin + first, begin + last);
+      });
+    }
+
+    _dirty = false;
+  }
+
+  //Mark
+  SKMATH_INLINE void TransformHierarchy::mark(std::size_t slot)
+  {
+    _flags[slot] |= cLocalDirty | cWorldDirty;
+    _dirty = true;
+  }
+
+  //Sort
+  SKMATH_INLINE void TransformHierarchy::sort()
+  {
+    const std::size_t size = _parent.size();
+    std::size_t levels = 0;
+    for(std::size_t i = 0; i < size; i++)
+      if(_depth[i] + 1 > levels)
+        levels = _depth[i] + 1;
+
+    //Counting sort, keeps the order of nodes within a level
+    _levels.assign(levels + 1, 0);
+    for(std::size_t i = 0; i < size; i++)
+      _levels[_depth[i] + 1]++;
+    for(std::size_t d = 1; d <= levels; d++)
+      _levels[d] += _levels[d - 1];
+
+    std::vector<std::size_t> next(_levels.begin(), _levels.end() - 1);
+    std::vector<std::size_t> to(size);
+    for(std::size_t i = 0; i < size; i++)
+      to[i] = next[_depth[i]]++;
+
+    std::vector<std::size_t> parent(size), depth(size), node(size);
+    std::vector<std::uint32_t> flags(size);
+    std::vector<Transform> local(size);
+    std::vector<Matrix> localMatrix(size), world(size);
+
+    for(std::size_t i = 0; i < size; i++)
+    {
+      std::size_t j = to[i];
+      parent[j] = _parent[i] == cNoParent ? _parent[i] : to[_parent[i]];
+      depth[j] = _depth[i];
+      node[j] = _node[i];
+      flags[j] = _flags[i];
+      local[j] = _local[i];
+      localMatrix[j] = _localMatrix[i];
+      world[j] = _world[i];
+      _slot[_node[i]] = j;
+    }
+
+    _parent.swap(parent);
+    _depth.swap(depth);
+    _node.swap(node);
+    _flags.swap(flags);
+    _local.swap(local);
+    _localMatrix.swap(localMatrix);
+    _world.swap(world);
+    _sorted = true;
+  }
+
+  //Update range
+  SKMATH_INLINE void TransformHierarchy::updateRange(std::size_t begin, std::size_t end)
+  {
+    for(std::size_t i = begin; i < end; i++)
+    {
+      const std::size_t p = _parent[i];
+      std::uint32_t flags = _flags[i];
+
+      if(p != cNoParent && (_flags[p] & cChanged))
+        flags |= cWorldDirty;
+
+      if(!(flags & (cLocalDirty | cWorldDirty)))
+      {
+        _flags[i] = 0;
+        continue;
+      }
+
+      if(flags & cLocalDirty)
+        _local[i].toMatrix(_localMatrix[i]);
+
+      if(p == cNoParent)
+        _world[i] = _localMatrix[i];
+      else
+        multiply(_world[p], _localMatrix[i], _world[i]);
+
+      _flags[i] = cChanged;
+    }
+  }
+
+};
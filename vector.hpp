@@ -1,125 +1,258 @@
-/**
-* @file vector.hpp
-* @author skwo
-* @brief Defenition of vector class.
-*/
-
-#ifndef VECTOR_HPP_INCLUDED
-#define VECTOR_HPP_INCLUDED
-
-const unsigned short int cVectorSize = 3;
-
-namespace skmath{
-
-  class Vector{
-    public:
-      /** Constructor. Initialize vector to 0,0,0,1. */
-      Vector();
-
-      /** Copy constructor.
-      * @param v Vector to copy.
-      */
-      Vector(const Vector& v);
-
-      /** Constructor. Initialize vector.
-      * @param xVal X Value.
-      * @param yVal Y Value.
-      * @param zVal Z Value.
-      */
-      Vector(float xVal, float yVal, float zVal);
-
-      /** Destructor. */
-      ~Vector();
-
-      /** Norma. (xx + yy + zz)
-      * @return Sum of components in square.
-      */
-      float norm() const;
-
-      /** Calculate vector magnitude/length.
-      * @return Magnitude of vector.
-      */
-      float magnitude() const;
-
-      /** Normalize vector. */
-      Vector normalize() const;
-
-      /** Inverse vector. */
-      Vector inverse() const;
-
-      /** Dot product.
-      * @param rhs Reference to right value vector.
-      * @return Scalar number the dot product of <c>this</c> and <c>rhs</c>.
-      */
-      float dot(const Vector& rhs) const;
-
-
-      /** Const access operator.
-      * @param place Place of component to get.
-      * @return Const reference to component in <c>place</c>.
-      * @note Place must be 0, 1 or 2.
-      */
-      const float& operator [](const int place) const;
-
-      /** Access operator
-      * @param place Place of component to get.
-      * @return Reference to component in <c>place</c>.
-      * @note Place must be 0, 1 or 2.
-      */
-      float& operator [](const int place);
-
-      /** Equal to operator.
-      * @param rhs Right value vector.
-      * @return true if <c>this</c> and <c>rhs</c> are equal, otherwise false.
-      */
-      bool operator ==(const Vector& rhs) const;
-
-      /** Not equal to operator.
-      * @param rhs Right value vector.
-      * @return true if <c>this</c> and <c>rhs</c> are not equal, otherwise false.
-      */
-      bool operator !=(const Vector& rhs) const;
-
-      /** Assign operator.
-      * @param rhs Right value vector.
-      * @return reference to <c>this</c>.
-      */
-      Vector& operator =(const Vector& rhs);
-
-      /** Addition operator.
-      * @param rhs Right value vector.
-      * @return New vector the sum of <c>this</c> and <c>rhs</c>.
-      */
-      Vector operator +(const Vector& rhs) const;
-
-      /** Substraction operator.
-      * @param rhs Right value vector.
-      * @return New vector, the substract of <c>this</c> and <c>rhs</c>.
-      */
-      Vector operator -(const Vector& rhs) const;
-
-      /** Multiplication operator.
-      * @param rhs Right value vector.
-      * @return New vector, thr cross product of <c>this</c> and <c>rhs</c>.
-      */
-      Vector operator *(const Vector& rhs) const;
-
-      /** Multiplication operator.
-      * @param rhs Right value scalar.
-      * @return New vector, the multiplication of <c>this</c> and <c>rhs</c>.
-      */
-      Vector operator *(const float& rhs) const;
-
-      /** Division operator.
-      * @param rhs Right value scalar.
-      * @return New vector, the divison of <c>this</c> and <c>rhs</c>.
-      */
-      Vector operator /(const float& rhs) const;
-
-    private:
-      float _v[cVectorSize]; /**< The vector it self. */
-  };
-
-};
-
-#endif // VECTOR_HPP_INCLUDED
+/**
+* @file vector.hpp
+* @author skwo
+* @brief Defenition of vector class.
+*
+* BasicVector<T, N> is a vector of <c>N</c> components of type <c>T</c>. Every operation is
+* unrolled at compile time; float and double vectors of 4 components use SSE/AVX.
+* Vector, the 3 component float vector, is the one the rest of the library works with.
+*/
+
+#ifndef VECTOR_HPP_INCLUDED
+#define VECTOR_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+#include "fastmath.hpp"
+
+const unsigned short int cVectorSize = 3;
+
+namespace skmath{
+
+  namespace detail{
+
+    //Call func(std::integral_constant<int, I>()) for I = 0..N-1, unrolled at compile time
+    template<typename Func, int... I>
+    constexpr void unroll(Func& func, std::integer_sequence<int, I...>)
+    {
+      (func(std::integral_constant<int, I>()), ...);
+    }
+    template<int N, typename Func>
+    constexpr void unroll(Func func)
+    {
+      unroll(func, std::make_integer_sequence<int, N>());
+    }
+
+    /** Alignment of <c>N</c> values of type <c>T</c>: their size when it fits one SSE/AVX
+    * register exactly, 32 for larger multiples of 32 bytes, otherwise the alignment of <c>T</c>.
+    */
+    template<typename T, int N>
+    struct Alignment{
+      static const std::size_t cBytes = sizeof(T) * N;
+      static const std::size_t value = (cBytes <= 32 && (cBytes & (cBytes - 1)) == 0) ? cBytes :
+                                       (cBytes % 32 == 0 ? 32 : alignof(T));
+    };
+
+  };
+
+  template<typename T, int N>
+  class alignas(detail::Alignment<T, N>::value) BasicVector{
+    static_assert(std::is_floating_point<T>::value, "BasicVector needs a floating point type");
+    static_assert(N > 0, "BasicVector needs at least one component");
+
+    public:
+      typedef T Scalar;
+      static const int cSize = N;
+
+      /** Constructor. Initialize vector to 0. */
+      SKMATH_CONSTEXPR BasicVector();
+
+      /** Copy constructor.
+      * @param v Vector to copy.
+      */
+      BasicVector(const BasicVector& v) = default;
+
+      /** Constructor. Initialize 2 component vector.
+      * @param xVal X Value.
+      * @param yVal Y Value.
+      */
+      template<int M = N, typename std::enable_if<M == 2, int>::type = 0>
+      SKMATH_CONSTEXPR BasicVector(T xVal, T yVal);
+
+      /** Constructor. Initialize 3 component vector.
+      * @param xVal X Value.
+      * @param yVal Y Value.
+      * @param zVal Z Value.
+      */
+      template<int M = N, typename std::enable_if<M == 3, int>::type = 0>
+      SKMATH_CONSTEXPR BasicVector(T xVal, T yVal, T zVal);
+
+      /** Constructor. Initialize 4 component vector.
+      * @param xVal X Value.
+      * @param yVal Y Value.
+      * @param zVal Z Value.
+      * @param wVal W Value.
+      */
+      template<int M = N, typename std::enable_if<M == 4, int>::type = 0>
+      SKMATH_CONSTEXPR BasicVector(T xVal, T yVal, T zVal, T wVal);
+
+      /** Constructor. Initialize vector from array.
+      * @param v Array of <c>N</c> components.
+      */
+      SKMATH_CONSTEXPR explicit BasicVector(const T* v);
+
+      /** Destructor. */
+      ~BasicVector() = default;
+
+      /** Norma. (xx + yy + zz)
+      * @return Sum of components in square.
+      */
+      SKMATH_CONSTEXPR T norm() const;
+
+      /** Calculate vector magnitude/length.
+      * @return Magnitude of vector.
+      */
+      T magnitude() const;
+
+      /** Calculate vector magnitude/length, as magnitude().
+      * @return Magnitude of vector.
+      */
+      T magnitude(Exact) const;
+
+      /** Calculate vector magnitude/length, as magnitude(). The hardware square root is faster
+      * than rsqrt(Fast) and a multiply.
+      * @return Magnitude of vector.
+      */
+      T magnitude(Fast) const;
+
+      /** Normalize vector. */
+      BasicVector normalize() const;
+
+      /** Normalize vector, as normalize(). */
+      BasicVector normalize(Exact) const;
+
+      /** Normalize vector, multiplying by rsqrt(Fast) of the norm instead of dividing by the
+      * magnitude. Components are within <c>cFastNormalizeUlp</c> ulp.
+      */
+      BasicVector normalize(Fast) const;
+
+      /** Inverse vector. */
+      SKMATH_CONSTEXPR BasicVector inverse() const;
+
+      /** Dot product.
+      * @param rhs Reference to right value vector.
+      * @return Scalar number the dot product of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR T dot(const BasicVector& rhs) const;
+
+
+      /** Const access operator.
+      * @param place Place of component to get.
+      * @return Const reference to component in <c>place</c>.
+      * @note Place must be in range [0, N).
+      */
+      SKMATH_CONSTEXPR const T& operator [](const int place) const;
+
+      /** Access operator
+      * @param place Place of component to get.
+      * @return Reference to component in <c>place</c>.
+      * @note Place must be in range [0, N).
+      */
+      SKMATH_CONSTEXPR T& operator [](const int place);
+
+      /** Equal to operator.
+      * @param rhs Right value vector.
+      * @return true if <c>this</c> and <c>rhs</c> are equal, otherwise false.
+      */
+      bool operator ==(const BasicVector& rhs) const;
+
+      /** Not equal to operator.
+      * @param rhs Right value vector.
+      * @return true if <c>this</c> and <c>rhs</c> are not equal, otherwise false.
+      */
+      bool operator !=(const BasicVector& rhs) const;
+
+      /** Assign operator.
+      * @param rhs Right value vector.
+      * @return reference to <c>this</c>.
+      */
+      BasicVector& operator =(const BasicVector& rhs) = default;
+
+      /** Addition operator.
+      * @param rhs Right value vector.
+      * @return New vector the sum of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicVector operator +(const BasicVector& rhs) const;
+
+      /** Substraction operator.
+      * @param rhs Right value vector.
+      * @return New vector, the substract of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicVector operator -(const BasicVector& rhs) const;
+
+      /** Multiplication operator, 3 component vectors only.
+      * @param rhs Right value vector.
+      * @return New vector, thr cross product of <c>this</c> and <c>rhs</c>.
+      */
+      template<int M = N, typename std::enable_if<M == 3, int>::type = 0>
+      SKMATH_CONSTEXPR BasicVector operator *(const BasicVector& rhs) const;
+
+      /** Multiplication operator.
+      * @param rhs Right value scalar.
+      * @return New vector, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicVector operator *(const T& rhs) const;
+
+      /** Division operator.
+      * @param rhs Right value scalar.
+      * @return New vector, the divison of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicVector operator /(const T& rhs) const;
+
+      /** Addition assign operator.
+      * @param rhs Right value vector.
+      * @return reference to <c>this</c>, the sum of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicVector& operator +=(const BasicVector& rhs);
+
+      /** Substraction assign operator.
+      * @param rhs Right value vector.
+      * @return reference to <c>this</c>, the substract of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicVector& operator -=(const BasicVector& rhs);
+
+      /** Multiplication assign operator, 3 component vectors only.
+      * @param rhs Right value vector.
+      * @return reference to <c>this</c>, the cross product of <c>this</c> and <c>rhs</c>.
+      */
+      template<int M = N, typename std::enable_if<M == 3, int>::type = 0>
+      SKMATH_CONSTEXPR BasicVector& operator *=(const BasicVector& rhs);
+
+      /** Multiplication assign operator.
+      * @param rhs Right value scalar.
+      * @return reference to <c>this</c>, the multiplication of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicVector& operator *=(const T& rhs);
+
+      /** Division assign operator.
+      * @param rhs Right value scalar.
+      * @return reference to <c>this</c>, the divison of <c>this</c> and <c>rhs</c>.
+      */
+      SKMATH_CONSTEXPR BasicVector& operator /=(const T& rhs);
+
+    private:
+      T _v[N]; /**< The vector it self. */
+  };
+
+  typedef BasicVector<float, 2> Vector2f;
+  typedef BasicVector<float, 3> Vector3f;
+  typedef BasicVector<float, 4> Vector4f;
+  typedef BasicVector<double, 2> Vector2d;
+  typedef BasicVector<double, 3> Vector3d;
+  typedef BasicVector<double, 4> Vector4d;
+  typedef Vector3f Vector;
+
+  static_assert(sizeof(Vector) == cVectorSize * sizeof(float), "Vector must be packed, arrays of it are used as float arrays");
+  static_assert(std::is_trivially_copyable<Vector>::value, "Vector must be trivially copyable");
+  static_assert(std::is_standard_layout<Vector>::value, "Vector must be standard layout");
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "vector.inl"
+#endif
+
+#endif // VECTOR_HPP_INCLUDED
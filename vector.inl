@@ -0,0 +1,342 @@
+/**
+* @file vector.inl
+* @author skwo
+* @brief Realization of vector class.
+* @note Included by vector.cpp, or by vector.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <cmath>
+#include <limits>
+
+#include "simd.hpp"
+
+namespace skmath{
+
+  namespace detail{
+
+    //Element-wise kernels, unrolled at compile time. The overloads for 4 component float and
+    //double vectors below use one SSE/AVX register instead.
+
+    //a + b
+    template<typename T, int N>
+    SKMATH_CONSTEXPR SKMATH_INLINE void add(const BasicVector<T, N>& a, const BasicVector<T, N>& b, BasicVector<T, N>& r)
+    {
+      unroll<N>([&](auto i) { r[i] = a[i] + b[i]; });
+    }
+
+    //a - b
+    template<typename T, int N>
+    SKMATH_CONSTEXPR SKMATH_INLINE void sub(const BasicVector<T, N>& a, const BasicVector<T, N>& b, BasicVector<T, N>& r)
+    {
+      unroll<N>([&](auto i) { r[i] = a[i] - b[i]; });
+    }
+
+    //a * s
+    template<typename T, int N>
+    SKMATH_CONSTEXPR SKMATH_INLINE void scale(const BasicVector<T, N>& a, T s, BasicVector<T, N>& r)
+    {
+      unroll<N>([&](auto i) { r[i] = a[i] * s; });
+    }
+
+    //a / s
+    template<typename T, int N>
+    SKMATH_CONSTEXPR SKMATH_INLINE void divide(const BasicVector<T, N>& a, T s, BasicVector<T, N>& r)
+    {
+      unroll<N>([&](auto i) { r[i] = a[i] / s; });
+    }
+
+    //a . b
+    template<typename T, int N>
+    SKMATH_CONSTEXPR SKMATH_INLINE T dot(const BasicVector<T, N>& a, const BasicVector<T, N>& b)
+    {
+      T res = a[0] * b[0];
+      unroll<N - 1>([&](auto i) { res += a[i + 1] * b[i + 1]; });
+
+      return res;
+    }
+
+#if defined(SKMATH_SSE)
+    SKMATH_INLINE void add(const Vector4f& a, const Vector4f& b, Vector4f& r)
+    {
+      _mm_store_ps(&r[0], _mm_add_ps(_mm_load_ps(&a[0]), _mm_load_ps(&b[0])));
+    }
+    SKMATH_INLINE void sub(const Vector4f& a, const Vector4f& b, Vector4f& r)
+    {
+      _mm_store_ps(&r[0], _mm_sub_ps(_mm_load_ps(&a[0]), _mm_load_ps(&b[0])));
+    }
+    SKMATH_INLINE void scale(const Vector4f& a, float s, Vector4f& r)
+    {
+      _mm_store_ps(&r[0], _mm_mul_ps(_mm_load_ps(&a[0]), _mm_set1_ps(s)));
+    }
+    SKMATH_INLINE void divide(const Vector4f& a, float s, Vector4f& r)
+    {
+      _mm_store_ps(&r[0], _mm_div_ps(_mm_load_ps(&a[0]), _mm_set1_ps(s)));
+    }
+    SKMATH_INLINE float dot(const Vector4f& a, const Vector4f& b)
+    {
+      __m128 p = _mm_mul_ps(_mm_load_ps(&a[0]), _mm_load_ps(&b[0]));
+      p = _mm_add_ps(p, _mm_movehl_ps(p, p));
+      p = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+      return _mm_cvtss_f32(p);
+    }
+
+  #if defined(SKMATH_AVX)
+    SKMATH_INLINE void add(const Vector4d& a, const Vector4d& b, Vector4d& r)
+    {
+      _mm256_store_pd(&r[0], _mm256_add_pd(_mm256_load_pd(&a[0]), _mm256_load_pd(&b[0])));
+    }
+    SKMATH_INLINE void sub(const Vector4d& a, const Vector4d& b, Vector4d& r)
+    {
+      _mm256_store_pd(&r[0], _mm256_sub_pd(_mm256_load_pd(&a[0]), _mm256_load_pd(&b[0])));
+    }
+    SKMATH_INLINE void scale(const Vector4d& a, double s, Vector4d& r)
+    {
+      _mm256_store_pd(&r[0], _mm256_mul_pd(_mm256_load_pd(&a[0]), _mm256_set1_pd(s)));
+    }
+    SKMATH_INLINE void divide(const Vector4d& a, double s, Vector4d& r)
+    {
+      _mm256_store_pd(&r[0], _mm256_div_pd(_mm256_load_pd(&a[0]), _mm256_set1_pd(s)));
+    }
+    SKMATH_INLINE double dot(const Vector4d& a, const Vector4d& b)
+    {
+      __m256d p = _mm256_mul_pd(_mm256_load_pd(&a[0]), _mm256_load_pd(&b[0]));
+      __m128d s = _mm_add_pd(_mm256_castpd256_pd128(p), _mm256_extractf128_pd(p, 1));
+      return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+  #endif
+#endif
+
+  };
+
+  //Constructor
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>::BasicVector()
+    : _v{}
+  {
+  }
+  template<typename T, int N>
+  template<int M, typename std::enable_if<M == 2, int>::type>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>::BasicVector(T xVal, T yVal)
+    : _v{xVal, yVal}
+  {
+  }
+  template<typename T, int N>
+  template<int M, typename std::enable_if<M == 3, int>::type>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>::BasicVector(T xVal, T yVal, T zVal)
+    : _v{xVal, yVal, zVal}
+  {
+  }
+  template<typename T, int N>
+  template<int M, typename std::enable_if<M == 4, int>::type>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>::BasicVector(T xVal, T yVal, T zVal, T wVal)
+    : _v{xVal, yVal, zVal, wVal}
+  {
+  }
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>::BasicVector(const T* v)
+    : _v{}
+  {
+    detail::unroll<N>([&](auto i) { _v[i] = v[i]; });
+  }
+
+  //Norm
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE T BasicVector<T, N>::norm() const
+  {
+    return detail::dot(*this, *this);
+  }
+
+  //Magnitude
+  template<typename T, int N>
+  SKMATH_INLINE T BasicVector<T, N>::magnitude() const
+  {
+    return std::sqrt(this->norm());
+  }
+  template<typename T, int N>
+  SKMATH_INLINE T BasicVector<T, N>::magnitude(Exact) const
+  {
+    return this->magnitude();
+  }
+  template<typename T, int N>
+  SKMATH_INLINE T BasicVector<T, N>::magnitude(Fast) const
+  {
+    return this->magnitude();
+  }
+
+  //Normalize
+  template<typename T, int N>
+  SKMATH_INLINE BasicVector<T, N> BasicVector<T, N>::normalize() const
+  {
+    T length = this->magnitude();
+    BasicVector res;
+
+    if(length != T(0))
+      detail::divide(*this, length, res);
+
+    return res;
+  }
+
+  template<typename T, int N>
+  SKMATH_INLINE BasicVector<T, N> BasicVector<T, N>::normalize(Exact) const
+  {
+    return this->normalize();
+  }
+  template<typename T, int N>
+  SKMATH_INLINE BasicVector<T, N> BasicVector<T, N>::normalize(Fast) const
+  {
+    T n = this->norm();
+
+    //Zero and subnormal norms are out of range of the rsqrt estimate
+    if(n < std::numeric_limits<T>::min())
+      return this->normalize();
+
+    BasicVector res;
+    detail::scale(*this, rsqrt(n, Fast()), res);
+
+    return res;
+  }
+
+  //Inverse
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N> BasicVector<T, N>::inverse() const
+  {
+    BasicVector res;
+    detail::unroll<N>([&](auto i) { res._v[i] = -_v[i]; });
+
+    return res;
+  }
+
+  //Dot
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE T BasicVector<T, N>::dot(const BasicVector& rhs) const
+  {
+    return detail::dot(*this, rhs);
+  }
+
+  //Operator []
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE const T& BasicVector<T, N>::operator [](const int place) const
+  {
+    return _v[place];
+  }
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE T& BasicVector<T, N>::operator [](const int place)
+  {
+    return _v[place];
+  }
+
+  //Operator ==
+  template<typename T, int N>
+  SKMATH_INLINE bool BasicVector<T, N>::operator ==(const BasicVector& rhs) const
+  {
+    if(&rhs == this)
+      return true;
+
+    bool res = true;
+    detail::unroll<N>([&](auto i) { res = res && (_v[i] == rhs[i]); });
+
+    return res;
+  }
+
+  //Operator !=
+  template<typename T, int N>
+  SKMATH_INLINE bool BasicVector<T, N>::operator !=(const BasicVector& rhs) const
+  {
+    return !(*this == rhs);
+  }
+
+  //Operator +
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N> BasicVector<T, N>::operator +(const BasicVector& rhs) const
+  {
+    BasicVector res;
+    detail::add(*this, rhs, res);
+
+    return res;
+  }
+
+  //Operator -
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N> BasicVector<T, N>::operator -(const BasicVector& rhs) const
+  {
+    BasicVector res;
+    detail::sub(*this, rhs, res);
+
+    return res;
+  }
+
+  //Operator *
+  template<typename T, int N>
+  template<int M, typename std::enable_if<M == 3, int>::type>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N> BasicVector<T, N>::operator *(const BasicVector& rhs) const
+  {
+    BasicVector res(_v[1] * rhs[2] - _v[2] * rhs[1],  //Ay*Bz - Az*By
+                    _v[2] * rhs[0] - _v[0] * rhs[2],  //Az*Bx - Ax*Bz
+                    _v[0] * rhs[1] - _v[1] * rhs[0]); //Ax*By - Ay*Bx
+
+    return res;
+  }
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N> BasicVector<T, N>::operator *(const T& rhs) const
+  {
+    BasicVector res;
+    detail::scale(*this, rhs, res);
+
+    return res;
+  }
+
+  //Operator /
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N> BasicVector<T, N>::operator /(const T& rhs) const
+  {
+    BasicVector res;
+    detail::divide(*this, rhs, res);
+
+    return res;
+  }
+
+  //Operator +=
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>& BasicVector<T, N>::operator +=(const BasicVector& rhs)
+  {
+    detail::add(*this, rhs, *this);
+
+    return *this;
+  }
+
+  //Operator -=
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>& BasicVector<T, N>::operator -=(const BasicVector& rhs)
+  {
+    detail::sub(*this, rhs, *this);
+
+    return *this;
+  }
+
+  //Operator *=
+  template<typename T, int N>
+  template<int M, typename std::enable_if<M == 3, int>::type>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>& BasicVector<T, N>::operator *=(const BasicVector& rhs)
+  {
+    *this = *this * rhs;
+
+    return *this;
+  }
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>& BasicVector<T, N>::operator *=(const T& rhs)
+  {
+    detail::scale(*this, rhs, *this);
+
+    return *this;
+  }
+
+  //Operator /=
+  template<typename T, int N>
+  SKMATH_CONSTEXPR SKMATH_INLINE BasicVector<T, N>& BasicVector<T, N>::operator /=(const T& rhs)
+  {
+    detail::divide(*this, rhs, *this);
+
+    return *this;
+  }
+
+};
@@ -0,0 +1,11 @@
+/**
+* @file vectorbatch.cpp
+* @author skwo
+* @brief Realization of vector batch class.
+*/
+
+#include "vectorbatch.hpp"
+
+#ifndef SKMATH_HEADER_ONLY
+  #include "vectorbatch.inl"
+#endif
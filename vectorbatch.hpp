@@ -0,0 +1,209 @@
+/**
+* @file vectorbatch.hpp
+* @author skwo
+* @brief Defenition of vector batch class.
+*
+* A VectorBatch stores many vectors as structure of arrays: all x components, then all y
+* components, then all z components, each array aligned to a cache line and padded to a
+* whole number of SIMD registers. Every operation of Vector has a batch version that runs
+* over the whole batch with SSE/AVX.
+*/
+
+#ifndef VECTORBATCH_HPP_INCLUDED
+#define VECTORBATCH_HPP_INCLUDED
+
+#include <cstddef>
+
+#include "config.hpp"
+#include "vector.hpp"
+
+namespace skmath{
+
+  class VectorBatch{
+    public:
+      /** Constructor. Create empty batch. */
+      VectorBatch();
+
+      /** Constructor. Create batch of <c>size</c> zero vectors.
+      * @param size Number of vectors.
+      */
+      explicit VectorBatch(std::size_t size);
+
+      /** Constructor. Create batch from array of vectors.
+      * @param v Array of vectors.
+      * @param size Number of vectors in <c>v</c>.
+      */
+      VectorBatch(const Vector* v, std::size_t size);
+
+      /** Copy constructor.
+      * @param b Batch to copy.
+      */
+      VectorBatch(const VectorBatch& b);
+
+      /** Move constructor.
+      * @param b Batch to move, left empty.
+      */
+      VectorBatch(VectorBatch&& b) noexcept;
+
+      /** Destructor. */
+      ~VectorBatch();
+
+      /** Assign operator.
+      * @param rhs Right value batch.
+      * @return reference to <c>this</c>.
+      */
+      VectorBatch& operator =(const VectorBatch& rhs);
+
+      /** Move assign operator.
+      * @param rhs Right value batch, left empty.
+      * @return reference to <c>this</c>.
+      */
+      VectorBatch& operator =(VectorBatch&& rhs) noexcept;
+
+      /** Get size.
+      * @return Number of vectors in batch.
+      */
+      std::size_t size() const;
+
+      /** Resize batch. Existing vectors are kept, new vectors are zero.
+      * @param size New number of vectors.
+      */
+      void resize(std::size_t size);
+
+      /** Get X components.
+      * @return Aligned array of <c>size()</c> x components.
+      */
+      float* x();
+      const float* x() const;
+
+      /** Get Y components.
+      * @return Aligned array of <c>size()</c> y components.
+      */
+      float* y();
+      const float* y() const;
+
+      /** Get Z components.
+      * @return Aligned array of <c>size()</c> z components.
+      */
+      float* z();
+      const float* z() const;
+
+      /** Get vector.
+      * @param place Index of vector.
+      * @return Vector in <c>place</c>.
+      */
+      Vector get(std::size_t place) const;
+
+      /** Set vector.
+      * @param place Index of vector.
+      * @param v Vector to store in <c>place</c>.
+      */
+      void set(std::size_t place, const Vector& v);
+
+      /** Gather. Load array of vectors into the batch, resizing it to <c>size</c>.
+      * The components are transposed straight from <c>v</c> into the batch arrays.
+      * @param v Array of vectors.
+      * @param size Number of vectors in <c>v</c>.
+      */
+      void gather(const Vector* v, std::size_t size);
+
+      /** Scatter. Store the batch into an array of vectors.
+      * The components are transposed straight from the batch arrays into <c>v</c>.
+      * @param v Array of at least <c>size()</c> vectors.
+      */
+      void scatter(Vector* v) const;
+
+      /** Norma of every vector. (xx + yy + zz)
+      * @param out Array of at least <c>size()</c> floats to store the result in.
+      */
+      void norm(float* out) const;
+
+      /** Magnitude of every vector.
+      * @param out Array of at least <c>size()</c> floats to store the result in.
+      */
+      void magnitude(float* out) const;
+
+      /** Magnitude of every vector, as magnitude(out).
+      * @param out Array of at least <c>size()</c> floats to store the result in.
+      */
+      void magnitude(float* out, Exact) const;
+
+      /** Magnitude of every vector, as magnitude(out), see Vector::magnitude(Fast).
+      * @param out Array of at least <c>size()</c> floats to store the result in.
+      */
+      void magnitude(float* out, Fast) const;
+
+      /** Normalize every vector. Zero length vectors become zero vectors, as in Vector::normalize.
+      * @param out Batch to store the result in, may be <c>this</c>.
+      */
+      void normalize(VectorBatch& out) const;
+
+      /** Normalize every vector, as normalize(out).
+      * @param out Batch to store the result in, may be <c>this</c>.
+      */
+      void normalize(VectorBatch& out, Exact) const;
+
+      /** Normalize every vector, as Vector::normalize(Fast). Vectors with a norm below the
+      * smallest normal float, shorter than about 1.1e-19, become zero vectors.
+      * @param out Batch to store the result in, may be <c>this</c>.
+      */
+      void normalize(VectorBatch& out, Fast) const;
+
+      /** Inverse every vector.
+      * @param out Batch to store the result in, may be <c>this</c>.
+      */
+      void inverse(VectorBatch& out) const;
+
+      /** Dot product of every pair.
+      * @param rhs Right value batch.
+      * @param out Array of at least <c>size()</c> floats to store the result in.
+      * @note <c>rhs</c> must have the same size as <c>this</c>.
+      */
+      void dot(const VectorBatch& rhs, float* out) const;
+
+      /** Cross product of every pair.
+      * @param rhs Right value batch.
+      * @param out Batch to store the result in, may be <c>this</c> or <c>rhs</c>.
+      * @note <c>rhs</c> must have the same size as <c>this</c>.
+      */
+      void cross(const VectorBatch& rhs, VectorBatch& out) const;
+
+      /** Sum of every pair.
+      * @param rhs Right value batch.
+      * @param out Batch to store the result in, may be <c>this</c> or <c>rhs</c>.
+      * @note <c>rhs</c> must have the same size as <c>this</c>.
+      */
+      void add(const VectorBatch& rhs, VectorBatch& out) const;
+
+      /** Substract of every pair.
+      * @param rhs Right value batch.
+      * @param out Batch to store the result in, may be <c>this</c> or <c>rhs</c>.
+      * @note <c>rhs</c> must have the same size as <c>this</c>.
+      */
+      void sub(const VectorBatch& rhs, VectorBatch& out) const;
+
+      /** Multiply every vector by scalar.
+      * @param rhs Right value scalar.
+      * @param out Batch to store the result in, may be <c>this</c>.
+      */
+      void scale(float rhs, VectorBatch& out) const;
+
+      /** Divide every vector by scalar.
+      * @param rhs Right value scalar.
+      * @param out Batch to store the result in, may be <c>this</c>.
+      */
+      void divide(float rhs, VectorBatch& out) const;
+
+    private:
+      float* _data; /**< x, y and z arrays, <c>_capacity</c> floats each. */
+      std::size_t _size; /**< Number of vectors. */
+      std::size_t _capacity; /**< Number of floats allocated per component. */
+  };
+
+};
+
+#ifdef SKMATH_HEADER_ONLY
+  #include "vectorbatch.inl"
+#endif
+
+#endif // VECTORBATCH_HPP_INCLUDED
@@ -0,0 +1,405 @@
+/**
+* @file vectorbatch.inl
+* @author skwo
+* @brief Realization of vector batch class.
+* @note Included by vectorbatch.cpp, or by vectorbatch.hpp when <c>SKMATH_HEADER_ONLY</c> is defined.
+*/
+
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "simd.hpp"
+
+namespace skmath{
+
+  //Constructor
+  SKMATH_INLINE VectorBatch::VectorBatch()
+    : _data(0), _size(0), _capacity(0)
+  {
+  }
+  SKMATH_INLINE VectorBatch::VectorBatch(std::size_t size)
+    : _data(0), _size(0), _capacity(0)
+  {
+    resize(size);
+  }
+  SKMATH_INLINE VectorBatch::VectorBatch(const Vector* v, std::size_t size)
+    : _data(0), _size(0), _capacity(0)
+  {
+    gather(v, size);
+  }
+  SKMATH_INLINE VectorBatch::VectorBatch(const VectorBatch& b)
+    : _data(0), _size(0), _capacity(0)
+  {
+    *this = b;
+  }
+  SKMATH_INLINE VectorBatch::VectorBatch(VectorBatch&& b) noexcept
+    : _data(b._data), _size(b._size), _capacity(b._capacity)
+  {
+    b._data = 0;
+    b._size = 0;
+    b._capacity = 0;
+  }
+
+  //Destructor
+  SKMATH_INLINE VectorBatch::~VectorBatch()
+  {
+    simd::alignedFree(_data);
+  }
+
+  //Operator =
+  SKMATH_INLINE VectorBatch& VectorBatch::operator =(const VectorBatch& rhs)
+  {
+    if(&rhs == this)
+      return *this;
+
+    resize(rhs.size());
+    if(_size != 0)
+    {
+      std::memcpy(x(), rhs.x(), _size * sizeof(float));
+      std::memcpy(y(), rhs.y(), _size * sizeof(float));
+      std::memcpy(z(), rhs.z(), _size * sizeof(float));
+    }
+
+    return *this;
+  }
+  SKMATH_INLINE VectorBatch& VectorBatch::operator =(VectorBatch&& rhs) noexcept
+  {
+    std::swap(_data, rhs._data);
+    std::swap(_size, rhs._size);
+    std::swap(_capacity, rhs._capacity);
+
+    return *this;
+  }
+
+  //Size
+  SKMATH_INLINE std::size_t VectorBatch::size() const
+  {
+    return _size;
+  }
+
+  //Resize
+  SKMATH_INLINE void VectorBatch::resize(std::size_t size)
+  {
+    if(size <= _capacity)
+    {
+      if(size > _size)
+      {
+        std::memset(x() + _size, 0, (size - _size) * sizeof(float));
+        std::memset(y() + _size, 0, (size - _size) * sizeof(float));
+        std::memset(z() + _size, 0, (size - _size) * sizeof(float));
+      }
+      _size = size;
+      return;
+    }
+
+    //Every component array starts on a cache line
+    std::size_t capacity = simd::roundUp(size, simd::cAlignment / sizeof(float));
+    float* data = static_cast<float*>(simd::alignedAlloc(3 * capacity * sizeof(float)));
+    std::memset(data, 0, 3 * capacity * sizeof(float));
+
+    if(_size != 0)
+    {
+      std::memcpy(data, x(), _size * sizeof(float));
+      std::memcpy(data + capacity, y(), _size * sizeof(float));
+      std::memcpy(data + 2 * capacity, z(), _size * sizeof(float));
+    }
+
+    simd::alignedFree(_data);
+    _data = data;
+    _size = size;
+    _capacity = capacity;
+  }
+
+  //Get components
+  SKMATH_INLINE float* VectorBatch::x()
+  {
+    return _data;
+  }
+  SKMATH_INLINE const float* VectorBatch::x() const
+  {
+    return _data;
+  }
+  SKMATH_INLINE float* VectorBatch::y()
+  {
+    return _data + _capacity;
+  }
+  SKMATH_INLINE const float* VectorBatch::y() const
+  {
+    return _data + _capacity;
+  }
+  SKMATH_INLINE float* VectorBatch::z()
+  {
+    return _data + 2 * _capacity;
+  }
+  SKMATH_INLINE const float* VectorBatch::z() const
+  {
+    return _data + 2 * _capacity;
+  }
+
+  //Get
+  SKMATH_INLINE Vector VectorBatch::get(std::size_t place) const
+  {
+    return Vector(x()[place], y()[place], z()[place]);
+  }
+
+  //Set
+  SKMATH_INLINE void VectorBatch::set(std::size_t place, const Vector& v)
+  {
+    x()[place] = v[0];
+    y()[place] = v[1];
+    z()[place] = v[2];
+  }
+
+  //Gather
+  SKMATH_INLINE void VectorBatch::gather(const Vector* v, std::size_t size)
+  {
+    resize(size);
+
+    float* px = x();
+    float* py = y();
+    float* pz = z();
+    std::size_t i = 0;
+
+#if defined(SKMATH_SSE)
+    for(; i + 4 <= size; i += 4)
+    {
+      __m128 vx, vy, vz;
+      simd::loadVectors4(&v[i][0], vx, vy, vz);
+      _mm_store_ps(px + i, vx);
+      _mm_store_ps(py + i, vy);
+      _mm_store_ps(pz + i, vz);
+    }
+#endif
+
+    for(; i < size; i++)
+    {
+      px[i] = v[i][0];
+      py[i] = v[i][1];
+      pz[i] = v[i][2];
+    }
+  }
+
+  //Scatter
+  SKMATH_INLINE void VectorBatch::scatter(Vector* v) const
+  {
+    const float* px = x();
+    const float* py = y();
+    const float* pz = z();
+    std::size_t i = 0;
+
+#if defined(SKMATH_SSE)
+    for(; i + 4 <= _size; i += 4)
+      simd::storeVectors4(&v[i][0], _mm_load_ps(px + i), _mm_load_ps(py + i), _mm_load_ps(pz + i));
+#endif
+
+    for(; i < _size; i++)
+      v[i] = Vector(px[i], py[i], pz[i]);
+  }
+
+  //Norm
+  SKMATH_INLINE void VectorBatch::norm(float* out) const
+  {
+    const float* px = x();
+    const float* py = y();
+    const float* pz = z();
+    std::size_t i = 0;
+
+    for(; i + simd::cWidth <= _size; i += simd::cWidth)
+    {
+      simd::Float vx = simd::load(px + i);
+      simd::Float vy = simd::load(py + i);
+      simd::Float vz = simd::load(pz + i);
+      simd::storeu(out + i, simd::add(simd::add(simd::mul(vx, vx), simd::mul(vy, vy)), simd::mul(vz, vz)));
+    }
+
+    for(; i < _size; i++)
+      out[i] = px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i];
+  }
+
+  //Magnitude
+  SKMATH_INLINE void VectorBatch::magnitude(float* out) const
+  {
+    norm(out);
+
+    std::size_t i = 0;
+    for(; i + simd::cWidth <= _size; i += simd::cWidth)
+      simd::storeu(out + i, simd::sqrt(simd::loadu(out + i)));
+
+    for(; i < _size; i++)
+      out[i] = static_cast<float>(sqrt(out[i]));
+  }
+  SKMATH_INLINE void VectorBatch::magnitude(float* out, Exact) const
+  {
+    magnitude(out);
+  }
+  SKMATH_INLINE void VectorBatch::magnitude(float* out, Fast) const
+  {
+    magnitude(out);
+  }
+
+  //Normalize
+  SKMATH_INLINE void VectorBatch::normalize(VectorBatch& out) const
+  {
+    out.resize(_size);
+
+    //Padding lanes are processed too, their results are never read
+    const std::size_t count = simd::roundUp(_size, simd::cWidth);
+    const simd::Float zero = simd::zero();
+
+    for(std::size_t i = 0; i < count; i += simd::cWidth)
+    {
+      simd::Float vx = simd::load(x() + i);
+      simd::Float vy = simd::load(y() + i);
+      simd::Float vz = simd::load(z() + i);
+      simd::Float length = simd::sqrt(simd::add(simd::add(simd::mul(vx, vx), simd::mul(vy, vy)), simd::mul(vz, vz)));
+      simd::Float nonZero = simd::cmpneq(length, zero);
+
+      simd::store(out.x() + i, simd::select(nonZero, simd::div(vx, length), zero));
+      simd::store(out.y() + i, simd::select(nonZero, simd::div(vy, length), zero));
+      simd::store(out.z() + i, simd::select(nonZero, simd::div(vz, length), zero));
+    }
+  }
+  SKMATH_INLINE void VectorBatch::normalize(VectorBatch& out, Exact) const
+  {
+    normalize(out);
+  }
+  SKMATH_INLINE void VectorBatch::normalize(VectorBatch& out, Fast) const
+  {
+    out.resize(_size);
+
+    const std::size_t count = simd::roundUp(_size, simd::cWidth);
+    const simd::Float zero = simd::zero();
+    const simd::Float normal = simd::set1(std::numeric_limits<float>::min());
+
+    for(std::size_t i = 0; i < count; i += simd::cWidth)
+    {
+      simd::Float vx = simd::load(x() + i);
+      simd::Float vy = simd::load(y() + i);
+      simd::Float vz = simd::load(z() + i);
+      simd::Float n = simd::madd(vx, vx, simd::madd(vy, vy, simd::mul(vz, vz)));
+      simd::Float s = simd::select(simd::cmplt(n, normal), zero, simd::rsqrt(simd::max(n, normal), Fast()));
+
+      simd::store(out.x() + i, simd::mul(vx, s));
+      simd::store(out.y() + i, simd::mul(vy, s));
+      simd::store(out.z() + i, simd::mul(vz, s));
+    }
+  }
+
+  //Inverse
+  SKMATH_INLINE void VectorBatch::inverse(VectorBatch& out) const
+  {
+    out.resize(_size);
+
+    const std::size_t count = simd::roundUp(_size, simd::cWidth);
+    for(std::size_t i = 0; i < count; i += simd::cWidth)
+    {
+      simd::store(out.x() + i, simd::neg(simd::load(x() + i)));
+      simd::store(out.y() + i, simd::neg(simd::load(y() + i)));
+      simd::store(out.z() + i, simd::neg(simd::load(z() + i)));
+    }
+  }
+
+  //Dot
+  SKMATH_INLINE void VectorBatch::dot(const VectorBatch& rhs, float* out) const
+  {
+    const float* ax = x();
+    const float* ay = y();
+    const float* az = z();
+    const float* bx = rhs.x();
+    const float* by = rhs.y();
+    const float* bz = rhs.z();
+    std::size_t i = 0;
+
+    for(; i + simd::cWidth <= _size; i += simd::cWidth)
+    {
+      simd::Float r = simd::add(simd::add(simd::mul(simd::load(ax + i), simd::load(bx + i)),
+                                          simd::mul(simd::load(ay + i), simd::load(by + i))),
+                                simd::mul(simd::load(az + i), simd::load(bz + i)));
+      simd::storeu(out + i, r);
+    }
+
+    for(; i < _size; i++)
+      out[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+  }
+
+  //Cross
+  SKMATH_INLINE void VectorBatch::cross(const VectorBatch& rhs, VectorBatch& out) const
+  {
+    out.resize(_size);
+
+    const std::size_t count = simd::roundUp(_size, simd::cWidth);
+    for(std::size_t i = 0; i < count; i += simd::cWidth)
+    {
+      simd::Float ax = simd::load(x() + i);
+      simd::Float ay = simd::load(y() + i);
+      simd::Float az = simd::load(z() + i);
+      simd::Float bx = simd::load(rhs.x() + i);
+      simd::Float by = simd::load(rhs.y() + i);
+      simd::Float bz = simd::load(rhs.z() + i);
+
+      simd::store(out.x() + i, simd::sub(simd::mul(ay, bz), simd::mul(az, by)));  //Ay*Bz - Az*By
+      simd::store(out.y() + i, simd::sub(simd::mul(az, bx), simd::mul(ax, bz)));  //Az*Bx - Ax*Bz
+      simd::store(out.z() + i, simd::sub(simd::mul(ax, by), simd::mul(ay, bx)));  //Ax*By - Ay*Bx
+    }
+  }
+
+  //Add
+  SKMATH_INLINE void VectorBatch::add(const VectorBatch& rhs, VectorBatch& out) const
+  {
+    out.resize(_size);
+
+    const std::size_t count = simd::roundUp(_size, simd::cWidth);
+    for(std::size_t i = 0; i < count; i += simd::cWidth)
+    {
+      simd::store(out.x() + i, simd::add(simd::load(x() + i), simd::load(rhs.x() + i)));
+      simd::store(out.y() + i, simd::add(simd::load(y() + i), simd::load(rhs.y() + i)));
+      simd::store(out.z() + i, simd::add(simd::load(z() + i), simd::load(rhs.z() + i)));
+    }
+  }
+
+  //Sub
+  SKMATH_INLINE void VectorBatch::sub(const VectorBatch& rhs, VectorBatch& out) const
+  {
+    out.resize(_size);
+
+    const std::size_t count = simd::roundUp(_size, simd::cWidth);
+    for(std::size_t i = 0; i < count; i += simd::cWidth)
+    {
+      simd::store(out.x() + i, simd::sub(simd::load(x() + i), simd::load(rhs.x() + i)));
+      simd::store(out.y() + i, simd::sub(simd::load(y() + i), simd::load(rhs.y() + i)));
+      simd::store(out.z() + i, simd::sub(simd::load(z() + i), simd::load(rhs.z() + i)));
+    }
+  }
+
+  //Scale
+  SKMATH_INLINE void VectorBatch::scale(float rhs, VectorBatch& out) const
+  {
+    out.resize(_size);
+
+    const simd::Float s = simd::set1(rhs);
+    const std::size_t count = simd::roundUp(_size, simd::cWidth);
+    for(std::size_t i = 0; i < count; i += simd::cWidth)
+    {
+      simd::store(out.x() + i, simd::mul(simd::load(x() + i), s));
+      simd::store(out.y() + i, simd::mul(simd::load(y() + i), s));
+      simd::store(out.z() + i, simd::mul(simd::load(z() + i), s));
+    }
+  }
+
+  //Divide
+  SKMATH_INLINE void VectorBatch::divide(float rhs, VectorBatch& out) const
+  {
+    out.resize(_size);
+
+    const simd::Float s = simd::set1(rhs);
+    const std::size_t count = simd::roundUp(_size, simd::cWidth);
+    for(std::size_t i = 0; i < count; i += simd::cWidth)
+    {
+      simd::store(out.x() + i, simd::div(simd::load(x() + i), s));
+      simd::store(out.y() + i, simd::div(simd::load(y() + i), s));
+      simd::store(out.z() + i, simd::div(simd::load(z() + i), s));
+    }
+  }
+
+};